@@ -36,7 +36,10 @@ if(LIBRARY_HAS_TESTS)
 
     add_library(${LIB_TESTS} INTERFACE)
     target_link_libraries(${LIB_TESTS} INTERFACE ${LIB})
-    target_link_libraries(${LIB_TESTS} INTERFACE Testing)
+    # tests are plain executables that return non-zero on failure, a test library is only linked if there is one
+    if(TARGET Testing)
+        target_link_libraries(${LIB_TESTS} INTERFACE Testing)
+    endif()
     message(STATUS "Library has tests: ")
 
     file(GLOB Tests
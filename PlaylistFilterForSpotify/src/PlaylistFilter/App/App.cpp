@@ -1,7 +1,11 @@
 #include "CommonStructs/CommonStructs.hpp"
 #include <App/App.hpp>
 #include <DynamicBitset/DynamicBitset.hpp>
+#include <FrameTiming/FrameTiming.hpp>
+#include <Graphing/Graphing.hpp>
 #include <Renderer/Renderer.hpp>
+#include <Spotify/ApiError.hpp>
+#include <Spotify/PlaylistSource.hpp>
 
 #include <GLFW/glfw3.h>
 #include <algorithm>
@@ -19,8 +23,7 @@
 
 App::App() : renderer(*this), pinnedTracksTable(*this, pinnedTracks), filteredTracksTable(*this, filteredTracks)
 {
-    apiAccess = SpotifyApiAccess();
-    resetFeatureFilters();
+    model.trackFilter.setThreadPool(&workerPool);
     userInput.fill(0);
 }
 
@@ -65,26 +68,195 @@ bool App::checkAuth()
 }
 
 // This is started asynchronously
-void App::loadSelectedPlaylist()
+SpotifyApiAccess::PlaylistData_t App::loadSelectedPlaylist(std::string id, PlaylistStream* stream)
 {
-    // have to use std::tie for now since CLANG doesnt allow for structured bindings to be captured in
-    // lambda can switch back if lambda refactored into function
-    std::tie(playlist, coverTable, genreNames, artistIds, artistIdToIndex) =
-        apiAccess.buildPlaylistData(playlistID, &loadPlaylistProgress, &loadingPlaylistProgressLabel);
-    // auto [playlist, coverTable] = apiAccess.buildPlaylistData(playlistID);
+    PlaylistSource source = loadPlaylistSource(apiAccess, id, loadProgress, stream);
+    loadProgress.startPhase(LoadProgress::Phase::Analyzing, 0);
+    return buildPlaylistData(source);
+}
+
+void App::startPlaylistStream()
+{
+    coverLoader.cancel();
+    // nothing may point into the playlist while its filled, so it cant reallocate
+    model.playlist.clear();
+    model.playlist.reserve(playlistStream->getExpectedTrackCount());
+    model.trackFeatures = FeatureStore{};
+    model.coverTable.clear();
+    model.genreNames.clear();
+    model.genreTracks.clear();
+    model.genreTrackCounts.clear();
+    model.artistIds.clear();
+    model.artistIdToIndex.clear();
+    model.playlistTracks.clear();
+    filteredTracks.clear();
+    model.currentGenreMask = DynBitset(0);
+    streamedArtists.clear();
+    streamedGenreIndices.clear();
+    streamLoadError.clear();
+    model.trackFilter.setPlaylist(model.playlist, model.trackFeatures, model.genreTracks);
+    // the first update evaluates the (still empty) playlist, after that tracks are added one by one
+    refreshFilteredTracks();
+
+    applyPlaylistStream();
+}
+
+// sets the bit, grows the set if its too small (the artists and genres of a playlist arent known up front)
+static void setBitGrowing(CompressedBitset& set, uint32_t index)
+{
+    if(index >= set.getSize())
+    {
+        set.resize(index + 1);
+    }
+    set.setBit(index);
+}
+
+void App::applyPlaylistStream()
+{
+    PlaylistStream::Update update = playlistStream->take();
+    std::vector<uint32_t> changedTracks;
+
+    // give a track the genres of one of its artists
+    const auto addArtistGenres = [&](uint32_t trackIndex, const StreamedArtist& artist)
+    {
+        Track& track = model.playlist[trackIndex];
+        for(const uint32_t genre : artist.genres)
+        {
+            if(!model.genreTracks[genre].getBit(trackIndex))
+            {
+                model.genreTracks[genre].setBit(trackIndex);
+                model.genreTrackCounts[genre]++;
+                setBitGrowing(track.genreMask, genre);
+            }
+        }
+    };
+
+    // tracks that dont fit anymore (the playlist grew while downloading) are only there once loading is done
+    const auto firstNew = static_cast<uint32_t>(model.playlist.size());
+    const auto newCount =
+        static_cast<uint32_t>(std::min(update.tracks.size(), model.playlist.capacity() - model.playlist.size()));
+    const uint32_t trackCount = firstNew + newCount;
+    model.trackFeatures.resize(trackCount);
+    for(DynBitset& tracks : model.genreTracks)
+    {
+        tracks.resize(trackCount);
+    }
+    for(uint32_t i = firstNew; i < trackCount; i++)
+    {
+        const TrackSource& source = update.tracks[i - firstNew];
+        Track& track = model.playlist.emplace_back(makeTrack(source, i));
+        for(int f = 0; f < Track::featureAmount; f++)
+        {
+            model.trackFeatures.set(f, i, source.features[f]);
+        }
+        const auto [coverIter, inserted] = model.coverTable.try_emplace(
+            source.albumId,
+            CoverInfo{
+                .albumId = source.albumId, .url = source.coverUrl, .layer = 0, .id = renderer.defaultCoverHandle});
+        track.coverInfoPtr = &coverIter->second;
+
+        for(const std::string& artistId : source.artistIds)
+        {
+            const auto [artistIter, newArtist] =
+                model.artistIdToIndex.try_emplace(artistId, static_cast<uint32_t>(model.artistIds.size()));
+            if(newArtist)
+            {
+                model.artistIds.push_back(artistId);
+                streamedArtists.emplace_back();
+            }
+            StreamedArtist& artist = streamedArtists[artistIter->second];
+            artist.tracks.push_back(i);
+            setBitGrowing(track.artistMask, artistIter->second);
+            addArtistGenres(i, artist);
+        }
+        model.playlistTracks.push_back(&track);
+        changedTracks.push_back(i);
+    }
 
-    currentGenreMask = DynBitset(genreNames.size());
-    currentGenreMask.clear();
+    for(const auto& [trackIndex, features] : update.features)
+    {
+        if(trackIndex < trackCount)
+        {
+            for(int f = 0; f < Track::featureAmount; f++)
+            {
+                model.trackFeatures.set(f, trackIndex, features[f]);
+            }
+            changedTracks.push_back(trackIndex);
+        }
+    }
 
-    playlistTracks = std::vector<Track*>(playlist.size());
-    for(auto i = 0; i < playlist.size(); i++)
+    for(const auto& [artistId, genres] : update.artistGenres)
     {
-        playlistTracks[i] = &playlist[i];
+        const auto artistIter = model.artistIdToIndex.find(artistId);
+        if(artistIter == model.artistIdToIndex.end())
+        {
+            // only has tracks that didnt fit
+            continue;
+        }
+        StreamedArtist& artist = streamedArtists[artistIter->second];
+        artist.hasGenres = true;
+        for(const std::string& genreName : genres)
+        {
+            const auto [genreIter, newGenre] =
+                streamedGenreIndices.try_emplace(genreName, static_cast<uint32_t>(model.genreNames.size()));
+            if(newGenre)
+            {
+                model.genreNames.push_back(genreName);
+                model.genreTracks.emplace_back(trackCount);
+                model.genreTrackCounts.push_back(0);
+            }
+            artist.genres.push_back(genreIter->second);
+        }
+        for(const uint32_t trackIndex : artist.tracks)
+        {
+            addArtistGenres(trackIndex, artist);
+            changedTracks.push_back(trackIndex);
+        }
     }
-    // initially the filtered playlist is the same as the original
-    filteredTracks = playlistTracks;
+    model.currentGenreMask.resize(static_cast<uint32_t>(model.genreNames.size()));
+
+    std::sort(changedTracks.begin(), changedTracks.end());
+    changedTracks.erase(std::unique(changedTracks.begin(), changedTracks.end()), changedTracks.end());
+    refreshChangedTracks(changedTracks);
+}
 
-    coversTotal = coverTable.size();
+void App::applyLoadedPlaylist(SpotifyApiAccess::PlaylistData_t&& data)
+{
+    // the covers point into the old cover table
+    coverLoader.cancel();
+    // moving doesnt reallocate, so the pointers into it stay valid until they are translated below
+    const std::vector<Track> oldPlaylist = std::move(model.playlist);
+    // filters that were set while the playlist was still loading are kept
+    model.setData(std::move(data));
+    streamedArtists.clear();
+    streamedGenreIndices.clear();
+
+    // the tracks keep their positions, unless the playlist changed while it was loading
+    const auto translate = [&](const Track* track) -> Track*
+    {
+        const auto index = static_cast<size_t>(track - oldPlaylist.data());
+        std::vector<Track>& playlist = model.playlist;
+        return index < playlist.size() && playlist[index].id == track->id ? &playlist[index] : nullptr;
+    };
+    std::erase_if(
+        pinnedTracks,
+        [&](Track*& track)
+        {
+            track = translate(track);
+            return track == nullptr;
+        });
+    std::erase_if(
+        recommendedTracks,
+        [&](Recommendation& recommendation)
+        {
+            recommendation.track = translate(recommendation.track);
+            return recommendation.track == nullptr;
+        });
+    selectedTrack = selectedTrack != nullptr ? translate(selectedTrack) : nullptr;
+
+    refreshFilteredTracks();
+
+    coversTotal = model.coverTable.size();
     coversLoaded = 0;
 }
 
@@ -109,45 +281,91 @@ void App::extractPlaylistIDFromInput()
     }
 }
 
-void App::resetFeatureFilters()
+void App::refreshChangedTracks(const std::vector<uint32_t>& trackIndices)
 {
-    featureMinMaxValues.fill(glm::vec2(0.0f, 1.0f));
-    featureMinMaxValues[7] = {0, 300};
+    if(trackIndices.empty())
+    {
+        return;
+    }
+    if(!model.trackFilter.refreshTracks(trackIndices))
+    {
+        filterDirty = true;
+        return;
+    }
+    const DynBitset& passMask = model.trackFilter.getPassMask();
+    // same as a partial update, the changed tracks are taken out and the passing ones merged back in
+    std::erase_if(
+        filteredTracks,
+        [&](const Track* track)
+        { return std::binary_search(trackIndices.begin(), trackIndices.end(), track->index); });
+    std::vector<Track*> addedTracks;
+    for(const uint32_t i : trackIndices)
+    {
+        if(passMask.getBit(i))
+        {
+            addedTracks.push_back(&model.playlist[i]);
+        }
+    }
+    filteredTracksTable.insertSorted(addedTracks);
+
+#ifdef VERIFY_INCREMENTAL_FILTER
+    {
+        TrackFilter freshFilter;
+        freshFilter.setPlaylist(model.playlist, model.trackFeatures, model.genreTracks);
+        freshFilter.update(model.featureMinMaxValues, model.currentGenreMask, model.nameFilter);
+        assert(freshFilter.getPassMask() == passMask);
+    }
+#endif
+
+    graphingDirty = true;
 }
 
 void App::refreshFilteredTracks()
 {
-    filteredTracks.clear();
-    for(auto& track : playlist)
+    TIME_FRAME_PHASE(RefreshFilteredTracks);
+    const TrackFilter::UpdateType updateType = model.updateFilter();
+    const DynBitset& passMask = model.trackFilter.getPassMask();
+
+    switch(updateType)
     {
-        for(auto i = 0; i < Track::featureAmount; i++)
-        {
-            if(track.features[i] < featureMinMaxValues[i].x || track.features[i] > featureMinMaxValues[i].y)
-            {
-                goto failedFilter;
-            }
-        }
-        if(currentGenreMask)
-        {
-            if(!(currentGenreMask & track.genreMask))
-            {
-                goto failedFilter;
-            }
-        }
-        if(nameFilter.InputBuf[0] != 0)
+    case TrackFilter::UpdateType::None:
+        return;
+    case TrackFilter::UpdateType::Partial:
+    {
+        // only a few tracks changed, remove the ones that dont pass anymore and merge in the new ones
+        std::erase_if(filteredTracks, [&](const Track* track) { return !passMask.getBit(track->index); });
+        std::vector<Track*> addedTracks;
+        for(uint32_t i : model.trackFilter.getChangedTracks())
         {
-            if(!nameFilter.PassFilter(track.artistsNamesEncoded.c_str()) &&
-               !nameFilter.PassFilter(track.albumNameEncoded.c_str()) &&
-               !nameFilter.PassFilter(track.trackNameEncoded.c_str()))
+            if(passMask.getBit(i))
             {
-                goto failedFilter;
+                addedTracks.push_back(&model.playlist[i]);
             }
         }
-        filteredTracks.push_back(&track);
-    failedFilter:;
+        filteredTracksTable.insertSorted(addedTracks);
+        break;
+    }
+    case TrackFilter::UpdateType::Full:
+        model.trackFilter.collectPassingTracks(model.playlist, filteredTracks);
+        // also have to re-sort here;
+        filteredTracksTable.sortData();
+        break;
+    }
+
+#ifdef VERIFY_INCREMENTAL_FILTER
+    {
+        // the incremental (and multithreaded) result has to be exactly the same as filtering everything from
+        // scratch on a single thread
+        TrackFilter freshFilter;
+        freshFilter.setPlaylist(model.playlist, model.trackFeatures, model.genreTracks);
+        freshFilter.update(model.featureMinMaxValues, model.currentGenreMask, model.nameFilter);
+        assert(freshFilter.getPassMask() == passMask);
+        std::vector<Track*> tracksBefore = filteredTracks;
+        filteredTracksTable.sortData();
+        assert(tracksBefore == filteredTracks);
     }
-    // also have to re-sort here;
-    filteredTracksTable.sortData();
+#endif
+
     graphingDirty = true;
 }
 
@@ -156,7 +374,7 @@ bool App::pinTrack(Track* track)
     if(std::find(pinnedTracks.begin(), pinnedTracks.end(), track) == pinnedTracks.end())
     {
         pinnedTracks.push_back(track);
-        lastPlayedTrack = std::distance(playlist.data(), track);
+        lastPlayedTrack = std::distance(model.playlist.data(), track);
         return true;
     }
     return false;
@@ -175,14 +393,13 @@ void App::pinTracks(const std::vector<Track*>& tracks)
 
 void App::setFeatureFiltersFromPins(int featureIndex)
 {
-    featureMinMaxValues[featureIndex] =
+    model.featureMinMaxValues[featureIndex] =
         glm::vec2(std::numeric_limits<float>::max(), std::numeric_limits<float>::min());
     for(const Track* trackPtr : pinnedTracks)
     {
-        featureMinMaxValues[featureIndex].x =
-            std::min(featureMinMaxValues[featureIndex].x, trackPtr->features[featureIndex]);
-        featureMinMaxValues[featureIndex].y =
-            std::max(featureMinMaxValues[featureIndex].y, trackPtr->features[featureIndex]);
+        const float value = model.trackFeatures.get(featureIndex, trackPtr->index);
+        model.featureMinMaxValues[featureIndex].x = std::min(model.featureMinMaxValues[featureIndex].x, value);
+        model.featureMinMaxValues[featureIndex].y = std::max(model.featureMinMaxValues[featureIndex].y, value);
     }
     filterDirty = true;
 }
@@ -196,34 +413,30 @@ bool App::startTrackPlayback(Track* track)
     }
     else
     {
-        lastPlayedTrack = std::distance(playlist.data(), track);
-        assert(&playlist[lastPlayedTrack] == track);
+        lastPlayedTrack = std::distance(model.playlist.data(), track);
+        assert(&model.playlist[lastPlayedTrack] == track);
     }
     return ret;
 }
 
 void App::createPlaylist(const std::vector<Track*>& tracks)
 {
-    std::vector<std::string> uris = {};
-    uris.reserve(tracks.size());
-    for(const auto& track : tracks)
+    try
     {
-        uris.emplace_back("spotify:track:" + track->id);
+        apiAccess.createPlaylist(getGeneratedPlaylistName(), getTrackUris(tracks));
+    }
+    catch(const ApiRequestError& error)
+    {
+        // the tracks are still shown, so the user can just try again
+        std::cerr << "could not create the playlist: " << error.what() << std::endl;
     }
-
-    const int MAXLEN = 80;
-    char s[MAXLEN] = "PlaylistFilter generated playlist - ";
-    time_t t = time(0);
-    strftime(&s[36], MAXLEN, "%d/%m/%Y::%H:%M", localtime(&t));
-
-    apiAccess.createPlaylist(&s[0], uris);
 }
 
 void App::extendPinsByRecommendations()
 {
     // only recommend tracks that are part of the users playlist
     std::unordered_map<std::string_view, Track*> playlistEntries;
-    for(Track& track : playlist)
+    for(Track& track : model.playlist)
     {
         playlistEntries.try_emplace(track.id, &track);
     }
@@ -351,21 +564,13 @@ void App::extendPinsByRecommendations()
 
 void App::extendPinsByArtists()
 {
-    DynBitset pinnedArtists = pinnedTracks[0]->artistMask;
-    for(int i = 1; i < pinnedTracks.size(); i++)
-    {
-        pinnedArtists = pinnedArtists | pinnedTracks[i]->artistMask;
-    }
+    DynBitset pinnedArtists;
+    getArtistMask(pinnedTracks, static_cast<uint32_t>(model.artistIds.size()), pinnedArtists);
     std::vector<std::string> pinnedArtistIds;
-    DynBitset temp = pinnedArtists;
-    while(temp)
-    {
-        uint32_t artistIndex = temp.getFirstBitSet();
-        temp.clearBit(artistIndex);
-        pinnedArtistIds.emplace_back(artistIds[artistIndex]);
-    }
+    pinnedArtists.forEachSetBit([&](uint32_t artistIndex)
+                                { pinnedArtistIds.emplace_back(model.artistIds[artistIndex]); });
 
-    DynBitset recommendedArtists{(uint32_t)artistIds.size()};
+    DynBitset recommendedArtists{(uint32_t)model.artistIds.size()};
     std::vector<std::string> recommendedIds;
     for(const auto& artistId : pinnedArtistIds)
     {
@@ -373,8 +578,8 @@ void App::extendPinsByArtists()
 
         for(const auto& recommendedId : recommendedIds)
         {
-            auto artistIdToIndexIter = artistIdToIndex.find(recommendedId);
-            if(artistIdToIndexIter != artistIdToIndex.end())
+            auto artistIdToIndexIter = model.artistIdToIndex.find(recommendedId);
+            if(artistIdToIndexIter != model.artistIdToIndex.end())
             {
                 uint32_t index = artistIdToIndexIter->second;
                 recommendedArtists.setBit(index);
@@ -383,19 +588,16 @@ void App::extendPinsByArtists()
     }
 
     // Also recommend other songs from artists themselves!
-    recommendedArtists = recommendedArtists | pinnedArtists;
+    recommendedArtists |= pinnedArtists;
 
     // Now find songs that were made by (at least) one of those artists
 
+    std::vector<Track*> foundTracks;
+    findTracksByArtists(model.playlist, recommendedArtists, foundTracks);
     recommendedTracks.clear();
-    for(Track& track : playlist)
+    for(Track* track : foundTracks)
     {
-        if((track.artistMask & recommendedArtists))
-        {
-            // if true, then any bit still set after "&"
-            //       -> theres at least one match
-            recommendedTracks.emplace_back(&track, 1);
-        }
+        recommendedTracks.emplace_back(track, 1);
     }
     showRecommendations = true;
     renderer.highlightWindow("Pin Recommendations");
@@ -403,18 +605,49 @@ void App::extendPinsByArtists()
 
 void App::generateGraphingData()
 {
-    graphingData.clear();
-    for(const Track* track : filteredTracks)
+    TIME_FRAME_PHASE(GenerateGraphingData);
+    ::generateGraphingData(
+        filteredTracks, model.trackFeatures, {graphingFeatureX, graphingFeatureY, graphingFeatureZ}, graphingData);
+}
+
+void App::prioritizeVisibleCovers()
+{
+    std::vector<CoverInfo*> covers;
+    for(const Track* track : filteredTracksTable.getVisibleTracks())
+    {
+        covers.push_back(track->coverInfoPtr);
+    }
+    for(const Track* track : pinnedTracksTable.getVisibleTracks())
     {
-        // uint32_t index = static_cast<uint32_t>(track - baseptr);
-        auto index = std::distance((const Track*)playlist.data(), track);
-        graphingData.emplace_back(GraphingBufferElement{
-            {track->features[graphingFeatureX],
-             track->features[graphingFeatureY],
-             track->features[graphingFeatureZ]},
-            track->coverInfoPtr->layer,
-            (GLuint)index});
+        covers.push_back(track->coverInfoPtr);
     }
+
+    // same transformation as in the cover graphing shader
+    const glm::vec3 cameraPosition = renderer.cam.getPosition();
+    const glm::vec3 axisMins{
+        model.featureMinMaxValues[graphingFeatureX].x,
+        model.featureMinMaxValues[graphingFeatureY].x,
+        model.featureMinMaxValues[graphingFeatureZ].x};
+    const glm::vec3 axisMaxs{
+        model.featureMinMaxValues[graphingFeatureX].y,
+        model.featureMinMaxValues[graphingFeatureY].y,
+        model.featureMinMaxValues[graphingFeatureZ].y};
+    std::vector<std::pair<float, uint32_t>> distances;
+    distances.reserve(graphingData.size());
+    for(const GraphingBufferElement& element : graphingData)
+    {
+        const glm::vec3 position = 2.0f * (element.p - axisMins) / (axisMaxs - axisMins) - glm::vec3(1.0f);
+        const glm::vec3 offset = position - cameraPosition;
+        distances.emplace_back(glm::dot(offset, offset), element.originalIndex);
+    }
+    const auto nearCount = static_cast<std::ptrdiff_t>(std::min(distances.size(), nearCameraCoverCount));
+    std::partial_sort(distances.begin(), distances.begin() + nearCount, distances.end());
+    for(std::ptrdiff_t i = 0; i < nearCount; i++)
+    {
+        covers.push_back(model.playlist[distances[i].second].coverInfoPtr);
+    }
+
+    coverLoader.prioritize(covers);
 }
 
 Renderer& App::getRenderer()
@@ -424,63 +657,32 @@ Renderer& App::getRenderer()
 
 SpotifyApiAccess::CoverTable_t& App::getCoverTable()
 {
-    return coverTable;
+    return model.coverTable;
 }
 
-Track* App::raycastAgainstGraphingBuffer(glm::vec3 rayPos, glm::vec3 rayDir)
+const FeatureStore& App::getTrackFeatures()
 {
-    glm::mat4 invProj = glm::inverse(*(renderer.cam.getProj()));
-    glm::mat4 invView = glm::inverse(*(renderer.cam.getView()));
-    glm::vec3 worldCamX = glm::vec3(invView * glm::vec4(1.0f, 0.f, 0.f, 0.f));
-    glm::vec3 worldCamY = glm::vec3(invView * glm::vec4(0.f, 1.0f, 0.f, 0.f));
-
-    glm::vec3 n = glm::normalize(glm::cross(worldCamX, worldCamY));
-
-    glm::vec3 axisMins{
-        featureMinMaxValues[graphingFeatureX].x,
-        featureMinMaxValues[graphingFeatureY].x,
-        featureMinMaxValues[graphingFeatureZ].x};
-    glm::vec3 axisMaxs{
-        featureMinMaxValues[graphingFeatureX].y,
-        featureMinMaxValues[graphingFeatureY].y,
-        featureMinMaxValues[graphingFeatureZ].y};
-    glm::vec3 axisFactors = axisMaxs - axisMins;
-
-    glm::vec3 hitP;
-    glm::vec3 debugHitP;
-    glm::vec3 resP;
-    struct HitResult
-    {
-        float t = std::numeric_limits<float>::max();
-        uint32_t index = std::numeric_limits<uint32_t>::max();
-    };
-    HitResult hit;
+    return model.trackFeatures;
+}
 
-    for(const auto& graphingBufferElement : graphingData)
-    {
-        glm::vec3 tboP = graphingBufferElement.p;
-        tboP = (tboP - axisMins) / axisFactors;
-        float t = glm::dot(tboP - rayPos, n) / glm::dot(rayDir, n);
-        t = std::max(0.f, t);
-        hitP = rayPos + t * rayDir;
+ThreadPool& App::getWorkerPool()
+{
+    return workerPool;
+}
 
-        float localX = glm::dot(hitP - tboP, worldCamX);
-        float localY = glm::dot(hitP - tboP, worldCamY);
-        bool insideSquare = std::abs(localX) < 0.5f * coverSize3D && std::abs(localY) < 0.5f * coverSize3D;
-        if(insideSquare && t < hit.t)
-        {
-            hit.t = t;
-            hit.index = graphingBufferElement.originalIndex;
-            resP = tboP;
-            debugHitP = hitP;
-        }
-    }
-    Track* selectedTrack = nullptr;
-    if(hit.index != std::numeric_limits<uint32_t>::max())
-    {
-        selectedTrack = &(playlist)[hit.index];
-    }
-    return selectedTrack;
+Track* App::raycastAgainstGraphingBuffer(glm::vec3 rayPos, glm::vec3 rayDir)
+{
+    const glm::vec3 axisMins{
+        model.featureMinMaxValues[graphingFeatureX].x,
+        model.featureMinMaxValues[graphingFeatureY].x,
+        model.featureMinMaxValues[graphingFeatureZ].x};
+    const glm::vec3 axisMaxs{
+        model.featureMinMaxValues[graphingFeatureX].y,
+        model.featureMinMaxValues[graphingFeatureY].y,
+        model.featureMinMaxValues[graphingFeatureZ].y};
+    const std::optional<uint32_t> hit = raycastGraphingData(
+        graphingData, rayPos, rayDir, *renderer.cam.getView(), axisMins, axisMaxs, coverSize3D);
+    return hit ? &model.playlist[*hit] : nullptr;
 }
 
 void App::setSelectedTrack(Track* track)
@@ -493,6 +695,13 @@ void App::toggleWindowVisibility()
     uiHidden = !uiHidden;
 }
 
+#ifdef FRAME_TIMING
+void App::toggleFrameTimingOverlay()
+{
+    frameTimingVisible = !frameTimingVisible;
+}
+#endif
+
 int App::getLastPlayedTrackIndex()
 {
     return lastPlayedTrack;
@@ -500,22 +709,22 @@ int App::getLastPlayedTrackIndex()
 
 bool App::genrePassesFilter(uint32_t index)
 {
-    return currentGenreMask.getBit(index);
+    return model.currentGenreMask.getBit(index);
 }
 
 void App::addGenreToFilter(uint32_t index)
 {
-    currentGenreMask.setBit(index);
+    model.currentGenreMask.setBit(index);
     filterDirty = true;
 }
 
 void App::toggleGenreFilter(uint32_t index)
 {
-    currentGenreMask.toggleBit(index);
+    model.currentGenreMask.toggleBit(index);
     filterDirty = true;
 }
 
 const char* App::getGenreName(uint32_t index)
 {
-    return genreNames[index].c_str();
+    return model.genreNames[index].c_str();
 }
\ No newline at end of file
@@ -1,18 +1,29 @@
 #pragma once
 
+// glad has to be included before glfw
+#include <glad/glad.h>
 #include <GLFW/glfw3.h>
 
+#include <chrono>
 #include <future>
+#include <memory>
 #include <optional>
 #include <unordered_map>
 #include <unordered_set>
 #include <vector>
 
 #include <CommonStructs/CommonStructs.hpp>
+#include <CoverCache/CoverCache.hpp>
+#include <CoverLoader/CoverLoader.hpp>
 #include <DynamicBitset/DynamicBitset.hpp>
+#include <FeatureStore/FeatureStore.hpp>
+#include <Filter/TrackFilter.hpp>
+#include <PlaylistModel/PlaylistModel.hpp>
 #include <Renderer/Renderer.hpp>
+#include <Spotify/PlaylistStream.hpp>
 #include <Spotify/SpotifyApiAccess.hpp>
 #include <Table/Table.hpp>
+#include <ThreadPool/ThreadPool.hpp>
 #include <Track/Track.hpp>
 
 class App
@@ -24,13 +35,19 @@ class App
     void run();
     Renderer& getRenderer();
     SpotifyApiAccess::CoverTable_t& getCoverTable();
+    const FeatureStore& getTrackFeatures();
+    ThreadPool& getWorkerPool();
     void setSelectedTrack(Track* track);
     void toggleWindowVisibility();
+#ifdef FRAME_TIMING
+    // the frame timing window, F3
+    void toggleFrameTimingOverlay();
+#endif
     int getLastPlayedTrackIndex();
     bool startTrackPlayback(Track* track);
     inline int getNumberOfTracks()
     {
-        return playlist.size();
+        return model.playlist.size();
     }
 
     // returns true, if the genre with given passes the current filter
@@ -83,11 +100,23 @@ class App
         Sets this class' playlistID field (either to the ID, or the empty string)
     */
     void extractPlaylistIDFromInput();
-    // Load all data relevant for analyzing the given playlist from Spotify
-    void loadSelectedPlaylist();
+    /*
+        Load all data relevant for analyzing the given playlist from Spotify.
+        Runs on its own thread, so it doesnt touch any of the app's tables. If the playlist has to be downloaded
+        the tracks are published to the stream while that is still going on
+    */
+    SpotifyApiAccess::PlaylistData_t loadSelectedPlaylist(std::string id, PlaylistStream* stream);
+    // the first tracks of the playlist are there, show them. The tables are filled by applyPlaylistStream()
+    void startPlaylistStream();
+    // append the tracks, features and genres that were published since the last call
+    void applyPlaylistStream();
+    // replace the (partial) tables with the ones of the loaded playlist
+    void applyLoadedPlaylist(SpotifyApiAccess::PlaylistData_t&& data);
+    void enterMain();
 
-    void resetFeatureFilters();
     void refreshFilteredTracks();
+    // after the features or genres of the given (or new) tracks changed, the filter settings stay the same
+    void refreshChangedTracks(const std::vector<uint32_t>& trackIndices);
 
     void extendPinsByRecommendations();
     void extendPinsByArtists();
@@ -95,13 +124,23 @@ class App
     void createPlaylist(const std::vector<Track*>& tracks);
 
     void generateGraphingData();
+    // the covers in the tables and closest to the camera are loaded first
+    void prioritizeVisibleCovers();
 
     // this needs to be first, so it gets initialized first
     //  (Table initialization needs ImGui calc width)
     Renderer renderer;
     // todo: make private, add get and/or set
 
+    // used to split up filtering and sorting of large playlists
+    //  thread count can be set through the PLAYLISTFILTER_THREADS environment variable
+    ThreadPool workerPool;
+
     SpotifyApiAccess apiAccess;
+    // covers from earlier sessions, the size can be capped through PLAYLISTFILTER_COVER_CACHE_MB
+    CoverCache coverCache;
+    // the number of covers loaded at the same time can be set through PLAYLISTFILTER_COVER_THREADS
+    CoverLoader coverLoader;
 
     // buffer for all kinds of user input (auth URL among other things, so may need a lot of space)
     std::array<char, 1000> userInput;
@@ -109,33 +148,11 @@ class App
     std::string playlistID;
     std::string playlistName;
 
-    /*
-        todo: dont like this being a vector, size is determined once and then constant for the rest of the program!
-              and it mustnt be resized anyways, since many places reference elements through pointers which need
-              to stay valid!
-    */
-    std::vector<Track> playlist;
-    /*
-        A filtered playlist is just a vector of pointers to the remaining tracks.
-        To make resetting filters faster, playlistTracks is a cached version including all tracks
-    */
-    std::vector<Track*> playlistTracks;
-    /*
-        Same goes for this, is initiated once, and mustnt be changed afterwards
-
-        Key string is AlbumID
-    */
-    SpotifyApiAccess::CoverTable_t coverTable;
-
-    std::vector<std::string> genreNames;
-    std::vector<std::string> artistIds;
-    SpotifyApiAccess::ArtistIndexLUT_t artistIdToIndex;
+    // the playlist and its tables, and the filter settings that arent ui state
+    PlaylistModel model;
 
     // Filtering related variables
-    DynBitset currentGenreMask;
     ImGuiTextFilter genreFilter;
-    ImGuiTextFilter nameFilter;
-    std::array<glm::vec2, Track::featureAmount> featureMinMaxValues;
     bool filterDirty = false;
     std::vector<Track*> filteredTracks;
     FilteredTracksTable filteredTracksTable;
@@ -152,6 +169,9 @@ class App
 
     // Rendering related app state
     bool uiHidden = false;
+#ifdef FRAME_TIMING
+    bool frameTimingVisible = false;
+#endif
     int graphingFeatureX = 0;
     int graphingFeatureY = 1;
     int graphingFeatureZ = 2;
@@ -164,10 +184,32 @@ class App
 
     // App State
     State state = LOG_IN;
-    float loadPlaylistProgress = 0.0f;
-    std::string loadingPlaylistProgressLabel = "Downloading track data";
-    std::future<void> doneLoading;
+    LoadProgress loadProgress;
+    std::unique_ptr<PlaylistStream> playlistStream;
+    std::future<SpotifyApiAccess::PlaylistData_t> doneLoading;
+    // the main view is already shown while this is set, the tables only hold what was published so far
+    bool playlistLoading = false;
+    std::chrono::steady_clock::time_point lastStreamApply;
+    /*
+        While loading genres are indexed in order of their first appearance, they are only sorted once the
+        playlist is complete. Artists get their genres later than their tracks, so the tracks of every
+        artist are kept to set them then
+    */
+    struct StreamedArtist
+    {
+        bool hasGenres = false;
+        std::vector<uint32_t> genres;
+        std::vector<uint32_t> tracks;
+    };
+    std::vector<StreamedArtist> streamedArtists;
+    std::unordered_map<std::string, uint32_t, StringHash, std::equal_to<>> streamedGenreIndices;
+    // failed while the tracks loaded so far were already shown
+    std::string streamLoadError;
+    // shown in the playlist selection if the last load failed
+    std::string playlistLoadError;
     bool canLoadCovers = true;
+    // besides the ones in the tables, this many covers closest to the camera are loaded first
+    static constexpr size_t nearCameraCoverCount = 64;
     int coversTotal;
     int coversLoaded;
 };
\ No newline at end of file
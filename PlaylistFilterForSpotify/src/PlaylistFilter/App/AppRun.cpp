@@ -1,6 +1,9 @@
 #include "App.hpp"
 #include "ImGui/imgui.h"
-#include <stb/stb_image.h>
+#include <FrameTiming/FrameTiming.hpp>
+#include <Spotify/ApiError.hpp>
+
+#include <cstdio>
 
 bool App::shouldClose()
 {
@@ -139,7 +142,15 @@ void App::createPlaylistSelectUI()
             if(ImGui::Button("Load Playlist##selection"))
             {
                 state = App::State::PLAYLIST_LOAD;
-                doneLoading = std::async(std::launch::async, &App::loadSelectedPlaylist, this);
+                playlistLoading = true;
+                playlistStream = std::make_unique<PlaylistStream>();
+                doneLoading = std::async(
+                    std::launch::async, &App::loadSelectedPlaylist, this, playlistID, playlistStream.get());
+            }
+            if(!playlistLoadError.empty())
+            {
+                ImGui::TextColored(
+                    ImVec4(1.0f, 0.4f, 0.4f, 1.0f), "Loading failed: %s", playlistLoadError.c_str());
             }
         }
         else
@@ -171,17 +182,52 @@ void App::runPlaylistLoad()
     std::future_status status = doneLoading.wait_for(std::chrono::seconds(0));
     if(status == std::future_status::ready)
     {
-        // can only upload to GPU from main thread, so this last step has to happen here
-        // to account for the extra "loading time" the progress bar in renderer.cpp only goes up to 90% :)
-        //                                                                                     todo: just no
-        graphingData.reserve(playlist.size());
-        generateGraphingData();
+        SpotifyApiAccess::PlaylistData_t data;
+        try
+        {
+            data = doneLoading.get();
+        }
+        catch(const ApiRequestError& error)
+        {
+            // nothing was replaced yet, so just go back and let the user try again
+            playlistLoadError = error.what();
+            playlistLoading = false;
+            playlistStream.reset();
+            state = State::PLAYLIST_SELECT;
+            return;
+        }
+        playlistLoadError.clear();
+        playlistLoading = false;
+        playlistStream.reset();
+        applyLoadedPlaylist(std::move(data));
+        enterMain();
+    }
+    else if(playlistStream->hasUpdate())
+    {
+        // a playlist that isnt cached yet can already be looked at while the rest of it downloads
+        playlistLoadError.clear();
+        startPlaylistStream();
+        lastStreamApply = std::chrono::steady_clock::now();
+        enterMain();
+    }
+}
+void App::enterMain()
+{
+    // can only upload to GPU from main thread, so this last step has to happen here
+    graphingData.reserve(model.playlist.capacity());
+    generateGraphingData();
+    if(!renderer.renderDataWasCreated)
+    {
         renderer.createRenderData();
-        renderer.uploadGraphingData(graphingData);
-        state = State::MAIN;
-        filteredTracksTable.calcHeaderWidth();
-        pinnedTracksTable.calcHeaderWidth();
     }
+    else
+    {
+        renderer.createCoverArray();
+    }
+    renderer.uploadGraphingData(graphingData);
+    state = State::MAIN;
+    filteredTracksTable.calcHeaderWidth();
+    pinnedTracksTable.calcHeaderWidth();
 }
 void App::createPlaylistLoadUI()
 {
@@ -196,16 +242,52 @@ void App::createPlaylistLoadUI()
         const float barWidth = static_cast<float>(renderer.width) / 3.0f;
         const float barHeight = renderer.scaleByDPI(30.0f);
         // ImGui::SetCursorScreenPos({width / 2.0f - barWidth / 2.0f, height / 2.0f});
-        ImGui::Text("%s:", loadingPlaylistProgressLabel.c_str());
-        ImGui::HorizontalBar(0.0f, loadPlaylistProgress, {barWidth, barHeight});
+        ImGui::Text("%s:", loadProgress.getLabel());
+        ImGui::HorizontalBar(0.0f, loadProgress.getFraction(), {barWidth, barHeight});
     }
     ImGui::End();
 }
 
 void App::runMain()
 {
+#ifdef FRAME_TIMING
+    FrameTiming::get().beginFrame();
+#endif
     renderer.startFrame();
 
+    if(playlistLoading)
+    {
+        // filtering and sorting the new tracks isnt free, so they are only taken a few times per second
+        const auto now = std::chrono::steady_clock::now();
+        if(playlistStream->hasUpdate() && now - lastStreamApply > std::chrono::milliseconds(100))
+        {
+            applyPlaylistStream();
+            lastStreamApply = now;
+        }
+        if(doneLoading.wait_for(std::chrono::seconds(0)) == std::future_status::ready)
+        {
+            playlistLoading = false;
+            try
+            {
+                applyLoadedPlaylist(doneLoading.get());
+            }
+            catch(const ApiRequestError& error)
+            {
+                // keep what was loaded so far, its still usable
+                streamLoadError = error.what();
+                applyPlaylistStream();
+            }
+            playlistStream.reset();
+            // the cover table is complete now, it needs a layer for every album
+            renderer.createCoverArray();
+            graphingDirty = true;
+        }
+    }
+
+    if(!canLoadCovers && coverLoader.getStats().pending != 0)
+    {
+        prioritizeVisibleCovers();
+    }
     if(renderer.uploadAvailableCovers(coversLoaded))
     {
         // also need to regenerate TrackBuffer, so that new layer indices are uploaded to GPU aswell
@@ -215,6 +297,12 @@ void App::runMain()
     }
 
     createMainUI();
+#ifdef FRAME_TIMING
+    if(frameTimingVisible)
+    {
+        FrameTiming::get().drawOverlay(&frameTimingVisible);
+    }
+#endif
 
     if(clearPinsAfterFrame)
     {
@@ -236,9 +324,9 @@ void App::runMain()
 
     renderer.draw3DGraph(
         coverSize3D,
-        featureMinMaxValues[graphingFeatureX],
-        featureMinMaxValues[graphingFeatureY],
-        featureMinMaxValues[graphingFeatureZ]);
+        model.featureMinMaxValues[graphingFeatureX],
+        model.featureMinMaxValues[graphingFeatureY],
+        model.featureMinMaxValues[graphingFeatureZ]);
     renderer.drawBackgroundWindow();
 
     renderer.drawUI();
@@ -257,9 +345,13 @@ void App::runMain()
         renderer.uploadGraphingData(graphingData);
         graphingDirty = false;
     }
+#ifdef FRAME_TIMING
+    FrameTiming::get().endFrame();
+#endif
 }
 void App::createMainUI()
 {
+    TIME_FRAME_PHASE(CreateMainUI);
     static constexpr char* comboNames = Track::FeatureNamesData;
     ImGui::Begin(
         "Graphing Settings",
@@ -296,16 +388,24 @@ void App::createMainUI()
                ImVec2(size.x - 2.0f * ImGui::GetStyle().WindowPadding.x, renderer.scaleByDPI(125.0f)),
                true))
         {
-            for(uint32_t i = 0; i < genreNames.size(); i++)
+            for(uint32_t i = 0; i < model.genreNames.size(); i++)
             {
-                if(genreFilter.PassFilter(genreNames[i].c_str()))
+                if(genreFilter.PassFilter(model.genreNames[i].c_str()))
                 {
-                    const bool isSelected = currentGenreMask.getBit(i);
+                    const bool isSelected = model.currentGenreMask.getBit(i);
                     if(!displayOnlySelectedGenres || isSelected)
                     {
-                        if(ImGui::Selectable(genreNames[i].c_str(), isSelected))
+                        // genre names are unique, so the label including the track count is still a unique ID
+                        char label[128];
+                        snprintf(
+                            label,
+                            sizeof(label),
+                            "%s (%u)",
+                            model.genreNames[i].c_str(),
+                            model.genreTrackCounts[i]);
+                        if(ImGui::Selectable(label, isSelected))
                         {
-                            currentGenreMask.toggleBit(i);
+                            model.currentGenreMask.toggleBit(i);
                             filterDirty = true;
                         }
                     }
@@ -315,11 +415,11 @@ void App::createMainUI()
         ImGui::EndChild();
         if(ImGui::Button("Select all matching genres##genreFilter"))
         {
-            for(uint32_t i = 0; i < genreNames.size(); i++)
+            for(uint32_t i = 0; i < model.genreNames.size(); i++)
             {
-                if(genreFilter.PassFilter(genreNames[i].c_str()))
+                if(genreFilter.PassFilter(model.genreNames[i].c_str()))
                 {
-                    currentGenreMask.setBit(i);
+                    model.currentGenreMask.setBit(i);
                     filterDirty = true;
                 }
             }
@@ -328,19 +428,19 @@ void App::createMainUI()
         ImGui::SameLine();
         if(ImGui::Button("↺##genreFilter"))
         {
-            currentGenreMask.clear();
+            model.currentGenreMask.clear();
             filterDirty = true;
         }
 
         ImGui::Text("Track, Artist, Album name");
-        if(nameFilter.Draw("##"))
+        if(model.nameFilter.Draw("##"))
         {
             filterDirty = true;
         }
         ImGui::SameLine();
         if(ImGui::Button("↺##text"))
         {
-            nameFilter.Clear();
+            model.nameFilter.Clear();
             filterDirty = true;
         }
         for(auto i = 0; i < Track::featureAmount; i++)
@@ -351,12 +451,12 @@ void App::createMainUI()
             ImGui::TextUnformatted(Track::FeatureNames[i].data());
             IMGUI_ACTIVATE(
                 ImGui::DragFloatRange2(
-                    "Min/Max", &featureMinMaxValues[i].x, &featureMinMaxValues[i].y, speed, 0.0f, max),
+                    "Min/Max", &model.featureMinMaxValues[i].x, &model.featureMinMaxValues[i].y, speed, 0.0f, max),
                 filterDirty);
             ImGui::SameLine();
             if(ImGui::Button("↺"))
             {
-                featureMinMaxValues[i] = {0.f, max};
+                model.featureMinMaxValues[i] = {0.f, max};
                 filterDirty = true;
             }
             ImGui::HelpMarkerFromLastItem("Reset filter");
@@ -365,7 +465,7 @@ void App::createMainUI()
         ImGui::Dummy(ImVec2(0.0f, 1.0f));
         if(ImGui::Button("Reset all ↺"))
         {
-            resetFeatureFilters();
+            model.resetFeatureFilters();
             filterDirty = true;
         }
         ImGui::Dummy(ImVec2(0.0f, 5.0f));
@@ -425,50 +525,84 @@ void App::createMainUI()
         {
             ImVec2 fullWindowContentSize = ImGui::GetContentRegionAvail();
 
-            if(canLoadCovers)
+            if(playlistLoading)
+            {
+                ImGui::Text("%s:", loadProgress.getLabel());
+                ImGui::ProgressBar(loadProgress.getFraction());
+                ImGui::Separator();
+            }
+            else if(!streamLoadError.empty())
+            {
+                ImGui::TextColored(
+                    ImVec4(1.0f, 0.4f, 0.4f, 1.0f),
+                    "Loading failed, only part of the playlist is shown: %s",
+                    streamLoadError.c_str());
+                ImGui::Separator();
+            }
+            // the cover table isnt complete yet
+            if(canLoadCovers && !playlistLoading)
             {
                 // ImGui::SameLine();
                 if(ImGui::Button("Load Covers"))
                 {
                     canLoadCovers = false;
-                    auto getCoverData = [&](std::pair<const std::string, CoverInfo>& entry) -> void
-                    {
-                        // todo: error handling for all the requests
-                        TextureLoadInfo tli;
-                        tli.ptr = &entry.second;
-
-                        const std::string& imageUrl = entry.second.url;
-                        cpr::Response r = cpr::Get(cpr::Url(imageUrl));
-                        int temp;
-                        tli.data = stbi_load_from_memory(
-                            (unsigned char*)r.text.c_str(), r.text.size(), &tli.x, &tli.y, &temp, 3);
-
-                        std::lock_guard<std::mutex> lock(renderer.coverLoadQueueMutex);
-                        renderer.coverLoadQueue.push(tli);
-                    };
-                    coversLoaded = 0;
-                    // todo:
-                    // handle partially loaded covers (when loading cover earlier went wrong, or new
-                    // tracks were added (not yet included)) probably easiest to have a "isLoaded" flag as
-                    // part of CoverInfo.
-                    // That would enable starting the download again, and only downloading ones that failed the
-                    // first time around
-                    for(std::pair<const std::string, CoverInfo>& entry : coverTable)
+                    std::vector<CoverInfo*> covers;
+                    std::vector<CoverInfo*> cachedCovers;
+                    covers.reserve(model.coverTable.size());
+                    for(std::pair<const std::string, CoverInfo>& entry : model.coverTable)
                     {
                         // skip the default texture entry
                         if(entry.first != "")
                         {
-                            // c++ cant guarantee that reference stays alive, need to explicitly wrap
-                            // as reference when passing to thread
-                            std::thread{getCoverData, std::ref(entry)}.detach();
+                            CoverInfo& cover = entry.second;
+                            (coverCache.contains(cover.albumId, cover.url) ? cachedCovers : covers)
+                                .push_back(&cover);
+                        }
+                    }
+                    coversTotal = static_cast<int>(covers.size() + cachedCovers.size());
+                    coversLoaded = 0;
+                    // before any tile is queued, this might move them
+                    coverCache.reserve(static_cast<uint32_t>(covers.size()));
+                    {
+                        // uploaded straight from the cache file
+                        std::lock_guard<std::mutex> lock(renderer.coverLoadQueueMutex);
+                        for(CoverInfo* cover : cachedCovers)
+                        {
+                            if(unsigned char* tile = coverCache.find(cover->albumId, cover->url))
+                            {
+                                renderer.coverLoadQueue.push(
+                                    TextureLoadInfo{.data = tile, .ptr = cover, .ownsData = false});
+                            }
+                            else
+                            {
+                                covers.push_back(cover);
+                            }
                         }
                     }
+                    coverLoader.load(
+                        std::move(covers),
+                        [&](TextureLoadInfo tli)
+                        {
+                            coverCache.store(tli.ptr->albumId, tli.ptr->url, tli.data);
+                            std::lock_guard<std::mutex> lock(renderer.coverLoadQueueMutex);
+                            renderer.coverLoadQueue.push(tli);
+                        });
                 }
                 ImGui::Separator();
             }
             if(!canLoadCovers && coversLoaded != coversTotal)
             {
                 ImGui::ProgressBar(static_cast<float>(coversLoaded) / coversTotal);
+                const CoverLoader::Stats coverStats = coverLoader.getStats();
+                if(coverStats.pending == 0 && coverStats.failed != 0)
+                {
+                    ImGui::Text("%u covers could not be loaded", coverStats.failed);
+                    ImGui::SameLine();
+                    if(ImGui::Button("Retry##covers"))
+                    {
+                        coverLoader.retryFailed();
+                    }
+                }
                 ImGui::Separator();
             }
 
@@ -510,10 +644,13 @@ void App::createMainUI()
                         extendPinsByRecommendations();
                     }
                     ImGui::SameLine();
+                    // the artists of the tracks are only complete once the playlist is
+                    ImGui::BeginDisabled(playlistLoading);
                     if(ImGui::Button("Based on artists"))
                     {
                         extendPinsByArtists();
                     }
+                    ImGui::EndDisabled();
                     ImGui::SameLine();
                     ImGui::SetNextItemWidth(renderer.scaleByDPI(100.0f));
                     ImGui::SliderInt("Accuracy", &recommendAccuracy, 1, 5, "");
@@ -536,16 +673,15 @@ void App::createMainUI()
                 if(ImGui::Button("Create filters from pinned tracks"))
                 {
                     // todo: XYZ(vector<Track*> v) that fills filter
-                    featureMinMaxValues.fill(
+                    model.featureMinMaxValues.fill(
                         glm::vec2(std::numeric_limits<float>::max(), std::numeric_limits<float>::min()));
                     for(const Track* trackPtr : pinnedTracks)
                     {
-                        for(auto indx = 0; indx < trackPtr->features.size(); indx++)
+                        for(auto indx = 0; indx < Track::featureAmount; indx++)
                         {
-                            featureMinMaxValues[indx].x =
-                                std::min(featureMinMaxValues[indx].x, trackPtr->features[indx]);
-                            featureMinMaxValues[indx].y =
-                                std::max(featureMinMaxValues[indx].y, trackPtr->features[indx]);
+                            const float value = model.trackFeatures.get(indx, trackPtr->index);
+                            model.featureMinMaxValues[indx].x = std::min(model.featureMinMaxValues[indx].x, value);
+                            model.featureMinMaxValues[indx].y = std::max(model.featureMinMaxValues[indx].y, value);
                         }
                     }
                     filterDirty = true;
@@ -51,6 +51,10 @@ void keyCallback(GLFWwindow* window, int key, int scancode, int action, int mods
         glfwSetWindowShouldClose(window, GL_TRUE);
     if(key == GLFW_KEY_TAB && action == GLFW_PRESS)
         app.toggleWindowVisibility();
+#ifdef FRAME_TIMING
+    if(key == GLFW_KEY_F3 && action == GLFW_PRESS)
+        app.toggleFrameTimingOverlay();
+#endif
 }
 
 void scrollCallback(GLFWwindow* window, double xoffset, double yoffset)
@@ -1,5 +1,7 @@
 #pragma once
 
+// glad has to be included before glfw
+#include <glad/glad.h>
 #include <GLFW/glfw3.h>
 
 void mouseButtonCallback(GLFWwindow* window, int button, int action, int mods);
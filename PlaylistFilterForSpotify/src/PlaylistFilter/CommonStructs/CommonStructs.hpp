@@ -1,9 +1,8 @@
 #pragma once
 
-#include <glad/glad.h>
-
 #include <ImGui/imgui.h>
 #include <array>
+#include <cstdint>
 #include <glm/ext.hpp>
 #include <string>
 #include <vector>
@@ -15,10 +14,10 @@ struct GraphingBufferElement
     // position of track
     glm::vec3 p;
     // index of album cover in cover array
-    GLuint layer;
+    uint32_t layer;
     // index in the original track vector. Needed for selection, when raycasting against elements in the track
     // buffer
-    GLuint originalIndex;
+    uint32_t originalIndex;
 };
 
 struct ColumnHeader
@@ -30,19 +29,21 @@ struct ColumnHeader
 
 struct CoverInfo
 {
+    std::string albumId;
     std::string url;
     // Layer index in the big cover array
-    GLuint layer = 0;
+    uint32_t layer = 0;
     // OpenGL handle of a texture view, covering just that single layer
-    GLuint id = 0xFFFFFFFF;
+    uint32_t id = 0xFFFFFFFF;
 };
 
 struct TextureLoadInfo
 {
-    int x;
-    int y;
+    // a whole cover tile with all mip levels (see CoverImage.hpp)
     unsigned char* data;
     CoverInfo* ptr;
+    // false if the data points into the cover cache, otherwise it has to be freed with delete[]
+    bool ownsData = true;
 };
 
 enum TableType
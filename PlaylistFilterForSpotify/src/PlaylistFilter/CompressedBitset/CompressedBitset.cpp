@@ -0,0 +1,588 @@
+#include "CompressedBitset.hpp"
+
+#include <iterator>
+#include <numeric>
+
+static uint32_t countBits(const std::vector<uint64_t>& words)
+{
+    uint32_t count = 0;
+    for(uint64_t word : words)
+    {
+        count += std::popcount(word);
+    }
+    return count;
+}
+
+// ---- Container ----
+
+bool CompressedBitset::Container::contains(uint16_t low) const
+{
+    if(isBitmap())
+    {
+        return (bitmap[low / 64] & (uint64_t(1) << (low % 64))) != 0U;
+    }
+    return std::binary_search(array.begin(), array.end(), low);
+}
+
+void CompressedBitset::Container::toBitmap()
+{
+    assert(!isBitmap());
+    bitmap.assign(bitmapWords, 0U);
+    for(uint16_t low : array)
+    {
+        bitmap[low / 64] |= uint64_t(1) << (low % 64);
+    }
+    bitmapCardinality = static_cast<uint32_t>(array.size());
+    array.clear();
+    array.shrink_to_fit();
+}
+
+void CompressedBitset::Container::toArray()
+{
+    assert(isBitmap());
+    array.clear();
+    array.reserve(bitmapCardinality);
+    for(uint32_t i = 0; i < bitmapWords; i++)
+    {
+        uint64_t word = bitmap[i];
+        while(word != 0U)
+        {
+            array.push_back(static_cast<uint16_t>(i * 64 + std::countr_zero(word)));
+            word &= word - 1;
+        }
+    }
+    bitmap.clear();
+    bitmap.shrink_to_fit();
+}
+
+void CompressedBitset::Container::normalize()
+{
+    if(isBitmap())
+    {
+        if(bitmapCardinality <= arrayMaxSize)
+        {
+            toArray();
+        }
+    }
+    else if(array.size() > arrayMaxSize)
+    {
+        toBitmap();
+    }
+}
+
+bool CompressedBitset::Container::operator==(const Container& other) const
+{
+    // containers are always normalized, so equal sets also use the same representation
+    return key == other.key && array == other.array && bitmap == other.bitmap;
+}
+
+void CompressedBitset::containerUnion(Container& a, const Container& b)
+{
+    if(!a.isBitmap() && !b.isBitmap())
+    {
+        std::vector<uint16_t> merged;
+        merged.reserve(a.array.size() + b.array.size());
+        std::set_union(a.array.begin(), a.array.end(), b.array.begin(), b.array.end(), std::back_inserter(merged));
+        a.array = std::move(merged);
+    }
+    else
+    {
+        if(!a.isBitmap())
+        {
+            a.toBitmap();
+        }
+        if(b.isBitmap())
+        {
+            for(uint32_t i = 0; i < bitmapWords; i++)
+            {
+                a.bitmap[i] |= b.bitmap[i];
+            }
+        }
+        else
+        {
+            for(uint16_t low : b.array)
+            {
+                a.bitmap[low / 64] |= uint64_t(1) << (low % 64);
+            }
+        }
+        a.bitmapCardinality = countBits(a.bitmap);
+    }
+    a.normalize();
+}
+
+void CompressedBitset::containerIntersection(Container& a, const Container& b)
+{
+    if(!a.isBitmap())
+    {
+        // result can only get smaller, so keep the array and drop whats not in b
+        std::erase_if(a.array, [&](uint16_t low) { return !b.contains(low); });
+    }
+    else if(!b.isBitmap())
+    {
+        // b is the smaller one, keep the values of b that are in a
+        std::vector<uint16_t> result;
+        result.reserve(b.array.size());
+        for(uint16_t low : b.array)
+        {
+            if(a.contains(low))
+            {
+                result.push_back(low);
+            }
+        }
+        a.bitmap.clear();
+        a.bitmap.shrink_to_fit();
+        a.array = std::move(result);
+    }
+    else
+    {
+        for(uint32_t i = 0; i < bitmapWords; i++)
+        {
+            a.bitmap[i] &= b.bitmap[i];
+        }
+        a.bitmapCardinality = countBits(a.bitmap);
+    }
+    a.normalize();
+}
+
+void CompressedBitset::containerXor(Container& a, const Container& b)
+{
+    if(!a.isBitmap() && !b.isBitmap())
+    {
+        std::vector<uint16_t> result;
+        result.reserve(a.array.size() + b.array.size());
+        std::set_symmetric_difference(
+            a.array.begin(), a.array.end(), b.array.begin(), b.array.end(), std::back_inserter(result));
+        a.array = std::move(result);
+    }
+    else
+    {
+        if(!a.isBitmap())
+        {
+            a.toBitmap();
+        }
+        if(b.isBitmap())
+        {
+            for(uint32_t i = 0; i < bitmapWords; i++)
+            {
+                a.bitmap[i] ^= b.bitmap[i];
+            }
+        }
+        else
+        {
+            for(uint16_t low : b.array)
+            {
+                a.bitmap[low / 64] ^= uint64_t(1) << (low % 64);
+            }
+        }
+        a.bitmapCardinality = countBits(a.bitmap);
+    }
+    a.normalize();
+}
+
+void CompressedBitset::containerDifference(Container& a, const Container& b)
+{
+    if(!a.isBitmap())
+    {
+        std::erase_if(a.array, [&](uint16_t low) { return b.contains(low); });
+    }
+    else
+    {
+        if(b.isBitmap())
+        {
+            for(uint32_t i = 0; i < bitmapWords; i++)
+            {
+                a.bitmap[i] &= ~b.bitmap[i];
+            }
+        }
+        else
+        {
+            for(uint16_t low : b.array)
+            {
+                a.bitmap[low / 64] &= ~(uint64_t(1) << (low % 64));
+            }
+        }
+        a.bitmapCardinality = countBits(a.bitmap);
+    }
+    a.normalize();
+}
+
+bool CompressedBitset::containersIntersect(const Container& a, const Container& b)
+{
+    if(a.isBitmap() && b.isBitmap())
+    {
+        for(uint32_t i = 0; i < bitmapWords; i++)
+        {
+            if((a.bitmap[i] & b.bitmap[i]) != 0U)
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+    if(a.isBitmap() || b.isBitmap())
+    {
+        const Container& arrayContainer = a.isBitmap() ? b : a;
+        const Container& bitmapContainer = a.isBitmap() ? a : b;
+        return std::any_of(
+            arrayContainer.array.begin(),
+            arrayContainer.array.end(),
+            [&](uint16_t low) { return bitmapContainer.contains(low); });
+    }
+    // both sorted, walk them in parallel
+    auto iterA = a.array.begin();
+    auto iterB = b.array.begin();
+    while(iterA != a.array.end() && iterB != b.array.end())
+    {
+        if(*iterA == *iterB)
+        {
+            return true;
+        }
+        if(*iterA < *iterB)
+        {
+            iterA++;
+        }
+        else
+        {
+            iterB++;
+        }
+    }
+    return false;
+}
+
+// ---- CompressedBitset ----
+
+CompressedBitset::CompressedBitset(uint32_t _size) : size(_size)
+{
+}
+
+CompressedBitset operator^(const CompressedBitset& lhs, const CompressedBitset& rhs)
+{
+    CompressedBitset result = lhs;
+    result ^= rhs;
+    return result;
+}
+CompressedBitset operator&(const CompressedBitset& lhs, const CompressedBitset& rhs)
+{
+    CompressedBitset result = lhs;
+    result &= rhs;
+    return result;
+}
+CompressedBitset operator|(const CompressedBitset& lhs, const CompressedBitset& rhs)
+{
+    CompressedBitset result = lhs;
+    result |= rhs;
+    return result;
+}
+
+CompressedBitset& CompressedBitset::operator&=(const CompressedBitset& other)
+{
+    size = std::max(size, other.size);
+    auto otherIter = other.containers.begin();
+    for(Container& container : containers)
+    {
+        while(otherIter != other.containers.end() && otherIter->key < container.key)
+        {
+            otherIter++;
+        }
+        if(otherIter == other.containers.end() || otherIter->key != container.key)
+        {
+            // nothing in other for this chunk
+            container.array.clear();
+            container.bitmap.clear();
+        }
+        else
+        {
+            containerIntersection(container, *otherIter);
+        }
+    }
+    removeEmptyContainers();
+    return *this;
+}
+CompressedBitset& CompressedBitset::operator|=(const CompressedBitset& other)
+{
+    size = std::max(size, other.size);
+    for(const Container& otherContainer : other.containers)
+    {
+        auto iter = findContainer(otherContainer.key);
+        if(iter == containers.end() || iter->key != otherContainer.key)
+        {
+            containers.insert(iter, otherContainer);
+        }
+        else
+        {
+            containerUnion(*iter, otherContainer);
+        }
+    }
+    return *this;
+}
+CompressedBitset& CompressedBitset::operator^=(const CompressedBitset& other)
+{
+    size = std::max(size, other.size);
+    for(const Container& otherContainer : other.containers)
+    {
+        auto iter = findContainer(otherContainer.key);
+        if(iter == containers.end() || iter->key != otherContainer.key)
+        {
+            containers.insert(iter, otherContainer);
+        }
+        else
+        {
+            containerXor(*iter, otherContainer);
+        }
+    }
+    removeEmptyContainers();
+    return *this;
+}
+CompressedBitset& CompressedBitset::andNot(const CompressedBitset& other)
+{
+    auto otherIter = other.containers.begin();
+    for(Container& container : containers)
+    {
+        while(otherIter != other.containers.end() && otherIter->key < container.key)
+        {
+            otherIter++;
+        }
+        if(otherIter != other.containers.end() && otherIter->key == container.key)
+        {
+            containerDifference(container, *otherIter);
+        }
+    }
+    removeEmptyContainers();
+    return *this;
+}
+bool CompressedBitset::intersects(const CompressedBitset& other) const
+{
+    auto iterA = containers.begin();
+    auto iterB = other.containers.begin();
+    while(iterA != containers.end() && iterB != other.containers.end())
+    {
+        if(iterA->key == iterB->key)
+        {
+            if(containersIntersect(*iterA, *iterB))
+            {
+                return true;
+            }
+            iterA++;
+            iterB++;
+        }
+        else if(iterA->key < iterB->key)
+        {
+            iterA++;
+        }
+        else
+        {
+            iterB++;
+        }
+    }
+    return false;
+}
+
+bool CompressedBitset::operator==(const CompressedBitset& other) const
+{
+    return size == other.size && containers == other.containers;
+}
+
+CompressedBitset::operator bool() const
+{
+    // empty containers are always removed
+    return !containers.empty();
+}
+void CompressedBitset::clear()
+{
+    containers.clear();
+}
+void CompressedBitset::setAll()
+{
+    containers.clear();
+    for(uint32_t first = 0; first < size; first += chunkBits)
+    {
+        const uint32_t count = std::min(chunkBits, size - first);
+        Container& container = containers.emplace_back();
+        container.key = static_cast<uint16_t>(first >> 16);
+        if(count > arrayMaxSize)
+        {
+            container.bitmap.assign(bitmapWords, 0U);
+            std::fill(container.bitmap.begin(), container.bitmap.begin() + count / 64, ~uint64_t(0));
+            if(count % 64 != 0)
+            {
+                container.bitmap[count / 64] = (~uint64_t(0)) >> (64 - (count % 64));
+            }
+            container.bitmapCardinality = count;
+        }
+        else
+        {
+            container.array.resize(count);
+            std::iota(container.array.begin(), container.array.end(), uint16_t(0));
+        }
+    }
+}
+bool CompressedBitset::getBit(uint32_t index) const
+{
+    assert(index < size);
+    const auto key = static_cast<uint16_t>(index >> 16);
+    auto iter = findContainer(key);
+    return iter != containers.end() && iter->key == key && iter->contains(static_cast<uint16_t>(index));
+}
+void CompressedBitset::setBit(uint32_t index)
+{
+    assert(index < size);
+    const auto key = static_cast<uint16_t>(index >> 16);
+    const auto low = static_cast<uint16_t>(index);
+    auto iter = findContainer(key);
+    if(iter == containers.end() || iter->key != key)
+    {
+        iter = containers.insert(iter, Container{});
+        iter->key = key;
+    }
+    Container& container = *iter;
+    if(container.isBitmap())
+    {
+        uint64_t& word = container.bitmap[low / 64];
+        const uint64_t bit = uint64_t(1) << (low % 64);
+        container.bitmapCardinality += (word & bit) == 0U ? 1 : 0;
+        word |= bit;
+        return;
+    }
+    auto pos = std::lower_bound(container.array.begin(), container.array.end(), low);
+    if(pos == container.array.end() || *pos != low)
+    {
+        container.array.insert(pos, low);
+        container.normalize();
+    }
+}
+void CompressedBitset::clearBit(uint32_t index)
+{
+    assert(index < size);
+    const auto key = static_cast<uint16_t>(index >> 16);
+    const auto low = static_cast<uint16_t>(index);
+    auto iter = findContainer(key);
+    if(iter == containers.end() || iter->key != key)
+    {
+        return;
+    }
+    Container& container = *iter;
+    if(container.isBitmap())
+    {
+        uint64_t& word = container.bitmap[low / 64];
+        const uint64_t bit = uint64_t(1) << (low % 64);
+        container.bitmapCardinality -= (word & bit) != 0U ? 1 : 0;
+        word &= ~bit;
+        container.normalize();
+    }
+    else
+    {
+        auto pos = std::lower_bound(container.array.begin(), container.array.end(), low);
+        if(pos != container.array.end() && *pos == low)
+        {
+            container.array.erase(pos);
+        }
+    }
+    if(container.cardinality() == 0)
+    {
+        containers.erase(iter);
+    }
+}
+void CompressedBitset::toggleBit(uint32_t index)
+{
+    if(getBit(index))
+    {
+        clearBit(index);
+    }
+    else
+    {
+        setBit(index);
+    }
+}
+uint32_t CompressedBitset::popcount() const
+{
+    uint32_t count = 0;
+    for(const Container& container : containers)
+    {
+        count += container.cardinality();
+    }
+    return count;
+}
+uint32_t CompressedBitset::getFirstBitSet() const
+{
+    if(containers.empty())
+    {
+        return ~0U;
+    }
+    const Container& first = containers.front();
+    const uint32_t base = static_cast<uint32_t>(first.key) << 16;
+    if(!first.isBitmap())
+    {
+        return base + first.array.front();
+    }
+    for(uint32_t i = 0; i < bitmapWords; i++)
+    {
+        if(first.bitmap[i] != 0U)
+        {
+            return base + i * 64 + std::countr_zero(first.bitmap[i]);
+        }
+    }
+    assert(false && "Empty containers should have been removed");
+    return ~0U;
+}
+
+bool CompressedBitset::resize(uint32_t nSize)
+{
+    size = nSize;
+    const size_t countBefore = popcount();
+    // drop everything at or past the new size
+    std::erase_if(containers, [&](const Container& c) { return (static_cast<uint32_t>(c.key) << 16) >= nSize; });
+    if(!containers.empty())
+    {
+        Container& last = containers.back();
+        const uint32_t base = static_cast<uint32_t>(last.key) << 16;
+        if(nSize - base < chunkBits)
+        {
+            const uint32_t keep = nSize - base;
+            if(last.isBitmap())
+            {
+                std::fill(last.bitmap.begin() + (keep + 63) / 64, last.bitmap.end(), 0U);
+                if(keep % 64 != 0)
+                {
+                    last.bitmap[keep / 64] &= (~uint64_t(0)) >> (64 - (keep % 64));
+                }
+                last.bitmapCardinality = countBits(last.bitmap);
+                last.normalize();
+            }
+            else
+            {
+                std::erase_if(last.array, [&](uint16_t low) { return low >= keep; });
+            }
+        }
+    }
+    removeEmptyContainers();
+    return popcount() != countBefore;
+}
+uint32_t CompressedBitset::getSize() const
+{
+    return size;
+}
+size_t CompressedBitset::getAllocatedBytes() const
+{
+    size_t bytes = containers.capacity() * sizeof(Container);
+    for(const Container& container : containers)
+    {
+        bytes += container.array.capacity() * sizeof(uint16_t);
+        bytes += container.bitmap.capacity() * sizeof(uint64_t);
+    }
+    return bytes;
+}
+
+std::vector<CompressedBitset::Container>::iterator CompressedBitset::findContainer(uint16_t key)
+{
+    return std::lower_bound(
+        containers.begin(), containers.end(), key, [](const Container& c, uint16_t k) { return c.key < k; });
+}
+std::vector<CompressedBitset::Container>::const_iterator CompressedBitset::findContainer(uint16_t key) const
+{
+    return std::lower_bound(
+        containers.begin(), containers.end(), key, [](const Container& c, uint16_t k) { return c.key < k; });
+}
+void CompressedBitset::removeEmptyContainers()
+{
+    std::erase_if(containers, [](const Container& c) { return c.cardinality() == 0; });
+}
@@ -0,0 +1,136 @@
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/*
+    Compressed bitset in the style of Roaring bitmaps, meant for huge sets of which only very few bits are set
+    (ie. which artists/genres a single track has, out of all artists/genres in the playlist).
+    The index range is split into chunks of 2^16 bits and only chunks that contain set bits are stored at all.
+    A chunk with few bits set stores the sorted lower 16 bits of their indices ("array container"), once it
+    holds more than arrayMaxSize indices it switches to a plain 2^16 bit bitmap ("bitmap container"), at that
+    point both take 8KB.
+    The interface mirrors DynBitset, except for the raw word access.
+*/
+class CompressedBitset
+{
+  public:
+    CompressedBitset() = default;
+    explicit CompressedBitset(uint32_t _size);
+
+    friend CompressedBitset operator^(const CompressedBitset& lhs, const CompressedBitset& rhs);
+    friend CompressedBitset operator&(const CompressedBitset& lhs, const CompressedBitset& rhs);
+    friend CompressedBitset operator|(const CompressedBitset& lhs, const CompressedBitset& rhs);
+
+    CompressedBitset& operator&=(const CompressedBitset& other);
+    CompressedBitset& operator|=(const CompressedBitset& other);
+    CompressedBitset& operator^=(const CompressedBitset& other);
+    // this &= ~other
+    CompressedBitset& andNot(const CompressedBitset& other);
+    // same result as bool(*this & other), without building the intersection
+    [[nodiscard]] bool intersects(const CompressedBitset& other) const;
+
+    bool operator==(const CompressedBitset& other) const;
+
+    operator bool() const; // NOLINT
+    void clear();
+    // sets all bits up to getSize()
+    void setAll();
+    [[nodiscard]] bool getBit(uint32_t index) const;
+    void setBit(uint32_t index);
+    void clearBit(uint32_t index);
+    void toggleBit(uint32_t index);
+    // number of bits set
+    [[nodiscard]] uint32_t popcount() const;
+    // returns 0xffffffff is no bit was set
+    [[nodiscard]] uint32_t getFirstBitSet() const;
+    // calls func(index) for every set bit, in ascending order. The set must not be modified from inside func
+    template <class Func>
+    void forEachSetBit(Func func) const
+    {
+        for(const Container& container : containers)
+        {
+            const uint32_t base = static_cast<uint32_t>(container.key) << 16;
+            if(container.isBitmap())
+            {
+                for(uint32_t i = 0; i < bitmapWords; i++)
+                {
+                    uint64_t word = container.bitmap[i];
+                    while(word != 0U)
+                    {
+                        func(base + i * 64 + static_cast<uint32_t>(std::countr_zero(word)));
+                        word &= word - 1;
+                    }
+                }
+            }
+            else
+            {
+                for(uint16_t low : container.array)
+                {
+                    func(base + low);
+                }
+            }
+        }
+    }
+
+    // returns true if set bits had to be dropped
+    bool resize(uint32_t nSize);
+    [[nodiscard]] uint32_t getSize() const;
+    // heap memory owned by this set, for statistics
+    [[nodiscard]] size_t getAllocatedBytes() const;
+
+  private:
+    static constexpr uint32_t chunkBits = 1U << 16;
+    static constexpr uint32_t bitmapWords = chunkBits / 64;
+    static constexpr uint32_t arrayMaxSize = 4096;
+
+    struct Container
+    {
+        // upper 16 bits of all indices in this container
+        uint16_t key = 0;
+        // only kept up to date for bitmap containers, arrays just use their size
+        uint32_t bitmapCardinality = 0;
+        // sorted lower 16 bits, while this is an array container
+        std::vector<uint16_t> array;
+        // bitmapWords words, while this is a bitmap container
+        std::vector<uint64_t> bitmap;
+
+        [[nodiscard]] inline bool isBitmap() const
+        {
+            return !bitmap.empty();
+        }
+        [[nodiscard]] inline uint32_t cardinality() const
+        {
+            return isBitmap() ? bitmapCardinality : static_cast<uint32_t>(array.size());
+        }
+        [[nodiscard]] bool contains(uint16_t low) const;
+        void toBitmap();
+        void toArray();
+        // switch to whichever representation fits the current cardinality
+        void normalize();
+        bool operator==(const Container& other) const;
+    };
+
+    /*
+        Operations on two containers with the same key, the result is stored in a.
+        Afterwards a is normalized, but may be empty
+    */
+    static void containerUnion(Container& a, const Container& b);
+    static void containerIntersection(Container& a, const Container& b);
+    static void containerXor(Container& a, const Container& b);
+    static void containerDifference(Container& a, const Container& b);
+    static bool containersIntersect(const Container& a, const Container& b);
+
+    // first container with key >= the given one
+    std::vector<Container>::iterator findContainer(uint16_t key);
+    [[nodiscard]] std::vector<Container>::const_iterator findContainer(uint16_t key) const;
+    void removeEmptyContainers();
+
+    uint32_t size = 0;
+    // sorted by key
+    std::vector<Container> containers;
+};
@@ -0,0 +1,210 @@
+#include <CompressedBitset/CompressedBitset.hpp>
+#include <DynamicBitset/DynamicBitset.hpp>
+
+#include <Testing/Testing.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+
+/*
+    Differential test of CompressedBitset against DynBitset: both get the same random bits and operations, after
+    every step all set bits, popcount, the first set bit and intersects() have to agree.
+    The bit counts per chunk are picked around arrayMaxSize (4096), so the containers keep switching between
+    sorted arrays and bitmaps, by single bit changes as well as by the results of the set operations.
+*/
+
+static constexpr uint32_t chunkBits = 1U << 16;
+
+// set bits per chunk: empty, sparse, right below/at/above the array limit, dense and full
+static const std::vector<uint32_t> chunkFills = {0, 1, 40, 3000, 4095, 4096, 4097, 6000, 40000, chunkBits};
+
+struct BitsetPair
+{
+    CompressedBitset compressed;
+    DynBitset dense;
+
+    explicit BitsetPair(uint32_t size) : compressed(size), dense(size)
+    {
+    }
+    void setBit(uint32_t index)
+    {
+        compressed.setBit(index);
+        dense.setBit(index);
+    }
+    void clearBit(uint32_t index)
+    {
+        compressed.clearBit(index);
+        dense.clearBit(index);
+    }
+    void toggleBit(uint32_t index)
+    {
+        compressed.toggleBit(index);
+        dense.toggleBit(index);
+    }
+};
+
+static BitsetPair makeRandomPair(uint32_t size, std::mt19937_64& random)
+{
+    BitsetPair pair(size);
+    for(uint32_t chunkStart = 0; chunkStart < size; chunkStart += chunkBits)
+    {
+        const uint32_t chunkSize = std::min(chunkBits, size - chunkStart);
+        const uint32_t fill = std::min(chunkFills[random() % chunkFills.size()], chunkSize);
+        if(fill == chunkSize)
+        {
+            for(uint32_t i = 0; i < chunkSize; i++)
+            {
+                pair.setBit(chunkStart + i);
+            }
+            continue;
+        }
+        // duplicates just land a little below the fill, that is fine
+        for(uint32_t i = 0; i < fill; i++)
+        {
+            pair.setBit(chunkStart + static_cast<uint32_t>(random() % chunkSize));
+        }
+    }
+    return pair;
+}
+
+// everything observable of the compressed set has to match the dense one
+static void checkSame(const BitsetPair& pair, const std::string& what)
+{
+    const CompressedBitset& compressed = pair.compressed;
+    const DynBitset& dense = pair.dense;
+    Testing::check(compressed.getSize() == dense.getSize(), "size", what);
+    Testing::check(compressed.popcount() == dense.popcount(), "popcount", what);
+    Testing::check(static_cast<bool>(compressed) == static_cast<bool>(dense), "operator bool", what);
+    Testing::check(compressed.getFirstBitSet() == dense.getFirstBitSet(), "getFirstBitSet", what);
+
+    std::vector<uint32_t> compressedBits;
+    compressed.forEachSetBit([&](uint32_t i) { compressedBits.push_back(i); });
+    std::vector<uint32_t> denseBits;
+    dense.forEachSetBit([&](uint32_t i) { denseBits.push_back(i); });
+    Testing::check(compressedBits == denseBits, "forEachSetBit", what);
+
+    bool getBitMatches = true;
+    for(uint32_t i = 0; i < dense.getSize(); i++)
+    {
+        getBitMatches = getBitMatches && compressed.getBit(i) == dense.getBit(i);
+    }
+    Testing::check(getBitMatches, "getBit", what);
+}
+
+static void checkOperations(uint64_t seed)
+{
+    std::mt19937_64 random(seed);
+    const std::string where = "seed " + std::to_string(seed);
+    // not a multiple of the chunk size, so the last chunk is cut off
+    const auto size = static_cast<uint32_t>(3 * chunkBits + random() % chunkBits);
+    const BitsetPair a = makeRandomPair(size, random);
+    const BitsetPair b = makeRandomPair(size, random);
+    checkSame(a, "random set (" + where + ")");
+
+    const bool denseIntersects = static_cast<bool>(a.dense & b.dense);
+    Testing::check(a.compressed.intersects(b.compressed) == denseIntersects, "intersects", where);
+    Testing::check((a.compressed == b.compressed) == (a.dense == b.dense), "operator==", where);
+
+    BitsetPair result = a;
+    result.compressed &= b.compressed;
+    result.dense &= b.dense;
+    checkSame(result, "&= (" + where + ")");
+
+    result = a;
+    result.compressed |= b.compressed;
+    result.dense |= b.dense;
+    checkSame(result, "|= (" + where + ")");
+
+    result = a;
+    result.compressed ^= b.compressed;
+    result.dense ^= b.dense;
+    checkSame(result, "^= (" + where + ")");
+
+    result = a;
+    result.compressed.andNot(b.compressed);
+    result.dense.andNot(b.dense);
+    checkSame(result, "andNot (" + where + ")");
+
+    result.compressed = a.compressed & b.compressed;
+    result.dense = a.dense & b.dense;
+    checkSame(result, "& (" + where + ")");
+    result.compressed = a.compressed | b.compressed;
+    result.dense = a.dense | b.dense;
+    checkSame(result, "| (" + where + ")");
+    result.compressed = a.compressed ^ b.compressed;
+    result.dense = a.dense ^ b.dense;
+    checkSame(result, "^ (" + where + ")");
+
+    // a set with itself, the containers on both sides are the same kind
+    result = a;
+    result.compressed ^= a.compressed;
+    result.dense ^= a.dense;
+    checkSame(result, "^= itself (" + where + ")");
+    Testing::check(!a.compressed.intersects(result.compressed), "intersects empty", where);
+}
+
+// single bits moving one chunk up over the array limit and back down again
+static void checkSingleBitCrossings(uint64_t seed)
+{
+    std::mt19937_64 random(seed);
+    const std::string where = "seed " + std::to_string(seed);
+    BitsetPair pair(2 * chunkBits);
+    const uint32_t chunkStart = chunkBits;
+    uint32_t next = 0;
+    // every other bit, so toBitmap and toArray have gaps to keep
+    for(; next < 2 * 4096 + 4; next += 2)
+    {
+        pair.setBit(chunkStart + next);
+        if(next / 2 >= 4094 && next / 2 <= 4098)
+        {
+            checkSame(pair, "setBit around the limit (" + where + ")");
+        }
+    }
+    pair.toggleBit(chunkStart + next);
+    pair.toggleBit(chunkStart + 1);
+    checkSame(pair, "toggleBit on a bitmap (" + where + ")");
+
+    // clear random set bits until the chunk is back to an array and then empty
+    std::vector<uint32_t> setBits;
+    pair.dense.forEachSetBit([&](uint32_t i) { setBits.push_back(i); });
+    std::shuffle(setBits.begin(), setBits.end(), random);
+    for(uint32_t i = 0; i < setBits.size(); i++)
+    {
+        pair.clearBit(setBits[i]);
+        const auto left = static_cast<uint32_t>(setBits.size()) - i - 1;
+        if((left >= 4094 && left <= 4098) || left <= 1)
+        {
+            checkSame(pair, "clearBit around the limit (" + where + ")");
+        }
+    }
+}
+
+static void checkResize(uint64_t seed)
+{
+    std::mt19937_64 random(seed);
+    const std::string where = "seed " + std::to_string(seed);
+    BitsetPair pair = makeRandomPair(3 * chunkBits, random);
+    for(const uint32_t size : {3 * chunkBits + 100, 2 * chunkBits + 17, chunkBits, 5000U, 64U, 0U, 2 * chunkBits})
+    {
+        pair.compressed.resize(size);
+        pair.dense.resize(size);
+        checkSame(pair, "resize to " + std::to_string(size) + " (" + where + ")");
+    }
+}
+
+int main()
+{
+    for(uint64_t seed = 1; seed <= 40; seed++)
+    {
+        checkOperations(seed);
+    }
+    for(uint64_t seed = 1; seed <= 3; seed++)
+    {
+        checkSingleBitCrossings(seed);
+        checkResize(seed);
+    }
+    return Testing::result("CompressedBitsetTest");
+}
@@ -0,0 +1,345 @@
+#include "CoverCache.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <type_traits>
+
+// bump whenever anything about the layout changes
+static constexpr uint32_t coverCacheVersion = 2;
+static constexpr std::array<char, 8> coverCacheMagic = {'P', 'F', 'C', 'O', 'V', 'E', 'R', '\n'};
+static constexpr size_t tileAlignment = 4096;
+
+struct CoverCacheHeader
+{
+    std::array<char, 8> magic;
+    uint32_t version;
+    // sizes of the structs, so changing them without bumping the version still doesnt load garbage
+    uint32_t headerSize;
+    uint32_t entrySize;
+    uint32_t tileBytes;
+    uint32_t capacity;
+    uint32_t padding;
+    // counts up on every use, entries store it as their last use
+    uint64_t useCounter;
+};
+
+struct CoverCacheEntry
+{
+    uint64_t albumHash;
+    uint64_t urlHash;
+    // 0 for free slots
+    uint64_t lastUse;
+};
+static_assert(std::is_trivially_copyable_v<CoverCacheHeader> && std::is_trivially_copyable_v<CoverCacheEntry>);
+
+static uint64_t hashString(std::string_view string)
+{
+    // FNV-1a
+    uint64_t hash = 0xCBF29CE484222325;
+    for(const char c : string)
+    {
+        hash = (hash ^ static_cast<uint8_t>(c)) * 0x100000001B3;
+    }
+    return hash;
+}
+
+static size_t getTilesOffset(uint32_t capacity)
+{
+    const size_t indexEnd = sizeof(CoverCacheHeader) + capacity * sizeof(CoverCacheEntry);
+    return (indexEnd + tileAlignment - 1) / tileAlignment * tileAlignment;
+}
+
+static size_t getFileSize(uint32_t capacity)
+{
+    return getTilesOffset(capacity) + capacity * coverTileBytes;
+}
+
+CoverCache::CoverCache(std::filesystem::path path, uint64_t maxBytes)
+    : path(std::move(path)),
+      maxCapacity(static_cast<uint32_t>(std::min<uint64_t>(
+          maxBytes / (coverTileBytes + sizeof(CoverCacheEntry)), std::numeric_limits<uint32_t>::max())))
+{
+    if(maxCapacity != 0)
+    {
+        open();
+    }
+}
+
+void CoverCache::open()
+{
+    file = MappedFile(path, 0);
+    const bool valid = [&]
+    {
+        if(!file.isOpen() || file.getSize() < sizeof(CoverCacheHeader))
+        {
+            return false;
+        }
+        const CoverCacheHeader& header = getHeader();
+        return header.magic == coverCacheMagic && header.version == coverCacheVersion &&
+               header.headerSize == sizeof(CoverCacheHeader) && header.entrySize == sizeof(CoverCacheEntry) &&
+               header.tileBytes == coverTileBytes && file.getSize() == getFileSize(header.capacity);
+    }();
+    if(!valid)
+    {
+        file.close();
+        std::error_code error;
+        std::filesystem::remove(path, error);
+        // nothing to keep, this just writes the header
+        rebuild(0);
+        return;
+    }
+    buildIndex();
+    if(getHeader().capacity > maxCapacity)
+    {
+        // the cap was lowered since
+        rebuild(maxCapacity);
+    }
+}
+
+bool CoverCache::rebuild(uint32_t capacity)
+{
+    // the most recently used covers are kept
+    std::vector<uint32_t> keptSlots;
+    if(file.isOpen())
+    {
+        const CoverCacheEntry* entries = getEntries();
+        for(const auto& [albumHash, slot] : slots)
+        {
+            keptSlots.push_back(slot);
+        }
+        std::sort(
+            keptSlots.begin(),
+            keptSlots.end(),
+            [&](uint32_t lhs, uint32_t rhs) { return entries[lhs].lastUse > entries[rhs].lastUse; });
+        keptSlots.resize(std::min<size_t>(keptSlots.size(), capacity));
+    }
+
+    std::filesystem::path tempPath = path;
+    tempPath += ".tmp";
+    std::error_code error;
+    std::filesystem::create_directories(path.parent_path(), error);
+    // might be left over with old data, the new file has to start out zeroed
+    std::filesystem::remove(tempPath, error);
+    {
+        MappedFile newFile(tempPath, getFileSize(capacity));
+        if(!newFile.isOpen())
+        {
+            file.close();
+            slots.clear();
+            return false;
+        }
+        uint8_t* data = newFile.writableData();
+        CoverCacheHeader header{
+            .magic = coverCacheMagic,
+            .version = coverCacheVersion,
+            .headerSize = sizeof(CoverCacheHeader),
+            .entrySize = sizeof(CoverCacheEntry),
+            .tileBytes = static_cast<uint32_t>(coverTileBytes),
+            .capacity = capacity,
+            .padding = 0,
+            .useCounter = file.isOpen() ? getHeader().useCounter : 0};
+        std::memcpy(data, &header, sizeof(CoverCacheHeader));
+        auto* newEntries = reinterpret_cast<CoverCacheEntry*>(data + sizeof(CoverCacheHeader));
+        for(uint32_t newSlot = 0; newSlot < keptSlots.size(); newSlot++)
+        {
+            const uint32_t slot = keptSlots[newSlot];
+            newEntries[newSlot] = getEntries()[slot];
+            std::memcpy(data + getTilesOffset(capacity) + newSlot * coverTileBytes, getTile(slot), coverTileBytes);
+        }
+    }
+    // has to be closed before it can be replaced (at least on windows)
+    file.close();
+    slots.clear();
+    std::filesystem::rename(tempPath, path, error);
+    if(error)
+    {
+        std::filesystem::remove(tempPath, error);
+        return false;
+    }
+    file = MappedFile(path, 0);
+    if(!file.isOpen() || file.getSize() != getFileSize(capacity))
+    {
+        file.close();
+        return false;
+    }
+    buildIndex();
+    return true;
+}
+
+void CoverCache::buildIndex()
+{
+    CoverCacheHeader& header = getHeader();
+    const CoverCacheEntry* entries = getEntries();
+    slots.clear();
+    slots.reserve(header.capacity);
+    replaceOrder.clear();
+    std::vector<uint32_t> used;
+    for(uint32_t slot = 0; slot < header.capacity; slot++)
+    {
+        const CoverCacheEntry& entry = entries[slot];
+        const bool valid = entry.lastUse != 0 && slots.try_emplace(entry.albumHash, slot).second;
+        (valid ? used : replaceOrder).push_back(slot);
+    }
+    std::sort(
+        used.begin(),
+        used.end(),
+        [&](uint32_t lhs, uint32_t rhs) { return entries[lhs].lastUse < entries[rhs].lastUse; });
+    replaceOrder.insert(replaceOrder.end(), used.begin(), used.end());
+    nextReplace = 0;
+    // a rebuild keeps the session going
+    if(sessionStart == 0)
+    {
+        sessionStart = header.useCounter + 1;
+    }
+}
+
+bool CoverCache::isOpen() const
+{
+    return file.isOpen();
+}
+
+bool CoverCache::contains(std::string_view albumId, std::string_view url) const
+{
+    std::lock_guard lock(mutex);
+    const auto iter = slots.find(hashString(albumId));
+    return iter != slots.end() && getEntries()[iter->second].urlHash == hashString(url);
+}
+
+unsigned char* CoverCache::find(std::string_view albumId, std::string_view url)
+{
+    std::lock_guard lock(mutex);
+    const auto iter = slots.find(hashString(albumId));
+    if(iter == slots.end())
+    {
+        return nullptr;
+    }
+    CoverCacheEntry& entry = getEntries()[iter->second];
+    // the album got a new cover
+    if(entry.urlHash != hashString(url))
+    {
+        return nullptr;
+    }
+    entry.lastUse = ++getHeader().useCounter;
+    return getTile(iter->second);
+}
+
+void CoverCache::reserve(uint32_t newCovers)
+{
+    std::lock_guard lock(mutex);
+    if(!file.isOpen())
+    {
+        return;
+    }
+    const uint32_t capacity = getHeader().capacity;
+    const uint64_t needed = slots.size() + static_cast<uint64_t>(newCovers);
+    if(needed <= capacity || capacity == maxCapacity)
+    {
+        return;
+    }
+    // grow by at least half, so a few more covers every session dont rewrite the file every time
+    const uint64_t grown = std::max<uint64_t>(needed, capacity + capacity / 2);
+    rebuild(static_cast<uint32_t>(std::min<uint64_t>(grown, maxCapacity)));
+}
+
+bool CoverCache::store(std::string_view albumId, std::string_view url, const unsigned char* tile)
+{
+    const uint64_t albumHash = hashString(albumId);
+    std::lock_guard lock(mutex);
+    if(!file.isOpen())
+    {
+        return false;
+    }
+    uint32_t slot = 0;
+    if(const auto iter = slots.find(albumHash); iter != slots.end())
+    {
+        // stored again with a new url
+        slot = iter->second;
+    }
+    else if(!takeSlot(slot))
+    {
+        return false;
+    }
+    CoverCacheEntry& entry = getEntries()[slot];
+    // only valid again once the pixels are there
+    entry.lastUse = 0;
+    std::memcpy(getTile(slot), tile, coverTileBytes);
+    entry.albumHash = albumHash;
+    entry.urlHash = hashString(url);
+    entry.lastUse = ++getHeader().useCounter;
+    slots[albumHash] = slot;
+    return true;
+}
+
+bool CoverCache::takeSlot(uint32_t& slot)
+{
+    const CoverCacheEntry* entries = getEntries();
+    while(nextReplace < replaceOrder.size())
+    {
+        const uint32_t candidate = replaceOrder[nextReplace++];
+        const CoverCacheEntry& entry = entries[candidate];
+        if(entry.lastUse >= sessionStart)
+        {
+            continue;
+        }
+        if(entry.lastUse != 0)
+        {
+            const auto iter = slots.find(entry.albumHash);
+            if(iter != slots.end() && iter->second == candidate)
+            {
+                slots.erase(iter);
+            }
+        }
+        slot = candidate;
+        return true;
+    }
+    return false;
+}
+
+uint32_t CoverCache::getCoverCount() const
+{
+    std::lock_guard lock(mutex);
+    return static_cast<uint32_t>(slots.size());
+}
+
+uint32_t CoverCache::getCapacity() const
+{
+    std::lock_guard lock(mutex);
+    return file.isOpen() ? getHeader().capacity : 0;
+}
+
+CoverCacheHeader& CoverCache::getHeader() const
+{
+    return *reinterpret_cast<CoverCacheHeader*>(file.writableData());
+}
+
+CoverCacheEntry* CoverCache::getEntries() const
+{
+    return reinterpret_cast<CoverCacheEntry*>(file.writableData() + sizeof(CoverCacheHeader));
+}
+
+unsigned char* CoverCache::getTile(uint32_t slot) const
+{
+    return file.writableData() + getTilesOffset(getHeader().capacity) + static_cast<size_t>(slot) * coverTileBytes;
+}
+
+std::filesystem::path CoverCache::getCoverCachePath()
+{
+    return std::filesystem::path(CACHE_PATH) / "covers.cache";
+}
+
+uint64_t CoverCache::defaultMaxBytes()
+{
+    // NOLINTNEXTLINE(concurrency-mt-unsafe) only read once at startup
+    if(const char* env = std::getenv("PLAYLISTFILTER_COVER_CACHE_MB"))
+    {
+        const long long requested = std::atoll(env);
+        if(requested >= 0)
+        {
+            return static_cast<uint64_t>(requested) << 20;
+        }
+    }
+    return uint64_t{256} << 20;
+}
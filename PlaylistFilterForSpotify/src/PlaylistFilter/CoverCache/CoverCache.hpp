@@ -0,0 +1,85 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <mutex>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include <CoverImage/CoverImage.hpp>
+#include <utils/MappedFile.hpp>
+
+struct CoverCacheHeader;
+struct CoverCacheEntry;
+
+/*
+    Decoded album covers from earlier sessions, so they dont have to be downloaded and decoded again.
+    Everything is in one memory mapped file:
+        header                  magic, version, sizes of the structs below, slot count, use counter
+        entries                 one per slot: hashes of album id and cover url, when it was last used
+        tiles                   one per slot, starting on a page: the cover with all its mip levels
+    The tiles are handed out as pointers into the mapping, the renderer uploads them from there.
+    The file only grows in reserve(), up to a size cap. Once it is full the least recently used cover is
+    replaced, covers that were used in this session are never replaced (something might still point at them).
+    Anything that doesnt look right (version, sizes) just starts an empty cache.
+*/
+class CoverCache
+{
+  public:
+    explicit CoverCache(std::filesystem::path path = getCoverCachePath(), uint64_t maxBytes = defaultMaxBytes());
+    CoverCache(const CoverCache&) = delete;
+    CoverCache& operator=(const CoverCache&) = delete;
+    CoverCache(CoverCache&&) = delete;
+    CoverCache& operator=(CoverCache&&) = delete;
+
+    // false if the file couldnt be opened or created, the cache is empty and doesnt store anything then
+    [[nodiscard]] bool isOpen() const;
+    [[nodiscard]] bool contains(std::string_view albumId, std::string_view url) const;
+    /*
+        Returns the tile (coverTileBytes) or nullptr if the cover isnt cached. The tile stays valid until the next
+        reserve(), the cover is marked as used so it isnt replaced in this session
+    */
+    unsigned char* find(std::string_view albumId, std::string_view url);
+    /*
+        Makes room for this many covers that arent cached yet (as far as the size cap allows).
+        Might have to move the file, so no tile from find() may still be in use
+    */
+    void reserve(uint32_t newCovers);
+    // can be called from any thread, returns false if the cover wasnt stored (the cache is full)
+    bool store(std::string_view albumId, std::string_view url, const unsigned char* tile);
+
+    [[nodiscard]] uint32_t getCoverCount() const;
+    [[nodiscard]] uint32_t getCapacity() const;
+
+    // where the covers are stored by default
+    static std::filesystem::path getCoverCachePath();
+    // 256MB, can be overwritten with the PLAYLISTFILTER_COVER_CACHE_MB environment variable (0 disables the cache)
+    static uint64_t defaultMaxBytes();
+
+  private:
+    // maps the file and reads the index, starts a new file if it isnt valid
+    void open();
+    // writes a new file with room for capacity covers, keeping the most recently used ones, then opens it
+    bool rebuild(uint32_t capacity);
+    void buildIndex();
+    // a free slot, or the least recently used one that wasnt used in this session. Returns false if there is none
+    bool takeSlot(uint32_t& slot);
+
+    [[nodiscard]] CoverCacheHeader& getHeader() const;
+    [[nodiscard]] CoverCacheEntry* getEntries() const;
+    [[nodiscard]] unsigned char* getTile(uint32_t slot) const;
+
+    std::filesystem::path path;
+    uint32_t maxCapacity = 0;
+    MappedFile file;
+
+    mutable std::mutex mutex;
+    // album id hash -> slot
+    std::unordered_map<uint64_t, uint32_t> slots;
+    // free slots first, then the others from least to most recently used, taken from the front
+    std::vector<uint32_t> replaceOrder;
+    size_t nextReplace = 0;
+    // entries used at or after this were used in this session
+    uint64_t sessionStart = 0;
+};
@@ -0,0 +1,164 @@
+#include "CoverImage.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <vector>
+
+#include <stb/stb_image.h>
+
+// for every texel along one axis: which source pixels contribute and how much
+struct ResampleTaps
+{
+    // taps per texel, unused taps have a weight of 0
+    int tapCount = 0;
+    std::vector<int> first;
+    std::vector<float> weights;
+};
+
+static ResampleTaps computeTaps(int sourceSize)
+{
+    ResampleTaps taps;
+    const float scale = static_cast<float>(sourceSize) / coverSize;
+    taps.tapCount = sourceSize > coverSize ? static_cast<int>(std::ceil(scale)) + 1 : 2;
+    taps.first.resize(coverSize);
+    taps.weights.assign(static_cast<size_t>(coverSize) * taps.tapCount, 0.0f);
+    for(int i = 0; i < coverSize; i++)
+    {
+        float* weights = &taps.weights[static_cast<size_t>(i) * taps.tapCount];
+        if(sourceSize > coverSize)
+        {
+            // box, every source pixel by how much of it is covered by the texel
+            const float start = static_cast<float>(i) * scale;
+            const float end = start + scale;
+            const int first = static_cast<int>(start);
+            taps.first[i] = first;
+            for(int t = 0; t < taps.tapCount && first + t < sourceSize; t++)
+            {
+                const float covered = std::min(end, static_cast<float>(first + t + 1)) -
+                                      std::max(start, static_cast<float>(first + t));
+                weights[t] = std::max(covered, 0.0f) / scale;
+            }
+        }
+        else
+        {
+            // bilinear between the two closest pixel centers, clamped at the edges
+            const float lastCenter = static_cast<float>(sourceSize - 1);
+            const float center = std::clamp((static_cast<float>(i) + 0.5f) * scale - 0.5f, 0.0f, lastCenter);
+            const int first = std::min(static_cast<int>(center), sourceSize - 1);
+            const float fraction = center - static_cast<float>(first);
+            taps.first[i] = first;
+            weights[0] = 1.0f - fraction;
+            weights[1] = first + 1 < sourceSize ? fraction : 0.0f;
+        }
+    }
+    return taps;
+}
+
+// the next level is the average of 2x2 texels of the current one
+static void generateCoverMips(unsigned char* tile)
+{
+    for(int level = 1; level < coverMipLevels; level++)
+    {
+        const int size = getCoverMipSize(level);
+        const int sourceSize = getCoverMipSize(level - 1);
+        const unsigned char* source = tile + getCoverMipOffset(level - 1);
+        unsigned char* target = tile + getCoverMipOffset(level);
+        for(int y = 0; y < size; y++)
+        {
+            const unsigned char* top = source + static_cast<size_t>(2 * y) * sourceSize * 3;
+            const unsigned char* bottom = top + static_cast<size_t>(sourceSize) * 3;
+            for(int x = 0; x < size; x++)
+            {
+                for(int c = 0; c < 3; c++)
+                {
+                    const int left = x * 6 + c;
+                    target[(y * size + x) * 3 + c] = static_cast<unsigned char>(
+                        (top[left] + top[left + 3] + bottom[left] + bottom[left + 3] + 2) / 4);
+                }
+            }
+        }
+    }
+}
+
+void resampleCover(const unsigned char* pixels, int width, int height, unsigned char* tile)
+{
+    if(width == coverSize && height == coverSize)
+    {
+        std::memcpy(tile, pixels, getCoverMipOffset(1));
+        generateCoverMips(tile);
+        return;
+    }
+
+    // horizontally first, so the vertical pass only has to go over the 64 columns
+    const ResampleTaps horizontal = computeTaps(width);
+    std::vector<float> rows(static_cast<size_t>(height) * coverSize * 3);
+    for(int y = 0; y < height; y++)
+    {
+        const unsigned char* sourceRow = pixels + static_cast<size_t>(y) * width * 3;
+        float* row = &rows[static_cast<size_t>(y) * coverSize * 3];
+        for(int x = 0; x < coverSize; x++)
+        {
+            const float* weights = &horizontal.weights[static_cast<size_t>(x) * horizontal.tapCount];
+            const unsigned char* source = sourceRow + static_cast<size_t>(horizontal.first[x]) * 3;
+            const int tapCount = std::min(horizontal.tapCount, width - horizontal.first[x]);
+            float r = 0.0f;
+            float g = 0.0f;
+            float b = 0.0f;
+            for(int t = 0; t < tapCount; t++)
+            {
+                r += weights[t] * source[t * 3];
+                g += weights[t] * source[t * 3 + 1];
+                b += weights[t] * source[t * 3 + 2];
+            }
+            row[x * 3] = r;
+            row[x * 3 + 1] = g;
+            row[x * 3 + 2] = b;
+        }
+    }
+
+    const ResampleTaps vertical = computeTaps(height);
+    std::vector<float> texels(static_cast<size_t>(coverSize) * 3);
+    for(int y = 0; y < coverSize; y++)
+    {
+        std::fill(texels.begin(), texels.end(), 0.0f);
+        const float* weights = &vertical.weights[static_cast<size_t>(y) * vertical.tapCount];
+        const int tapCount = std::min(vertical.tapCount, height - vertical.first[y]);
+        for(int t = 0; t < tapCount; t++)
+        {
+            const float* row = &rows[static_cast<size_t>(vertical.first[y] + t) * coverSize * 3];
+            for(int x = 0; x < coverSize * 3; x++)
+            {
+                texels[x] += weights[t] * row[x];
+            }
+        }
+        unsigned char* target = tile + static_cast<size_t>(y) * coverSize * 3;
+        for(int x = 0; x < coverSize * 3; x++)
+        {
+            target[x] = static_cast<unsigned char>(std::clamp(texels[x] + 0.5f, 0.0f, 255.0f));
+        }
+    }
+    generateCoverMips(tile);
+}
+
+std::unique_ptr<unsigned char[]> decodeCover(std::string_view encoded)
+{
+    int width = 0;
+    int height = 0;
+    int components = 0;
+    unsigned char* pixels = stbi_load_from_memory(
+        reinterpret_cast<const stbi_uc*>(encoded.data()),
+        static_cast<int>(encoded.size()),
+        &width,
+        &height,
+        &components,
+        3);
+    if(pixels == nullptr)
+    {
+        return nullptr;
+    }
+    auto tile = std::make_unique_for_overwrite<unsigned char[]>(coverTileBytes);
+    resampleCover(pixels, width, height, tile.get());
+    stbi_image_free(pixels);
+    return tile;
+}
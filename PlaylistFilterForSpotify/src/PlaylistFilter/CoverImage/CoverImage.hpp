@@ -0,0 +1,40 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <string_view>
+
+/*
+    Every cover is kept as a 64x64 RGB tile together with the other mip levels of the cover array (32x32 and
+    16x16), the levels back to back without any padding. Images of any size are resampled to that when they are
+    decoded, so the renderer only has to copy the levels into the array.
+*/
+static constexpr int coverSize = 64;
+static constexpr int coverMipLevels = 3;
+
+constexpr int getCoverMipSize(int level)
+{
+    return coverSize >> level;
+}
+
+// byte offset of the given level in a tile, getCoverMipOffset(coverMipLevels) is the size of the whole tile
+constexpr size_t getCoverMipOffset(int level)
+{
+    size_t offset = 0;
+    for(int l = 0; l < level; l++)
+    {
+        offset += static_cast<size_t>(getCoverMipSize(l)) * getCoverMipSize(l) * 3;
+    }
+    return offset;
+}
+
+static constexpr size_t coverTileBytes = getCoverMipOffset(coverMipLevels);
+
+/*
+    Resamples width x height RGB pixels into a whole tile (coverTileBytes).
+    Shrinking averages all pixels that fall into a texel (box filter), growing interpolates bilinearly
+*/
+void resampleCover(const unsigned char* pixels, int width, int height, unsigned char* tile);
+
+// decodes a jpeg or png of any size into a new tile, nullptr if it cant be decoded
+std::unique_ptr<unsigned char[]> decodeCover(std::string_view encoded);
@@ -0,0 +1,178 @@
+#include "CoverLoader.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+
+#include <CoverImage/CoverImage.hpp>
+
+CoverLoader::CoverLoader(uint32_t threadCount)
+    // every worker waits for its own request, so the transport never has to queue any
+    : transport(std::max(threadCount, 1U))
+{
+    const uint32_t workerCount = transport.getMaxInFlight();
+    workers.reserve(workerCount);
+    for(uint32_t i = 0; i < workerCount; i++)
+    {
+        workers.emplace_back(&CoverLoader::workerLoop, this);
+    }
+}
+
+CoverLoader::~CoverLoader()
+{
+    {
+        std::lock_guard lock(mutex);
+        stopWorkers = true;
+        callback = nullptr;
+    }
+    wakeWorkers.notify_all();
+    for(auto& worker : workers)
+    {
+        worker.join();
+    }
+}
+
+void CoverLoader::load(std::vector<CoverInfo*> covers, Callback onLoaded)
+{
+    {
+        std::lock_guard lock(mutex);
+        generation++;
+        urgent.clear();
+        failed.clear();
+        waiting = {covers.begin(), covers.end()};
+        queue = {covers.begin(), covers.end()};
+        callback = std::move(onLoaded);
+        loadedCount = 0;
+    }
+    wakeWorkers.notify_all();
+}
+
+void CoverLoader::prioritize(std::span<CoverInfo* const> covers)
+{
+    std::lock_guard lock(mutex);
+    urgent.clear();
+    for(CoverInfo* cover : covers)
+    {
+        if(waiting.contains(cover))
+        {
+            urgent.push_back(cover);
+        }
+    }
+}
+
+void CoverLoader::retryFailed()
+{
+    {
+        std::lock_guard lock(mutex);
+        for(CoverInfo* cover : failed)
+        {
+            if(waiting.insert(cover).second)
+            {
+                queue.push_back(cover);
+            }
+        }
+        failed.clear();
+    }
+    wakeWorkers.notify_all();
+}
+
+void CoverLoader::cancel()
+{
+    std::lock_guard lock(mutex);
+    generation++;
+    queue.clear();
+    urgent.clear();
+    waiting.clear();
+    failed.clear();
+    callback = nullptr;
+}
+
+CoverLoader::Stats CoverLoader::getStats() const
+{
+    std::lock_guard lock(mutex);
+    return {
+        .pending = static_cast<uint32_t>(waiting.size()) + downloading,
+        .loaded = loadedCount,
+        .failed = static_cast<uint32_t>(failed.size())};
+}
+
+uint32_t CoverLoader::getThreadCount() const
+{
+    return static_cast<uint32_t>(workers.size());
+}
+
+bool CoverLoader::takeNextCover(CoverInfo*& cover, std::string& url, uint64_t& coverGeneration)
+{
+    std::unique_lock lock(mutex);
+    while(!stopWorkers)
+    {
+        for(std::deque<CoverInfo*>* from : {&urgent, &queue})
+        {
+            while(!from->empty())
+            {
+                CoverInfo* next = from->front();
+                from->pop_front();
+                // was already taken through the other queue
+                if(waiting.erase(next) != 0)
+                {
+                    cover = next;
+                    // the cover might be gone by the time the download is done, the url is needed until then
+                    url = next->url;
+                    coverGeneration = generation;
+                    downloading++;
+                    return true;
+                }
+            }
+        }
+        wakeWorkers.wait(lock);
+    }
+    return false;
+}
+
+void CoverLoader::workerLoop()
+{
+    CoverInfo* cover = nullptr;
+    std::string url;
+    uint64_t coverGeneration = 0;
+    while(takeNextCover(cover, url, coverGeneration))
+    {
+        const cpr::Response response = transport.get(url, {});
+        TextureLoadInfo tli{.data = nullptr, .ptr = cover};
+        if(response.status_code == 200)
+        {
+            // resized and with mip levels already, whatever size the image has
+            tli.data = decodeCover(response.text).release();
+        }
+
+        std::lock_guard lock(mutex);
+        downloading--;
+        if(coverGeneration != generation)
+        {
+            delete[] tli.data;
+        }
+        else if(tli.data == nullptr)
+        {
+            failed.push_back(cover);
+        }
+        else
+        {
+            loadedCount++;
+            // under the lock, so cancel() cant return while a cover of its generation is handed out
+            callback(tli);
+        }
+    }
+}
+
+uint32_t CoverLoader::defaultThreadCount()
+{
+    // NOLINTNEXTLINE(concurrency-mt-unsafe) only read once at startup
+    if(const char* env = std::getenv("PLAYLISTFILTER_COVER_THREADS"))
+    {
+        const int requested = std::atoi(env);
+        if(requested > 0)
+        {
+            return static_cast<uint32_t>(requested);
+        }
+    }
+    // covers are tiny, its mostly waiting for the round trips
+    return 32;
+}
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <span>
+#include <string>
+#include <thread>
+#include <unordered_set>
+#include <vector>
+
+#include <CommonStructs/CommonStructs.hpp>
+#include <HttpTransport/HttpTransport.hpp>
+
+/*
+    Downloads and decodes album covers on a fixed set of worker threads, no matter how many albums there are.
+    Every worker takes the next cover from the queue, downloads it through its own connection of the transport
+    (which also retries network errors and 5xx) and decodes it right there into a 64x64 tile with all mip levels,
+    so the main thread only has to upload the pixels.
+    Covers that are visible right now can be moved to the front of the queue with prioritize().
+    The covers are referenced by pointer, cancel() has to be called before they go away.
+*/
+class CoverLoader
+{
+  public:
+    // called from the worker threads with the decoded cover, the data has to be freed with delete[]
+    using Callback = std::function<void(TextureLoadInfo)>;
+
+    struct Stats
+    {
+        // waiting or downloading
+        uint32_t pending = 0;
+        uint32_t loaded = 0;
+        // could not be downloaded or decoded, see retryFailed()
+        uint32_t failed = 0;
+    };
+
+    explicit CoverLoader(uint32_t threadCount = defaultThreadCount());
+    ~CoverLoader();
+    CoverLoader(const CoverLoader&) = delete;
+    CoverLoader& operator=(const CoverLoader&) = delete;
+    CoverLoader(CoverLoader&&) = delete;
+    CoverLoader& operator=(CoverLoader&&) = delete;
+
+    // replaces everything that was queued before, covers are loaded in the given order
+    void load(std::vector<CoverInfo*> covers, Callback onLoaded);
+    // the given covers are loaded next (if they are still waiting), in the given order. Replaces the last call
+    void prioritize(std::span<CoverInfo* const> covers);
+    // queue the covers that failed again
+    void retryFailed();
+    // drops all queued covers, covers that are being downloaded right now are thrown away once they are done
+    // Once this returns the callback isnt called anymore
+    void cancel();
+
+    [[nodiscard]] Stats getStats() const;
+    [[nodiscard]] uint32_t getThreadCount() const;
+
+    // 32, can be overwritten with the PLAYLISTFILTER_COVER_THREADS environment variable
+    static uint32_t defaultThreadCount();
+
+  private:
+    void workerLoop();
+    // false if the loader is shutting down
+    bool takeNextCover(CoverInfo*& cover, std::string& url, uint64_t& generation);
+
+    HttpTransport transport;
+    std::vector<std::thread> workers;
+
+    mutable std::mutex mutex;
+    std::condition_variable wakeWorkers;
+    std::deque<CoverInfo*> queue;
+    // from prioritize(), taken before the queue
+    std::deque<CoverInfo*> urgent;
+    // queued covers that werent taken by a worker yet, both queues can still hold covers that are in neither
+    std::unordered_set<CoverInfo*> waiting;
+    std::vector<CoverInfo*> failed;
+    Callback callback;
+    // bumped by cancel(), results of an older generation are thrown away
+    uint64_t generation = 0;
+    uint32_t downloading = 0;
+    uint32_t loadedCount = 0;
+    bool stopWorkers = false;
+};
@@ -1,30 +1,104 @@
+#include <bit>
 #include <cassert>
 #include <functional>
+#include <utility>
 
 #include "DynamicBitset.hpp"
 
 DynBitset::DynBitset(uint32_t _size) : size(_size)
 {
-    internal.resize(UintDivAndCeil(size, 32), 0);
+    allocate(UintDivAndCeil(size, bitsPerWord));
+    std::fill(words, words + wordCount, Word(0));
+}
+DynBitset::DynBitset(const DynBitset& other) : size(other.size)
+{
+    allocate(other.wordCount);
+    std::copy(other.words, other.words + wordCount, words);
+}
+DynBitset::DynBitset(DynBitset&& other) noexcept
+{
+    *this = std::move(other);
+}
+DynBitset& DynBitset::operator=(const DynBitset& other)
+{
+    if(this == &other)
+    {
+        return *this;
+    }
+    size = other.size;
+    allocate(other.wordCount);
+    std::copy(other.words, other.words + wordCount, words);
+    return *this;
+}
+DynBitset& DynBitset::operator=(DynBitset&& other) noexcept
+{
+    if(this == &other)
+    {
+        return *this;
+    }
+    if(other.isInline())
+    {
+        // nothing to steal, just copy the few words
+        size = other.size;
+        allocate(other.wordCount);
+        std::copy(other.words, other.words + wordCount, words);
+    }
+    else
+    {
+        if(!isInline())
+        {
+            delete[] words;
+        }
+        size = other.size;
+        wordCount = other.wordCount;
+        capacity = other.capacity;
+        words = other.words;
+        other.words = other.inlineStorage;
+        other.capacity = inlineWords;
+    }
+    other.size = 0;
+    other.wordCount = 0;
+    return *this;
+}
+DynBitset::~DynBitset()
+{
+    if(!isInline())
+    {
+        delete[] words;
+    }
 }
 
 DynBitset& DynBitset::operator=(uint32_t val)
 {
     size = 32;
-    internal.resize(1, val);
+    allocate(1);
+    words[0] = val;
     return *this;
 }
 DynBitset& DynBitset::operator=(uint64_t val)
 {
     size = 64;
-    uint32_t first = val & 0xFFFFFFFFU;
-    uint32_t second = val >> 32U;
-    internal.resize(2);
-    internal[0] = first;
-    internal[1] = second;
+    allocate(1);
+    words[0] = val;
     return *this;
 }
 
+void DynBitset::allocate(uint32_t nWordCount)
+{
+    wordCount = nWordCount;
+    if(nWordCount <= capacity)
+    {
+        // never shrink, whatever this held before probably needed the space too
+        return;
+    }
+    if(!isInline())
+    {
+        delete[] words;
+    }
+    words = new Word[nWordCount];
+    capacity = nWordCount;
+}
+
 DynBitset operator^(const DynBitset& lhs, const DynBitset& rhs)
 {
     return DynBitset{lhs, rhs, std::bit_xor<>()};
@@ -38,88 +112,175 @@ DynBitset operator|(const DynBitset& lhs, const DynBitset& rhs)
     return DynBitset{lhs, rhs, std::bit_or<>()};
 }
 
-DynBitset::operator bool() const
+DynBitset& DynBitset::operator&=(const DynBitset& other)
 {
-    if(size == 0)
+    const uint32_t common = std::min(wordCount, other.wordCount);
+    Word* dst = words;
+    const Word* src = other.words;
+    for(uint32_t i = 0; i < common; i++)
     {
-        return false;
+        dst[i] &= src[i];
     }
-    bool anyBitSet = false;
-    for(auto i = 0; i < internal.size() - 1; i++)
+    // other is treated as 0 there
+    std::fill(dst + common, dst + wordCount, Word(0));
+    size = std::max(size, other.size);
+    if(other.wordCount > wordCount)
     {
-        if(internal[i] != 0U)
+        resize(size);
+    }
+    return *this;
+}
+DynBitset& DynBitset::operator|=(const DynBitset& other)
+{
+    if(other.size > size)
+    {
+        resize(other.size);
+    }
+    Word* dst = words;
+    const Word* src = other.words;
+    for(uint32_t i = 0; i < other.wordCount; i++)
+    {
+        dst[i] |= src[i];
+    }
+    return *this;
+}
+DynBitset& DynBitset::operator^=(const DynBitset& other)
+{
+    if(other.size > size)
+    {
+        resize(other.size);
+    }
+    Word* dst = words;
+    const Word* src = other.words;
+    for(uint32_t i = 0; i < other.wordCount; i++)
+    {
+        dst[i] ^= src[i];
+    }
+    return *this;
+}
+DynBitset& DynBitset::andNot(const DynBitset& other)
+{
+    // nothing to clear past the end of other
+    const uint32_t common = std::min(wordCount, other.wordCount);
+    Word* dst = words;
+    const Word* src = other.words;
+    for(uint32_t i = 0; i < common; i++)
+    {
+        dst[i] &= ~src[i];
+    }
+    return *this;
+}
+bool DynBitset::intersects(const DynBitset& other) const
+{
+    const uint32_t common = std::min(wordCount, other.wordCount);
+    for(uint32_t i = 0; i < common; i++)
+    {
+        if((words[i] & other.words[i]) != 0U)
         {
             return true;
         }
     }
-    // bits left over = size % 32
-    uint32_t lastBits = internal[internal.size() - 1];
-    lastBits &= ((~0U) >> (32 - (size % 32)));
-    return lastBits != 0U;
+    return false;
 }
-void DynBitset::clear()
+
+DynBitset::operator bool() const
 {
-    std::fill(internal.begin(), internal.end(), 0U);
+    // bits past size are never set, so no need to mask the last word
+    for(uint32_t i = 0; i < wordCount; i++)
+    {
+        if(words[i] != 0U)
+        {
+            return true;
+        }
+    }
+    return false;
 }
-bool DynBitset::getBit(uint32_t index) const
+bool DynBitset::operator==(const DynBitset& other) const
 {
-    assert(index < size);
-    uint32_t dwordIndex = index / 32;
-    return (internal[dwordIndex] & (1U << index % 32)) != 0U;
+    // bits past size are never set, so comparing the words directly is fine
+    return size == other.size && std::equal(words, words + wordCount, other.words);
 }
-void DynBitset::setBit(uint32_t index)
+
+void DynBitset::clear()
 {
-    assert(index < size);
-    uint32_t dwordIndex = index / 32;
-    internal[dwordIndex] |= (1U << index % 32);
+    std::fill(words, words + wordCount, Word(0));
 }
-void DynBitset::clearBit(uint32_t index)
+void DynBitset::setAll()
 {
-    assert(index < size);
-    uint32_t dwordIndex = index / 32;
-    internal[dwordIndex] &= ~(1U << index % 32);
+    if(size == 0)
+    {
+        return;
+    }
+    std::fill(words, words + wordCount, ~Word(0));
+    // keep the bits past size cleared
+    if(size % bitsPerWord != 0)
+    {
+        words[wordCount - 1] = (~Word(0)) >> (bitsPerWord - (size % bitsPerWord));
+    }
 }
-void DynBitset::toggleBit(uint32_t index)
+uint32_t DynBitset::popcount() const
 {
-    assert(index < size);
-    uint32_t dwordIndex = index / 32;
-    internal[dwordIndex] ^= (1U << index % 32);
+    uint32_t count = 0;
+    for(uint32_t i = 0; i < wordCount; i++)
+    {
+        count += std::popcount(words[i]);
+    }
+    return count;
 }
+
 uint32_t DynBitset::getFirstBitSet() const
 {
-    for(auto i = 0; i < internal.size() - 1; i++)
+    for(uint32_t i = 0; i < wordCount; i++)
     {
-        if(internal[i] != 0U)
+        if(words[i] != 0U)
         {
-            // todo: ifdef the MSVC specific name for this
-            return 32 * i + __builtin_ctz(internal[i]);
+            return bitsPerWord * i + std::countr_zero(words[i]);
         }
     }
-    uint32_t lastBits = internal[internal.size() - 1];
-    lastBits &= ((~0U) >> (32 - (size % 32)));
-    if(lastBits != 0U)
-    {
-        return (internal.size() - 1) * 32 + __builtin_ctz(lastBits);
-    }
     return ~0U;
 }
 
 bool DynBitset::resize(uint32_t nSize)
 {
+    const uint32_t nWordCount = UintDivAndCeil(nSize, bitsPerWord);
+    const bool wordCountChanged = nWordCount != wordCount;
+    if(nWordCount > capacity)
+    {
+        Word* nWords = new Word[nWordCount];
+        std::copy(words, words + wordCount, nWords);
+        if(!isInline())
+        {
+            delete[] words;
+        }
+        words = nWords;
+        capacity = nWordCount;
+    }
+    if(nWordCount > wordCount)
+    {
+        std::fill(words + wordCount, words + nWordCount, Word(0));
+    }
+    wordCount = nWordCount;
     size = nSize;
-    uint32_t nInternalSize = UintDivAndCeil(nSize, 32);
-    if(nInternalSize != internal.size())
+    // when shrinking, the bits past the new size have to be cleared
+    if(size % bitsPerWord != 0)
     {
-        internal.resize(nInternalSize, 0);
-        return true;
+        words[wordCount - 1] &= (~Word(0)) >> (bitsPerWord - (size % bitsPerWord));
     }
-    return false;
+    return wordCountChanged;
 }
 uint32_t DynBitset::getSize() const
 {
     return size;
 }
-const std::vector<uint32_t>& DynBitset::getInternal()
+uint32_t DynBitset::getWordCount() const
 {
-    return internal;
-}
\ No newline at end of file
+    return wordCount;
+}
+const DynBitset::Word* DynBitset::data() const
+{
+    return words;
+}
+DynBitset::Word* DynBitset::data()
+{
+    return words;
+}
@@ -1,22 +1,37 @@
 #pragma once
 
+#include <algorithm>
+#include <bit>
+#include <cassert>
 #include <cstdint>
-#include <vector>
 
+/*
+    Bitset with a size only known at runtime.
+    Bits are stored in 64bit words. Sets of up to inlineWords * 64 bits are stored inside the object itself, only
+    larger ones allocate. Bits past getSize() are always kept at 0, so whole words can be compared/counted.
+    All operations that combine two sets just loop over the words, which the compiler vectorizes.
+*/
 class DynBitset
 {
   public:
+    using Word = uint64_t;
+    static constexpr uint32_t bitsPerWord = 64;
+    static constexpr uint32_t inlineWords = 2;
+
     DynBitset() = default;
     explicit DynBitset(uint32_t _size);
+    DynBitset(const DynBitset& other);
+    DynBitset(DynBitset&& other) noexcept;
+    DynBitset& operator=(const DynBitset& other);
+    DynBitset& operator=(DynBitset&& other) noexcept;
+    ~DynBitset();
 
     DynBitset& operator=(uint32_t val);
     DynBitset& operator=(uint64_t val);
-    // DynBitset& operator^=(const DynBitset& other);
 
     template <class Func>
-    DynBitset(const DynBitset& lhs, const DynBitset& rhs, Func func) : size(std::max(lhs.size, rhs.size))
+    DynBitset(const DynBitset& lhs, const DynBitset& rhs, Func func) : DynBitset(std::max(lhs.size, rhs.size))
     {
-        internal.resize(UintDivAndCeil(size, 32), 0U);
         setFromOperator(lhs, rhs, func);
     }
 
@@ -25,19 +40,75 @@ class DynBitset
     friend DynBitset operator|(const DynBitset& lhs, const DynBitset& rhs);
     // todo: bitshift not yet implemented
 
+    /*
+        In-place versions of the operators above, these dont allocate as long as other is not larger than this.
+        Bits missing in the smaller operand are treated as 0 (same as for the operators above)
+    */
+    DynBitset& operator&=(const DynBitset& other);
+    DynBitset& operator|=(const DynBitset& other);
+    DynBitset& operator^=(const DynBitset& other);
+    // this &= ~other
+    DynBitset& andNot(const DynBitset& other);
+    // same result as bool(*this & other), without building the intersection
+    [[nodiscard]] bool intersects(const DynBitset& other) const;
+
+    bool operator==(const DynBitset& other) const;
+
     operator bool() const; // NOLINT
     void clear();
-    [[nodiscard]] bool getBit(uint32_t index) const;
-    void setBit(uint32_t index);
-    void clearBit(uint32_t index);
-    void toggleBit(uint32_t index);
+    // sets all bits up to getSize()
+    void setAll();
+    [[nodiscard]] inline bool getBit(uint32_t index) const
+    {
+        assert(index < size);
+        return (words[index / bitsPerWord] & (Word(1) << (index % bitsPerWord))) != 0U;
+    }
+    inline void setBit(uint32_t index)
+    {
+        assert(index < size);
+        words[index / bitsPerWord] |= Word(1) << (index % bitsPerWord);
+    }
+    inline void clearBit(uint32_t index)
+    {
+        assert(index < size);
+        words[index / bitsPerWord] &= ~(Word(1) << (index % bitsPerWord));
+    }
+    inline void toggleBit(uint32_t index)
+    {
+        assert(index < size);
+        words[index / bitsPerWord] ^= Word(1) << (index % bitsPerWord);
+    }
+    // number of bits set
+    [[nodiscard]] uint32_t popcount() const;
     // returns 0xffffffff is no bit was set
     [[nodiscard]] uint32_t getFirstBitSet() const;
+    /*
+        Calls func(index) for every set bit, in ascending order.
+        Only visits every word once and jumps straight to the set bits inside, so prefer this over
+        looping getFirstBitSet() + clearBit() on a copy. The set must not be modified from inside func
+    */
+    template <class Func>
+    void forEachSetBit(Func func) const
+    {
+        for(uint32_t i = 0; i < wordCount; i++)
+        {
+            Word word = words[i];
+            while(word != 0U)
+            {
+                func(i * bitsPerWord + static_cast<uint32_t>(std::countr_zero(word)));
+                // clear lowest set bit
+                word &= word - 1;
+            }
+        }
+    }
 
-    // returns true if internal resize happended
+    // returns true if internal resize happended. New bits are 0
     bool resize(uint32_t nSize);
     [[nodiscard]] uint32_t getSize() const;
-    const std::vector<uint32_t>& getInternal();
+    [[nodiscard]] uint32_t getWordCount() const;
+    // raw access to the words for bulk kernels. Bits past getSize() in the last word must be left at 0
+    [[nodiscard]] const Word* data() const;
+    Word* data();
 
   private:
     template <class Func>
@@ -46,29 +117,39 @@ class DynBitset
     void setFromOperator(const DynBitset& lhs, const DynBitset& rhs, Func func)
     {
         assert(size >= lhs.size && size >= rhs.size);
-        assert(internal.size() >= lhs.internal.size() && internal.size() >= rhs.internal.size());
-        const bool lhsLarger = lhs.internal.size() > rhs.internal.size();
+        const bool lhsLarger = lhs.wordCount > rhs.wordCount;
         const DynBitset& larger = lhsLarger ? lhs : rhs;
         const DynBitset& smaller = lhsLarger ? rhs : lhs;
-        for(auto i = 0; i < smaller.internal.size(); i++)
+        for(uint32_t i = 0; i < smaller.wordCount; i++)
         {
-            internal[i] = func(smaller.internal[i], larger.internal[i]);
+            words[i] = func(smaller.words[i], larger.words[i]);
         }
-        for(auto i = smaller.internal.size(); i < larger.internal.size(); i++)
+        for(uint32_t i = smaller.wordCount; i < larger.wordCount; i++)
         {
-            internal[i] = func(larger.internal[i], 0U);
+            words[i] = func(larger.words[i], Word(0));
         }
-        for(auto i = larger.internal.size(); i < internal.size(); i++)
+        for(uint32_t i = larger.wordCount; i < wordCount; i++)
         {
-            internal[i] = func(0U, 0U);
+            words[i] = func(Word(0), Word(0));
         }
     }
 
+    // (re)allocates storage for nWordCount words, contents are undefined afterwards
+    void allocate(uint32_t nWordCount);
+    [[nodiscard]] inline bool isInline() const
+    {
+        return words == inlineStorage;
+    }
+
     static inline uint32_t UintDivAndCeil(uint32_t x, uint32_t y) // NOLINT
     {
         return (x + y - 1) / y;
     }
 
     uint32_t size = 0;
-    std::vector<uint32_t> internal;
-};
\ No newline at end of file
+    uint32_t wordCount = 0;
+    // number of words words points to, inlineWords while using the inline storage
+    uint32_t capacity = inlineWords;
+    Word* words = inlineStorage;
+    Word inlineStorage[inlineWords] = {};
+};
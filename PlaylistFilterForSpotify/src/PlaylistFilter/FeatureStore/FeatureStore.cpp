@@ -0,0 +1,31 @@
+#include "FeatureStore.hpp"
+
+#include <algorithm>
+
+FeatureStore::FeatureStore(uint32_t trackCount)
+{
+    resize(trackCount);
+}
+
+void FeatureStore::resize(uint32_t nTrackCount)
+{
+    trackCount = nTrackCount;
+    const uint32_t paddedCount = (trackCount + columnPadding - 1) / columnPadding * columnPadding;
+    for(auto& column : columns)
+    {
+        column.resize(paddedCount, 0.0f);
+        // when shrinking the padding still holds the features of removed tracks
+        std::fill(column.begin() + trackCount, column.end(), 0.0f);
+    }
+}
+
+uint32_t FeatureStore::getTrackCount() const
+{
+    return trackCount;
+}
+
+std::span<const float> FeatureStore::column(int feature) const
+{
+    assert(feature < Track::featureAmount);
+    return {columns[feature].data(), trackCount};
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <array>
+#include <cassert>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include <Track/Track.hpp>
+
+/*
+    Columnar storage for the audio features of all tracks of a playlist.
+    Every feature is stored in its own contiguous array, indexed by Track::index.
+    Filtering, sorting and graphing only ever need a few floats per track, so keeping them out of the
+    (large) Track objects means those passes dont have to pull all the strings and bitsets through the cache
+*/
+class FeatureStore
+{
+  public:
+    FeatureStore() = default;
+    explicit FeatureStore(uint32_t trackCount);
+
+    // resizes all columns, new entries and the padding behind the last track are set to 0
+    void resize(uint32_t nTrackCount);
+    [[nodiscard]] uint32_t getTrackCount() const;
+
+    [[nodiscard]] inline float get(int feature, uint32_t trackIndex) const
+    {
+        assert(feature < Track::featureAmount && trackIndex < trackCount);
+        return columns[feature][trackIndex];
+    }
+    inline void set(int feature, uint32_t trackIndex, float value)
+    {
+        assert(feature < Track::featureAmount && trackIndex < trackCount);
+        columns[feature][trackIndex] = value;
+    }
+
+    [[nodiscard]] std::span<const float> column(int feature) const;
+
+    /*
+        Columns are allocated in multiples of this many entries (padding is 0) so that vectorized
+        kernels can always load full blocks, even for the last tracks of the playlist.
+        Reading past getTrackCount() is only valid up to the next multiple of columnPadding!
+    */
+    static constexpr uint32_t columnPadding = 64;
+
+  private:
+    uint32_t trackCount = 0;
+    std::array<std::vector<float>, Track::featureAmount> columns;
+};
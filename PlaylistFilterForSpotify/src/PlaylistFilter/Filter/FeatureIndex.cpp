@@ -0,0 +1,53 @@
+#include "FeatureIndex.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <numeric>
+
+void FeatureIndex::build(const FeatureStore& features)
+{
+    trackCount = features.getTrackCount();
+    for(int f = 0; f < Track::featureAmount; f++)
+    {
+        const std::span<const float> column = features.column(f);
+        // values come from JSON which cant encode NaN, so the order is a proper strict weak ordering
+        assert(std::none_of(column.begin(), column.end(), [](float v) { return std::isnan(v); }));
+
+        std::vector<uint32_t>& order = sortedTracks[f];
+        order.resize(trackCount);
+        std::iota(order.begin(), order.end(), 0U);
+        // stable, so equal values stay ordered by track index
+        std::stable_sort(
+            order.begin(), order.end(), [&](uint32_t a, uint32_t b) { return column[a] < column[b]; });
+
+        std::vector<float>& values = sortedValues[f];
+        values.resize(trackCount);
+        for(uint32_t i = 0; i < trackCount; i++)
+        {
+            values[i] = column[order[i]];
+        }
+    }
+}
+
+uint32_t FeatureIndex::getTrackCount() const
+{
+    return trackCount;
+}
+
+FeatureIndex::Span FeatureIndex::findRange(int feature, glm::vec2 range) const
+{
+    assert(feature < Track::featureAmount);
+    const std::vector<float>& values = sortedValues[feature];
+    // first value thats not less than min, first value thats greater than max
+    const auto first = std::lower_bound(values.begin(), values.end(), range.x);
+    const auto last = std::upper_bound(first, values.end(), range.y);
+    // last is searched starting at first, so min > max just results in an empty span
+    return {static_cast<uint32_t>(first - values.begin()), static_cast<uint32_t>(last - values.begin())};
+}
+
+std::span<const uint32_t> FeatureIndex::getTracks(int feature, Span span) const
+{
+    assert(feature < Track::featureAmount && span.first <= span.last && span.last <= trackCount);
+    return {sortedTracks[feature].data() + span.first, span.size()};
+}
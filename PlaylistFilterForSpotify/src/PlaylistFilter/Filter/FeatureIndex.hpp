@@ -0,0 +1,47 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include <glm/ext.hpp>
+
+#include <FeatureStore/FeatureStore.hpp>
+#include <Track/Track.hpp>
+
+/*
+    For every audio feature the track indices ordered by their value (ties ordered by track index).
+    All tracks within a [min, max] range of one feature then form one contiguous span of that order,
+    which is found with two binary searches instead of looking at every track.
+    Built for the whole playlist, if tracks are added (or their features change) it has to be built again.
+*/
+class FeatureIndex
+{
+  public:
+    // positions [first, last) in the sorted order of one feature
+    struct Span
+    {
+        uint32_t first = 0;
+        uint32_t last = 0;
+
+        [[nodiscard]] inline uint32_t size() const
+        {
+            return last - first;
+        }
+    };
+
+    void build(const FeatureStore& features);
+    [[nodiscard]] uint32_t getTrackCount() const;
+
+    // span of all tracks that lie within range, same check as the range filter: !(v < min) && !(v > max)
+    [[nodiscard]] Span findRange(int feature, glm::vec2 range) const;
+    // track indices of the given positions, ordered by the value of feature
+    [[nodiscard]] std::span<const uint32_t> getTracks(int feature, Span span) const;
+
+  private:
+    uint32_t trackCount = 0;
+    // sorted copy of the values so the binary searches dont have to jump through the feature columns
+    std::array<std::vector<float>, Track::featureAmount> sortedValues;
+    std::array<std::vector<uint32_t>, Track::featureAmount> sortedTracks;
+};
@@ -0,0 +1,280 @@
+#include "NameIndex.hpp"
+
+#include <Filter/RangeFilter.hpp>
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cassert>
+#include <span>
+#include <unordered_map>
+
+// same as the toupper() ImGuiTextFilter compares with, in the default "C" locale only ASCII letters change
+static char foldCase(char c)
+{
+    return (c >= 'a' && c <= 'z') ? static_cast<char>(c - 'a' + 'A') : c;
+}
+
+static uint32_t packTrigram(const char* c)
+{
+    return static_cast<uint32_t>(static_cast<uint8_t>(c[0])) << 16 |
+           static_cast<uint32_t>(static_cast<uint8_t>(c[1])) << 8 | static_cast<uint32_t>(static_cast<uint8_t>(c[2]));
+}
+
+template <class Func>
+void NameIndex::forEachTrigram(uint32_t track, Func func) const
+{
+    for(uint32_t field = 0; field < fieldAmount; field++)
+    {
+        const std::string_view name = getField(track, field);
+        for(size_t c = 0; c + 3 <= name.size(); c++)
+        {
+            func(packTrigram(&name[c]));
+        }
+    }
+}
+
+void NameIndex::build(const std::vector<Track>& tracks)
+{
+    trackCount = static_cast<uint32_t>(tracks.size());
+
+    foldedNames.clear();
+    fieldOffsets.clear();
+    fieldOffsets.reserve(trackCount * fieldAmount + 1);
+    for(const Track& track : tracks)
+    {
+        for(const std::string* name : {&track.artistsNamesEncoded, &track.albumNameEncoded, &track.trackNameEncoded})
+        {
+            fieldOffsets.push_back(static_cast<uint32_t>(foldedNames.size()));
+            // PassFilter gets the c_str(), so it never sees anything after a \0
+            for(const char* c = name->c_str(); *c != '\0'; c++)
+            {
+                foldedNames.push_back(foldCase(*c));
+            }
+        }
+    }
+    fieldOffsets.push_back(static_cast<uint32_t>(foldedNames.size()));
+
+    /*
+        First count the tracks per trigram, so the posting lists can be laid out back to back.
+        A trigram can appear multiple times in the names of one track, remembering the last track that was
+        counted is enough to skip those since all tracks are visited in order.
+    */
+    struct TrigramInfo
+    {
+        uint32_t trackCount = 0;
+        uint32_t lastTrack = UINT32_MAX;
+    };
+    std::unordered_map<Trigram, TrigramInfo> infos;
+    for(uint32_t i = 0; i < trackCount; i++)
+    {
+        forEachTrigram(
+            i,
+            [&](Trigram trigram)
+            {
+                TrigramInfo& info = infos[trigram];
+                if(info.lastTrack != i)
+                {
+                    info.lastTrack = i;
+                    info.trackCount++;
+                }
+            });
+    }
+    trigrams.clear();
+    trigrams.reserve(infos.size());
+    for(const auto& [trigram, info] : infos)
+    {
+        trigrams.push_back(trigram);
+    }
+    std::sort(trigrams.begin(), trigrams.end());
+    postingOffsets.resize(trigrams.size() + 1);
+    postingOffsets[0] = 0;
+    for(uint32_t t = 0; t < trigrams.size(); t++)
+    {
+        TrigramInfo& info = infos[trigrams[t]];
+        postingOffsets[t + 1] = postingOffsets[t] + info.trackCount;
+        // reuse the count as the write position of the list
+        info.trackCount = postingOffsets[t];
+        info.lastTrack = UINT32_MAX;
+    }
+
+    // tracks are visited in order, so every posting list ends up sorted
+    postings.resize(postingOffsets.back());
+    for(uint32_t i = 0; i < trackCount; i++)
+    {
+        forEachTrigram(
+            i,
+            [&](Trigram trigram)
+            {
+                TrigramInfo& info = infos[trigram];
+                if(info.lastTrack != i)
+                {
+                    info.lastTrack = i;
+                    postings[info.trackCount++] = i;
+                }
+            });
+    }
+}
+
+uint32_t NameIndex::getTrackCount() const
+{
+    return trackCount;
+}
+
+std::string_view NameIndex::getField(uint32_t track, uint32_t field) const
+{
+    const uint32_t slot = track * fieldAmount + field;
+    return {foldedNames.data() + fieldOffsets[slot], fieldOffsets[slot + 1] - fieldOffsets[slot]};
+}
+
+void NameIndex::findCandidates(std::string_view foldedTerm, std::vector<uint32_t>& candidates) const
+{
+    assert(foldedTerm.size() >= 3);
+    candidates.clear();
+
+    std::vector<std::span<const uint32_t>> lists;
+    for(size_t c = 0; c + 3 <= foldedTerm.size(); c++)
+    {
+        const Trigram trigram = packTrigram(&foldedTerm[c]);
+        const auto it = std::lower_bound(trigrams.begin(), trigrams.end(), trigram);
+        if(it == trigrams.end() || *it != trigram)
+        {
+            // no track contains this part of the term
+            return;
+        }
+        const auto t = static_cast<uint32_t>(it - trigrams.begin());
+        lists.emplace_back(postings.data() + postingOffsets[t], postingOffsets[t + 1] - postingOffsets[t]);
+    }
+
+    // start with the shortest list, the others are only searched for what is left of it
+    std::sort(lists.begin(), lists.end(), [](auto& a, auto& b) { return a.size() < b.size(); });
+    candidates.assign(lists[0].begin(), lists[0].end());
+    for(size_t l = 1; l < lists.size() && !candidates.empty(); l++)
+    {
+        const std::span<const uint32_t> list = lists[l];
+        auto position = list.begin();
+        size_t kept = 0;
+        for(uint32_t track : candidates)
+        {
+            position = std::lower_bound(position, list.end(), track);
+            if(position == list.end())
+            {
+                break;
+            }
+            if(*position == track)
+            {
+                candidates[kept++] = track;
+            }
+        }
+        candidates.resize(kept);
+    }
+}
+
+void NameIndex::filter(const ImGuiTextFilter& nameFilter, DynBitset& passMask, ThreadPool* pool) const
+{
+    passMask.resize(trackCount);
+    passMask.clear();
+    if(!nameFilter.IsActive())
+    {
+        passMask.setAll();
+        return;
+    }
+
+    /*
+        PassFilter goes through the terms in order and the first one found in the name decides.
+        So per field keep the tracks for which no term was found yet, once one is found it either makes the whole
+        track pass (include) or just this field fail (exclude). Tracks that already pass dont need to be searched.
+    */
+    std::array<DynBitset, fieldAmount> undecided;
+    for(DynBitset& fieldUndecided : undecided)
+    {
+        fieldUndecided.resize(trackCount);
+        fieldUndecided.setAll();
+    }
+
+    std::string term;
+    std::vector<uint32_t> candidates;
+    for(const ImGuiTextFilter::ImGuiTextRange& range : nameFilter.Filters)
+    {
+        if(range.empty())
+        {
+            continue;
+        }
+        const bool exclude = range.b[0] == '-';
+        term.assign(exclude ? range.b + 1 : range.b, range.e);
+        // a lone "-" is an empty term, which ImStristr never finds
+        if(term.empty())
+        {
+            continue;
+        }
+        std::transform(term.begin(), term.end(), term.begin(), foldCase);
+
+        const auto searchTrack = [&](uint32_t track)
+        {
+            for(uint32_t field = 0; field < fieldAmount; field++)
+            {
+                if(!undecided[field].getBit(track) || getField(track, field).find(term) == std::string_view::npos)
+                {
+                    continue;
+                }
+                undecided[field].clearBit(track);
+                if(!exclude)
+                {
+                    passMask.setBit(track);
+                    return;
+                }
+            }
+        };
+
+        if(term.size() >= 3)
+        {
+            findCandidates(term, candidates);
+            for(uint32_t track : candidates)
+            {
+                if(!passMask.getBit(track))
+                {
+                    searchTrack(track);
+                }
+            }
+            continue;
+        }
+
+        // too short for the index, search every track that is still undecided in any field
+        // every chunk only touches the bits of its own words
+        static_assert(fieldAmount == 3);
+        const auto searchWords = [&](uint32_t firstWord, uint32_t lastWord)
+        {
+            for(uint32_t w = firstWord; w < lastWord; w++)
+            {
+                uint64_t word = (undecided[0].data()[w] | undecided[1].data()[w] | undecided[2].data()[w]) &
+                                ~passMask.data()[w];
+                while(word != 0U)
+                {
+                    searchTrack(w * DynBitset::bitsPerWord + static_cast<uint32_t>(std::countr_zero(word)));
+                    word &= word - 1;
+                }
+            }
+        };
+        const uint32_t wordCount = passMask.getWordCount();
+        if(pool == nullptr)
+        {
+            searchWords(0, wordCount);
+        }
+        else
+        {
+            pool->parallelFor(
+                wordCount,
+                minWordsPerChunk,
+                [&](uint32_t /*chunk*/, uint32_t firstWord, uint32_t lastWord) { searchWords(firstWord, lastWord); });
+        }
+    }
+
+    // no term was found in a field, without any include terms that still counts as passing
+    if(nameFilter.CountGrep == 0)
+    {
+        for(const DynBitset& fieldUndecided : undecided)
+        {
+            passMask |= fieldUndecided;
+        }
+    }
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <ImGui/imgui.h>
+
+#include <DynamicBitset/DynamicBitset.hpp>
+#include <ThreadPool/ThreadPool.hpp>
+#include <Track/Track.hpp>
+
+/*
+    Trigram index over the artist, album and track names of a playlist, for the name filter.
+    All names are case folded once when building. For every 3 character sequence ("trigram") the index stores
+    which tracks contain it in any of their names, so the tracks that can contain a filter term at all are the
+    intersection of the lists of all its trigrams. Only those candidates are actually searched for the term.
+    Terms shorter than 3 characters dont have a trigram, those still search through all tracks.
+    Built for the whole playlist, if tracks are added (or their names change) it has to be built again.
+*/
+class NameIndex
+{
+  public:
+    void build(const std::vector<Track>& tracks);
+    [[nodiscard]] uint32_t getTrackCount() const;
+
+    /*
+        Sets bit i of passMask if track i passes the filter, which is exactly the same as
+            nameFilter.PassFilter(artists) || nameFilter.PassFilter(album) || nameFilter.PassFilter(track)
+        so the comma separated terms, "-" excludes and the "first matching term decides" order all still apply.
+        The pool is only used for terms that are too short for the index
+    */
+    void filter(const ImGuiTextFilter& nameFilter, DynBitset& passMask, ThreadPool* pool = nullptr) const;
+
+  private:
+    // artists, album, track
+    static constexpr uint32_t fieldAmount = 3;
+    // three folded characters packed into the lower 24 bits
+    using Trigram = uint32_t;
+
+    [[nodiscard]] std::string_view getField(uint32_t track, uint32_t field) const;
+    // calls func(trigram) for every trigram in the fields of a track, can contain duplicates
+    template <class Func>
+    void forEachTrigram(uint32_t track, Func func) const;
+    // tracks that contain all trigrams of term (in any of their fields), ascending
+    void findCandidates(std::string_view foldedTerm, std::vector<uint32_t>& candidates) const;
+
+    uint32_t trackCount = 0;
+    // the folded names of all tracks back to back, field f of track i starts at fieldOffsets[i * fieldAmount + f]
+    std::string foldedNames;
+    std::vector<uint32_t> fieldOffsets;
+
+    // sorted, the tracks containing trigrams[t] are postings[postingOffsets[t], postingOffsets[t + 1])
+    std::vector<Trigram> trigrams;
+    std::vector<uint32_t> postingOffsets;
+    std::vector<uint32_t> postings;
+};
@@ -0,0 +1,331 @@
+#include "RangeFilter.hpp"
+
+#include <cassert>
+#include <cstdint>
+
+// SSE2 is part of the x86-64 baseline, so only the AVX2 path needs a runtime check
+#if defined(__x86_64__) || defined(_M_X64)
+    #define RANGE_FILTER_X86
+    #include <immintrin.h>
+    #if defined(_MSC_VER) && !defined(__clang__)
+        #include <intrin.h>
+        // MSVC allows using any intrinsic without changing the target of the whole TU
+        #define TARGET_AVX2
+    #else
+        #include <cpuid.h>
+        #define TARGET_AVX2 __attribute__((target("avx2")))
+    #endif
+#endif
+
+// one bitset word covers this many tracks
+static constexpr uint32_t tracksPerWord = DynBitset::bitsPerWord;
+static_assert(FeatureStore::columnPadding % tracksPerWord == 0, "Kernels read full words worth of tracks");
+static_assert(Track::featureAmount <= 15, "Failed features need to fit into (signed) 16bit masks");
+
+using RangeKernel = void (*)(
+    const std::array<const float*, Track::featureAmount>& columns,
+    const FeatureRanges& ranges,
+    uint64_t* words,
+    uint16_t* failedFeatures,
+    uint32_t wordCount);
+
+static void rangeKernelScalar(
+    const std::array<const float*, Track::featureAmount>& columns,
+    const FeatureRanges& ranges,
+    uint64_t* words,
+    uint16_t* failedFeatures,
+    uint32_t wordCount)
+{
+    for(uint32_t w = 0; w < wordCount; w++)
+    {
+        uint64_t word = 0;
+        for(uint32_t bit = 0; bit < tracksPerWord; bit++)
+        {
+            const uint32_t track = w * tracksPerWord + bit;
+            uint16_t failed = 0;
+            for(int f = 0; f < Track::featureAmount; f++)
+            {
+                const float value = columns[f][track];
+                const bool inRange = !(value < ranges[f].x) && !(value > ranges[f].y);
+                failed |= static_cast<uint16_t>(!inRange) << f;
+            }
+            failedFeatures[track] = failed;
+            word |= static_cast<uint64_t>(failed == 0) << bit;
+        }
+        words[w] = word;
+    }
+}
+
+#ifdef RANGE_FILTER_X86
+
+static bool cpuSupportsAVX2()
+{
+    #if defined(_MSC_VER) && !defined(__clang__)
+    int info[4];
+    __cpuid(info, 0);
+    if(info[0] < 7)
+    {
+        return false;
+    }
+    __cpuid(info, 1);
+    const bool osxsave = (info[2] & (1 << 27)) != 0;
+    const bool avx = (info[2] & (1 << 28)) != 0;
+    // the OS also has to save the upper halves of the ymm registers
+    if(!osxsave || !avx || (_xgetbv(0) & 0x6) != 0x6)
+    {
+        return false;
+    }
+    __cpuidex(info, 7, 0);
+    return (info[1] & (1 << 5)) != 0;
+    #else
+    unsigned int eax = 0;
+    unsigned int ebx = 0;
+    unsigned int ecx = 0;
+    unsigned int edx = 0;
+    if(__get_cpuid(1, &eax, &ebx, &ecx, &edx) == 0)
+    {
+        return false;
+    }
+    if((ecx & bit_OSXSAVE) == 0 || (ecx & bit_AVX) == 0)
+    {
+        return false;
+    }
+    uint32_t xcr0 = 0;
+    __asm__("xgetbv" : "=a"(xcr0) : "c"(0) : "%edx");
+    if((xcr0 & 0x6) != 0x6)
+    {
+        return false;
+    }
+    if(__get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx) == 0)
+    {
+        return false;
+    }
+    return (ebx & bit_AVX2) != 0;
+    #endif
+}
+
+// 4 tracks per compare
+static void rangeKernelSSE(
+    const std::array<const float*, Track::featureAmount>& columns,
+    const FeatureRanges& ranges,
+    uint64_t* words,
+    uint16_t* failedFeatures,
+    uint32_t wordCount)
+{
+    __m128 mins[Track::featureAmount];
+    __m128 maxs[Track::featureAmount];
+    __m128i featureBits[Track::featureAmount];
+    for(int f = 0; f < Track::featureAmount; f++)
+    {
+        mins[f] = _mm_set1_ps(ranges[f].x);
+        maxs[f] = _mm_set1_ps(ranges[f].y);
+        featureBits[f] = _mm_set1_epi32(1 << f);
+    }
+    const __m128i zero = _mm_setzero_si128();
+
+    for(uint32_t w = 0; w < wordCount; w++)
+    {
+        uint64_t word = 0;
+        for(uint32_t block = 0; block < tracksPerWord / 4; block++)
+        {
+            const uint32_t start = w * tracksPerWord + block * 4;
+            __m128i failed = zero;
+            for(int f = 0; f < Track::featureAmount; f++)
+            {
+                const __m128 values = _mm_loadu_ps(columns[f] + start);
+                // "not less than" / "not greater than" also hold for NaN, same as the scalar check
+                const __m128 inRange =
+                    _mm_and_ps(_mm_cmpnlt_ps(values, mins[f]), _mm_cmpngt_ps(values, maxs[f]));
+                failed = _mm_or_si128(failed, _mm_andnot_si128(_mm_castps_si128(inRange), featureBits[f]));
+            }
+            // 4x 32bit -> 4x 16bit, masks are small enough that saturation never happens
+            _mm_storel_epi64(
+                reinterpret_cast<__m128i*>(failedFeatures + start), _mm_packs_epi32(failed, failed));
+            const __m128i passed = _mm_cmpeq_epi32(failed, zero);
+            word |= static_cast<uint64_t>(_mm_movemask_ps(_mm_castsi128_ps(passed))) << (block * 4);
+        }
+        words[w] = word;
+    }
+}
+
+// 8 tracks per compare
+static TARGET_AVX2 void rangeKernelAVX2(
+    const std::array<const float*, Track::featureAmount>& columns,
+    const FeatureRanges& ranges,
+    uint64_t* words,
+    uint16_t* failedFeatures,
+    uint32_t wordCount)
+{
+    __m256 mins[Track::featureAmount];
+    __m256 maxs[Track::featureAmount];
+    __m256i featureBits[Track::featureAmount];
+    for(int f = 0; f < Track::featureAmount; f++)
+    {
+        mins[f] = _mm256_set1_ps(ranges[f].x);
+        maxs[f] = _mm256_set1_ps(ranges[f].y);
+        featureBits[f] = _mm256_set1_epi32(1 << f);
+    }
+    const __m256i zero = _mm256_setzero_si256();
+
+    for(uint32_t w = 0; w < wordCount; w++)
+    {
+        uint64_t word = 0;
+        for(uint32_t block = 0; block < tracksPerWord / 8; block++)
+        {
+            const uint32_t start = w * tracksPerWord + block * 8;
+            __m256i failed = zero;
+            for(int f = 0; f < Track::featureAmount; f++)
+            {
+                const __m256 values = _mm256_loadu_ps(columns[f] + start);
+                const __m256 inRange = _mm256_and_ps(
+                    _mm256_cmp_ps(values, mins[f], _CMP_NLT_UQ), _mm256_cmp_ps(values, maxs[f], _CMP_NGT_UQ));
+                failed =
+                    _mm256_or_si256(failed, _mm256_andnot_si256(_mm256_castps_si256(inRange), featureBits[f]));
+            }
+            // 8x 32bit -> 8x 16bit, masks are small enough that saturation never happens
+            const __m128i packed =
+                _mm_packs_epi32(_mm256_castsi256_si128(failed), _mm256_extracti128_si256(failed, 1));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(failedFeatures + start), packed);
+            const __m256i passed = _mm256_cmpeq_epi32(failed, zero);
+            word |= static_cast<uint64_t>(_mm256_movemask_ps(_mm256_castsi256_ps(passed))) << (block * 8);
+        }
+        words[w] = word;
+    }
+}
+
+#endif
+
+static bool kernelSupported(RangeFilterKernel kernel)
+{
+#ifdef RANGE_FILTER_X86
+    if(kernel == RangeFilterKernel::AVX2)
+    {
+        // only query the CPU once
+        static const bool avx2 = cpuSupportsAVX2();
+        return avx2;
+    }
+    return true;
+#else
+    return kernel == RangeFilterKernel::Scalar;
+#endif
+}
+
+static RangeKernel getKernelFunction(RangeFilterKernel kernel)
+{
+    assert(kernelSupported(kernel));
+    switch(kernel)
+    {
+#ifdef RANGE_FILTER_X86
+    case RangeFilterKernel::SSE:
+        return rangeKernelSSE;
+    case RangeFilterKernel::AVX2:
+        return rangeKernelAVX2;
+#endif
+    default:
+        return rangeKernelScalar;
+    }
+}
+
+void filterFeatureRanges(
+    const FeatureStore& features,
+    const FeatureRanges& ranges,
+    DynBitset& passMask,
+    std::vector<uint16_t>& failedFeatures,
+    ThreadPool* pool)
+{
+    filterFeatureRanges(getRangeFilterKernel(), features, ranges, passMask, failedFeatures, pool);
+}
+
+void filterFeatureRanges(
+    RangeFilterKernel kernelType,
+    const FeatureStore& features,
+    const FeatureRanges& ranges,
+    DynBitset& passMask,
+    std::vector<uint16_t>& failedFeatures,
+    ThreadPool* pool)
+{
+    const uint32_t trackCount = features.getTrackCount();
+    passMask.resize(trackCount);
+    if(trackCount == 0)
+    {
+        failedFeatures.clear();
+        return;
+    }
+
+    std::array<const float*, Track::featureAmount> columns;
+    for(int f = 0; f < Track::featureAmount; f++)
+    {
+        columns[f] = features.column(f).data();
+    }
+    const uint32_t wordCount = (trackCount + tracksPerWord - 1) / tracksPerWord;
+    assert(passMask.getWordCount() == wordCount);
+    // kernels always write full words worth of masks
+    failedFeatures.resize(wordCount * tracksPerWord);
+
+    uint64_t* words = passMask.data();
+    const RangeKernel kernel = getKernelFunction(kernelType);
+    if(pool == nullptr)
+    {
+        kernel(columns, ranges, words, failedFeatures.data(), wordCount);
+    }
+    else
+    {
+        // every chunk writes its own words and failedFeatures, so the result is the same as the serial one
+        pool->parallelFor(
+            wordCount,
+            minWordsPerChunk,
+            [&](uint32_t /*chunk*/, uint32_t firstWord, uint32_t lastWord)
+            {
+                const uint32_t firstTrack = firstWord * tracksPerWord;
+                std::array<const float*, Track::featureAmount> chunkColumns;
+                for(int f = 0; f < Track::featureAmount; f++)
+                {
+                    chunkColumns[f] = columns[f] + firstTrack;
+                }
+                kernel(
+                    chunkColumns,
+                    ranges,
+                    words + firstWord,
+                    failedFeatures.data() + firstTrack,
+                    lastWord - firstWord);
+            });
+    }
+
+    // the padding at the end of the columns may have passed as well
+    const uint32_t tailBits = trackCount % tracksPerWord;
+    if(tailBits != 0)
+    {
+        words[wordCount - 1] &= (uint64_t(1) << tailBits) - 1U;
+    }
+}
+
+RangeFilterKernel getRangeFilterKernel()
+{
+    static const RangeFilterKernel fastest = kernelSupported(RangeFilterKernel::AVX2) ? RangeFilterKernel::AVX2
+                                             : kernelSupported(RangeFilterKernel::SSE) ? RangeFilterKernel::SSE
+                                                                                       : RangeFilterKernel::Scalar;
+    return fastest;
+}
+
+bool isRangeFilterKernelSupported(RangeFilterKernel kernel)
+{
+    return kernelSupported(kernel);
+}
+
+const char* getRangeFilterKernelName(RangeFilterKernel kernel)
+{
+    switch(kernel)
+    {
+    case RangeFilterKernel::SSE:
+        return "SSE";
+    case RangeFilterKernel::AVX2:
+        return "AVX2";
+    default:
+        return "Scalar";
+    }
+}
+
+const char* getRangeFilterKernelName()
+{
+    return getRangeFilterKernelName(getRangeFilterKernel());
+}
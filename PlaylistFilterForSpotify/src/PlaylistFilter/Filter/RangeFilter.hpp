@@ -0,0 +1,59 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+#include <glm/ext.hpp>
+
+#include <DynamicBitset/DynamicBitset.hpp>
+#include <FeatureStore/FeatureStore.hpp>
+#include <ThreadPool/ThreadPool.hpp>
+#include <Track/Track.hpp>
+
+// [min, max] range per audio feature, same layout as the filter sliders in the UI
+using FeatureRanges = std::array<glm::vec2, Track::featureAmount>;
+
+/*
+    Tests the features of every track against all ranges at once.
+    Afterwards bit i of passMask is set if track i lies within all of the given ranges, and bit f of
+    failedFeatures[i] is set if track i lies outside the range of feature f.
+    passMask is resized to the track count of the store, failedFeatures to the padded track count.
+
+    The actual kernel (AVX2, SSE or scalar) is selected once at runtime depending on what the CPU supports.
+    All kernels behave exactly like the scalar check "!(value < min) && !(value > max)"
+    If a pool is given the tracks are split into word aligned chunks that are filtered in parallel
+*/
+void filterFeatureRanges(
+    const FeatureStore& features,
+    const FeatureRanges& ranges,
+    DynBitset& passMask,
+    std::vector<uint16_t>& failedFeatures,
+    ThreadPool* pool = nullptr);
+
+// the kernels filterFeatureRanges can dispatch to, slowest first
+enum class RangeFilterKernel
+{
+    Scalar,
+    SSE,
+    AVX2
+};
+
+// same as above, but forces the given kernel instead of the fastest one. Only for comparing them (benchmarks)
+void filterFeatureRanges(
+    RangeFilterKernel kernel,
+    const FeatureStore& features,
+    const FeatureRanges& ranges,
+    DynBitset& passMask,
+    std::vector<uint16_t>& failedFeatures,
+    ThreadPool* pool = nullptr);
+
+// smallest amount of words a worker gets, splitting up less work than this isnt worth the synchronization
+constexpr uint32_t minWordsPerChunk = 64;
+
+// the kernel filterFeatureRanges dispatches to
+RangeFilterKernel getRangeFilterKernel();
+bool isRangeFilterKernelSupported(RangeFilterKernel kernel);
+const char* getRangeFilterKernelName(RangeFilterKernel kernel);
+// name of the kernel filterFeatureRanges dispatches to, for debug output
+const char* getRangeFilterKernelName();
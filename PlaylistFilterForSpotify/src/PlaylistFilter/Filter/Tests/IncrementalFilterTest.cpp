@@ -0,0 +1,311 @@
+#include <DynamicBitset/DynamicBitset.hpp>
+#include <FeatureStore/FeatureStore.hpp>
+#include <Filter/TrackFilter.hpp>
+#include <ThreadPool/ThreadPool.hpp>
+#include <Track/Track.hpp>
+
+#include <ImGui/imgui.h>
+#include <Testing/Testing.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+
+/*
+    Differential test of TrackFilter: random sequences of slider, genre and name filter edits (plus tracks
+    changing or being appended in between) are applied, and after every single update the pass mask is compared
+    against a plain loop over all tracks. For partial updates the changed tracks also have to be exactly the
+    ones whose bit flipped. Every sequence runs once on the calling thread and once with the filter on a thread
+    pool.
+*/
+
+static constexpr uint32_t genreAmount = 24;
+
+// values and slider borders are multiples of this, so borders often lie exactly on (many equal) values
+static constexpr float valueStep = 0.01f;
+
+static const std::array<const char*, 12> syllables = {
+    "ka", "lo", "mi", "ne", "ru", "sa", "te", "vo", "xi", "zu", "bra", "ght"};
+// comma separated terms and excludes, see ImGuiTextFilter
+static const std::array<const char*, 12> nameFilters = {
+    "", "ka", "lom", "ne,ru", "-sa", "brag", "TE", "vo,-xi", "ght", "kalo", "zu ", "-ka,-mi"};
+
+struct TestPlaylist
+{
+    std::vector<Track> tracks;
+    FeatureStore features;
+    // the genres of every track, the brute force check only looks at these
+    std::vector<std::vector<uint32_t>> trackGenres;
+    std::vector<DynBitset> genreTracks;
+};
+
+static float randomValue(std::mt19937_64& random, int feature)
+{
+    const float scale = feature == 7 ? 300.0f : 1.0f;
+    return static_cast<float>(random() % 101) * valueStep * scale;
+}
+
+static std::string randomName(std::mt19937_64& random)
+{
+    std::string name;
+    const uint64_t length = 1 + random() % 4;
+    for(uint64_t i = 0; i < length; i++)
+    {
+        name += syllables[random() % syllables.size()];
+    }
+    return name;
+}
+
+static void addTrack(TestPlaylist& playlist, std::mt19937_64& random)
+{
+    const auto index = static_cast<uint32_t>(playlist.tracks.size());
+    Track& track = playlist.tracks.emplace_back();
+    track.index = static_cast<int>(index);
+    track.id = std::to_string(index);
+    track.trackNameEncoded = randomName(random);
+    track.artistsNamesEncoded = randomName(random);
+    track.albumNameEncoded = randomName(random);
+
+    playlist.features.resize(index + 1);
+    for(int f = 0; f < Track::featureAmount; f++)
+    {
+        playlist.features.set(f, index, randomValue(random, f));
+    }
+
+    std::vector<uint32_t>& genres = playlist.trackGenres.emplace_back();
+    const uint64_t genreCount = random() % 4;
+    for(uint64_t g = 0; g < genreCount; g++)
+    {
+        genres.push_back(static_cast<uint32_t>(random() % genreAmount));
+    }
+    for(DynBitset& genre : playlist.genreTracks)
+    {
+        genre.resize(index + 1);
+    }
+    for(const uint32_t genre : genres)
+    {
+        playlist.genreTracks[genre].setBit(index);
+    }
+}
+
+static TestPlaylist makePlaylist(uint32_t trackCount, std::mt19937_64& random)
+{
+    TestPlaylist playlist;
+    playlist.genreTracks.resize(genreAmount);
+    for(uint32_t i = 0; i < trackCount; i++)
+    {
+        addTrack(playlist, random);
+    }
+    return playlist;
+}
+
+static FeatureRanges getDefaultRanges()
+{
+    FeatureRanges ranges;
+    ranges.fill(glm::vec2(0.0f, 1.0f));
+    ranges[7] = {0, 300};
+    return ranges;
+}
+
+// what the filter has to come up with, without any of its tricks
+static DynBitset bruteForce(
+    const TestPlaylist& playlist,
+    const FeatureRanges& ranges,
+    const DynBitset& genreMask,
+    const ImGuiTextFilter& nameFilter)
+{
+    const auto trackCount = static_cast<uint32_t>(playlist.tracks.size());
+    DynBitset expected(trackCount);
+    for(uint32_t i = 0; i < trackCount; i++)
+    {
+        bool passes = true;
+        for(int f = 0; f < Track::featureAmount; f++)
+        {
+            const float value = playlist.features.get(f, i);
+            passes = passes && value >= ranges[f].x && value <= ranges[f].y;
+        }
+
+        if(genreMask)
+        {
+            bool hasGenre = false;
+            for(const uint32_t genre : playlist.trackGenres[i])
+            {
+                hasGenre = hasGenre || genreMask.getBit(genre);
+            }
+            passes = passes && hasGenre;
+        }
+
+        const Track& track = playlist.tracks[i];
+        if(nameFilter.IsActive())
+        {
+            passes = passes && (nameFilter.PassFilter(track.artistsNamesEncoded.c_str()) ||
+                                nameFilter.PassFilter(track.albumNameEncoded.c_str()) ||
+                                nameFilter.PassFilter(track.trackNameEncoded.c_str()));
+        }
+
+        if(passes)
+        {
+            expected.setBit(i);
+        }
+    }
+    return expected;
+}
+
+static std::string describeStep(uint64_t seed, int step)
+{
+    return "seed " + std::to_string(seed) + ", step " + std::to_string(step);
+}
+
+static void moveBorder(FeatureRanges& ranges, int feature, std::mt19937_64& random)
+{
+    const float scale = feature == 7 ? 300.0f : 1.0f;
+    // mostly small drags, sometimes a jump
+    const int steps = random() % 8 == 0 ? static_cast<int>(random() % 61) - 30 : static_cast<int>(random() % 7) - 3;
+    const float delta = static_cast<float>(steps) * valueStep * scale;
+    glm::vec2& range = ranges[feature];
+    if(random() % 2 == 0)
+    {
+        range.x = std::clamp(range.x + delta, 0.0f, range.y);
+    }
+    else
+    {
+        range.y = std::clamp(range.y + delta, range.x, scale);
+    }
+}
+
+static void runSequence(uint64_t seed, uint32_t trackCount, int steps, ThreadPool* pool)
+{
+    std::mt19937_64 random(seed);
+    TestPlaylist playlist = makePlaylist(trackCount, random);
+
+    TrackFilter filter;
+    filter.setThreadPool(pool);
+    filter.setPlaylist(playlist.tracks, playlist.features, playlist.genreTracks);
+
+    FeatureRanges ranges = getDefaultRanges();
+    DynBitset genreMask(genreAmount);
+    std::string nameText;
+    DynBitset previous;
+
+    for(int step = 0; step < steps; step++)
+    {
+        const uint64_t edit = random() % 100;
+        if(edit < 55)
+        {
+            moveBorder(ranges, static_cast<int>(random() % Track::featureAmount), random);
+        }
+        else if(edit < 65)
+        {
+            // two sliders at once, can still be partial
+            moveBorder(ranges, static_cast<int>(random() % Track::featureAmount), random);
+            moveBorder(ranges, static_cast<int>(random() % Track::featureAmount), random);
+        }
+        else if(edit < 70)
+        {
+            for(int f = 0; f < Track::featureAmount; f++)
+            {
+                moveBorder(ranges, f, random);
+            }
+        }
+        else if(edit < 80)
+        {
+            genreMask.toggleBit(static_cast<uint32_t>(random() % genreAmount));
+        }
+        else if(edit < 88)
+        {
+            nameText = nameFilters[random() % nameFilters.size()];
+        }
+        else if(edit < 92)
+        {
+            ranges = getDefaultRanges();
+        }
+        else if(edit < 94)
+        {
+            filter.invalidate();
+        }
+        else
+        {
+            // tracks changing their features or being appended, like while the playlist is still loading
+            std::vector<uint32_t> changed;
+            if(random() % 2 == 0)
+            {
+                const uint64_t count = 1 + random() % 50;
+                for(uint64_t t = 0; t < count; t++)
+                {
+                    changed.push_back(static_cast<uint32_t>(playlist.tracks.size()));
+                    addTrack(playlist, random);
+                }
+            }
+            else
+            {
+                const uint64_t count = 1 + random() % 20;
+                for(uint64_t t = 0; t < count; t++)
+                {
+                    const auto i = static_cast<uint32_t>(random() % playlist.tracks.size());
+                    const auto f = static_cast<int>(random() % Track::featureAmount);
+                    playlist.features.set(f, i, randomValue(random, f));
+                    changed.push_back(i);
+                }
+                std::sort(changed.begin(), changed.end());
+                changed.erase(std::unique(changed.begin(), changed.end()), changed.end());
+            }
+            if(filter.refreshTracks(changed))
+            {
+                // the settings didnt change, so the refreshed mask has to match them already
+                const ImGuiTextFilter nameFilter(nameText.c_str());
+                Testing::check(
+                    filter.getPassMask() == bruteForce(playlist, ranges, genreMask, nameFilter),
+                    "refreshTracks",
+                    describeStep(seed, step));
+            }
+            previous = filter.getPassMask();
+            continue;
+        }
+
+        const ImGuiTextFilter nameFilter(nameText.c_str());
+        const TrackFilter::UpdateType updateType = filter.update(ranges, genreMask, nameFilter);
+        const DynBitset expected = bruteForce(playlist, ranges, genreMask, nameFilter);
+        const DynBitset& passMask = filter.getPassMask();
+        Testing::check(passMask == expected, "pass mask", describeStep(seed, step));
+
+        if(updateType == TrackFilter::UpdateType::Partial)
+        {
+            // exactly the tracks that flipped, each of them once
+            std::vector<uint32_t> changed = filter.getChangedTracks();
+            std::sort(changed.begin(), changed.end());
+            std::vector<uint32_t> flipped;
+            for(uint32_t i = 0; i < expected.getSize(); i++)
+            {
+                if(i >= previous.getSize() || previous.getBit(i) != expected.getBit(i))
+                {
+                    flipped.push_back(i);
+                }
+            }
+            Testing::check(changed == flipped, "changed tracks of a partial update", describeStep(seed, step));
+        }
+        else if(updateType == TrackFilter::UpdateType::None)
+        {
+            Testing::check(passMask == previous, "update without changes", describeStep(seed, step));
+        }
+        previous = passMask;
+    }
+}
+
+int main()
+{
+    ThreadPool pool(4);
+    for(uint64_t seed = 1; seed <= 4; seed++)
+    {
+        // not a multiple of 64, so the last word of the masks is only partially used
+        const auto trackCount = static_cast<uint32_t>(3000 + seed * 517);
+        runSequence(seed, trackCount, 500, nullptr);
+        runSequence(seed, trackCount, 500, &pool);
+    }
+    // big enough that the full evaluations are actually split up
+    runSequence(5, 40000, 100, &pool);
+
+    return Testing::result("IncrementalFilterTest");
+}
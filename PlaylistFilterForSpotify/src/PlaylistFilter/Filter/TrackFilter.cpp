@@ -0,0 +1,457 @@
+#include "TrackFilter.hpp"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cassert>
+
+void TrackFilter::setPlaylist(
+    const std::vector<Track>& p_tracks,
+    const FeatureStore& p_features,
+    const std::vector<DynBitset>& p_genreTracks,
+    bool buildIndices)
+{
+    assert(p_tracks.size() == p_features.getTrackCount());
+    tracks = &p_tracks;
+    features = &p_features;
+    genreTracks = &p_genreTracks;
+    useIndices = buildIndices;
+    if(useIndices)
+    {
+        featureIndex.build(p_features);
+        nameIndex.build(p_tracks);
+    }
+    else
+    {
+        // the ones of an earlier playlist would only take up memory
+        featureIndex = {};
+        nameIndex = {};
+    }
+    featureIndexStale = false;
+    nameIndexStale = false;
+    invalidate();
+}
+
+void TrackFilter::invalidate()
+{
+    needsFullUpdate = true;
+}
+
+void TrackFilter::setThreadPool(ThreadPool* pool)
+{
+    threadPool = pool;
+}
+
+// the same check NameIndex::filter() does through the index
+static bool passesNameFilter(const ImGuiTextFilter& nameFilter, const Track& track)
+{
+    return nameFilter.PassFilter(track.artistsNamesEncoded.c_str()) ||
+           nameFilter.PassFilter(track.albumNameEncoded.c_str()) ||
+           nameFilter.PassFilter(track.trackNameEncoded.c_str());
+}
+
+// runs func(firstWord, lastWord) over all words of a wordCount sized bitset, on the pool if there is one
+template <class Func>
+static void forWordChunks(ThreadPool* pool, uint32_t wordCount, Func func)
+{
+    if(pool == nullptr)
+    {
+        func(0U, wordCount);
+        return;
+    }
+    pool->parallelFor(
+        wordCount,
+        minWordsPerChunk,
+        [&](uint32_t /*chunk*/, uint32_t firstWord, uint32_t lastWord) { func(firstWord, lastWord); });
+}
+
+TrackFilter::UpdateType
+TrackFilter::update(const FeatureRanges& ranges, const DynBitset& genreMask, const ImGuiTextFilter& nameFilter)
+{
+    assert(tracks != nullptr && features != nullptr);
+    changedTracks.clear();
+
+    const bool genresChanged = needsFullUpdate || !(genreMask == appliedGenreMask);
+    const bool namesChanged = needsFullUpdate || appliedNameFilter != nameFilter.InputBuf;
+    std::array<int, Track::featureAmount> changedRanges;
+    uint32_t changedRangeCount = 0;
+    for(int f = 0; f < Track::featureAmount; f++)
+    {
+        if(ranges[f].x != appliedRanges[f].x || ranges[f].y != appliedRanges[f].y)
+        {
+            changedRanges[changedRangeCount++] = f;
+        }
+    }
+
+    if(!needsFullUpdate && !genresChanged && !namesChanged && changedRangeCount == 0)
+    {
+        return UpdateType::None;
+    }
+
+    if(useIndices && featureIndexStale && (needsFullUpdate || changedRangeCount != 0))
+    {
+        featureIndex.build(*features);
+        featureIndexStale = false;
+    }
+    if(useIndices && nameIndexStale && namesChanged)
+    {
+        nameIndex.build(*tracks);
+        nameIndexStale = false;
+    }
+
+    if(genresChanged)
+    {
+        evaluateGenres(genreMask);
+    }
+    if(namesChanged)
+    {
+        evaluateNames(nameFilter);
+    }
+
+    // partial updates walk the sorted order of the moved features, that needs the index
+    if(needsFullUpdate || changedRangeCount > maxPartialRangeUpdates || !useIndices)
+    {
+        evaluateFeatureRanges(ranges);
+    }
+    else
+    {
+        for(uint32_t c = 0; c < changedRangeCount; c++)
+        {
+            updateFeatureRange(changedRanges[c], ranges[changedRanges[c]]);
+        }
+        if(!genresChanged && !namesChanged)
+        {
+            // passMask was already patched track by track
+            if(changedRangeCount > 1)
+            {
+                // a track may have flipped more than once (eg. failing one moved range but passing another)
+                // only the ones that flipped an odd number of times actually changed
+                std::sort(changedTracks.begin(), changedTracks.end());
+                size_t out = 0;
+                for(size_t i = 0; i < changedTracks.size();)
+                {
+                    size_t j = i;
+                    while(j < changedTracks.size() && changedTracks[j] == changedTracks[i])
+                    {
+                        j++;
+                    }
+                    if((j - i) % 2 == 1)
+                    {
+                        changedTracks[out++] = changedTracks[i];
+                    }
+                    i = j;
+                }
+                changedTracks.resize(out);
+            }
+            return UpdateType::Partial;
+        }
+        changedTracks.clear();
+    }
+
+    passMask = featurePassMask;
+    passMask &= genrePassMask;
+    passMask &= namePassMask;
+    needsFullUpdate = false;
+    return UpdateType::Full;
+}
+
+bool TrackFilter::refreshTracks(const std::vector<uint32_t>& trackIndices)
+{
+    assert(tracks != nullptr && features != nullptr);
+    if(needsFullUpdate)
+    {
+        return false;
+    }
+
+    const auto trackCount = static_cast<uint32_t>(tracks->size());
+    assert(features->getTrackCount() == trackCount);
+    if(failedFeatures.size() < trackCount)
+    {
+        failedFeatures.resize(trackCount);
+    }
+    for(DynBitset* mask : {&featurePassMask, &genrePassMask, &namePassMask, &passMask})
+    {
+        mask->resize(trackCount);
+    }
+    // genres only get appended, a genre mask sized to all of them still counts as the applied one
+    if(appliedGenreMask.getSize() < genreTracks->size())
+    {
+        appliedGenreMask.resize(static_cast<uint32_t>(genreTracks->size()));
+    }
+
+    // the same checks as the full evaluations, for single tracks
+    const ImGuiTextFilter nameFilter(appliedNameFilter.c_str());
+    const bool anyGenre = static_cast<bool>(appliedGenreMask);
+    for(const uint32_t i : trackIndices)
+    {
+        assert(i < trackCount);
+        uint16_t failed = 0;
+        for(int f = 0; f < Track::featureAmount; f++)
+        {
+            const float value = features->get(f, i);
+            if(value < appliedRanges[f].x || value > appliedRanges[f].y)
+            {
+                failed |= static_cast<uint16_t>(1U << f);
+            }
+        }
+        failedFeatures[i] = failed;
+
+        bool passesGenres = !anyGenre;
+        appliedGenreMask.forEachSetBit([&](uint32_t genre) { passesGenres |= (*genreTracks)[genre].getBit(i); });
+
+        const bool passesNames = !nameFilter.IsActive() || passesNameFilter(nameFilter, (*tracks)[i]);
+
+        const auto setTo = [i](DynBitset& mask, bool value) { value ? mask.setBit(i) : mask.clearBit(i); };
+        setTo(featurePassMask, failed == 0);
+        setTo(genrePassMask, passesGenres);
+        setTo(namePassMask, passesNames);
+        setTo(passMask, failed == 0 && passesGenres && passesNames);
+    }
+    featureIndexStale = true;
+    nameIndexStale = true;
+    return true;
+}
+
+const DynBitset& TrackFilter::getPassMask() const
+{
+    return passMask;
+}
+
+const std::vector<uint32_t>& TrackFilter::getChangedTracks() const
+{
+    return changedTracks;
+}
+
+void TrackFilter::evaluateFeatureRanges(const FeatureRanges& ranges)
+{
+    appliedRanges = ranges;
+    if(!useIndices)
+    {
+        filterFeatureRanges(*features, ranges, featurePassMask, failedFeatures, threadPool);
+        return;
+    }
+    const uint32_t trackCount = featureIndex.getTrackCount();
+
+    std::array<FeatureIndex::Span, Track::featureAmount> spans;
+    uint64_t indexCost = 0;
+    for(int f = 0; f < Track::featureAmount; f++)
+    {
+        spans[f] = featureIndex.findRange(f, ranges[f]);
+        indexCost += std::min(spans[f].size(), trackCount - spans[f].size());
+    }
+    if(indexCost * indexCostFactor >= trackCount)
+    {
+        filterFeatureRanges(*features, ranges, featurePassMask, failedFeatures, threadPool);
+        return;
+    }
+
+    // Start with the bit of every narrow range set and clear it for the tracks inside the span. For wide
+    // ranges mark the few tracks outside of it instead. That way only min(inside, outside) tracks are touched
+    uint16_t initialFailed = 0;
+    for(int f = 0; f < Track::featureAmount; f++)
+    {
+        if(spans[f].size() < trackCount - spans[f].size())
+        {
+            initialFailed |= static_cast<uint16_t>(1U << f);
+        }
+    }
+    failedFeatures.assign(trackCount, initialFailed);
+    for(int f = 0; f < Track::featureAmount; f++)
+    {
+        const auto featureBit = static_cast<uint16_t>(1U << f);
+        if((initialFailed & featureBit) != 0)
+        {
+            for(uint32_t track : featureIndex.getTracks(f, spans[f]))
+            {
+                failedFeatures[track] &= ~featureBit;
+            }
+        }
+        else
+        {
+            for(uint32_t track : featureIndex.getTracks(f, {0, spans[f].first}))
+            {
+                failedFeatures[track] |= featureBit;
+            }
+            for(uint32_t track : featureIndex.getTracks(f, {spans[f].last, trackCount}))
+            {
+                failedFeatures[track] |= featureBit;
+            }
+        }
+    }
+
+    // passing tracks are the intersection of all spans, so its enough to look at the smallest one
+    const auto smallest = std::min_element(
+        spans.begin(), spans.end(), [](auto& a, auto& b) { return a.size() < b.size(); });
+    const int smallestFeature = static_cast<int>(smallest - spans.begin());
+    featurePassMask.resize(trackCount);
+    featurePassMask.clear();
+    for(uint32_t track : featureIndex.getTracks(smallestFeature, *smallest))
+    {
+        if(failedFeatures[track] == 0)
+        {
+            featurePassMask.setBit(track);
+        }
+    }
+}
+
+void TrackFilter::updateFeatureRange(int feature, glm::vec2 newRange)
+{
+    /*
+        In the sorted order of this feature the old and the new range are both a single span. A track can only
+        change its state for this feature if it lies between the two lower or between the two upper borders,
+        so only those parts of the order have to be visited (both parts overlap if the spans dont, then some
+        tracks are just visited twice, the second visit sees them as up to date).
+    */
+    const FeatureIndex::Span oldSpan = featureIndex.findRange(feature, appliedRanges[feature]);
+    const FeatureIndex::Span newSpan = featureIndex.findRange(feature, newRange);
+    const FeatureIndex::Span borders[2] = {
+        {std::min(oldSpan.first, newSpan.first), std::max(oldSpan.first, newSpan.first)},
+        {std::min(oldSpan.last, newSpan.last), std::max(oldSpan.last, newSpan.last)}};
+
+    const auto featureBit = static_cast<uint16_t>(1U << feature);
+    for(const FeatureIndex::Span& border : borders)
+    {
+        const std::span<const uint32_t> borderTracks = featureIndex.getTracks(feature, border);
+        for(uint32_t j = 0; j < borderTracks.size(); j++)
+        {
+            const uint32_t position = border.first + j;
+            const uint32_t i = borderTracks[j];
+            const bool fails = position < newSpan.first || position >= newSpan.last;
+            const bool failed = (failedFeatures[i] & featureBit) != 0;
+            if(fails == failed)
+            {
+                continue;
+            }
+            failedFeatures[i] ^= featureBit;
+            const bool passesFeatures = failedFeatures[i] == 0;
+            if(passesFeatures != featurePassMask.getBit(i))
+            {
+                featurePassMask.toggleBit(i);
+                if(genrePassMask.getBit(i) && namePassMask.getBit(i))
+                {
+                    passMask.toggleBit(i);
+                    changedTracks.push_back(i);
+                }
+            }
+        }
+    }
+    appliedRanges[feature] = newRange;
+}
+
+void TrackFilter::evaluateGenres(const DynBitset& genreMask)
+{
+    appliedGenreMask = genreMask;
+    genrePassMask.resize(static_cast<uint32_t>(tracks->size()));
+    genrePassMask.clear();
+    if(!genreMask)
+    {
+        // no genre selected, dont filter by genre at all
+        genrePassMask.setAll();
+        return;
+    }
+    // one pass over the track bitset of every selected genre, instead of testing every single track
+    uint64_t* passWords = genrePassMask.data();
+    forWordChunks(
+        threadPool,
+        genrePassMask.getWordCount(),
+        [&](uint32_t firstWord, uint32_t lastWord)
+        {
+            genreMask.forEachSetBit(
+                [&](uint32_t genre)
+                {
+                    assert((*genreTracks)[genre].getSize() == genrePassMask.getSize());
+                    const uint64_t* genreWords = (*genreTracks)[genre].data();
+                    for(uint32_t w = firstWord; w < lastWord; w++)
+                    {
+                        passWords[w] |= genreWords[w];
+                    }
+                });
+        });
+}
+
+void TrackFilter::evaluateNames(const ImGuiTextFilter& nameFilter)
+{
+    appliedNameFilter = nameFilter.InputBuf;
+    if(useIndices)
+    {
+        nameIndex.filter(nameFilter, namePassMask, threadPool);
+        return;
+    }
+
+    const auto trackCount = static_cast<uint32_t>(tracks->size());
+    namePassMask.resize(trackCount);
+    if(!nameFilter.IsActive())
+    {
+        namePassMask.setAll();
+        return;
+    }
+    namePassMask.clear();
+    // every chunk only sets the bits of its own words
+    forWordChunks(
+        threadPool,
+        namePassMask.getWordCount(),
+        [&](uint32_t firstWord, uint32_t lastWord)
+        {
+            const uint32_t lastTrack = std::min(lastWord * DynBitset::bitsPerWord, trackCount);
+            for(uint32_t i = firstWord * DynBitset::bitsPerWord; i < lastTrack; i++)
+            {
+                if(passesNameFilter(nameFilter, (*tracks)[i]))
+                {
+                    namePassMask.setBit(i);
+                }
+            }
+        });
+}
+
+void TrackFilter::collectPassingTracks(std::vector<Track>& playlist, std::vector<Track*>& passing) const
+{
+    assert(&playlist == tracks);
+    // passing is only resized, so collecting about as many tracks as last time doesnt allocate
+    const auto collectWords = [&](uint32_t firstWord, uint32_t lastWord, Track** out)
+    {
+        const uint64_t* words = passMask.data();
+        for(uint32_t w = firstWord; w < lastWord; w++)
+        {
+            uint64_t word = words[w];
+            while(word != 0U)
+            {
+                const uint32_t i = w * DynBitset::bitsPerWord + static_cast<uint32_t>(std::countr_zero(word));
+                *out++ = &playlist[i];
+                word &= word - 1;
+            }
+        }
+    };
+    const uint32_t wordCount = passMask.getWordCount();
+    if(threadPool == nullptr)
+    {
+        passing.resize(passMask.popcount());
+        collectWords(0, wordCount, passing.data());
+        return;
+    }
+    // every chunk writes the passing tracks of its own word range behind the ones of the chunks before it,
+    // which gives the same list as a single pass over the whole mask
+    const uint32_t chunkCount = threadPool->getChunkCount(wordCount, minWordsPerChunk);
+    chunkOffsets.assign(chunkCount + 1, 0);
+    threadPool->parallelFor(
+        wordCount,
+        minWordsPerChunk,
+        [&](uint32_t chunk, uint32_t firstWord, uint32_t lastWord)
+        {
+            uint32_t count = 0;
+            for(uint32_t w = firstWord; w < lastWord; w++)
+            {
+                count += static_cast<uint32_t>(std::popcount(passMask.data()[w]));
+            }
+            chunkOffsets[chunk + 1] = count;
+        });
+    for(uint32_t chunk = 0; chunk < chunkCount; chunk++)
+    {
+        chunkOffsets[chunk + 1] += chunkOffsets[chunk];
+    }
+    passing.resize(chunkOffsets[chunkCount]);
+    threadPool->parallelFor(
+        wordCount,
+        minWordsPerChunk,
+        [&](uint32_t chunk, uint32_t firstWord, uint32_t lastWord)
+        { collectWords(firstWord, lastWord, passing.data() + chunkOffsets[chunk]); });
+}
@@ -0,0 +1,119 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <ImGui/imgui.h>
+
+#include <DynamicBitset/DynamicBitset.hpp>
+#include <FeatureStore/FeatureStore.hpp>
+#include <Filter/FeatureIndex.hpp>
+#include <Filter/NameIndex.hpp>
+#include <Filter/RangeFilter.hpp>
+#include <ThreadPool/ThreadPool.hpp>
+#include <Track/Track.hpp>
+
+/*
+    Keeps track of which tracks of a playlist pass the current filter settings.
+
+    For every track a mask of the audio features it fails is stored. When only a few of the feature ranges
+    changed since the last update (ie. the user is dragging a slider) only the tracks that crossed one of the
+    moved range borders need to be updated, instead of testing the whole playlist again. Those tracks are
+    found through a sorted index per feature, so a small slider movement only touches a handful of tracks.
+    When all ranges are set at once the index is used as well if the ranges are selective enough, otherwise
+    all tracks are simply tested with the vectorized range filter.
+    The genre and name checks only depend on their own settings, so their results are cached as well.
+    The name check looks up the candidates for each filter term in a trigram index of all names.
+    Tracks passing the genre check are the union of the track bitsets of all selected genres.
+    Full evaluations of the range, genre and name checks can be split across a thread pool. The chunks are
+    aligned to bitset words, so the masks come out exactly the same as when evaluated on a single thread.
+*/
+class TrackFilter
+{
+  public:
+    enum class UpdateType
+    {
+        // nothing changed since the last update
+        None,
+        // only the tracks in getChangedTracks() switched between passing and failing
+        Partial,
+        // the whole playlist was re-evaluated
+        Full
+    };
+
+    // start filtering a new playlist, all need to stay alive as long as this filter is used with them
+    // genreTracks[g] has bit i set if track i has genre g. Also (re)builds the feature and name index
+    // tracks can still be appended afterwards (with the others grown to match), see refreshTracks()
+    // The indices only pay off when the filter is updated again and again (ie. while dragging a slider). Without
+    // them every update tests all tracks, which is faster if it is only evaluated once or twice (ie. headless)
+    void setPlaylist(
+        const std::vector<Track>& tracks,
+        const FeatureStore& features,
+        const std::vector<DynBitset>& genreTracks,
+        bool buildIndices = true);
+    // make the next update() re-evaluate everything
+    void invalidate();
+    // pool used for full evaluations, nullptr runs everything on the calling thread. Needs to outlive the filter
+    void setThreadPool(ThreadPool* pool);
+
+    UpdateType update(const FeatureRanges& ranges, const DynBitset& genreMask, const ImGuiTextFilter& nameFilter);
+    /*
+        Tests the given tracks again with the settings of the last update, after their features or genres changed
+        or they were appended to the playlist (every appended track has to be given). Only their bits of the pass
+        mask change, the caller knows which tracks to look at.
+        The indices are rebuilt by the next update() that needs them.
+        Returns false if there was no update since the playlist was set (or invalidate()), then nothing is done
+    */
+    bool refreshTracks(const std::vector<uint32_t>& trackIndices);
+
+    // bit i is set if track i passes all filters
+    [[nodiscard]] const DynBitset& getPassMask() const;
+    // indices of the tracks whose state changed during the last (partial) update, in no particular order
+    [[nodiscard]] const std::vector<uint32_t>& getChangedTracks() const;
+    // replaces passing with the tracks (of the playlist given to setPlaylist()) that pass, in playlist order
+    void collectPassingTracks(std::vector<Track>& playlist, std::vector<Track*>& passing) const;
+
+    // if more ranges than this changed, just re-run the full range check
+    static constexpr int maxPartialRangeUpdates = 2;
+    /*
+        Setting all ranges through the index costs a few random writes per track inside (or outside) the
+        spans, the vectorized filter handles 64 tracks per word sequentially. Only use the index if it has to
+        touch less than 1/indexCostFactor of the playlist
+    */
+    static constexpr uint32_t indexCostFactor = 4;
+
+  private:
+    void evaluateFeatureRanges(const FeatureRanges& ranges);
+    void updateFeatureRange(int feature, glm::vec2 newRange);
+    void evaluateGenres(const DynBitset& genreMask);
+    void evaluateNames(const ImGuiTextFilter& nameFilter);
+
+    const std::vector<Track>* tracks = nullptr;
+    const FeatureStore* features = nullptr;
+    const std::vector<DynBitset>* genreTracks = nullptr;
+    ThreadPool* threadPool = nullptr;
+    bool useIndices = true;
+    FeatureIndex featureIndex;
+    NameIndex nameIndex;
+    // tracks were added or changed since they were built
+    bool featureIndexStale = false;
+    bool nameIndexStale = false;
+    bool needsFullUpdate = true;
+
+    FeatureRanges appliedRanges;
+    // bit f is set if the track lies outside the range of feature f
+    std::vector<uint16_t> failedFeatures;
+    DynBitset featurePassMask;
+
+    DynBitset appliedGenreMask;
+    DynBitset genrePassMask;
+
+    std::string appliedNameFilter;
+    DynBitset namePassMask;
+
+    DynBitset passMask;
+    std::vector<uint32_t> changedTracks;
+    // where the tracks of every chunk start in the output of collectPassingTracks(), kept to reuse its storage
+    mutable std::vector<uint32_t> chunkOffsets;
+};
@@ -0,0 +1,228 @@
+#include "FrameTiming.hpp"
+
+#ifdef FRAME_TIMING
+
+    #include <ImGui/imgui.h>
+
+    #include <algorithm>
+    #include <cstdio>
+    #include <fstream>
+
+static constexpr std::array<std::string_view, FrameTiming::phaseCount> phaseNames = {
+    "createMainUI",
+    "refreshFilteredTracks",
+    "generateGraphingData",
+    "uploadGraphingData",
+    "uploadAvailableCovers",
+    "draw3DGraph",
+    "Table::draw",
+    "frame"};
+
+static float toMilliseconds(FrameTiming::Clock::duration duration)
+{
+    return std::chrono::duration<float, std::milli>(duration).count();
+}
+
+FrameTiming& FrameTiming::get()
+{
+    static FrameTiming timing;
+    return timing;
+}
+
+FrameTiming::FrameTiming() : events(eventCapacity), epoch(Clock::now())
+{
+}
+
+std::string_view FrameTiming::getPhaseName(FramePhase phase)
+{
+    return phaseNames[static_cast<size_t>(phase)];
+}
+
+void FrameTiming::beginFrame()
+{
+    currentFrame.fill(0.0f);
+    frameStart = Clock::now();
+    inFrame = true;
+}
+
+void FrameTiming::endFrame()
+{
+    if(!inFrame)
+    {
+        return;
+    }
+    addEvent(FramePhase::Frame, frameStart, Clock::now());
+    const uint64_t slot = frameCount % historySize;
+    for(size_t p = 0; p < phaseCount; p++)
+    {
+        history[p][slot] = currentFrame[p];
+    }
+    frameCount++;
+    inFrame = false;
+}
+
+void FrameTiming::addEvent(FramePhase phase, Clock::time_point start, Clock::time_point end)
+{
+    events[eventCount % eventCapacity] = Event{.start = start, .duration = end - start, .phase = phase};
+    eventCount++;
+    // outside of a frame (ie. while entering the main view) its only kept for the trace
+    if(inFrame)
+    {
+        currentFrame[static_cast<size_t>(phase)] += toMilliseconds(end - start);
+    }
+}
+
+uint32_t FrameTiming::getHistoryCount() const
+{
+    return static_cast<uint32_t>(std::min<uint64_t>(frameCount, historySize));
+}
+
+uint32_t FrameTiming::getHistoryStart() const
+{
+    return frameCount < historySize ? 0 : static_cast<uint32_t>(frameCount % historySize);
+}
+
+FrameTiming::Percentiles FrameTiming::getPercentiles(FramePhase phase) const
+{
+    const uint32_t count = getHistoryCount();
+    if(count == 0)
+    {
+        return {};
+    }
+    const auto& samples = history[static_cast<size_t>(phase)];
+    std::array<float, historySize> sorted;
+    std::copy(samples.begin(), samples.begin() + count, sorted.begin());
+    std::sort(sorted.begin(), sorted.begin() + count);
+    const auto at = [&](float percentile)
+    { return sorted[std::min(static_cast<uint32_t>(percentile * static_cast<float>(count)), count - 1)]; };
+    return {.p50 = at(0.50f), .p95 = at(0.95f), .p99 = at(0.99f)};
+}
+
+void FrameTiming::drawOverlay(bool* open)
+{
+    ImGui::SetNextWindowSize(ImVec2(ImGui::CalcTextSize("M").x * 60.0f, 0.0f), ImGuiCond_FirstUseEver);
+    if(!ImGui::Begin("Frame timing (F3)", open))
+    {
+        ImGui::End();
+        return;
+    }
+    const uint32_t count = getHistoryCount();
+    ImGui::Text("last %u frames, in ms", count);
+    if(ImGui::BeginTable("##frameTimingPercentiles", 5, ImGuiTableFlags_RowBg | ImGuiTableFlags_SizingStretchProp))
+    {
+        ImGui::TableSetupColumn("phase");
+        ImGui::TableSetupColumn("last");
+        ImGui::TableSetupColumn("p50");
+        ImGui::TableSetupColumn("p95");
+        ImGui::TableSetupColumn("p99");
+        ImGui::TableHeadersRow();
+        const uint64_t lastSlot = (frameCount + historySize - 1) % historySize;
+        for(size_t p = 0; p < phaseCount; p++)
+        {
+            const Percentiles percentiles = getPercentiles(static_cast<FramePhase>(p));
+            ImGui::TableNextRow();
+            ImGui::TableNextColumn();
+            ImGui::TextUnformatted(phaseNames[p].data(), phaseNames[p].data() + phaseNames[p].size());
+            ImGui::TableNextColumn();
+            ImGui::Text("%.3f", count != 0 ? history[p][lastSlot] : 0.0f);
+            ImGui::TableNextColumn();
+            ImGui::Text("%.3f", percentiles.p50);
+            ImGui::TableNextColumn();
+            ImGui::Text("%.3f", percentiles.p95);
+            ImGui::TableNextColumn();
+            ImGui::Text("%.3f", percentiles.p99);
+        }
+        ImGui::EndTable();
+    }
+
+    // oldest frame on the left, scaled to the slowest one so spikes stand out
+    const float graphHeight = ImGui::GetTextLineHeight() * 2.5f;
+    for(size_t p = 0; p < phaseCount; p++)
+    {
+        const auto& samples = history[p];
+        const float maxValue = count != 0 ? *std::max_element(samples.begin(), samples.begin() + count) : 0.0f;
+        char overlay[64];
+        std::snprintf(overlay, sizeof(overlay), "%s (max %.2f ms)", phaseNames[p].data(), maxValue);
+        ImGui::PushID(static_cast<int>(p));
+        ImGui::PlotLines(
+            "##phaseGraph",
+            samples.data(),
+            static_cast<int>(count),
+            static_cast<int>(getHistoryStart()),
+            overlay,
+            0.0f,
+            std::max(maxValue, 0.001f),
+            ImVec2(-1.0f, graphHeight));
+        ImGui::PopID();
+    }
+
+    const std::filesystem::path directory = CACHE_PATH;
+    if(ImGui::Button("Export CSV"))
+    {
+        const std::filesystem::path path = directory / "frame_timing.csv";
+        exportMessage = writeCSV(path) ? "wrote " + path.string() : "could not write " + path.string();
+    }
+    ImGui::SameLine();
+    if(ImGui::Button("Export Chrome trace"))
+    {
+        const std::filesystem::path path = directory / "frame_trace.json";
+        exportMessage = writeChromeTrace(path) ? "wrote " + path.string() : "could not write " + path.string();
+    }
+    ImGui::TextWrapped("%s", exportMessage.c_str());
+    ImGui::End();
+}
+
+bool FrameTiming::writeCSV(const std::filesystem::path& path) const
+{
+    std::error_code error;
+    std::filesystem::create_directories(path.parent_path(), error);
+    std::ofstream file(path);
+    file << "frame";
+    for(const std::string_view name : phaseNames)
+    {
+        file << "," << name;
+    }
+    file << "\n";
+    const uint32_t count = getHistoryCount();
+    const uint64_t firstFrame = frameCount - count;
+    for(uint32_t i = 0; i < count; i++)
+    {
+        const uint64_t slot = (firstFrame + i) % historySize;
+        file << firstFrame + i;
+        for(size_t p = 0; p < phaseCount; p++)
+        {
+            file << "," << history[p][slot];
+        }
+        file << "\n";
+    }
+    return file.good();
+}
+
+bool FrameTiming::writeChromeTrace(const std::filesystem::path& path) const
+{
+    std::error_code error;
+    std::filesystem::create_directories(path.parent_path(), error);
+    std::ofstream file(path);
+    file << R"({"displayTimeUnit":"ms","traceEvents":[)";
+    const uint64_t count = std::min<uint64_t>(eventCount, eventCapacity);
+    const uint64_t firstEvent = eventCount - count;
+    char line[160];
+    for(uint64_t i = 0; i < count; i++)
+    {
+        const Event& event = events[(firstEvent + i) % eventCapacity];
+        // complete events, in microseconds
+        std::snprintf(
+            line,
+            sizeof(line),
+            R"(%s{"name":"%s","cat":"frame","ph":"X","ts":%.3f,"dur":%.3f,"pid":1,"tid":1})",
+            i != 0 ? "," : "",
+            phaseNames[static_cast<size_t>(event.phase)].data(),
+            std::chrono::duration<double, std::micro>(event.start - epoch).count(),
+            std::chrono::duration<double, std::micro>(event.duration).count());
+        file << line << "\n";
+    }
+    file << "]}\n";
+    return file.good();
+}
+
+#endif
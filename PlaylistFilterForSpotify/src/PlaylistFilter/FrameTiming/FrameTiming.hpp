@@ -0,0 +1,134 @@
+#pragma once
+
+/*
+    Timing of the phases of every frame of the main view, to find out what makes the ui stutter.
+    Only exists if FRAME_TIMING is defined (the PLAYLISTFILTER_FRAME_TIMING cmake option), otherwise
+    TIME_FRAME_PHASE() expands to nothing and none of this is compiled.
+*/
+#ifdef FRAME_TIMING
+
+    #include <array>
+    #include <chrono>
+    #include <cstdint>
+    #include <filesystem>
+    #include <string>
+    #include <string_view>
+    #include <vector>
+
+enum class FramePhase : uint8_t
+{
+    CreateMainUI,
+    RefreshFilteredTracks,
+    GenerateGraphingData,
+    UploadGraphingData,
+    UploadAvailableCovers,
+    Draw3DGraph,
+    TableDraw,
+    // from beginFrame() to endFrame()
+    Frame,
+    Count
+};
+
+/*
+    Every timed phase is kept as a single event (for the trace) and added to the time of its phase in the
+    current frame (a phase can run more than once per frame, ie. there are two tables). endFrame() moves those
+    sums into a history of the last frames, which the overlay takes its percentiles and graphs from.
+    Phases are timed inclusively, createMainUI contains the drawing of the tables. GL calls only queue work, so
+    the render phases measure how long submitting took, not the gpu.
+    Only to be used from the main thread.
+*/
+class FrameTiming
+{
+  public:
+    using Clock = std::chrono::steady_clock;
+    static constexpr auto phaseCount = static_cast<size_t>(FramePhase::Count);
+    // frames kept for the percentiles, graphs and csv
+    static constexpr uint32_t historySize = 1024;
+    // single phase runs kept for the trace
+    static constexpr uint32_t eventCapacity = 1 << 16;
+
+    struct Percentiles
+    {
+        float p50 = 0;
+        float p95 = 0;
+        float p99 = 0;
+    };
+
+    // the one of the app
+    static FrameTiming& get();
+
+    void beginFrame();
+    void endFrame();
+    void addEvent(FramePhase phase, Clock::time_point start, Clock::time_point end);
+
+    // in milliseconds, over the frames in the history
+    [[nodiscard]] Percentiles getPercentiles(FramePhase phase) const;
+    // closes the window by setting open to false
+    void drawOverlay(bool* open);
+
+    // one row per frame of the history with the milliseconds of every phase
+    [[nodiscard]] bool writeCSV(const std::filesystem::path& path) const;
+    // the kept events in the chrome trace event format (chrome://tracing, ui.perfetto.dev)
+    [[nodiscard]] bool writeChromeTrace(const std::filesystem::path& path) const;
+
+    static std::string_view getPhaseName(FramePhase phase);
+
+  private:
+    FrameTiming();
+
+    struct Event
+    {
+        Clock::time_point start;
+        Clock::duration duration;
+        FramePhase phase;
+    };
+
+    // number of frames in the history, and the index of the oldest one
+    [[nodiscard]] uint32_t getHistoryCount() const;
+    [[nodiscard]] uint32_t getHistoryStart() const;
+
+    // ms per frame, history[phase][frame % historySize]
+    std::array<std::array<float, historySize>, phaseCount> history{};
+    std::array<float, phaseCount> currentFrame{};
+    uint64_t frameCount = 0;
+    Clock::time_point frameStart;
+    bool inFrame = false;
+
+    // ring buffer, eventCount % eventCapacity is the next one to replace
+    std::vector<Event> events;
+    uint64_t eventCount = 0;
+    // trace timestamps start here
+    Clock::time_point epoch;
+
+    std::string exportMessage;
+};
+
+class ScopedPhaseTimer
+{
+  public:
+    explicit ScopedPhaseTimer(FramePhase phase) : phase(phase), start(FrameTiming::Clock::now())
+    {
+    }
+    ~ScopedPhaseTimer()
+    {
+        FrameTiming::get().addEvent(phase, start, FrameTiming::Clock::now());
+    }
+    ScopedPhaseTimer(const ScopedPhaseTimer&) = delete;
+    ScopedPhaseTimer& operator=(const ScopedPhaseTimer&) = delete;
+    ScopedPhaseTimer(ScopedPhaseTimer&&) = delete;
+    ScopedPhaseTimer& operator=(ScopedPhaseTimer&&) = delete;
+
+  private:
+    FramePhase phase;
+    FrameTiming::Clock::time_point start;
+};
+
+    #define FRAME_TIMING_CONCAT_IMPL(a, b) a##b
+    #define FRAME_TIMING_CONCAT(a, b) FRAME_TIMING_CONCAT_IMPL(a, b)
+    // times the rest of the enclosing scope as the given FramePhase
+    #define TIME_FRAME_PHASE(phase) \
+        const ScopedPhaseTimer FRAME_TIMING_CONCAT(phaseTimer, __LINE__)(FramePhase::phase)
+
+#else
+    #define TIME_FRAME_PHASE(phase)
+#endif
@@ -0,0 +1,60 @@
+#include "Graphing.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+void generateGraphingData(
+    std::span<Track* const> tracks,
+    const FeatureStore& features,
+    GraphingAxes axes,
+    std::vector<GraphingBufferElement>& graphingData)
+{
+    graphingData.clear();
+    graphingData.reserve(tracks.size());
+    const std::span<const float> xValues = features.column(axes[0]);
+    const std::span<const float> yValues = features.column(axes[1]);
+    const std::span<const float> zValues = features.column(axes[2]);
+    for(const Track* track : tracks)
+    {
+        const auto index = static_cast<uint32_t>(track->index);
+        graphingData.emplace_back(GraphingBufferElement{
+            {xValues[index], yValues[index], zValues[index]}, track->coverInfoPtr->layer, index});
+    }
+}
+
+std::optional<uint32_t> raycastGraphingData(
+    std::span<const GraphingBufferElement> graphingData,
+    glm::vec3 rayPos,
+    glm::vec3 rayDir,
+    const glm::mat4& view,
+    glm::vec3 axisMins,
+    glm::vec3 axisMaxs,
+    float coverSize)
+{
+    const glm::mat4 invView = glm::inverse(view);
+    const glm::vec3 worldCamX = glm::vec3(invView * glm::vec4(1.0f, 0.f, 0.f, 0.f));
+    const glm::vec3 worldCamY = glm::vec3(invView * glm::vec4(0.f, 1.0f, 0.f, 0.f));
+    const glm::vec3 n = glm::normalize(glm::cross(worldCamX, worldCamY));
+    const glm::vec3 axisFactors = axisMaxs - axisMins;
+
+    float hitT = std::numeric_limits<float>::max();
+    std::optional<uint32_t> hitIndex;
+    for(const auto& graphingBufferElement : graphingData)
+    {
+        const glm::vec3 tboP = (graphingBufferElement.p - axisMins) / axisFactors;
+        float t = glm::dot(tboP - rayPos, n) / glm::dot(rayDir, n);
+        t = std::max(0.f, t);
+        const glm::vec3 hitP = rayPos + t * rayDir;
+
+        const float localX = glm::dot(hitP - tboP, worldCamX);
+        const float localY = glm::dot(hitP - tboP, worldCamY);
+        const bool insideSquare = std::abs(localX) < 0.5f * coverSize && std::abs(localY) < 0.5f * coverSize;
+        if(insideSquare && t < hitT)
+        {
+            hitT = t;
+            hitIndex = graphingBufferElement.originalIndex;
+        }
+    }
+    return hitIndex;
+}
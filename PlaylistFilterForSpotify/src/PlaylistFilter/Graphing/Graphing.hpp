@@ -0,0 +1,36 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include <CommonStructs/CommonStructs.hpp>
+#include <FeatureStore/FeatureStore.hpp>
+#include <Track/Track.hpp>
+
+// the features shown along the x, y and z axis of the 3D graph
+using GraphingAxes = std::array<int, 3>;
+
+// replaces graphingData with a point for every given track, at its values of the axis features
+void generateGraphingData(
+    std::span<Track* const> tracks,
+    const FeatureStore& features,
+    GraphingAxes axes,
+    std::vector<GraphingBufferElement>& graphingData);
+
+/*
+    The closest of the covers hit by the ray, as its originalIndex. Every cover is a square of coverSize facing
+    the camera (given by its view matrix), centered on its point scaled so that axisMins to axisMaxs is 0 to 1
+*/
+std::optional<uint32_t> raycastGraphingData(
+    std::span<const GraphingBufferElement> graphingData,
+    glm::vec3 rayPos,
+    glm::vec3 rayDir,
+    const glm::mat4& view,
+    glm::vec3 axisMins,
+    glm::vec3 axisMaxs,
+    float coverSize);
@@ -0,0 +1,300 @@
+#include "HttpTransport.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <random>
+
+HttpTransport::HttpTransport(
+    uint32_t p_maxInFlight, RateLimit rateLimit, RetryPolicy p_retryPolicy, bool p_reuseConnections)
+    : maxInFlight(std::max(p_maxInFlight, 1U)), reuseConnections(p_reuseConnections), retryPolicy(p_retryPolicy),
+      rateLimiter(rateLimit)
+{
+    workers.reserve(maxInFlight);
+    for(uint32_t i = 0; i < maxInFlight; i++)
+    {
+        workers.emplace_back(&HttpTransport::workerLoop, this);
+    }
+}
+
+HttpTransport::~HttpTransport()
+{
+    std::deque<PendingRequest> unsent;
+    {
+        std::lock_guard lock(mutex);
+        stopWorkers = true;
+        unsent.swap(queue);
+    }
+    wakeWorkers.notify_all();
+    rateLimiter.stop();
+    // the ones in flight are still answered by their worker (requeue() cancels them instead of retrying)
+    for(PendingRequest& pending : unsent)
+    {
+        cancel(pending);
+    }
+    for(auto& worker : workers)
+    {
+        worker.join();
+    }
+}
+
+void HttpTransport::cancel(PendingRequest& pending)
+{
+    cpr::Response response;
+    response.status_code = 0;
+    response.url = cpr::Url{pending.request.url};
+    response.error.code = cpr::ErrorCode::INTERNAL_ERROR;
+    response.error.message = "the transport was shut down before the request was sent";
+    pending.promise.set_value(std::move(response));
+}
+
+std::future<cpr::Response> HttpTransport::sendAsync(Request request)
+{
+    std::string endpoint = getEndpoint(request.url);
+    std::future<cpr::Response> response;
+    {
+        std::lock_guard lock(mutex);
+        PendingRequest& pending = queue.emplace_back(
+            PendingRequest{.request = std::move(request), .promise = {}, .endpoint = std::move(endpoint)});
+        response = pending.promise.get_future();
+    }
+    requestCount++;
+    wakeWorkers.notify_one();
+    return response;
+}
+
+cpr::Response HttpTransport::send(Request request)
+{
+    return sendAsync(std::move(request)).get();
+}
+
+std::future<cpr::Response> HttpTransport::getAsync(std::string url, cpr::Header header)
+{
+    return sendAsync({.method = Method::Get, .url = std::move(url), .header = std::move(header)});
+}
+
+cpr::Response HttpTransport::get(std::string url, cpr::Header header)
+{
+    return getAsync(std::move(url), std::move(header)).get();
+}
+
+uint32_t HttpTransport::getMaxInFlight() const
+{
+    return maxInFlight;
+}
+
+HttpTransport::Stats HttpTransport::getStats() const
+{
+    return {.requests = requestCount.load(), .sessions = sessionCount.load(), .peakInFlight = peakInFlight.load()};
+}
+
+std::map<std::string, HttpTransport::EndpointStats> HttpTransport::getEndpointStats() const
+{
+    std::lock_guard lock(statsMutex);
+    return endpointStats;
+}
+
+// spotify ids are 22 characters of base62, the ids of cover images 40 hex digits
+static bool isSpotifyId(std::string_view segment)
+{
+    const auto isBase62 = [](char c) { return std::isalnum(static_cast<uint8_t>(c)) != 0; };
+    const auto isHex = [](char c) { return std::isxdigit(static_cast<uint8_t>(c)) != 0; };
+    return (segment.size() == 22 && std::all_of(segment.begin(), segment.end(), isBase62)) ||
+           (segment.size() == 40 && std::all_of(segment.begin(), segment.end(), isHex));
+}
+
+std::string HttpTransport::getEndpoint(std::string_view url)
+{
+    // drop scheme, host and query
+    if(const size_t schemeEnd = url.find("://"); schemeEnd != std::string_view::npos)
+    {
+        url.remove_prefix(schemeEnd + 3);
+        url.remove_prefix(std::min(url.find('/'), url.size()));
+    }
+    url = url.substr(0, url.find('?'));
+
+    std::string endpoint;
+    while(!url.empty())
+    {
+        url.remove_prefix(1);
+        const std::string_view segment = url.substr(0, url.find('/'));
+        url.remove_prefix(segment.size());
+        endpoint += '/';
+        endpoint += isSpotifyId(segment) ? "{id}" : segment;
+    }
+    return endpoint;
+}
+
+bool HttpTransport::takeNextRequest(PendingRequest& pending)
+{
+    std::unique_lock lock(mutex);
+    while(!stopWorkers)
+    {
+        // retries wait in the queue as well, take the first one thats ready
+        const Clock::time_point now = Clock::now();
+        std::optional<Clock::time_point> nextReady;
+        for(auto iter = queue.begin(); iter != queue.end(); iter++)
+        {
+            if(iter->notBefore <= now)
+            {
+                pending = std::move(*iter);
+                queue.erase(iter);
+                return true;
+            }
+            nextReady = std::min(nextReady.value_or(iter->notBefore), iter->notBefore);
+        }
+        if(nextReady)
+        {
+            wakeWorkers.wait_until(lock, *nextReady);
+        }
+        else
+        {
+            wakeWorkers.wait(lock);
+        }
+    }
+    // the destructor answers whatever is still queued
+    return false;
+}
+
+void HttpTransport::requeue(PendingRequest&& pending)
+{
+    {
+        std::lock_guard lock(mutex);
+        if(stopWorkers)
+        {
+            // the queue was already emptied, nobody would take it anymore
+            cancel(pending);
+            return;
+        }
+        // it was sent before everything thats still queued
+        queue.push_front(std::move(pending));
+    }
+    wakeWorkers.notify_one();
+}
+
+void HttpTransport::workerLoop()
+{
+    // once a cpr::Session had a body set it sends it with every GET as well, so requests with a body get their
+    // own session. Both are only created once they are needed, so idle workers dont count as connections
+    std::optional<cpr::Session> getSession;
+    std::optional<cpr::Session> bodySession;
+    std::mt19937 jitterRng{std::random_device{}()};
+    PendingRequest pending;
+    while(takeNextRequest(pending))
+    {
+        if(!rateLimiter.acquire())
+        {
+            // stopped while waiting for the rate limit
+            cancel(pending);
+            return;
+        }
+
+        const Request& request = pending.request;
+        std::optional<cpr::Session>& session = request.method == Method::Get ? getSession : bodySession;
+        if(!session)
+        {
+            session.emplace();
+            session->SetHttpVersion(cpr::HttpVersion{cpr::HttpVersionCode::VERSION_2_0_TLS});
+            sessionCount++;
+        }
+        const uint32_t nowInFlight = ++inFlight;
+        uint32_t peak = peakInFlight.load();
+        while(nowInFlight > peak && !peakInFlight.compare_exchange_weak(peak, nowInFlight))
+        {
+        }
+
+        session->SetUrl(cpr::Url{request.url});
+        session->SetHeader(request.header);
+        cpr::Response response;
+        if(request.method == Method::Get)
+        {
+            response = session->Get();
+        }
+        else
+        {
+            // copied, it might have to be sent again
+            if(request.payload)
+            {
+                session->SetPayload(*request.payload);
+            }
+            else
+            {
+                session->SetBody(cpr::Body{request.body});
+            }
+            response = request.method == Method::Post ? session->Post() : session->Put();
+        }
+        inFlight--;
+        if(response.error)
+        {
+            // a connection that broke off in the middle of the answer still has the status of its headers,
+            // but the body is incomplete
+            response.status_code = 0;
+        }
+
+        // 0 is a network error (timeout, connection reset, ...)
+        const bool throttled = response.status_code == 429;
+        // being throttled isnt the requests fault, doesnt use up its attempts
+        pending.attempts += throttled ? 0 : 1;
+        const bool transient = response.status_code == 0 || response.status_code >= 500;
+        std::optional<Clock::duration> retryDelay;
+        if(throttled)
+        {
+            // seconds, spotify always sends it but dont rely on that
+            const auto retryAfterIter = response.header.find("Retry-After");
+            const int retryAfter =
+                retryAfterIter != response.header.end() ? std::atoi(retryAfterIter->second.c_str()) : 1;
+            const auto delay = std::chrono::seconds(std::max(retryAfter, 1));
+            if(delay <= retryPolicy.maxRetryAfter)
+            {
+                // everything else would most likely get a 429 as well
+                rateLimiter.pauseUntil(Clock::now() + delay);
+                retryDelay = Clock::duration::zero();
+            }
+        }
+        else if(transient && pending.attempts < retryPolicy.maxAttempts)
+        {
+            const auto fullDelay = std::min<Clock::duration>(
+                retryPolicy.baseDelay * (1LL << std::min(pending.attempts - 1, 20U)), retryPolicy.maxDelay);
+            std::uniform_int_distribution<Clock::rep> jitter(fullDelay.count() / 2, fullDelay.count());
+            retryDelay = Clock::duration(jitter(jitterRng));
+        }
+
+        {
+            std::lock_guard lock(statsMutex);
+            EndpointStats& stats = endpointStats[pending.endpoint];
+            stats.sent++;
+            stats.throttled += throttled ? 1 : 0;
+            stats.retried += retryDelay && !throttled ? 1 : 0;
+            stats.failed += !retryDelay && (response.status_code == 0 || response.status_code >= 400) ? 1 : 0;
+        }
+
+        if(retryDelay)
+        {
+            pending.notBefore = Clock::now() + *retryDelay;
+            requeue(std::move(pending));
+        }
+        else
+        {
+            pending.promise.set_value(std::move(response));
+        }
+        pending = {};
+        if(!reuseConnections)
+        {
+            session.reset();
+        }
+    }
+}
+
+uint32_t HttpTransport::defaultMaxInFlight()
+{
+    // NOLINTNEXTLINE(concurrency-mt-unsafe) only read once at startup
+    if(const char* env = std::getenv("PLAYLISTFILTER_HTTP_CONNECTIONS"))
+    {
+        const int requested = std::atoi(env);
+        if(requested > 0)
+        {
+            return static_cast<uint32_t>(requested);
+        }
+    }
+    return 8;
+}
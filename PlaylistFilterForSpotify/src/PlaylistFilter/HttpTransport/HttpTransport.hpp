@@ -0,0 +1,148 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <future>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include <cpr/cpr.h>
+
+#include <HttpTransport/RateLimiter.hpp>
+
+struct RetryPolicy
+{
+    // including the first one
+    uint32_t maxAttempts = 5;
+    // doubled for every failed attempt, each delay is picked randomly between half and all of it
+    std::chrono::milliseconds baseDelay{500};
+    std::chrono::milliseconds maxDelay{16000};
+    // if the server wants us to wait longer than this its not worth waiting for, the request fails instead
+    std::chrono::milliseconds maxRetryAfter{120000};
+};
+
+/*
+    All requests go through here instead of creating a new connection for every single one.
+    Every worker thread owns one cpr::Session and keeps reusing it, so its connection stays alive between
+    requests (and uses HTTP/2 if the server supports it). The number of workers is the limit of requests in
+    flight at the same time, everything else waits in the queue in the order it was sent.
+    Before sending, every request has to get through the rate limiter. A 429 pauses all requests for as long as
+    its Retry-After says and then sends it again, network errors and 5xx are retried with exponential backoff.
+    Only once the retries are used up (or on any other error) the failed response is handed to the caller.
+    Requests that are still waiting when the transport is destroyed are answered with status 0 and an error,
+    so nobody waiting on them gets a broken promise.
+*/
+class HttpTransport
+{
+  public:
+    using Clock = std::chrono::steady_clock;
+
+    enum class Method
+    {
+        Get,
+        Post,
+        Put
+    };
+
+    struct Request
+    {
+        Method method = Method::Get;
+        std::string url;
+        cpr::Header header;
+        std::string body;
+        // form data, replaces the body if set
+        std::optional<cpr::Payload> payload;
+    };
+
+    struct Stats
+    {
+        uint64_t requests = 0;
+        // every session holds (at most) one connection, so this is the number of connections opened
+        uint32_t sessions = 0;
+        uint32_t peakInFlight = 0;
+    };
+
+    // every attempt counts as sent
+    struct EndpointStats
+    {
+        uint64_t sent = 0;
+        // after a network error or 5xx
+        uint64_t retried = 0;
+        // answered with 429
+        uint64_t throttled = 0;
+        // handed to the caller as failed
+        uint64_t failed = 0;
+    };
+
+    // without reuseConnections every request opens a new connection, only to compare against
+    explicit HttpTransport(
+        uint32_t maxInFlight = defaultMaxInFlight(),
+        RateLimit rateLimit = {},
+        RetryPolicy retryPolicy = {},
+        bool reuseConnections = true);
+    ~HttpTransport();
+    HttpTransport(const HttpTransport&) = delete;
+    HttpTransport& operator=(const HttpTransport&) = delete;
+    HttpTransport(HttpTransport&&) = delete;
+    HttpTransport& operator=(HttpTransport&&) = delete;
+
+    // queue the request, dont wait on the future from a callback that runs on the transport itself
+    std::future<cpr::Response> sendAsync(Request request);
+    cpr::Response send(Request request);
+    std::future<cpr::Response> getAsync(std::string url, cpr::Header header);
+    cpr::Response get(std::string url, cpr::Header header);
+
+    [[nodiscard]] uint32_t getMaxInFlight() const;
+    [[nodiscard]] Stats getStats() const;
+    // by path of the url, with ids replaced by {id} (ie. "/v1/playlists/{id}/tracks" or "/image/{id}")
+    [[nodiscard]] std::map<std::string, EndpointStats> getEndpointStats() const;
+
+    // 8, can be overwritten with the PLAYLISTFILTER_HTTP_CONNECTIONS environment variable
+    static uint32_t defaultMaxInFlight();
+    static std::string getEndpoint(std::string_view url);
+
+  private:
+    struct PendingRequest
+    {
+        Request request;
+        std::promise<cpr::Response> promise;
+        std::string endpoint;
+        uint32_t attempts = 0;
+        // for retries
+        Clock::time_point notBefore;
+    };
+
+    void workerLoop();
+    // false if the transport is shutting down
+    bool takeNextRequest(PendingRequest& pending);
+    void requeue(PendingRequest&& pending);
+    // answers it without sending it (again), because the transport is shutting down
+    static void cancel(PendingRequest& pending);
+
+    uint32_t maxInFlight;
+    bool reuseConnections;
+    RetryPolicy retryPolicy;
+    RateLimiter rateLimiter;
+    std::vector<std::thread> workers;
+
+    std::mutex mutex;
+    std::condition_variable wakeWorkers;
+    std::deque<PendingRequest> queue;
+    bool stopWorkers = false;
+
+    mutable std::mutex statsMutex;
+    std::map<std::string, EndpointStats> endpointStats;
+
+    std::atomic<uint64_t> requestCount = 0;
+    std::atomic<uint32_t> sessionCount = 0;
+    std::atomic<uint32_t> inFlight = 0;
+    std::atomic<uint32_t> peakInFlight = 0;
+};
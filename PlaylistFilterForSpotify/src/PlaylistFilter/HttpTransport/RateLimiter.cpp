@@ -0,0 +1,67 @@
+#include "RateLimiter.hpp"
+
+#include <algorithm>
+
+RateLimiter::RateLimiter(RateLimit limit)
+    : capacity(limit.requestsPerWindow),
+      tokensPerSecond(
+          limit.requestsPerWindow / std::max(std::chrono::duration<double>(limit.window).count(), 0.001)),
+      tokens(capacity), lastRefill(Clock::now()), pausedUntil(lastRefill)
+{
+}
+
+void RateLimiter::refill(Clock::time_point now)
+{
+    const double elapsed = std::chrono::duration<double>(now - std::max(lastRefill, pausedUntil)).count();
+    if(elapsed > 0)
+    {
+        tokens = std::min(capacity, tokens + elapsed * tokensPerSecond);
+    }
+    lastRefill = std::max(lastRefill, now);
+}
+
+bool RateLimiter::acquire()
+{
+    std::unique_lock lock(mutex);
+    while(!stopped)
+    {
+        const Clock::time_point now = Clock::now();
+        Clock::time_point wakeTime = pausedUntil;
+        if(now >= pausedUntil)
+        {
+            if(capacity == 0)
+            {
+                return true;
+            }
+            refill(now);
+            if(tokens >= 1.0)
+            {
+                tokens -= 1.0;
+                return true;
+            }
+            wakeTime = now + std::chrono::duration_cast<Clock::duration>(
+                                 std::chrono::duration<double>((1.0 - tokens) / tokensPerSecond));
+        }
+        wakeUp.wait_until(lock, wakeTime, [&]() { return stopped; });
+    }
+    return false;
+}
+
+void RateLimiter::pauseUntil(Clock::time_point time)
+{
+    std::lock_guard lock(mutex);
+    if(time > pausedUntil)
+    {
+        pausedUntil = time;
+        tokens = 0;
+    }
+}
+
+void RateLimiter::stop()
+{
+    {
+        std::lock_guard lock(mutex);
+        stopped = true;
+    }
+    wakeUp.notify_all();
+}
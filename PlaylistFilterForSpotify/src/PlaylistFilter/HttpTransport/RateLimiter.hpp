@@ -0,0 +1,46 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+
+struct RateLimit
+{
+    // 0 means unlimited (but pauses are still respected)
+    uint32_t requestsPerWindow = 0;
+    std::chrono::milliseconds window{30000};
+};
+
+/*
+    Token bucket: holds up to requestsPerWindow tokens and refills them evenly over the window, every request
+    takes one. So bursts of up to a full window are fine, but on average it never goes over the limit.
+    When the server says to back off (Retry-After), nothing is let through until then.
+*/
+class RateLimiter
+{
+  public:
+    using Clock = std::chrono::steady_clock;
+
+    explicit RateLimiter(RateLimit limit);
+
+    // blocks until a request may be sent, returns false if stop() was called in the meantime
+    bool acquire();
+    // nothing gets through before time, and the bucket starts out empty after that
+    void pauseUntil(Clock::time_point time);
+    // wakes everyone waiting in acquire()
+    void stop();
+
+  private:
+    void refill(Clock::time_point now);
+
+    const double capacity;
+    const double tokensPerSecond;
+
+    std::mutex mutex;
+    std::condition_variable wakeUp;
+    double tokens;
+    Clock::time_point lastRefill;
+    Clock::time_point pausedUntil;
+    bool stopped = false;
+};
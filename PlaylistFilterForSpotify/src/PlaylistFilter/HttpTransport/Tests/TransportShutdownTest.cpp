@@ -0,0 +1,57 @@
+#include <HttpTransport/HttpTransport.hpp>
+
+#include <Testing/Testing.hpp>
+
+#include <chrono>
+#include <future>
+#include <string>
+#include <thread>
+#include <vector>
+
+/*
+    Destroys transports while requests are still queued, waiting for a retry or waiting for the rate limiter.
+    Every one of them has to be answered (with status 0 and an error if it was never sent successfully) instead
+    of leaving the caller with a broken promise.
+    Nothing listens on port 1, so every request fails right away and is retried.
+*/
+
+static void destroyWhileQueued(const std::string& what, RateLimit rateLimit)
+{
+    constexpr int requestCount = 20;
+    std::vector<std::future<cpr::Response>> responses;
+    {
+        HttpTransport transport(2, rateLimit, RetryPolicy{.baseDelay = std::chrono::milliseconds(200)});
+        for(int i = 0; i < requestCount; i++)
+        {
+            responses.push_back(transport.getAsync("http://127.0.0.1:1/v1/me?i=" + std::to_string(i), {}));
+        }
+        // some are sent and wait for their retry, the others are still queued
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    }
+
+    int answered = 0;
+    for(std::future<cpr::Response>& response : responses)
+    {
+        if(response.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+        {
+            continue;
+        }
+        try
+        {
+            const cpr::Response r = response.get();
+            answered += r.status_code == 0 && r.error ? 1 : 0;
+        }
+        catch(const std::future_error&)
+        {
+        }
+    }
+    Testing::check(answered == requestCount, "every request failed explicitly", what);
+}
+
+int main()
+{
+    destroyWhileQueued("retries", RateLimit{});
+    // the workers wait in the rate limiter with a request they already took
+    destroyWhileQueued("rate limited", RateLimit{.requestsPerWindow = 1, .window = std::chrono::seconds(60)});
+    return Testing::result("TransportShutdownTest");
+}
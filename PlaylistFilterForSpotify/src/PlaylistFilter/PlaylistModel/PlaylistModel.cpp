@@ -0,0 +1,122 @@
+#include "PlaylistModel.hpp"
+
+#include <algorithm>
+#include <ctime>
+#include <filesystem>
+#include <tuple>
+
+#include <Snapshot/PlaylistSnapshot.hpp>
+
+PlaylistModel::PlaylistModel()
+{
+    resetFeatureFilters();
+}
+
+void PlaylistModel::setData(SpotifyApiAccess::PlaylistData_t&& data, bool buildFilterIndices)
+{
+    std::vector<std::string> selectedGenres;
+    currentGenreMask.forEachSetBit([&](uint32_t genre) { selectedGenres.push_back(genreNames[genre]); });
+
+    // have to use std::tie for now since CLANG doesnt allow for structured bindings to be captured in
+    // lambda can switch back if lambda refactored into function
+    // (moving keeps the pointers from the tracks into the cover table valid)
+    std::tie(playlist, trackFeatures, coverTable, genreNames, genreTracks, artistIds, artistIdToIndex) =
+        std::move(data);
+
+    currentGenreMask = DynBitset(genreNames.size());
+    currentGenreMask.clear();
+    for(uint32_t i = 0; i < genreNames.size(); i++)
+    {
+        if(std::find(selectedGenres.begin(), selectedGenres.end(), genreNames[i]) != selectedGenres.end())
+        {
+            currentGenreMask.setBit(i);
+        }
+    }
+    genreTrackCounts.resize(genreTracks.size());
+    for(uint32_t i = 0; i < genreTracks.size(); i++)
+    {
+        genreTrackCounts[i] = genreTracks[i].popcount();
+    }
+
+    playlistTracks = std::vector<Track*>(playlist.size());
+    for(auto i = 0; i < playlist.size(); i++)
+    {
+        playlistTracks[i] = &playlist[i];
+    }
+    // filters that were set while the playlist was still loading are kept
+    trackFilter.setPlaylist(playlist, trackFeatures, genreTracks, buildFilterIndices);
+}
+
+void PlaylistModel::resetFeatureFilters()
+{
+    featureMinMaxValues = getFullFeatureRanges();
+}
+
+FeatureRanges PlaylistModel::getFullFeatureRanges()
+{
+    FeatureRanges ranges;
+    ranges.fill(glm::vec2(0.0f, 1.0f));
+    ranges[7] = {0, 300};
+    return ranges;
+}
+
+std::optional<uint32_t> PlaylistModel::findGenre(std::string_view name) const
+{
+    const auto genre = std::find(genreNames.begin(), genreNames.end(), name);
+    if(genre == genreNames.end())
+    {
+        return std::nullopt;
+    }
+    return static_cast<uint32_t>(genre - genreNames.begin());
+}
+
+TrackFilter::UpdateType PlaylistModel::updateFilter()
+{
+    return trackFilter.update(featureMinMaxValues, currentGenreMask, nameFilter);
+}
+
+PlaylistSource loadPlaylistSource(
+    SpotifyApiAccess& apiAccess,
+    std::string_view playlistID,
+    LoadProgress& progress,
+    PlaylistStream* stream,
+    ThreadPool* pool)
+{
+    // opening a playlist again only downloads what changed since the last time
+    const std::filesystem::path snapshotPath = getPlaylistSnapshotPath(playlistID);
+    progress.startPhase(LoadProgress::Phase::ReadingCache, 0);
+    std::optional<PlaylistSource> source = loadPlaylistSnapshot(snapshotPath, pool);
+    if(source)
+    {
+        if(apiAccess.syncPlaylist(playlistID, *source, progress))
+        {
+            writePlaylistSnapshot(snapshotPath, *source);
+        }
+    }
+    else
+    {
+        source = apiAccess.downloadPlaylist(playlistID, progress, stream);
+        writePlaylistSnapshot(snapshotPath, *source);
+    }
+    return std::move(*source);
+}
+
+std::string getGeneratedPlaylistName()
+{
+    const int MAXLEN = 80;
+    char s[MAXLEN] = "PlaylistFilter generated playlist - ";
+    time_t t = time(0);
+    strftime(&s[36], MAXLEN - 36, "%d/%m/%Y::%H:%M", localtime(&t));
+    return s;
+}
+
+std::vector<std::string> getTrackUris(std::span<Track* const> tracks)
+{
+    std::vector<std::string> uris = {};
+    uris.reserve(tracks.size());
+    for(const auto& track : tracks)
+    {
+        uris.emplace_back("spotify:track:" + track->id);
+    }
+    return uris;
+}
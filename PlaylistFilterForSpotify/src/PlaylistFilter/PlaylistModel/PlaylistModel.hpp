@@ -0,0 +1,98 @@
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <ImGui/imgui.h>
+
+#include <DynamicBitset/DynamicBitset.hpp>
+#include <FeatureStore/FeatureStore.hpp>
+#include <Filter/RangeFilter.hpp>
+#include <Filter/TrackFilter.hpp>
+#include <Spotify/PlaylistSource.hpp>
+#include <Spotify/PlaylistStream.hpp>
+#include <Spotify/SpotifyApiAccess.hpp>
+#include <ThreadPool/ThreadPool.hpp>
+#include <Track/Track.hpp>
+
+/*
+    A loaded playlist with all the tables around its tracks, and the filter settings applied to it.
+    Nothing in here needs a window, the app keeps one for the playlist it shows and PlaylistFilterCLI filters
+    one without any ui.
+    The tables are filled by setData() (or appended to by whoever streams in a playlist), after that the filter
+    points into them. So they mustnt be resized while it is used, unless the filter is told (see TrackFilter)
+*/
+struct PlaylistModel
+{
+    // every feature over its whole range
+    PlaylistModel();
+
+    /*
+        Replaces all tables with the ones of a (newly) loaded playlist. The filter settings are kept, selected
+        genres by their name. The filter only builds its indices if it is going to be updated again and again
+    */
+    void setData(SpotifyApiAccess::PlaylistData_t&& data, bool buildFilterIndices = true);
+    void resetFeatureFilters();
+    // the range of every feature that lets all tracks pass, tempo is in bpm, everything else 0..1
+    static FeatureRanges getFullFeatureRanges();
+    // index into genreNames, nullopt if none of the tracks has this genre
+    [[nodiscard]] std::optional<uint32_t> findGenre(std::string_view name) const;
+    // applies the current filter settings, afterwards trackFilter has the tracks that pass
+    TrackFilter::UpdateType updateFilter();
+
+    /*
+        todo: dont like this being a vector, size is determined once and then constant for the rest of the program!
+              and it mustnt be resized anyways, since many places reference elements through pointers which need
+              to stay valid!
+              (while the playlist is streamed in it is reserved up front and only filled up to that capacity)
+    */
+    std::vector<Track> playlist;
+    // audio features of the tracks above, one contiguous column per feature (indexed by Track::index)
+    FeatureStore trackFeatures;
+    /*
+        A filtered playlist is just a vector of pointers to the remaining tracks.
+        To make resetting filters faster, playlistTracks is a cached version including all tracks
+    */
+    std::vector<Track*> playlistTracks;
+    /*
+        Same goes for this, is initiated once, and mustnt be changed afterwards
+
+        Key string is AlbumID
+    */
+    SpotifyApiAccess::CoverTable_t coverTable;
+
+    std::vector<std::string> genreNames;
+    // bit i of genreTracks[g] is set if playlist[i] has genre g
+    std::vector<DynBitset> genreTracks;
+    std::vector<uint32_t> genreTrackCounts;
+    std::vector<std::string> artistIds;
+    SpotifyApiAccess::ArtistIndexLUT_t artistIdToIndex;
+
+    // Filtering related variables
+    // no genre selected lets all tracks pass, otherwise they need any of the selected ones
+    DynBitset currentGenreMask;
+    ImGuiTextFilter nameFilter;
+    FeatureRanges featureMinMaxValues;
+    TrackFilter trackFilter;
+};
+
+/*
+    Gets the playlist as it is now. If there is a snapshot of it in the cache only what changed since is
+    downloaded, otherwise the whole playlist is (publishing the tracks to the stream, if one is given).
+    Either way the snapshot is updated afterwards. The pool (if any) is only used for reading the snapshot
+*/
+PlaylistSource loadPlaylistSource(
+    SpotifyApiAccess& apiAccess,
+    std::string_view playlistID,
+    LoadProgress& progress,
+    PlaylistStream* stream = nullptr,
+    ThreadPool* pool = nullptr);
+
+// "PlaylistFilter generated playlist - " and the current date and time
+std::string getGeneratedPlaylistName();
+// spotify:track:{id} of every track, what SpotifyApiAccess::createPlaylist() takes
+std::vector<std::string> getTrackUris(std::span<Track* const> tracks);
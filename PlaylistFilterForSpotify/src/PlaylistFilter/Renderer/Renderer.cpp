@@ -1,4 +1,6 @@
 #include "CommonStructs/CommonStructs.hpp"
+// glad has to be included before glfw
+#include <glad/glad.h>
 #include <GLFW/glfw3.h>
 #include <future>
 
@@ -18,6 +20,8 @@
 
 #include "Renderer.hpp"
 #include <App/App.hpp>
+#include <CoverImage/CoverImage.hpp>
+#include <FrameTiming/FrameTiming.hpp>
 #include <App/Input.hpp>
 #include <utils/OpenGLErrorHandler.hpp>
 #include <utils/imgui_extensions.hpp>
@@ -341,28 +345,64 @@ Renderer::~Renderer()
 
 void Renderer::createRenderData()
 {
-    unsigned char* data = nullptr;
+    createCoverArray();
+
+    glGenVertexArrays(1, &trackVAO);
+    glBindVertexArray(trackVAO);
+    glGenBuffers(1, &trackVBO);
+    glBindBuffer(GL_ARRAY_BUFFER, trackVBO);
+    GraphingBufferElement placeholder;
+    glBufferData(GL_ARRAY_BUFFER, sizeof(GraphingBufferElement) * 1, &placeholder, GL_STATIC_DRAW);
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(GraphingBufferElement), nullptr);
+    glEnableVertexAttribArray(1);
+    glVertexAttribIPointer(1, 1, GL_UNSIGNED_INT, sizeof(GraphingBufferElement), (void*)(3 * sizeof(float)));
+
+    renderDataWasCreated = true;
+}
+
+void Renderer::createCoverArray()
+{
+    // covers can only be loaded once the playlist is complete, so the old array only has the placeholder
+    if(coverArrayHandle != 0)
+    {
+        glDeleteTextures(1, &defaultCoverHandle);
+        glDeleteTextures(1, &coverArrayHandle);
+    }
+    coverArrayFreeIndex = 1;
+    {
+        // decoded for the old cover table
+        std::lock_guard<std::mutex> lock(coverLoadQueueMutex);
+        while(!coverLoadQueue.empty())
+        {
+            if(coverLoadQueue.front().ownsData)
+            {
+                delete[] coverLoadQueue.front().data;
+            }
+            coverLoadQueue.pop();
+        }
+    }
 
     // init covers array & load placeholder Album cover
     glCreateTextures(GL_TEXTURE_2D_ARRAY, 1, &coverArrayHandle);
     glTextureParameteri(coverArrayHandle, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
     glTextureParameteri(coverArrayHandle, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
     // size() + 1 for the default icon
-    glTextureStorage3D(coverArrayHandle, 3, GL_RGB8, 64, 64, app.getCoverTable().size() + 1);
+    glTextureStorage3D(
+        coverArrayHandle, coverMipLevels, GL_RGB8, coverSize, coverSize, app.getCoverTable().size() + 1);
     // Load data of placeholder texture
     {
         int x, y, components;
-        data = stbi_load(MISC_PATH "/albumPlaceholder.jpg", &x, &y, &components, 3);
+        unsigned char* data = stbi_load(MISC_PATH "/albumPlaceholder.jpg", &x, &y, &components, 3);
+        std::vector<unsigned char> tile(coverTileBytes);
+        resampleCover(data, x, y, tile.data());
+        stbi_image_free(data);
         // Load into first layer of array
-        glTextureSubImage3D(coverArrayHandle, 0, 0, 0, 0, 64, 64, 1, GL_RGB, GL_UNSIGNED_BYTE, data);
+        uploadCoverTile(0, tile.data());
     }
-    glGenerateTextureMipmap(coverArrayHandle);
     // create image view to handle layer as indiv texture
-    GLuint defaultCoverHandle;
     glGenTextures(1, &defaultCoverHandle);
-    glTextureView(defaultCoverHandle, GL_TEXTURE_2D, coverArrayHandle, GL_RGB8, 0, 3, 0, 1);
-
-    stbi_image_free(data);
+    glTextureView(defaultCoverHandle, GL_TEXTURE_2D, coverArrayHandle, GL_RGB8, 0, coverMipLevels, 0, 1);
 
     CoverInfo defaultInfo = {.url = "", .layer = 0, .id = defaultCoverHandle};
     app.getCoverTable()[""] = defaultInfo;
@@ -371,23 +411,11 @@ void Renderer::createRenderData()
     {
         entry.second.id = defaultCoverHandle;
     }
-
-    glGenVertexArrays(1, &trackVAO);
-    glBindVertexArray(trackVAO);
-    glGenBuffers(1, &trackVBO);
-    glBindBuffer(GL_ARRAY_BUFFER, trackVBO);
-    GraphingBufferElement placeholder;
-    glBufferData(GL_ARRAY_BUFFER, sizeof(GraphingBufferElement) * 1, &placeholder, GL_STATIC_DRAW);
-    glEnableVertexAttribArray(0);
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(GraphingBufferElement), nullptr);
-    glEnableVertexAttribArray(1);
-    glVertexAttribIPointer(1, 1, GL_UNSIGNED_INT, sizeof(GraphingBufferElement), (void*)(3 * sizeof(float)));
-
-    renderDataWasCreated = true;
 }
 
 void Renderer::uploadGraphingData(const std::vector<GraphingBufferElement>& data)
 {
+    TIME_FRAME_PHASE(UploadGraphingData);
     glNamedBufferData(trackVBO, sizeof(data[0]) * data.size(), data.data(), GL_STATIC_DRAW);
     graphingDataCount = data.size();
 };
@@ -450,6 +478,7 @@ void Renderer::drawUI()
 
 void Renderer::draw3DGraph(float coverSize, glm::vec2& minMaxX, glm::vec2& minMaxY, glm::vec2& minMaxZ)
 {
+    TIME_FRAME_PHASE(Draw3DGraph);
     // todo: move this into camera code (some update() func)
     if(!ImGui::IsWindowHovered(ImGuiHoveredFlags_AnyWindow | ImGuiHoveredFlags_AllowWhenBlockedByPopup))
     {
@@ -600,6 +629,7 @@ Renderer::Ray Renderer::getMouseRay()
 
 bool Renderer::uploadAvailableCovers(int& progressTracker)
 {
+    TIME_FRAME_PHASE(UploadAvailableCovers);
     // upload new texture data if theyre ready
     // could limit to a max amount per frame to keep frametimes more stable
     if(coverLoadQueue.empty())
@@ -615,24 +645,45 @@ bool Renderer::uploadAvailableCovers(int& progressTracker)
         coverArrayFreeIndex += 1;
         tli.ptr->layer = layerToLoadInto;
 
-        assert(tli.x <= 64 && tli.y <= 64 && "Cover Image larger than texture array dimensions");
         assert(tli.data != nullptr && "Trying to upload freed data to the GPU?");
-        glTextureSubImage3D(
-            coverArrayHandle, 0, 0, 0, layerToLoadInto, tli.x, tli.y, 1, GL_RGB, GL_UNSIGNED_BYTE, tli.data);
+        uploadCoverTile(layerToLoadInto, tli.data);
 
         GLuint albumCoverHandle;
         glGenTextures(1, &albumCoverHandle);
-        glTextureView(albumCoverHandle, GL_TEXTURE_2D, coverArrayHandle, GL_RGB8, 0, 3, layerToLoadInto, 1);
+        glTextureView(
+            albumCoverHandle, GL_TEXTURE_2D, coverArrayHandle, GL_RGB8, 0, coverMipLevels, layerToLoadInto, 1);
         glTextureParameteri(albumCoverHandle, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
         glTextureParameteri(albumCoverHandle, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
 
-        stbi_image_free(tli.data);
+        if(tli.ownsData)
+        {
+            delete[] tli.data;
+        }
         // add entry to table
         tli.ptr->id = albumCoverHandle;
         progressTracker++;
     }
-    // generate new mipmaps now that new covers have been added
-    glGenerateTextureMipmap(coverArrayHandle);
 
     return true;
+}
+
+void Renderer::uploadCoverTile(GLuint layer, const unsigned char* tile)
+{
+    // the mip levels were already generated when the cover was decoded
+    for(int level = 0; level < coverMipLevels; level++)
+    {
+        const int size = getCoverMipSize(level);
+        glTextureSubImage3D(
+            coverArrayHandle,
+            level,
+            0,
+            0,
+            static_cast<GLint>(layer),
+            size,
+            size,
+            1,
+            GL_RGB,
+            GL_UNSIGNED_BYTE,
+            tile + getCoverMipOffset(level));
+    }
 }
\ No newline at end of file
@@ -52,6 +52,8 @@ class Renderer
     bool uploadAvailableCovers(int& progressTracker);
 
     void createRenderData();
+    // (re)creates the texture array sized to the current cover table, all covers get the placeholder again
+    void createCoverArray();
     bool renderDataWasCreated = false;
     void highlightWindow(const std::string& name);
 
@@ -75,8 +77,10 @@ class Renderer
 
     GLuint spotifyIconHandle;
 
-    GLuint coverArrayHandle;
+    GLuint coverArrayHandle = 0;
     GLuint coverArrayFreeIndex = 1;
+    // view of the placeholder layer, covers that werent loaded (yet) use this
+    GLuint defaultCoverHandle = 0;
     std::mutex coverLoadQueueMutex;
     std::queue<TextureLoadInfo> coverLoadQueue;
 
@@ -84,6 +88,9 @@ class Renderer
     uint32_t graphingDataCount = 0;
 
   private:
+    // all mip levels of a tile from CoverImage.hpp into the given layer of the cover array
+    void uploadCoverTile(GLuint layer, const unsigned char* tile);
+
     int FONT_SIZE = 14;
     float dpiScale = 1.0f;
 
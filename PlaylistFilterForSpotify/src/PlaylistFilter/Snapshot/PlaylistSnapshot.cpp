@@ -0,0 +1,440 @@
+#include "PlaylistSnapshot.hpp"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cassert>
+#include <cctype>
+#include <cstddef>
+#include <cstring>
+#include <fstream>
+#include <span>
+#include <type_traits>
+#include <unordered_map>
+
+#include <utils/MappedFile.hpp>
+
+// bump whenever anything about the layout changes
+static constexpr uint32_t snapshotVersion = 2;
+static constexpr std::array<char, 8> snapshotMagic = {'P', 'F', 'S', 'N', 'A', 'P', '\r', '\n'};
+// smallest amount of tracks a worker reads, less isnt worth the synchronization
+static constexpr uint32_t minTracksPerChunk = 4096;
+
+struct StringRef
+{
+    uint32_t offset = 0;
+    uint32_t length = 0;
+};
+
+struct TrackRecord
+{
+    StringRef id;
+    StringRef trackName;
+    StringRef artistsNames;
+    uint32_t albumIndex = 0;
+    std::array<float, Track::featureAmount> features{};
+};
+
+struct AlbumRecord
+{
+    StringRef id;
+    StringRef name;
+    StringRef coverUrl;
+};
+
+// array of count elements starting at offset
+struct Section
+{
+    uint64_t offset = 0;
+    uint64_t count = 0;
+};
+
+struct SnapshotHeader
+{
+    std::array<char, 8> magic;
+    uint32_t version;
+    // sizes of the structs, so changing them without bumping the version still doesnt load garbage
+    uint32_t headerSize;
+    uint32_t trackRecordSize;
+    uint32_t albumRecordSize;
+    uint64_t fileSize;
+
+    uint32_t trackCount;
+    uint32_t artistCount;
+    uint32_t genreCount;
+    uint32_t albumCount;
+    uint32_t pageSize;
+    uint32_t pageCount;
+    StringRef snapshotId;
+
+    Section tracks;
+    Section trackArtistOffsets;
+    Section trackArtists;
+    Section artistIds;
+    Section artistGenreOffsets;
+    Section artistGenres;
+    Section genreNames;
+    Section albums;
+    Section pageHashes;
+    Section strings;
+
+    // of everything after the header
+    uint64_t payloadChecksum;
+    // of the header up to this member
+    uint64_t headerChecksum;
+};
+// no padding, so the checksum over the raw bytes is well defined
+static_assert(std::has_unique_object_representations_v<SnapshotHeader>);
+static_assert(std::is_trivially_copyable_v<TrackRecord> && std::is_trivially_copyable_v<AlbumRecord>);
+
+// not cryptographic at all, only meant to catch truncated or otherwise corrupted files
+static uint64_t computeChecksum(const uint8_t* data, size_t size)
+{
+    constexpr uint64_t multiplier = 0x9E3779B97F4A7C15;
+    // a few independent lanes, so the multiplications dont all have to wait on each other
+    std::array<uint64_t, 4> lanes = {size, 1, 2, 3};
+    size_t i = 0;
+    for(; i + sizeof(lanes) <= size; i += sizeof(lanes))
+    {
+        for(size_t l = 0; l < lanes.size(); l++)
+        {
+            uint64_t word = 0;
+            std::memcpy(&word, data + i + l * sizeof(uint64_t), sizeof(uint64_t));
+            lanes[l] = (lanes[l] ^ word) * multiplier;
+            lanes[l] ^= lanes[l] >> 29;
+        }
+    }
+    uint64_t hash = lanes[0];
+    for(size_t l = 1; l < lanes.size(); l++)
+    {
+        hash = (hash ^ lanes[l]) * multiplier;
+        hash ^= hash >> 29;
+    }
+    for(; i < size; i++)
+    {
+        hash = (hash ^ data[i]) * multiplier;
+    }
+    return hash ^ (hash >> 32);
+}
+
+template <class T>
+static Section appendSection(std::vector<uint8_t>& buffer, std::span<const T> elements)
+{
+    buffer.resize((buffer.size() + 7) / 8 * 8, 0);
+    const Section section{buffer.size(), elements.size()};
+    const auto* bytes = reinterpret_cast<const uint8_t*>(elements.data());
+    buffer.insert(buffer.end(), bytes, bytes + elements.size_bytes());
+    return section;
+}
+
+// returns false if the section doesnt lie completely inside the file (or overlaps the header)
+template <class T>
+static bool getSection(const MappedFile& file, const Section& section, std::span<const T>& out)
+{
+    if(section.offset < sizeof(SnapshotHeader) || section.offset > file.getSize() ||
+       section.offset % alignof(T) != 0 || section.count > (file.getSize() - section.offset) / sizeof(T))
+    {
+        return false;
+    }
+    out = {reinterpret_cast<const T*>(file.data() + section.offset), static_cast<size_t>(section.count)};
+    return true;
+}
+
+// CSR offsets have to start at 0, never decrease and end at the number of indices
+static bool isValidAdjacency(
+    std::span<const uint32_t> offsets, std::span<const uint32_t> indices, uint32_t rowCount, uint32_t indexLimit)
+{
+    if(offsets.size() != rowCount + 1 || offsets[0] != 0 || offsets.back() != indices.size())
+    {
+        return false;
+    }
+    for(size_t i = 1; i < offsets.size(); i++)
+    {
+        if(offsets[i] < offsets[i - 1])
+        {
+            return false;
+        }
+    }
+    return std::all_of(indices.begin(), indices.end(), [&](uint32_t index) { return index < indexLimit; });
+}
+
+std::filesystem::path getPlaylistSnapshotPath(std::string_view playlistID)
+{
+    // ids are base62, but this comes from user input so dont let it point anywhere else
+    std::string fileName{playlistID};
+    for(char& c : fileName)
+    {
+        if(std::isalnum(static_cast<unsigned char>(c)) == 0)
+        {
+            c = '_';
+        }
+    }
+    return std::filesystem::path(CACHE_PATH) / "playlists" / (fileName + ".snapshot");
+}
+
+
+bool writePlaylistSnapshot(const std::filesystem::path& path, const PlaylistSource& source)
+{
+    std::string strings;
+    const auto addString = [&](std::string_view string)
+    {
+        assert(strings.size() + string.size() <= UINT32_MAX);
+        const StringRef ref{static_cast<uint32_t>(strings.size()), static_cast<uint32_t>(string.size())};
+        strings += string;
+        return ref;
+    };
+
+    // albums, artists and genres are only stored once and referenced by index
+    std::vector<AlbumRecord> albums;
+    std::unordered_map<std::string_view, uint32_t> albumIndices;
+    std::vector<StringRef> artistIdRefs;
+    std::unordered_map<std::string_view, uint32_t> artistIndices;
+    std::vector<uint32_t> artistGenreOffsets{0};
+    std::vector<uint32_t> artistGenres;
+    std::vector<StringRef> genreNameRefs;
+    std::unordered_map<std::string_view, uint32_t> genreIndices;
+
+    std::vector<TrackRecord> records(source.tracks.size());
+    std::vector<uint32_t> trackArtistOffsets{0};
+    std::vector<uint32_t> trackArtists;
+    for(uint32_t i = 0; i < source.tracks.size(); i++)
+    {
+        const TrackSource& track = source.tracks[i];
+        TrackRecord& record = records[i];
+        record.id = addString(track.id);
+        record.trackName = addString(track.name);
+        record.artistsNames = addString(track.artistsNames);
+        record.features = track.features;
+
+        const auto [albumIter, newAlbum] =
+            albumIndices.try_emplace(track.albumId, static_cast<uint32_t>(albums.size()));
+        if(newAlbum)
+        {
+            albums.push_back({addString(track.albumId), addString(track.albumName), addString(track.coverUrl)});
+        }
+        record.albumIndex = albumIter->second;
+
+        for(const std::string& artistId : track.artistIds)
+        {
+            const auto [artistIter, newArtist] =
+                artistIndices.try_emplace(artistId, static_cast<uint32_t>(artistIdRefs.size()));
+            if(newArtist)
+            {
+                artistIdRefs.push_back(addString(artistId));
+                const auto genresIter = source.artistGenres.find(artistId);
+                if(genresIter != source.artistGenres.end())
+                {
+                    for(const std::string& genreName : genresIter->second)
+                    {
+                        const auto [genreIter, newGenre] =
+                            genreIndices.try_emplace(genreName, static_cast<uint32_t>(genreNameRefs.size()));
+                        if(newGenre)
+                        {
+                            genreNameRefs.push_back(addString(genreName));
+                        }
+                        artistGenres.push_back(genreIter->second);
+                    }
+                }
+                artistGenreOffsets.push_back(static_cast<uint32_t>(artistGenres.size()));
+            }
+            trackArtists.push_back(artistIter->second);
+        }
+        trackArtistOffsets.push_back(static_cast<uint32_t>(trackArtists.size()));
+    }
+
+    SnapshotHeader header{};
+    header.magic = snapshotMagic;
+    header.version = snapshotVersion;
+    header.headerSize = sizeof(SnapshotHeader);
+    header.trackRecordSize = sizeof(TrackRecord);
+    header.albumRecordSize = sizeof(AlbumRecord);
+    header.trackCount = static_cast<uint32_t>(records.size());
+    header.artistCount = static_cast<uint32_t>(artistIdRefs.size());
+    header.genreCount = static_cast<uint32_t>(genreNameRefs.size());
+    header.albumCount = static_cast<uint32_t>(albums.size());
+    header.pageSize = PlaylistSource::pageSize;
+    header.pageCount = static_cast<uint32_t>(source.pageHashes.size());
+    header.snapshotId = addString(source.snapshotId);
+
+    std::vector<uint8_t> buffer(sizeof(SnapshotHeader), 0);
+    header.tracks = appendSection<TrackRecord>(buffer, records);
+    header.trackArtistOffsets = appendSection<uint32_t>(buffer, trackArtistOffsets);
+    header.trackArtists = appendSection<uint32_t>(buffer, trackArtists);
+    header.artistIds = appendSection<StringRef>(buffer, artistIdRefs);
+    header.artistGenreOffsets = appendSection<uint32_t>(buffer, artistGenreOffsets);
+    header.artistGenres = appendSection<uint32_t>(buffer, artistGenres);
+    header.genreNames = appendSection<StringRef>(buffer, genreNameRefs);
+    header.albums = appendSection<AlbumRecord>(buffer, albums);
+    header.pageHashes = appendSection<uint64_t>(buffer, source.pageHashes);
+    header.strings = appendSection<char>(buffer, strings);
+    buffer.resize((buffer.size() + 7) / 8 * 8, 0);
+    header.fileSize = buffer.size();
+
+    header.payloadChecksum =
+        computeChecksum(buffer.data() + sizeof(SnapshotHeader), buffer.size() - sizeof(SnapshotHeader));
+    header.headerChecksum =
+        computeChecksum(reinterpret_cast<const uint8_t*>(&header), offsetof(SnapshotHeader, headerChecksum));
+    std::memcpy(buffer.data(), &header, sizeof(SnapshotHeader));
+
+    // write to a temporary file first, so a crash while writing cant leave a half written snapshot behind
+    std::error_code error;
+    std::filesystem::create_directories(path.parent_path(), error);
+    std::filesystem::path tempPath = path;
+    tempPath += ".tmp";
+    {
+        std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+        file.write(reinterpret_cast<const char*>(buffer.data()), static_cast<std::streamsize>(buffer.size()));
+        file.close();
+        if(!file)
+        {
+            std::filesystem::remove(tempPath, error);
+            return false;
+        }
+    }
+    std::filesystem::rename(tempPath, path, error);
+    return !error;
+}
+
+std::optional<PlaylistSource> loadPlaylistSnapshot(const std::filesystem::path& path, ThreadPool* pool)
+{
+    const MappedFile file(path);
+    if(!file.isOpen() || file.getSize() < sizeof(SnapshotHeader))
+    {
+        return std::nullopt;
+    }
+    SnapshotHeader header;
+    std::memcpy(&header, file.data(), sizeof(SnapshotHeader));
+    if(header.magic != snapshotMagic || header.version != snapshotVersion ||
+       header.headerSize != sizeof(SnapshotHeader) || header.trackRecordSize != sizeof(TrackRecord) ||
+       header.albumRecordSize != sizeof(AlbumRecord) || header.fileSize != file.getSize() ||
+       header.pageSize != PlaylistSource::pageSize)
+    {
+        return std::nullopt;
+    }
+    if(header.headerChecksum !=
+           computeChecksum(reinterpret_cast<const uint8_t*>(&header), offsetof(SnapshotHeader, headerChecksum)) ||
+       header.payloadChecksum !=
+           computeChecksum(file.data() + sizeof(SnapshotHeader), file.getSize() - sizeof(SnapshotHeader)))
+    {
+        return std::nullopt;
+    }
+
+    std::span<const TrackRecord> trackRecords;
+    std::span<const uint32_t> trackArtistOffsets;
+    std::span<const uint32_t> trackArtists;
+    std::span<const StringRef> artistIdRefs;
+    std::span<const uint32_t> artistGenreOffsets;
+    std::span<const uint32_t> artistGenres;
+    std::span<const StringRef> genreNameRefs;
+    std::span<const AlbumRecord> albumRecords;
+    std::span<const uint64_t> pageHashes;
+    std::span<const char> stringPool;
+    if(!getSection(file, header.tracks, trackRecords) ||
+       !getSection(file, header.trackArtistOffsets, trackArtistOffsets) ||
+       !getSection(file, header.trackArtists, trackArtists) || !getSection(file, header.artistIds, artistIdRefs) ||
+       !getSection(file, header.artistGenreOffsets, artistGenreOffsets) ||
+       !getSection(file, header.artistGenres, artistGenres) ||
+       !getSection(file, header.genreNames, genreNameRefs) || !getSection(file, header.albums, albumRecords) ||
+       !getSection(file, header.pageHashes, pageHashes) || !getSection(file, header.strings, stringPool))
+    {
+        return std::nullopt;
+    }
+    const uint32_t trackCount = header.trackCount;
+    if(trackRecords.size() != trackCount || artistIdRefs.size() != header.artistCount ||
+       genreNameRefs.size() != header.genreCount || albumRecords.size() != header.albumCount ||
+       pageHashes.size() != header.pageCount ||
+       header.pageCount != (trackCount + PlaylistSource::pageSize - 1) / PlaylistSource::pageSize ||
+       !isValidAdjacency(trackArtistOffsets, trackArtists, trackCount, header.artistCount) ||
+       !isValidAdjacency(artistGenreOffsets, artistGenres, header.artistCount, header.genreCount))
+    {
+        return std::nullopt;
+    }
+
+    const std::string_view strings{stringPool.data(), stringPool.size()};
+    // tracks are read in parallel, any of them can find a broken reference
+    std::atomic<bool> stringsValid = true;
+    const auto getString = [&](StringRef ref) -> std::string
+    {
+        if(ref.offset > strings.size() || ref.length > strings.size() - ref.offset)
+        {
+            stringsValid.store(false, std::memory_order_relaxed);
+            return {};
+        }
+        return std::string{strings.substr(ref.offset, ref.length)};
+    };
+
+    PlaylistSource source;
+    source.snapshotId = getString(header.snapshotId);
+    source.pageHashes.assign(pageHashes.begin(), pageHashes.end());
+
+    std::vector<std::string> genreNames;
+    genreNames.reserve(header.genreCount);
+    for(const StringRef& ref : genreNameRefs)
+    {
+        genreNames.push_back(getString(ref));
+    }
+
+    std::vector<std::string> artistIds;
+    artistIds.reserve(header.artistCount);
+    source.artistGenres.reserve(header.artistCount);
+    for(uint32_t a = 0; a < header.artistCount; a++)
+    {
+        artistIds.push_back(getString(artistIdRefs[a]));
+        std::vector<std::string> genres;
+        genres.reserve(artistGenreOffsets[a + 1] - artistGenreOffsets[a]);
+        for(uint32_t j = artistGenreOffsets[a]; j < artistGenreOffsets[a + 1]; j++)
+        {
+            genres.push_back(genreNames[artistGenres[j]]);
+        }
+        if(!source.artistGenres.emplace(artistIds.back(), std::move(genres)).second)
+        {
+            return std::nullopt;
+        }
+    }
+
+    if(std::any_of(
+           trackRecords.begin(),
+           trackRecords.end(),
+           [&](const TrackRecord& record) { return record.albumIndex >= header.albumCount; }))
+    {
+        return std::nullopt;
+    }
+
+    // every track only reads its own record, so they can be split up freely
+    source.tracks.resize(trackCount);
+    const auto readTracks = [&](uint32_t /*chunk*/, uint32_t firstTrack, uint32_t lastTrack)
+    {
+        for(uint32_t i = firstTrack; i < lastTrack; i++)
+        {
+            const TrackRecord& record = trackRecords[i];
+            TrackSource& track = source.tracks[i];
+            track.id = getString(record.id);
+            track.name = getString(record.trackName);
+            track.artistsNames = getString(record.artistsNames);
+            track.features = record.features;
+            const AlbumRecord& album = albumRecords[record.albumIndex];
+            track.albumId = getString(album.id);
+            track.albumName = getString(album.name);
+            track.coverUrl = getString(album.coverUrl);
+
+            track.artistIds.reserve(trackArtistOffsets[i + 1] - trackArtistOffsets[i]);
+            for(uint32_t j = trackArtistOffsets[i]; j < trackArtistOffsets[i + 1]; j++)
+            {
+                track.artistIds.push_back(artistIds[trackArtists[j]]);
+            }
+        }
+    };
+    if(pool != nullptr)
+    {
+        pool->parallelFor(trackCount, minTracksPerChunk, readTracks);
+    }
+    else
+    {
+        readTracks(0, 0, trackCount);
+    }
+    if(!stringsValid)
+    {
+        return std::nullopt;
+    }
+    return source;
+}
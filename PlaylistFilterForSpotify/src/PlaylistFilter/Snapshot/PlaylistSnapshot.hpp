@@ -0,0 +1,35 @@
+#pragma once
+
+#include <filesystem>
+#include <optional>
+#include <string_view>
+
+#include <Spotify/PlaylistSource.hpp>
+#include <ThreadPool/ThreadPool.hpp>
+
+/*
+    Binary snapshot of everything downloaded for a playlist (the PlaylistSource), so opening the same playlist
+    again only has to download what changed since.
+    Layout (all offsets from the start of the file, every section 8 byte aligned):
+        header                  magic, version, snapshot id, element counts, the location of every section,
+                                checksums
+        track records           fixed size, names as offset+length into the string pool, album index, features
+        track -> artists        CSR: trackCount+1 offsets into a flat list of artist indices
+        artist ids              string refs
+        artist -> genres        CSR: artistCount+1 offsets into a flat list of genre indices
+        genre names             string refs
+        albums                  album id, name and cover url string refs
+        page hashes             hashTrackIds() of every page of tracks
+        string pool             all strings back to back, not null terminated
+    The file is memory mapped when loading, anything that doesnt match (version, size, checksums, out of bounds
+    references) just makes loading fail so the caller can fall back to the network.
+*/
+
+// where the snapshot of the given playlist is stored
+std::filesystem::path getPlaylistSnapshotPath(std::string_view playlistID);
+
+// returns false if the file couldnt be written, any previous snapshot is only replaced once the new one is done
+bool writePlaylistSnapshot(const std::filesystem::path& path, const PlaylistSource& source);
+
+// returns nullopt if there is no (valid) snapshot. The pool (if any) splits up reading the tracks
+std::optional<PlaylistSource> loadPlaylistSnapshot(const std::filesystem::path& path, ThreadPool* pool = nullptr);
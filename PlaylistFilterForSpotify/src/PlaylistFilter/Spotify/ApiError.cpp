@@ -3,4 +3,22 @@
 const char* UnknownApiError::what() const noexcept
 {
     return "An unknown api error has occured";
-}
\ No newline at end of file
+}
+
+ApiRequestError::ApiRequestError(long p_statusCode, const std::string& url)
+    : statusCode(p_statusCode),
+      message(
+          statusCode == 0 ? "Could not reach " + url
+                          : "Request to " + url + " failed with status " + std::to_string(statusCode))
+{
+}
+
+const char* ApiRequestError::what() const noexcept
+{
+    return message.c_str();
+}
+
+long ApiRequestError::getStatusCode() const
+{
+    return statusCode;
+}
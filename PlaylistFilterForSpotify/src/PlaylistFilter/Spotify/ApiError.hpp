@@ -1,8 +1,21 @@
 #pragma once
 
 #include <exception>
+#include <string>
 
 class UnknownApiError : public std::exception
 {
     const char* what() const noexcept final;
-};
\ No newline at end of file
+};
+// a request that still failed after all retries of the transport
+class ApiRequestError : public std::exception
+{
+  public:
+    ApiRequestError(long statusCode, const std::string& url);
+    const char* what() const noexcept final;
+    [[nodiscard]] long getStatusCode() const;
+
+  private:
+    long statusCode;
+    std::string message;
+};
@@ -1,12 +1,24 @@
 #include "ApiResponsesJSON.hpp"
 
+#include <algorithm>
+#include <cassert>
+#include <optional>
+
 ResponseTotal ResponseTotal::load(const std::string& text)
 {
     return daw::json::from_json<ResponseTotal>(text);
 }
-PlaylistTracksResponse PlaylistTracksResponse::load(const std::string& text)
+PlaylistInfoResponse PlaylistInfoResponse::load(const std::string& text)
+{
+    return daw::json::from_json<PlaylistInfoResponse>(text);
+}
+std::vector<TrackSource> PlaylistTracksResponse::load(const std::string& text)
 {
-    return daw::json::from_json<PlaylistTracksResponse>(text);
+    return daw::json::from_json_array<TrackSource>(text, "items");
+}
+PlaylistTrackIdsResponse PlaylistTrackIdsResponse::load(const std::string& text)
+{
+    return daw::json::from_json<PlaylistTrackIdsResponse>(text);
 }
 TracksFeaturesResponse TracksFeaturesResponse::load(const std::string& text)
 {
@@ -15,4 +27,148 @@ TracksFeaturesResponse TracksFeaturesResponse::load(const std::string& text)
 ArtistsResponse ArtistsResponse::load(const std::string& text)
 {
     return daw::json::from_json<ArtistsResponse>(text);
-}
\ No newline at end of file
+}
+static uint32_t readHex4(std::string_view hex)
+{
+    uint32_t value = 0;
+    for(const char c : hex.substr(0, 4))
+    {
+        value <<= 4;
+        if(c >= '0' && c <= '9')
+        {
+            value |= c - '0';
+        }
+        else if(c >= 'a' && c <= 'f')
+        {
+            value |= c - 'a' + 10;
+        }
+        else if(c >= 'A' && c <= 'F')
+        {
+            value |= c - 'A' + 10;
+        }
+    }
+    return value;
+}
+
+static void appendUtf8(std::string& out, uint32_t codepoint)
+{
+    if(codepoint < 0x80)
+    {
+        out += static_cast<char>(codepoint);
+    }
+    else if(codepoint < 0x800)
+    {
+        out += static_cast<char>(0xC0 | (codepoint >> 6));
+        out += static_cast<char>(0x80 | (codepoint & 0x3F));
+    }
+    else if(codepoint < 0x10000)
+    {
+        out += static_cast<char>(0xE0 | (codepoint >> 12));
+        out += static_cast<char>(0x80 | ((codepoint >> 6) & 0x3F));
+        out += static_cast<char>(0x80 | (codepoint & 0x3F));
+    }
+    else
+    {
+        out += static_cast<char>(0xF0 | (codepoint >> 18));
+        out += static_cast<char>(0x80 | ((codepoint >> 12) & 0x3F));
+        out += static_cast<char>(0x80 | ((codepoint >> 6) & 0x3F));
+        out += static_cast<char>(0x80 | (codepoint & 0x3F));
+    }
+}
+
+// the raw string from the json, spotify only escapes quotes and backslashes in practice so this is rarely needed
+static void appendUnescaped(std::string& out, std::string_view raw)
+{
+    size_t escape = raw.find('\\');
+    if(escape == std::string_view::npos)
+    {
+        out += raw;
+        return;
+    }
+
+    out.reserve(out.size() + raw.size());
+    while(escape != std::string_view::npos && escape + 1 < raw.size())
+    {
+        out += raw.substr(0, escape);
+        const char type = raw[escape + 1];
+        raw.remove_prefix(escape + 2);
+        switch(type)
+        {
+        case 'b':
+            out += '\b';
+            break;
+        case 'f':
+            out += '\f';
+            break;
+        case 'n':
+            out += '\n';
+            break;
+        case 'r':
+            out += '\r';
+            break;
+        case 't':
+            out += '\t';
+            break;
+        case 'u':
+        {
+            uint32_t codepoint = readHex4(raw);
+            raw.remove_prefix(std::min<size_t>(4, raw.size()));
+            // characters outside the BMP come as a surrogate pair
+            if(codepoint >= 0xD800 && codepoint < 0xDC00 && raw.size() >= 6 && raw[0] == '\\' && raw[1] == 'u')
+            {
+                const uint32_t low = readHex4(raw.substr(2));
+                if(low >= 0xDC00 && low < 0xE000)
+                {
+                    codepoint = 0x10000 + ((codepoint - 0xD800) << 10) + (low - 0xDC00);
+                    raw.remove_prefix(6);
+                }
+            }
+            appendUtf8(out, codepoint);
+            break;
+        }
+        default:
+            // quote, backslash and slash stand for themselves
+            out += type;
+            break;
+        }
+        escape = raw.find('\\');
+    }
+    out += raw;
+}
+
+TrackSource TrackSourceConstructor::operator()(const TrackView& trackView) const
+{
+    TrackSource track;
+    track.id = trackView.id;
+    assert(track.id.length() == 22);
+    appendUnescaped(track.name, trackView.name);
+
+    for(const auto& artistItem : trackView.artists)
+    {
+        const auto artist = daw::json::from_json<ArtistView>(artistItem.value);
+        if(!track.artistIds.empty())
+        {
+            track.artistsNames += ", ";
+        }
+        appendUnescaped(track.artistsNames, artist.name);
+        assert(artist.id.size() == 22);
+        track.artistIds.emplace_back(artist.id);
+    }
+
+    track.albumId = trackView.album.id;
+    assert(track.albumId.size() == 22);
+    appendUnescaped(track.albumName, trackView.album.name);
+    // smallest image is last, the ones before are skipped without parsing them
+    std::optional<daw::json::json_value> smallestImage;
+    for(const auto& imageItem : trackView.album.images)
+    {
+        smallestImage = imageItem.value;
+    }
+    if(smallestImage)
+    {
+        track.coverUrl = daw::json::from_json<ImageView>(*smallestImage).url;
+    }
+
+    track.features[8] = static_cast<float>(trackView.popularity) / 100.f;
+    return track;
+}
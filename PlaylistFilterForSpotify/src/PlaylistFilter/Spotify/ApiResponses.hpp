@@ -12,49 +12,46 @@ struct ResponseTotal
     static ResponseTotal load(const std::string& text);
 };
 
-// ----
-
-struct ImageResponse
+struct PlaylistInfoResponse
 {
-    uint32_t height;
-    uint32_t width;
-    std::string url;
-};
+    // changes whenever the playlist is edited
+    std::string snapshotId;
+    ResponseTotal tracks;
 
-struct AlbumResponse
-{
-    std::string id;
-    std::vector<ImageResponse> images;
-    std::string name;
+    static PlaylistInfoResponse load(const std::string& text);
 };
 
-struct ArtistResponse
+// ----
+
+struct TrackSource;
+
+/*
+    A page of playlist tracks, parsed straight into TrackSources without building response objects first.
+    Ids are read as views into the text, of the cover images only the one that is used (the smallest) is read
+    and the artists are walked instead of collected, so the strings a TrackSource keeps are the only allocations
+*/
+struct PlaylistTracksResponse
 {
-    std::string id;
-    std::string name;
+    // todo: items could also be episodes, see API docs
+    static std::vector<TrackSource> load(const std::string& text);
 };
 
-struct TrackResponse
+// only the ids of a page of playlist tracks, to find out what changed
+struct TrackIdResponse
 {
-    AlbumResponse album;
-    std::vector<ArtistResponse> artists;
     std::string id;
-    std::string name;
-    uint32_t popularity;
 };
 
-struct PlaylistElementResponse
+struct PlaylistTrackIdElementResponse
 {
-    TrackResponse track;
-    // todo: could also be an episode, see API docs
+    TrackIdResponse track;
 };
 
-struct PlaylistTracksResponse
+struct PlaylistTrackIdsResponse
 {
-    std::vector<PlaylistElementResponse> items;
-    std::optional<std::string> next;
+    std::vector<PlaylistTrackIdElementResponse> items;
 
-    static PlaylistTracksResponse load(const std::string& text);
+    static PlaylistTrackIdsResponse load(const std::string& text);
 };
 
 // ----
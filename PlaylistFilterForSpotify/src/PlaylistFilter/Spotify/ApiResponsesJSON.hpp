@@ -2,6 +2,9 @@
 
 #include "ApiResponses.hpp"
 #include "Spotify/ApiResponses.hpp"
+#include "Spotify/PlaylistSource.hpp"
+
+#include <string_view>
 
 #include <daw/json/daw_json_link.h>
 
@@ -16,57 +19,111 @@ JSONType(ResponseTotal)
         >;
 };
 
+JSONType(PlaylistInfoResponse)
+{
+    using type = json_member_list<          //
+        json_string<"snapshot_id">,         //
+        json_class<"tracks", ResponseTotal> //
+        >;
+};
+
 // ----
 
-JSONType(ImageResponse)
+// views into the text of a tracks page, names are still escaped
+struct ImageView
+{
+    std::string_view url;
+};
+
+struct ArtistView
+{
+    std::string_view id;
+    std::string_view name;
+};
+
+struct AlbumView
+{
+    std::string_view id;
+    daw::json::json_value images;
+    std::string_view name;
+};
+
+struct TrackView
 {
-    using type = json_member_list<       //
-        json_number<"height", uint32_t>, //
-        json_number<"width", uint32_t>,  //
-        json_string<"url">               //
+    AlbumView album;
+    daw::json::json_value artists;
+    std::string_view id;
+    std::string_view name;
+    uint32_t popularity;
+};
+
+struct TrackSourceConstructor
+{
+    TrackSource operator()(const TrackView& track) const;
+};
+
+JSONType(ImageView)
+{
+    using type = json_member_list<               //
+        json_string_raw<"url", std::string_view> //
         >;
 };
 
-JSONType(AlbumResponse)
+JSONType(ArtistView)
 {
-    using type = json_member_list<           //
-        json_string<"id">,                   //
-        json_array<"images", ImageResponse>, //
-        json_string<"name">                  //
+    using type = json_member_list<                //
+        json_string_raw<"id", std::string_view>,  //
+        json_string_raw<"name", std::string_view> //
         >;
 };
 
-JSONType(ArtistResponse)
+JSONType(AlbumView)
 {
-    using type = json_member_list< //
-        json_string<"id">,         //
-        json_string<"name">        //
+    using type = json_member_list<                //
+        json_string_raw<"id", std::string_view>,  //
+        json_raw<"images">,                       //
+        json_string_raw<"name", std::string_view> //
         >;
 };
 
-JSONType(TrackResponse)
+JSONType(TrackView)
 {
-    using type = json_member_list<             //
-        json_class<"album", AlbumResponse>,    //
-        json_array<"artists", ArtistResponse>, //
-        json_string<"id">,                     //
-        json_string<"name">,                   //
-        json_number<"popularity", uint32_t>    //
+    using type = json_member_list<                 //
+        json_class<"album", AlbumView>,            //
+        json_raw<"artists">,                       //
+        json_string_raw<"id", std::string_view>,   //
+        json_string_raw<"name", std::string_view>, //
+        json_number<"popularity", uint32_t>        //
         >;
 };
 
-JSONType(PlaylistElementResponse)
+// an item of the page, built from its track
+JSONType(TrackSource)
 {
-    using type = json_member_list<         //
-        json_class<"track", TrackResponse> //
+    using constructor_t = TrackSourceConstructor;
+    using type = json_member_list<     //
+        json_class<"track", TrackView> //
+        >;
+};
+
+JSONType(TrackIdResponse)
+{
+    using type = json_member_list< //
+        json_string<"id">          //
+        >;
+};
+
+JSONType(PlaylistTrackIdElementResponse)
+{
+    using type = json_member_list<           //
+        json_class<"track", TrackIdResponse> //
         >;
 };
 
-JSONType(PlaylistTracksResponse)
+JSONType(PlaylistTrackIdsResponse)
 {
-    using type = json_member_list<                    //
-        json_array<"items", PlaylistElementResponse>, //
-        json_string_null<"next">                      //
+    using type = json_member_list<                          //
+        json_array<"items", PlaylistTrackIdElementResponse> //
         >;
 };
 
@@ -0,0 +1,240 @@
+#include "PlaylistSource.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <numeric>
+#include <span>
+
+// a multiple of the bitset words, so chunks never write to the same word of the genre bitsets
+static constexpr uint32_t minTracksPerChunk = 64 * DynBitset::bitsPerWord;
+
+// func(chunk, firstTrack, lastTrack) on the pool if there is one, otherwise on the calling thread
+static void forTrackChunks(ThreadPool* pool, uint32_t trackCount, const ThreadPool::ChunkFunc& func)
+{
+    if(pool != nullptr)
+    {
+        pool->parallelFor(trackCount, minTracksPerChunk, func);
+    }
+    else
+    {
+        func(0, 0, trackCount);
+    }
+}
+
+uint64_t hashTrackIds(const std::vector<std::string_view>& ids)
+{
+    // FNV-1a, the separator keeps ["ab", "c"] and ["a", "bc"] apart
+    uint64_t hash = 0xCBF29CE484222325;
+    for(const std::string_view id : ids)
+    {
+        for(const char c : id)
+        {
+            hash = (hash ^ static_cast<uint8_t>(c)) * 0x100000001B3;
+        }
+        hash = (hash ^ ',') * 0x100000001B3;
+    }
+    return hash;
+}
+
+void PlaylistSource::updatePageHashes()
+{
+    pageHashes.clear();
+    std::vector<std::string_view> ids;
+    for(size_t pageStart = 0; pageStart < tracks.size(); pageStart += pageSize)
+    {
+        ids.clear();
+        const size_t pageEnd = std::min(pageStart + pageSize, tracks.size());
+        for(size_t i = pageStart; i < pageEnd; i++)
+        {
+            ids.emplace_back(tracks[i].id);
+        }
+        pageHashes.push_back(hashTrackIds(ids));
+    }
+}
+
+Track makeTrack(const TrackSource& source, uint32_t index, bool decodeNames)
+{
+    Track track;
+    track.index = static_cast<int>(index);
+    track.id = source.id;
+    track.trackNameEncoded = source.name;
+    track.artistsNamesEncoded = source.artistsNames;
+    track.albumId = source.albumId;
+    track.albumNameEncoded = source.albumName;
+    if(decodeNames)
+    {
+        track.decodeNames();
+    }
+    return track;
+}
+
+SpotifyApiAccess::PlaylistData_t
+buildPlaylistData(const PlaylistSource& source, ThreadPool* pool, PlaylistBuildMode mode)
+{
+    using GenreName = SpotifyApiAccess::GenreName;
+    const auto trackCount = static_cast<uint32_t>(source.tracks.size());
+    const bool full = mode == PlaylistBuildMode::Full;
+
+    std::vector<Track> tracks(trackCount);
+    FeatureStore features{trackCount};
+    // copying the strings and decoding the names only depends on the track itself
+    forTrackChunks(
+        pool,
+        trackCount,
+        [&](uint32_t /*chunk*/, uint32_t firstTrack, uint32_t lastTrack)
+        {
+            for(uint32_t i = firstTrack; i < lastTrack; i++)
+            {
+                tracks[i] = makeTrack(source.tracks[i], i, full);
+                for(int f = 0; f < Track::featureAmount; f++)
+                {
+                    features.set(f, i, source.tracks[i].features[f]);
+                }
+            }
+        });
+
+    // artists and genres are indexed in order of their first appearance, so the same source always builds the
+    // same tables (no matter in which order the api answered)
+    SpotifyApiAccess::CoverTable_t coverTable;
+    std::vector<SpotifyApiAccess::ArtistID> artistIds;
+    SpotifyApiAccess::ArtistIndexLUT_t artistIdToIndex;
+    // the artists of track i are trackArtists[trackArtistOffsets[i], trackArtistOffsets[i + 1])
+    std::vector<uint32_t> trackArtistOffsets(trackCount + 1, 0);
+    std::vector<uint32_t> trackArtists;
+    trackArtists.reserve(trackCount);
+
+    std::vector<const GenreName*> genreNames;
+    std::unordered_map<std::string_view, uint32_t> genreNameToIndex;
+    std::vector<std::vector<uint32_t>> perArtistGenreIndices;
+
+    for(uint32_t i = 0; i < trackCount; i++)
+    {
+        const TrackSource& trackSource = source.tracks[i];
+
+        // create and/or link to album table, most albums have more than one track so only copy on insertion
+        if(full)
+        {
+            const auto [coverIter, inserted] = coverTable.try_emplace(trackSource.albumId);
+            if(inserted)
+            {
+                coverIter->second = CoverInfo{
+                    .albumId = trackSource.albumId, .url = trackSource.coverUrl, .layer = 0, .id = 0xFFFFFFFFu};
+            }
+            tracks[i].coverInfoPtr = &coverIter->second;
+        }
+
+        for(const std::string& artistId : trackSource.artistIds)
+        {
+            const auto [artistIter, newArtist] =
+                artistIdToIndex.try_emplace(artistId, static_cast<uint32_t>(artistIds.size()));
+            if(newArtist)
+            {
+                artistIds.push_back(artistId);
+                auto& genreIndices = perArtistGenreIndices.emplace_back();
+                const auto genresIter = source.artistGenres.find(artistId);
+                // every artist should have been requested, but dont fail over a missing one
+                assert(genresIter != source.artistGenres.end());
+                if(genresIter != source.artistGenres.end())
+                {
+                    for(const GenreName& genreName : genresIter->second)
+                    {
+                        const auto [genreIter, newGenre] =
+                            genreNameToIndex.try_emplace(genreName, static_cast<uint32_t>(genreNames.size()));
+                        if(newGenre)
+                        {
+                            genreNames.push_back(&genreName);
+                        }
+                        genreIndices.push_back(genreIter->second);
+                    }
+                }
+            }
+            trackArtists.push_back(artistIter->second);
+        }
+        trackArtistOffsets[i + 1] = static_cast<uint32_t>(trackArtists.size());
+    }
+    const auto getTrackArtists = [&](uint32_t track)
+    {
+        return std::span<const uint32_t>(
+            trackArtists.data() + trackArtistOffsets[track], trackArtists.data() + trackArtistOffsets[track + 1]);
+    };
+
+    // build the inverted index (genre -> tracks) first, the genres are then sorted by how many tracks they have
+    const auto genreCount = static_cast<uint32_t>(genreNames.size());
+    std::vector<DynBitset> unsortedGenreTracks(genreCount, DynBitset{trackCount});
+    forTrackChunks(
+        pool,
+        trackCount,
+        [&](uint32_t /*chunk*/, uint32_t firstTrack, uint32_t lastTrack)
+        {
+            for(uint32_t i = firstTrack; i < lastTrack; i++)
+            {
+                for(const uint32_t artistIndex : getTrackArtists(i))
+                {
+                    for(const uint32_t genreIndex : perArtistGenreIndices[artistIndex])
+                    {
+                        unsortedGenreTracks[genreIndex].setBit(i);
+                    }
+                }
+            }
+        });
+    std::vector<uint32_t> occurances(genreCount);
+    for(uint32_t g = 0; g < genreCount; g++)
+    {
+        occurances[g] = unsortedGenreTracks[g].popcount();
+    }
+    // stable, so genres with the same amount of tracks stay in order of appearance
+    std::vector<uint32_t> sortedToUnsorted(genreCount);
+    std::iota(sortedToUnsorted.begin(), sortedToUnsorted.end(), 0);
+    std::stable_sort(
+        sortedToUnsorted.begin(),
+        sortedToUnsorted.end(),
+        [&](uint32_t lhs, uint32_t rhs) { return occurances[lhs] > occurances[rhs]; });
+    std::vector<uint32_t> unsortedToSorted(genreCount);
+    for(uint32_t s = 0; s < genreCount; s++)
+    {
+        unsortedToSorted[sortedToUnsorted[s]] = s;
+    }
+
+    const auto artistCount = static_cast<uint32_t>(artistIds.size());
+    // TrackFilter doesnt need the masks, it works with the tracks of every genre
+    if(full)
+    {
+        forTrackChunks(
+            pool,
+            trackCount,
+            [&](uint32_t /*chunk*/, uint32_t firstTrack, uint32_t lastTrack)
+            {
+                for(uint32_t i = firstTrack; i < lastTrack; i++)
+                {
+                    Track& track = tracks[i];
+                    track.genreMask = CompressedBitset{genreCount};
+                    track.artistMask = CompressedBitset{artistCount};
+                    for(const uint32_t artistIndex : getTrackArtists(i))
+                    {
+                        track.artistMask.setBit(artistIndex);
+                        for(const uint32_t genreIndex : perArtistGenreIndices[artistIndex])
+                        {
+                            track.genreMask.setBit(unsortedToSorted[genreIndex]);
+                        }
+                    }
+                }
+            });
+    }
+
+    std::vector<GenreName> sortedGenres(genreCount);
+    std::vector<DynBitset> genreTracks(genreCount);
+    for(uint32_t s = 0; s < genreCount; s++)
+    {
+        sortedGenres[s] = *genreNames[sortedToUnsorted[s]];
+        genreTracks[s] = std::move(unsortedGenreTracks[sortedToUnsorted[s]]);
+    }
+
+    return std::make_tuple(
+        std::move(tracks),
+        std::move(features),
+        std::move(coverTable),
+        std::move(sortedGenres),
+        std::move(genreTracks),
+        std::move(artistIds),
+        std::move(artistIdToIndex));
+}
@@ -0,0 +1,81 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include <CommonStructs/CommonStructs.hpp>
+#include <Spotify/SpotifyApiAccess.hpp>
+#include <ThreadPool/ThreadPool.hpp>
+#include <Track/Track.hpp>
+
+// a track as the api returns it, before any of the playlist wide tables (artists, genres, covers) exist
+struct TrackSource
+{
+    std::string id;
+    std::string name;
+    // names of all artists joined by ", "
+    std::string artistsNames;
+    // in the order the api lists them
+    std::vector<std::string> artistIds;
+    std::string albumId;
+    std::string albumName;
+    std::string coverUrl;
+    std::array<float, Track::featureAmount> features{};
+};
+
+/*
+    Everything that is downloaded for a playlist, in a form that can be patched when the playlist changes
+    (tracks are looked up by their id, not their position) and stored in a snapshot.
+    buildPlaylistData() turns it into the tables the app works with.
+*/
+struct PlaylistSource
+{
+    // tracks are requested in pages of this many
+    static constexpr uint32_t pageSize = 50;
+    using ArtistGenres_t = std::unordered_map<
+        SpotifyApiAccess::ArtistID,
+        std::vector<SpotifyApiAccess::GenreName>,
+        StringHash,
+        std::equal_to<>>;
+
+    // spotify changes this whenever the playlist is edited
+    std::string snapshotId;
+    std::vector<TrackSource> tracks;
+    // genres of every artist in the playlist
+    ArtistGenres_t artistGenres;
+    // hashTrackIds() of the ids of every page of tracks, in playlist order
+    std::vector<uint64_t> pageHashes;
+
+    void updatePageHashes();
+};
+
+// hash of the track ids of a page, so pages that didnt change can be recognized without comparing all ids
+uint64_t hashTrackIds(const std::vector<std::string_view>& ids);
+
+// the Track at the given index, without any of the playlist wide tables (cover, genre and artist masks)
+// the wide names are only needed to show them, without decodeNames they stay empty
+Track makeTrack(const TrackSource& source, uint32_t index, bool decodeNames = true);
+
+enum class PlaylistBuildMode
+{
+    // everything the app shows
+    Full,
+    /*
+        Only what TrackFilter needs and the names, ie. to filter without a ui. Leaves out the wide names, the cover
+        table (coverInfoPtr stays nullptr) and the genre and artist masks of the tracks
+    */
+    FilterOnly
+};
+
+/*
+    Builds the tracks and all the tables around them (features, covers, genres sorted by how many tracks have
+    them and the tracks of every genre, artists)
+    The pool (if any) splits up the work per track, only indexing the artists and genres stays on the calling
+    thread. The tables are the same no matter how many threads the pool has
+*/
+SpotifyApiAccess::PlaylistData_t buildPlaylistData(
+    const PlaylistSource& source, ThreadPool* pool = nullptr, PlaylistBuildMode mode = PlaylistBuildMode::Full);
@@ -0,0 +1,83 @@
+#include "PlaylistStream.hpp"
+
+#include <algorithm>
+
+void LoadProgress::startPhase(Phase newPhase, uint32_t stepCount)
+{
+    done = 0;
+    total = stepCount;
+    phase = newPhase;
+}
+
+float LoadProgress::getFraction() const
+{
+    const uint32_t stepCount = total;
+    if(stepCount == 0)
+    {
+        return 0.0f;
+    }
+    // both are read separately, could be from different phases for a moment
+    return std::min(static_cast<float>(done) / static_cast<float>(stepCount), 1.0f);
+}
+
+const char* LoadProgress::getLabel() const
+{
+    switch(phase.load())
+    {
+    case Phase::ReadingCache:
+        return "Reading cached playlist";
+    case Phase::CheckingChanges:
+        return "Checking for changes";
+    case Phase::DownloadingTracks:
+        return "Downloading track data";
+    case Phase::DownloadingDetails:
+        return "Retrieving audio features & genres";
+    case Phase::Analyzing:
+        return "Analyzing genres";
+    }
+    return "";
+}
+
+void PlaylistStream::setExpectedTrackCount(uint32_t count)
+{
+    expectedTrackCount = count;
+}
+
+uint32_t PlaylistStream::getExpectedTrackCount() const
+{
+    return expectedTrackCount;
+}
+
+void PlaylistStream::publishTracks(std::span<const TrackSource> tracks)
+{
+    std::lock_guard lock(mutex);
+    pending.tracks.insert(pending.tracks.end(), tracks.begin(), tracks.end());
+    updated = true;
+}
+
+void PlaylistStream::publishFeatures(uint32_t trackIndex, const std::array<float, Track::featureAmount>& features)
+{
+    std::lock_guard lock(mutex);
+    pending.features.emplace_back(trackIndex, features);
+    updated = true;
+}
+
+void PlaylistStream::publishArtistGenres(
+    std::string_view artistId, const std::vector<SpotifyApiAccess::GenreName>& genres)
+{
+    std::lock_guard lock(mutex);
+    pending.artistGenres.insert_or_assign(std::string(artistId), genres);
+    updated = true;
+}
+
+bool PlaylistStream::hasUpdate() const
+{
+    return updated;
+}
+
+PlaylistStream::Update PlaylistStream::take()
+{
+    std::lock_guard lock(mutex);
+    updated = false;
+    return std::exchange(pending, {});
+}
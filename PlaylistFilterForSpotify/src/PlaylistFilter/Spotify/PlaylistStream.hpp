@@ -0,0 +1,76 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <span>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include <Spotify/PlaylistSource.hpp>
+#include <Track/Track.hpp>
+
+// how far loading a playlist got, written by the loading thread and read by the ui every frame
+struct LoadProgress
+{
+    enum class Phase : uint8_t
+    {
+        ReadingCache,
+        CheckingChanges,
+        DownloadingTracks,
+        // audio features and genres
+        DownloadingDetails,
+        Analyzing
+    };
+
+    std::atomic<Phase> phase = Phase::ReadingCache;
+    // steps of the current phase
+    std::atomic<uint32_t> done = 0;
+    std::atomic<uint32_t> total = 0;
+
+    void startPhase(Phase newPhase, uint32_t stepCount);
+    // of the current phase, 0 if it has no steps
+    [[nodiscard]] float getFraction() const;
+    [[nodiscard]] const char* getLabel() const;
+};
+
+/*
+    Hands a playlist from the loading thread to the ui while it is still downloading, so it can already be shown
+    and filtered. Tracks are only ever appended, in playlist order. Their audio features and the genres of their
+    artists follow whenever the requests for them are answered.
+    The ui takes everything that was published since it last looked.
+*/
+class PlaylistStream
+{
+  public:
+    struct Update
+    {
+        // follow the tracks of all updates taken before
+        std::vector<TrackSource> tracks;
+        // (track index, all features) of tracks of this or an earlier update
+        std::vector<std::pair<uint32_t, std::array<float, Track::featureAmount>>> features;
+        PlaylistSource::ArtistGenres_t artistGenres;
+    };
+
+    // how many tracks the playlist had when the download started, it could still change while downloading
+    void setExpectedTrackCount(uint32_t count);
+    [[nodiscard]] uint32_t getExpectedTrackCount() const;
+
+    void publishTracks(std::span<const TrackSource> tracks);
+    void publishFeatures(uint32_t trackIndex, const std::array<float, Track::featureAmount>& features);
+    void publishArtistGenres(
+        std::string_view artistId, const std::vector<SpotifyApiAccess::GenreName>& genres);
+
+    // cheap enough to check every frame
+    [[nodiscard]] bool hasUpdate() const;
+    Update take();
+
+  private:
+    std::atomic<uint32_t> expectedTrackCount = 0;
+    std::atomic<bool> updated = false;
+
+    std::mutex mutex;
+    Update pending;
+};
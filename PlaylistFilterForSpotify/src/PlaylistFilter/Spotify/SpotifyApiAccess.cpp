@@ -3,6 +3,8 @@
 #include "ApiResponses.hpp"
 #include "Spotify/ApiResponses.hpp"
 #include "Spotify/SpotifyApiAccess.hpp"
+#include "Spotify/PlaylistSource.hpp"
+#include "Spotify/PlaylistStream.hpp"
 #include "secrets.hpp"
 #include <CommonStructs/CommonStructs.hpp>
 #include <DynamicBitset/DynamicBitset.hpp>
@@ -13,7 +15,9 @@
 #include <cpr/payload.h>
 #include <cpr/response.h>
 #include <cpr/session.h>
+#include <cstdlib>
 #include <execution>
+#include <numeric>
 #include <string>
 #include <string_view>
 #include <thread>
@@ -26,10 +30,42 @@
 #include <cryptopp/osrng.h>
 #include <cryptopp/sha.h>
 
-SpotifyApiAccess::SpotifyApiAccess()
+SpotifyApiAccess::SpotifyApiAccess(
+    std::string apiUrl, std::string accountsUrl, RateLimit rateLimit, uint32_t maxInFlight, bool reuseConnections)
+    : apiUrl(std::move(apiUrl)), accountsUrl(std::move(accountsUrl)),
+      transport(maxInFlight, rateLimit, RetryPolicy{}, reuseConnections)
 {
 }
 
+std::string SpotifyApiAccess::defaultApiUrl()
+{
+    // NOLINTNEXTLINE(concurrency-mt-unsafe) only read once at startup
+    const char* env = std::getenv("PLAYLISTFILTER_API_URL");
+    return env != nullptr ? env : "https://api.spotify.com/v1";
+}
+
+std::string SpotifyApiAccess::defaultAccountsUrl()
+{
+    // NOLINTNEXTLINE(concurrency-mt-unsafe) only read once at startup
+    const char* env = std::getenv("PLAYLISTFILTER_ACCOUNTS_URL");
+    return env != nullptr ? env : "https://accounts.spotify.com";
+}
+
+const HttpTransport& SpotifyApiAccess::getTransport() const
+{
+    return transport;
+}
+
+void SpotifyApiAccess::setPipelining(bool enabled)
+{
+    pipelineRequests = enabled;
+}
+
+cpr::Header SpotifyApiAccess::getApiHeader() const
+{
+    return cpr::Header{{"Content-Type", "application/json"}, {"Authorization", "Bearer " + access_token}};
+}
+
 std::string SpotifyApiAccess::getAuthURL()
 {
     CryptoPP::AutoSeededRandomPool rng;
@@ -62,7 +98,7 @@ std::string SpotifyApiAccess::getAuthURL()
     code_challenge.resize(encoder.MaxRetrievable());
     encoder.Get(reinterpret_cast<CryptoPP::byte*>(&code_challenge[0]), code_challenge.size());
 
-    return "https://accounts.spotify.com/authorize?" +                                         //
+    return accountsUrl + "/authorize?" +                                                       //
            ("client_id=" + clientID +                                                          //
             "&response_type=code" +                                                            //
             "&redirect_uri=" + encodedRedirectURL +                                            //
@@ -82,16 +118,17 @@ bool SpotifyApiAccess::checkAuth(const std::string& p_state, const std::string&
         return false;
     }
 
-    std::string query = "https://accounts.spotify.com/api/token";
-    cpr::Response r = cpr::Post(
-        cpr::Url(query),
-        cpr::Payload{
-            {"grant_type", "authorization_code"},
-            {"code", code},
-            {"redirect_uri", redirectURL},
-            {"client_id", clientID},
-            {"code_verifier", code_verifier}},
-        cpr::Header{{"Authorization", "Basic " + base64}});
+    std::string query = accountsUrl + "/api/token";
+    cpr::Response r = transport.send(
+        {.method = HttpTransport::Method::Post,
+         .url = query,
+         .header = cpr::Header{{"Authorization", "Basic " + base64}},
+         .payload = cpr::Payload{
+             {"grant_type", "authorization_code"},
+             {"code", code},
+             {"redirect_uri", redirectURL},
+             {"client_id", clientID},
+             {"code_verifier", code_verifier}}});
     if(r.status_code != 200)
     {
         std::cout << r.text << std::endl;
@@ -106,9 +143,39 @@ bool SpotifyApiAccess::checkAuth(const std::string& p_state, const std::string&
     refresh_token = r_json["refresh_token"].get<std::string>();
 
     // get user id
-    r = cpr::Get(
-        cpr::Url("https://api.spotify.com/v1/me"),
-        cpr::Header{{"Content-Type", "application/json"}, {"Authorization", "Bearer " + access_token}});
+    r = transport.get(apiUrl + "/me", getApiHeader());
+    r_json = json::parse(r.text);
+    userId = r_json["id"].get<std::string>();
+
+    return true;
+}
+
+bool SpotifyApiAccess::authorizeWithRefreshToken(const std::string& token)
+{
+    const std::string query = accountsUrl + "/api/token";
+    cpr::Response r = transport.send(
+        {.method = HttpTransport::Method::Post,
+         .url = query,
+         .header = cpr::Header{{"Authorization", "Basic " + base64}},
+         .payload = cpr::Payload{
+             {"grant_type", "refresh_token"}, {"refresh_token", token}, {"client_id", clientID}}});
+    if(r.status_code != 200)
+    {
+        std::cerr << "refreshing the access token failed (status " << r.status_code << "): " << r.text << std::endl;
+        return false;
+    }
+    json r_json = json::parse(r.text);
+    secondsUntilRefreshRequired = r_json["expires_in"].get<int>() * 90 / 100;
+    access_token = r_json["access_token"].get<std::string>();
+    // spotify only sometimes hands out a new one
+    refresh_token = r_json.contains("refresh_token") ? r_json["refresh_token"].get<std::string>() : token;
+
+    r = transport.get(apiUrl + "/me", getApiHeader());
+    if(r.status_code != 200)
+    {
+        std::cerr << "getting the user failed (status " << r.status_code << "): " << r.text << std::endl;
+        return false;
+    }
     r_json = json::parse(r.text);
     userId = r_json["id"].get<std::string>();
 
@@ -145,11 +212,13 @@ void SpotifyApiAccess::waitAndRefresh()
 
 void SpotifyApiAccess::refreshAccessToken()
 {
-    const std::string query = "https://accounts.spotify.com/api/token";
-    cpr::Response r = cpr::Post(
-        cpr::Url(query),
-        cpr::Payload{{"grant_type", "refresh_token"}, {"refresh_token", refresh_token}, {"client_id", clientID}},
-        cpr::Header{{"Authorization", "Basic " + base64}});
+    const std::string query = accountsUrl + "/api/token";
+    cpr::Response r = transport.send(
+        {.method = HttpTransport::Method::Post,
+         .url = query,
+         .header = cpr::Header{{"Authorization", "Basic " + base64}},
+         .payload = cpr::Payload{
+             {"grant_type", "refresh_token"}, {"refresh_token", refresh_token}, {"client_id", clientID}}});
 
     auto r_json = json::parse(r.text);
 
@@ -157,392 +226,540 @@ void SpotifyApiAccess::refreshAccessToken()
     secondsUntilRefreshRequired = r_json["expires_in"].get<int>();
 }
 
-std::tuple<
-    std::vector<Track>,
-    SpotifyApiAccess::CoverTable_t,
-    std::vector<std::string>,
-    std::vector<SpotifyApiAccess::ArtistID>,
-    SpotifyApiAccess::ArtistIndexLUT_t>
-SpotifyApiAccess::buildPlaylistData(std::string_view playlistID, float* progressTracker, std::string* progressName)
+// the transport already retried whatever could be retried, so anything else aborts the load
+static cpr::Response checkResponse(cpr::Response r)
 {
-    cpr::Response totalCountResponse = cpr::Get(
-        cpr::Url(
-            "https://api.spotify.com/v1/playlists/" + std::string(playlistID) + "/tracks?limit=50&fields=total"),
-        cpr::Header{{"Content-Type", "application/json"}, {"Authorization", "Bearer " + access_token}});
+    if(r.status_code != 200)
+    {
+        throw ApiRequestError(r.status_code, r.url.str());
+    }
+    return r;
+}
 
-    ResponseTotal responseTotal = ResponseTotal::load(totalCountResponse.text);
-    uint32_t totalAmountOfTracks = responseTotal.total;
+// for the requests that create or change something, spotify answers those with 201 or 204 as well
+static cpr::Response checkSuccess(cpr::Response r)
+{
+    if(r.status_code < 200 || r.status_code >= 300)
+    {
+        throw ApiRequestError(r.status_code, r.url.str());
+    }
+    return r;
+}
 
-    int requestCountLimit = 50;
-    uint32_t trackRequestsAmount = (totalAmountOfTracks + requestCountLimit - 1) / requestCountLimit;
+static cpr::Response waitForResponse(cpr::AsyncResponse& asyncResponse)
+{
+    return checkResponse(asyncResponse.get());
+}
 
-    uint32_t tracksLoaded = 0;
+PlaylistInfoResponse SpotifyApiAccess::getPlaylistInfo(std::string_view playlistID)
+{
+    cpr::Response r = checkResponse(transport.get(
+        apiUrl + "/playlists/" + std::string(playlistID) + "?fields=snapshot_id,tracks.total", getApiHeader()));
+    return PlaylistInfoResponse::load(r.text);
+}
 
-    std::vector<Track> tracks;
-    tracks.resize(totalAmountOfTracks);
+// comma separated, the endpoints that take several ids want them like that
+static std::string joinIds(const std::vector<std::string_view>& ids)
+{
+    std::string joined;
+    // idLength characters per id + comma per id
+    joined.reserve(ids.size() * 22 + ids.size());
+    for(const std::string_view id : ids)
+    {
+        joined += id;
+        joined += ',';
+    }
+    // remove trailing comma from id list
+    if(!joined.empty())
+    {
+        joined.pop_back();
+    }
+    return joined;
+}
 
-    CoverTable_t coverTable;
+cpr::AsyncResponse SpotifyApiAccess::requestAudioFeatures(const std::vector<TrackSource*>& tracks)
+{
+    std::vector<std::string_view> trackIds(tracks.size());
+    for(uint32_t i = 0; i < tracks.size(); i++)
+    {
+        trackIds[i] = tracks[i]->id;
+    }
+    const std::string queryURL = apiUrl + "/audio-features?ids=" + joinIds(trackIds);
+    return transport.getAsync(queryURL, getApiHeader());
+}
 
-    // todo: Doesnt work if an item in the playlist is an episode instead of a song!
-    std::string queryURL_start =
-        "https://api.spotify.com/v1/playlists/" + std::string(playlistID) + "/tracks?offset=";
-    std::string queryURL_end =
-        "&limit=" + std::to_string(requestCountLimit) +
-        "&fields=next,items(track(name,id,artists(name,id),popularity,album(id,name,images)))";
+cpr::AsyncResponse SpotifyApiAccess::requestArtists(const std::vector<std::string_view>& artistIds)
+{
+    return transport.getAsync(apiUrl + "/artists?ids=" + joinIds(artistIds), getApiHeader());
+}
 
-    std::vector<cpr::AsyncResponse> asyncResponses;
-    for(int i = 0; i < trackRequestsAmount; i++)
+static void readAudioFeatures(const cpr::Response& r, const std::vector<TrackSource*>& tracks)
+{
+    const TracksFeaturesResponse audioFeatureResponse = TracksFeaturesResponse::load(r.text);
+    for(size_t j = 0; j < std::min(audioFeatureResponse.audioFeatures.size(), tracks.size()); j++)
     {
-        const std::string queryURL = queryURL_start + std::to_string(i * requestCountLimit) + queryURL_end;
-
-        // todo: use MultiGetAsync?
-        // https://docs.libcpr.org/advanced-usage.html#:~:text=endl%3B%0A%7D-,Alternatively,-%2C%20you%20can%20use
-        asyncResponses.emplace_back(cpr::GetAsync(
-            cpr::Url(queryURL),
-            cpr::Header{{"Content-Type", "application/json"}, {"Authorization", "Bearer " + access_token}}));
+        TrackSource& track = *tracks[j];
+        const auto& trackFeatures = audioFeatureResponse.audioFeatures[j];
+        // ensure ids werent mixed up somehow
+        assert(trackFeatures.id == track.id);
+
+        track.features[0] = trackFeatures.acousticness;
+        track.features[1] = trackFeatures.danceability;
+        track.features[2] = trackFeatures.energy;
+        track.features[3] = trackFeatures.instrumentalness;
+        track.features[4] = trackFeatures.speechiness;
+        track.features[5] = trackFeatures.liveness;
+        track.features[6] = trackFeatures.valence;
+        track.features[7] = trackFeatures.tempo;
     }
+}
 
-    std::unordered_map<ArtistID, uint32_t, StringHash, std::equal_to<>> artistIDtoIndex;
-    std::vector<uint32_t> artistOccurances;
+static void readArtistGenres(
+    const cpr::Response& r, const std::vector<std::string_view>& artistIds, PlaylistSource& source)
+{
+    ArtistsResponse artistsResponse = ArtistsResponse::load(r.text);
+    for(size_t j = 0; j < artistsResponse.artists.size(); j++)
+    {
+        auto& artist = artistsResponse.artists[j];
+        assert(j < artistIds.size() && artist.id == artistIds[j]);
+        source.artistGenres.insert_or_assign(std::move(artist.id), std::move(artist.genres));
+    }
+}
 
-    // the actual vector will be created later, so these indices arent valid until then!
-    std::vector<std::vector<uint32_t>> perTrackArtistIndices;
-    perTrackArtistIndices.resize(totalAmountOfTracks);
+std::vector<std::vector<TrackSource>> SpotifyApiAccess::downloadTrackPages(
+    std::string_view playlistID,
+    const std::vector<uint32_t>& pages,
+    const std::function<bool(const TrackSource&)>& needsFeatures,
+    PlaylistSource& source,
+    LoadProgress& progress,
+    PlaylistStream* stream)
+{
+    const std::string queryURL_start = apiUrl + "/playlists/" + std::string(playlistID) + "/tracks?offset=";
+    const std::string queryURL_end =
+        "&limit=" + std::to_string(PlaylistSource::pageSize) +
+        "&fields=items(track(name,id,artists(name,id),popularity,album(id,name,images)))";
+
+    progress.startPhase(LoadProgress::Phase::DownloadingTracks, static_cast<uint32_t>(pages.size()));
+    std::vector<cpr::AsyncResponse> pageResponses;
+    pageResponses.reserve(pages.size());
+    for(const uint32_t page : pages)
+    {
+        const std::string queryURL =
+            queryURL_start + std::to_string(page * PlaylistSource::pageSize) + queryURL_end;
 
-    std::vector<cpr::AsyncResponse> asyncAudioFeatureResponses;
+        pageResponses.emplace_back(transport.getAsync(queryURL, getApiHeader()));
+    }
 
-    PlaylistTracksResponse response;
-    TracksFeaturesResponse audioFeatureResponse;
-    for(int i = 0; i < trackRequestsAmount; i++)
+    /*
+        Instead of waiting for all pages before asking for any audio features (and for those before asking for any
+        genres), the requests for a page's tracks are queued as soon as it is parsed. So the transport always has
+        something to send and parsing overlaps with the network.
+        The endpoints take up to 100 (features) and 50 (artists) ids at once, a request is sent whenever that many
+        are collected and once more for the rest after the last page.
+        Pointers and views into the pages stay valid, every page is only written once.
+    */
+    constexpr uint32_t featureRequestLimit = 100;
+    constexpr uint32_t artistRequestLimit = 50;
+    struct FeatureRequest
+    {
+        std::vector<TrackSource*> tracks;
+        // of the tracks, counted over all pages
+        std::vector<uint32_t> positions;
+        cpr::AsyncResponse response;
+        bool read = false;
+    };
+    struct ArtistRequest
     {
-        cpr::Response r = asyncResponses[i].get();
-        // find a way to re-queue requests that werent fulfilled correctly
-        if(r.status_code != 200)
+        std::vector<std::string_view> artistIds;
+        cpr::AsyncResponse response;
+        bool read = false;
+    };
+    std::vector<FeatureRequest> featureRequests;
+    std::vector<ArtistRequest> artistRequests;
+    std::vector<TrackSource*> pendingTracks;
+    std::vector<uint32_t> pendingPositions;
+    std::vector<std::string_view> pendingArtists;
+    std::unordered_set<std::string_view> requestedArtists;
+
+    const auto flushTracks = [&]()
+    {
+        if(!pendingTracks.empty())
         {
-            // todo: differentiate between different error types
-            assert(false);
+            cpr::AsyncResponse response = requestAudioFeatures(pendingTracks);
+            featureRequests.push_back(
+                {std::move(pendingTracks), std::move(pendingPositions), std::move(response)});
+            pendingTracks.clear();
+            pendingPositions.clear();
         }
-
-        response = PlaylistTracksResponse::load(r.text);
-
-        uint32_t tracksInRequest = response.items.size();
-
-        std::string trackIds;
-        // Lengh of spotify IDs (I think, but cant find specification for it in API atm)
-        const int idLength = 22;
-        // idLength characters per song + comma per song
-        trackIds.reserve(tracksInRequest * idLength + tracksInRequest);
-
-        // TODO: I think a lot of the strings can be moved instead of copied
-
-        // load track data from requst (names & ids)
-        for(auto j = 0; j < tracksInRequest; j++)
+    };
+    const auto flushArtists = [&]()
+    {
+        if(!pendingArtists.empty())
         {
-            const int trackIndex = i * requestCountLimit + j;
-            const auto& trackResponse = response.items[j].track;
-            Track& track = tracks[trackIndex];
-            assert(std::distance(tracks.data(), &track) == trackIndex);
-            track.index = trackIndex;
-
-            // can move here?
-            track.trackNameEncoded = trackResponse.name;
-            track.id = trackResponse.id;
-
-            assert(track.id.length() == 22);
-            trackIds += track.id + ",";
-
-            std::string& artistsNamesE = track.artistsNamesEncoded;
-
-            perTrackArtistIndices[trackIndex].resize(trackResponse.artists.size());
-            for(auto k = 0; k < trackResponse.artists.size(); k++)
+            cpr::AsyncResponse response = requestArtists(pendingArtists);
+            artistRequests.push_back({std::move(pendingArtists), std::move(response)});
+            pendingArtists.clear();
+        }
+    };
+    const auto queueFeatures = [&](TrackSource& track, uint32_t trackPosition)
+    {
+        if(needsFeatures(track))
+        {
+            pendingTracks.push_back(&track);
+            pendingPositions.push_back(trackPosition);
+            if(pendingTracks.size() == featureRequestLimit)
             {
-                auto& artist = trackResponse.artists[k];
-                const auto& artistNameE = artist.name;
-                artistsNamesE += artistNameE;
-                if(k < trackResponse.artists.size() - 1)
-                {
-                    artistsNamesE += ", ";
-                }
-
-                assert(artist.id.size() == 22);
-                auto artistIdToIndexIter = artistIDtoIndex.find(artist.id);
-                if(artistIdToIndexIter == artistIDtoIndex.end())
+                flushTracks();
+            }
+        }
+    };
+    const auto queueArtists = [&](const TrackSource& track)
+    {
+        for(const std::string& artistId : track.artistIds)
+        {
+            if(!source.artistGenres.contains(artistId) && requestedArtists.insert(artistId).second)
+            {
+                pendingArtists.push_back(artistId);
+                if(pendingArtists.size() == artistRequestLimit)
                 {
-                    // artist hasnt been recorded yet, add entry
-                    auto newEntry = artistIDtoIndex.emplace(std::make_pair(artist.id, artistOccurances.size()));
-                    assert(newEntry.second);
-                    assert(newEntry.first->second == artistOccurances.size());
-                    artistOccurances.emplace_back(0);
-
-                    artistIdToIndexIter = newEntry.first;
+                    flushArtists();
                 }
-                artistOccurances[artistIdToIndexIter->second]++;
-                perTrackArtistIndices[trackIndex][k] = artistIdToIndexIter->second;
             }
-
-            track.albumId = trackResponse.album.id;
-            track.albumNameEncoded = trackResponse.album.name;
-
-            track.features[8] = trackResponse.popularity / 100.f;
-
-            // create and/or link to album table
-            auto iter = coverTable.find(track.albumId);
-            if(iter == coverTable.end())
+        }
+    };
+    // the answers are read whenever they are there, so a stream gets them while the pages are still coming in
+    const auto readAnswers = [&](bool wait)
+    {
+        const auto isReady = [&](cpr::AsyncResponse& response)
+        { return wait || response.wait_for(std::chrono::seconds(0)) == std::future_status::ready; };
+        for(FeatureRequest& request : featureRequests)
+        {
+            if(!request.read && isReady(request.response))
             {
-                // not found, construct and set pointer
-                assert(track.albumId.size() == 22);
-                const std::string& coverUrl =
-                    trackResponse.album.images[trackResponse.album.images.size() - 1].url;
-                // todo: pretty sure can also move here
-                CoverInfo info{.url = coverUrl, .layer = 0, .id = 0xFFFFFFFFu};
-                auto newEntry = coverTable.emplace(track.albumId, info);
-                track.coverInfoPtr = &(newEntry.first->second);
+                readAudioFeatures(waitForResponse(request.response), request.tracks);
+                request.read = true;
+                for(uint32_t j = 0; stream != nullptr && j < request.tracks.size(); j++)
+                {
+                    stream->publishFeatures(request.positions[j], request.tracks[j]->features);
+                }
+                progress.done += wait ? 1 : 0;
             }
-            else
+        }
+        for(ArtistRequest& request : artistRequests)
+        {
+            if(!request.read && isReady(request.response))
             {
-                track.coverInfoPtr = &(iter->second);
+                readArtistGenres(waitForResponse(request.response), request.artistIds, source);
+                request.read = true;
+                for(const std::string_view artistId : request.artistIds)
+                {
+                    const auto genresIter = source.artistGenres.find(artistId);
+                    if(stream != nullptr && genresIter != source.artistGenres.end())
+                    {
+                        stream->publishArtistGenres(artistId, genresIter->second);
+                    }
+                }
+                progress.done += wait ? 1 : 0;
             }
-
-            track.decodeNames();
         }
-        // remove trailing comma from track id list
-        trackIds.pop_back();
+    };
 
-        // Now retrieve audio featres from api (for the same batch of ids as the playlist tracks request)
-        std::string queryURL = "https://api.spotify.com/v1/audio-features?ids=" + trackIds;
-        asyncAudioFeatureResponses.emplace_back(cpr::GetAsync(
-            cpr::Url(queryURL),
-            cpr::Header{{"Content-Type", "application/json"}, {"Authorization", "Bearer " + access_token}}));
+    std::vector<std::vector<TrackSource>> pageTracks(pages.size());
+    uint32_t position = 0;
+    for(int i = 0; i < pageResponses.size(); i++)
+    {
+        cpr::Response r = waitForResponse(pageResponses[i]);
+        // todo: Doesnt work if an item in the playlist is an episode instead of a song!
+        pageTracks[i] = PlaylistTracksResponse::load(r.text);
+        if(stream != nullptr)
+        {
+            // before any of their features or genres can be published
+            stream->publishTracks(pageTracks[i]);
+        }
 
-        tracksLoaded += requestCountLimit;
-        *progressTracker = static_cast<float>(tracksLoaded) / static_cast<float>(totalAmountOfTracks);
-        *progressTracker = std::min(*progressTracker, 1.0f);
+        for(TrackSource& track : pageTracks[i])
+        {
+            if(pipelineRequests)
+            {
+                queueFeatures(track, position);
+                queueArtists(track);
+            }
+            position++;
+        }
+        readAnswers(false);
+        progress.done++;
     }
-
-    *progressName = "Retrieving audio features";
-    tracksLoaded = 0;
-
-    assert(trackRequestsAmount == asyncAudioFeatureResponses.size());
-    // this whole thing could be done asynchronously
-    for(int i = 0; i < trackRequestsAmount; i++)
+    if(!pipelineRequests)
     {
-        cpr::Response r = asyncAudioFeatureResponses[i].get();
-        // find a way to re-queue requests that werent fulfilled correctly
-        if(r.status_code != 200)
+        // every phase waits for the one before
+        position = 0;
+        for(auto& page : pageTracks)
         {
-            // todo: differentiate between different error types
-            assert(false);
+            for(TrackSource& track : page)
+            {
+                queueFeatures(track, position++);
+            }
         }
-
-        audioFeatureResponse = TracksFeaturesResponse::load(r.text);
-        for(auto j = 0; j < audioFeatureResponse.audioFeatures.size(); j++)
+        flushTracks();
+        progress.startPhase(LoadProgress::Phase::DownloadingDetails, static_cast<uint32_t>(featureRequests.size()));
+        readAnswers(true);
+        for(const auto& page : pageTracks)
         {
-            const int trackIndex = i * requestCountLimit + j;
-            // ensure ids werent mixed up somehow
-            assert(audioFeatureResponse.audioFeatures[j].id == tracks[trackIndex].id);
-
-            const auto& trackFeatures = audioFeatureResponse.audioFeatures[j];
-
-            Track& track = tracks[trackIndex];
-
-            track.features[0] = trackFeatures.acousticness;
-            track.features[1] = trackFeatures.danceability;
-            track.features[2] = trackFeatures.energy;
-            track.features[3] = trackFeatures.instrumentalness;
-            track.features[4] = trackFeatures.speechiness;
-            track.features[5] = trackFeatures.liveness;
-            track.features[6] = trackFeatures.valence;
-            track.features[7] = trackFeatures.tempo;
+            for(const TrackSource& track : page)
+            {
+                queueArtists(track);
+            }
         }
-
-        tracksLoaded += requestCountLimit;
-        *progressTracker = static_cast<float>(tracksLoaded) / static_cast<float>(totalAmountOfTracks);
-        *progressTracker = std::min(*progressTracker, 1.0f);
     }
+    flushTracks();
+    flushArtists();
+
+    const auto unread = [](const auto& request) { return !request.read; };
+    progress.startPhase(
+        LoadProgress::Phase::DownloadingDetails,
+        static_cast<uint32_t>(
+            std::count_if(featureRequests.begin(), featureRequests.end(), unread) +
+            std::count_if(artistRequests.begin(), artistRequests.end(), unread)));
+    readAnswers(true);
+    return pageTracks;
+}
 
-    *progressName = "Analyzing genres";
+void SpotifyApiAccess::downloadArtistGenres(
+    const std::vector<std::string_view>& artistIds, PlaylistSource& source, LoadProgress& progress)
+{
+    // request up to 50 ids at once
+    constexpr uint32_t requestCountLimit = 50;
 
-    // The genres need to be fetched from a different endpoint
-    // They also need to be mapped from artists -> tracks and sorted by occurance
+    std::vector<std::vector<std::string_view>> batches;
+    std::vector<cpr::AsyncResponse> asyncResponses;
+    for(uint32_t i = 0; i < artistIds.size(); i += requestCountLimit)
+    {
+        const auto batchEnd = artistIds.begin() + std::min<size_t>(i + requestCountLimit, artistIds.size());
+        const auto& batch = batches.emplace_back(artistIds.begin() + i, batchEnd);
+        asyncResponses.emplace_back(requestArtists(batch));
+    }
 
-    struct GenreData
+    progress.startPhase(LoadProgress::Phase::DownloadingDetails, static_cast<uint32_t>(asyncResponses.size()));
+    for(int i = 0; i < asyncResponses.size(); i++)
     {
-        uint32_t occurances = 0;
-        uint32_t sortedIndex = 0;
-        const std::string* name = nullptr;
-    };
-    // store all genres in a nice linear array, need to have stability which index offers
-    std::vector<GenreData> genreData;
-    std::unordered_map<GenreName, uint32_t> genreNameToIndex;
+        readArtistGenres(waitForResponse(asyncResponses[i]), batches[i], source);
+        progress.done++;
+    }
+}
 
-    std::vector<std::vector<uint32_t>> perArtistGenreIndices;
-    perArtistGenreIndices.resize(artistIDtoIndex.size());
+// artists of the tracks that arent in artistGenres yet, in order of appearance
+static std::vector<std::string_view> findMissingArtists(const PlaylistSource& source)
+{
+    std::vector<std::string_view> missing;
+    std::unordered_set<std::string_view> seen;
+    for(const TrackSource& track : source.tracks)
+    {
+        for(const std::string& artistId : track.artistIds)
+        {
+            if(!source.artistGenres.contains(artistId) && seen.insert(artistId).second)
+            {
+                missing.emplace_back(artistId);
+            }
+        }
+    }
+    return missing;
+}
 
-    // again, request up to 50 ids at once
-    std::string ids;
-    ids.reserve(50 * 22 + 50);
+PlaylistSource
+SpotifyApiAccess::downloadPlaylist(std::string_view playlistID, LoadProgress& progress, PlaylistStream* stream)
+{
+    PlaylistSource source;
+    // the playlist could still change while downloading, then the next sync just finds a different snapshot id
+    const PlaylistInfoResponse info = getPlaylistInfo(playlistID);
+    source.snapshotId = info.snapshotId;
+    if(stream != nullptr)
+    {
+        stream->setExpectedTrackCount(info.tracks.total);
+    }
 
-    *progressName = "Downloading genre data";
+    const uint32_t pageCount = (info.tracks.total + PlaylistSource::pageSize - 1) / PlaylistSource::pageSize;
+    std::vector<uint32_t> pages(pageCount);
+    std::iota(pages.begin(), pages.end(), 0);
+    // audio features and genres are requested along with the pages
+    std::vector<std::vector<TrackSource>> pageTracks = downloadTrackPages(
+        playlistID, pages, [](const TrackSource&) { return true; }, source, progress, stream);
 
-    auto iter = artistIDtoIndex.begin();
-    assert(artistOccurances.size() == artistIDtoIndex.size());
-    uint32_t artistCount = artistOccurances.size();
+    source.tracks.reserve(info.tracks.total);
+    for(auto& page : pageTracks)
+    {
+        std::move(page.begin(), page.end(), std::back_inserter(source.tracks));
+    }
 
-    std::vector<uint32_t> artistIndexFromRequestIndex;
+    source.updatePageHashes();
+    return source;
+}
 
-    std::vector<cpr::AsyncResponse> asyncGenreResponses;
-    for(int i = 0; i < artistCount; i += 50)
+bool SpotifyApiAccess::syncPlaylist(std::string_view playlistID, PlaylistSource& source, LoadProgress& progress)
+{
+    const PlaylistInfoResponse info = getPlaylistInfo(playlistID);
+    if(info.snapshotId == source.snapshotId)
     {
-        int requestSize = 0;
-        for(; requestSize < 50 && iter != artistIDtoIndex.end(); requestSize++)
-        {
-            ids += iter->first;
-            ids += ',';
-            artistIndexFromRequestIndex.emplace_back(iter->second);
-            iter++;
-        }
-        ids.pop_back(); // delete trailing comma
+        return false;
+    }
 
-        std::string queryURL = "https://api.spotify.com/v1/artists?ids=" + ids;
-        asyncGenreResponses.emplace_back(cpr::GetAsync(
-            cpr::Url(queryURL),
-            cpr::Header{{"Content-Type", "application/json"}, {"Authorization", "Bearer " + access_token}}));
+    const uint32_t pageCount = (info.tracks.total + PlaylistSource::pageSize - 1) / PlaylistSource::pageSize;
+    progress.startPhase(LoadProgress::Phase::CheckingChanges, pageCount);
+    // every page is requested again, but only the ids, which is a fraction of the full track data
+    const std::string queryURL_start = apiUrl + "/playlists/" + std::string(playlistID) + "/tracks?offset=";
+    const std::string queryURL_end =
+        "&limit=" + std::to_string(PlaylistSource::pageSize) + "&fields=items(track(id))";
+    std::vector<cpr::AsyncResponse> asyncIdResponses;
+    asyncIdResponses.reserve(pageCount);
+    for(uint32_t page = 0; page < pageCount; page++)
+    {
+        const std::string queryURL =
+            queryURL_start + std::to_string(page * PlaylistSource::pageSize) + queryURL_end;
+        asyncIdResponses.emplace_back(transport.getAsync(queryURL, getApiHeader()));
+    }
 
-        ids.clear();
+    // the same track can be in a playlist more than once, the first one is as good as any
+    std::unordered_map<std::string_view, uint32_t> oldTrackIndices;
+    oldTrackIndices.reserve(source.tracks.size());
+    for(uint32_t i = 0; i < source.tracks.size(); i++)
+    {
+        oldTrackIndices.emplace(source.tracks[i].id, i);
     }
 
-    ArtistsResponse artistsResponse;
-    for(int i = 0; i < asyncGenreResponses.size(); i++)
+    // for every track of the new playlist, where its data comes from
+    constexpr uint32_t notDownloadedYet = UINT32_MAX;
+    std::vector<uint32_t> oldIndexOf;
+    oldIndexOf.reserve(info.tracks.total);
+    std::vector<uint32_t> changedPages;
+    std::vector<uint32_t> pageStarts;
+    PlaylistTrackIdsResponse idResponse;
+    std::vector<std::string_view> ids;
+    for(uint32_t page = 0; page < pageCount; page++)
     {
-        cpr::Response r = asyncGenreResponses[i].get();
-        // find a way to re-queue requests that werent fulfilled correctly
-        if(r.status_code != 200)
+        cpr::Response r = waitForResponse(asyncIdResponses[page]);
+        idResponse = PlaylistTrackIdsResponse::load(r.text);
+        pageStarts.push_back(static_cast<uint32_t>(oldIndexOf.size()));
+
+        ids.clear();
+        for(const auto& item : idResponse.items)
         {
-            // todo: differentiate between different error types
-            assert(false);
+            ids.emplace_back(item.track.id);
         }
-
-        artistsResponse = ArtistsResponse::load(r.text);
-
-        auto& artists = artistsResponse.artists;
-        for(int j = 0; j < artists.size(); j++)
+        const uint32_t oldPageStart = page * PlaylistSource::pageSize;
+        if(page < source.pageHashes.size() && hashTrackIds(ids) == source.pageHashes[page] &&
+           oldPageStart + ids.size() <= source.tracks.size())
         {
-            auto& artist = artists[j];
-            // todo: this needed? (ie, check again what artistIndices was used for and if its still needed!)
-            uint32_t requestIndex = i * 50 + j;
-            uint32_t& artistIndex = artistIndexFromRequestIndex[requestIndex];
-
-            assert(artistIDtoIndex.find(artist.id)->second == artistIndex);
-            perArtistGenreIndices[artistIndex].reserve(artist.genres.size());
-
-            for(auto& genreName : artist.genres)
+            // page is exactly the same as before
+            for(uint32_t j = 0; j < ids.size(); j++)
             {
-                auto genreNameToIndexIter = genreNameToIndex.find(genreName);
-                if(genreNameToIndexIter == genreNameToIndex.end())
-                {
-                    // genre hasnt been recorded yet
-
-                    // add genre to vector
-                    GenreData& newGenreData = genreData.emplace_back();
-                    uint32_t newIndex = genreData.size() - 1;
-                    assert(&genreData[newIndex] == &newGenreData);
-
-                    // add new mapping: name -> new index
-                    auto emplaceResult = genreNameToIndex.emplace(std::make_pair(genreName, newIndex));
-                    assert(emplaceResult.second);
-                    genreNameToIndexIter = emplaceResult.first;
-                }
-                genreData[genreNameToIndexIter->second].occurances += artistOccurances[artistIndex];
-                // add reference back to artist!
-                perArtistGenreIndices[artistIndex].emplace_back(genreNameToIndexIter->second);
+                oldIndexOf.push_back(oldPageStart + j);
             }
         }
-
-        *progressTracker = static_cast<float>(i) / static_cast<float>(artistCount);
-    }
-    *progressTracker = 1.0f;
-
-    *progressName = "Sorting genres";
-    *progressTracker = 0.0f;
-    for(auto& entry : genreNameToIndex)
-    {
-        genreData[entry.second].name = &entry.first;
+        else
+        {
+            // tracks were added, removed or moved here, the ones that are still known dont need downloading
+            bool hasNewTracks = false;
+            for(const std::string_view id : ids)
+            {
+                const auto iter = oldTrackIndices.find(id);
+                hasNewTracks |= iter == oldTrackIndices.end();
+                oldIndexOf.push_back(iter == oldTrackIndices.end() ? notDownloadedYet : iter->second);
+            }
+            if(hasNewTracks)
+            {
+                changedPages.push_back(page);
+            }
+        }
+        progress.done++;
     }
 
-    std::vector<GenreData*> genreProxies;
-    genreProxies.reserve(genreData.size());
-    for(auto& data : genreData)
+    // tracks that are still known keep their features, genres are only requested for artists that are new
+    std::vector<std::vector<TrackSource>> changedPageTracks = downloadTrackPages(
+        playlistID,
+        changedPages,
+        [&](const TrackSource& track) { return !oldTrackIndices.contains(track.id); },
+        source,
+        progress,
+        nullptr);
+
+    // reuse what is known (moving it out of the old tracks when its used for the last time)
+    std::vector<uint32_t> remainingUses(source.tracks.size(), 0);
+    for(const uint32_t oldIndex : oldIndexOf)
     {
-        genreProxies.emplace_back(&data);
+        if(oldIndex != notDownloadedYet)
+        {
+            remainingUses[oldIndex]++;
+        }
     }
-    std::sort(
-        genreProxies.begin(),
-        genreProxies.end(),
-        [](const GenreData* lhs, const GenreData* rhs) -> bool { return lhs->occurances > rhs->occurances; });
-
-    for(uint32_t i = 0; i < genreProxies.size(); i++)
+    std::vector<TrackSource> tracks(oldIndexOf.size());
+    for(uint32_t i = 0; i < tracks.size(); i++)
     {
-        genreProxies[i]->sortedIndex = i;
+        const uint32_t oldIndex = oldIndexOf[i];
+        if(oldIndex == notDownloadedYet)
+        {
+            continue;
+        }
+        if(--remainingUses[oldIndex] == 0)
+        {
+            tracks[i] = std::move(source.tracks[oldIndex]);
+        }
+        else
+        {
+            tracks[i] = source.tracks[oldIndex];
+        }
     }
 
-    // Could see if its worth it to generate a bitset for each artist first, and then for each track just combine
-    // all artists bitsets
-    // But for now, just do a simple double loop. (at least this definitly uses less memory)
-    assert(genreData.size() == genreNameToIndex.size());
-    for(int i = 0; i < tracks.size(); i++)
+    for(uint32_t c = 0; c < changedPages.size(); c++)
     {
-        Track& track = tracks[i];
-        track.genreMask = DynBitset{static_cast<uint32_t>(genreData.size())};
-        track.artistMask = DynBitset{static_cast<uint32_t>(artistIDtoIndex.size())};
-        for(uint32_t& artistIndex : perTrackArtistIndices[i])
+        const uint32_t pageStart = pageStarts[changedPages[c]];
+        auto& pageTracks = changedPageTracks[c];
+        // the playlist could have changed again since the ids were requested, then dont go out of bounds
+        const uint32_t pageEnd = std::min<uint32_t>(pageStart + pageTracks.size(), tracks.size());
+        for(uint32_t i = pageStart; i < pageEnd; i++)
         {
-            track.artistMask.setBit(artistIndex);
-            for(uint32_t& genreDataIndex : perArtistGenreIndices[artistIndex])
+            TrackSource& track = tracks[i];
+            TrackSource& downloaded = pageTracks[i - pageStart];
+            if(oldIndexOf[i] == notDownloadedYet)
+            {
+                track = std::move(downloaded);
+            }
+            else if(track.id == downloaded.id)
             {
-                const GenreData& data = genreData[genreDataIndex];
-                track.genreMask.setBit(data.sortedIndex);
+                // already known, but the popularity is more recent
+                track.features[8] = downloaded.features[8];
             }
         }
     }
 
-    // this is last so can move into
-    std::vector<std::string> sortedGenres;
-    sortedGenres.resize(genreData.size());
-    for(auto& genreProxy : genreProxies)
-    {
-        // this will break the map, but its useless now anyways
-        sortedGenres[genreProxy->sortedIndex] = *genreProxy->name;
-    }
+    // only if the playlist got shorter in the meantime
+    std::erase_if(tracks, [](const TrackSource& track) { return track.id.empty(); });
 
-    std::vector<ArtistID> artistIds;
-    artistIds.resize(artistIDtoIndex.size());
-    for(auto& entry : artistIDtoIndex)
+    source.tracks = std::move(tracks);
+    source.snapshotId = info.snapshotId;
+    source.updatePageHashes();
+
+    // usually none are missing anymore, unless the playlist changed while syncing
+    downloadArtistGenres(findMissingArtists(source), source, progress);
+    // drop the artists that arent in the playlist anymore
+    std::unordered_set<std::string_view> usedArtists;
+    for(const TrackSource& track : source.tracks)
     {
-        artistIds[entry.second] = entry.first;
+        usedArtists.insert(track.artistIds.begin(), track.artistIds.end());
     }
+    std::erase_if(source.artistGenres, [&](const auto& entry) { return !usedArtists.contains(entry.first); });
 
-    return std::make_tuple(
-        std::move(tracks),
-        std::move(coverTable),
-        std::move(sortedGenres),
-        std::move(artistIds),
-        std::move(artistIDtoIndex));
+    return true;
 }
 
 json SpotifyApiAccess::getAlbum(const std::string& albumId)
 {
-    const std::string queryUrl = "https://api.spotify.com/v1/albums/" + albumId;
-    cpr::Response r = cpr::Get(
-        cpr::Url(queryUrl),
-        cpr::Header{{"Content-Type", "application/json"}, {"Authorization", "Bearer " + access_token}});
+    const std::string queryUrl = apiUrl + "/albums/" + albumId;
+    cpr::Response r = transport.get(queryUrl, getApiHeader());
     return json::parse(r.text);
 }
 
 std::string SpotifyApiAccess::checkPlaylistExistance(std::string_view id)
 {
-    cpr::Response r = cpr::Get(
-        cpr::Url("https://api.spotify.com/v1/playlists/" + std::string(id) + "?fields=name"),
-        cpr::Header{{"Content-Type", "application/json"}, {"Authorization", "Bearer " + access_token}});
+    cpr::Response r = transport.get(apiUrl + "/playlists/" + std::string(id) + "?fields=name", getApiHeader());
     if(r.status_code == 200)
     {
         return json::parse(r.text)["name"].get<std::string>();
@@ -553,13 +770,14 @@ std::string SpotifyApiAccess::checkPlaylistExistance(std::string_view id)
 
 void SpotifyApiAccess::stopPlayback()
 {
-    std::string queryUrl = "https://api.spotify.com/v1/me/player/pause";
-    cpr::Response r = cpr::Put(
-        cpr::Url(queryUrl),
-        cpr::Header{
-            {"Authorization", "Bearer " + access_token},
-            {"Content-Type", "application/json"},
-            {"Content-Length", "0"}});
+    std::string queryUrl = apiUrl + "/me/player/pause";
+    cpr::Response r = transport.send(
+        {.method = HttpTransport::Method::Put,
+         .url = queryUrl,
+         .header = cpr::Header{
+             {"Authorization", "Bearer " + access_token},
+             {"Content-Type", "application/json"},
+             {"Content-Length", "0"}}});
     std::cout << r.text << std::endl;
 }
 
@@ -567,23 +785,20 @@ void SpotifyApiAccess::stopPlayback()
 bool SpotifyApiAccess::startTrackPlayback(const std::string& trackId)
 {
     // "load" the song into queue
-    std::string queryUrl = "https://api.spotify.com/v1/me/player/queue?uri=spotify:track:" + trackId;
-    cpr::Response r = cpr::Post(
-        cpr::Url(queryUrl),
-        cpr::Header{{"Authorization", "Bearer " + access_token}, {"Content-Type", "application/json"}});
+    std::string queryUrl = apiUrl + "/me/player/queue?uri=spotify:track:" + trackId;
+    cpr::Response r =
+        transport.send({.method = HttpTransport::Method::Post, .url = queryUrl, .header = getApiHeader()});
     if(r.status_code == 404)
     {
         return false;
     }
 
     // skip to that song, starts plaback automatically it seems
-    queryUrl = "https://api.spotify.com/v1/me/player/next";
-    r = cpr::Post(
-        cpr::Url(queryUrl),
-        cpr::Header{{"Authorization", "Bearer " + access_token}, {"Content-Type", "application/json"}});
+    queryUrl = apiUrl + "/me/player/next";
+    r = transport.send({.method = HttpTransport::Method::Post, .url = queryUrl, .header = getApiHeader()});
 
     // now start the song
-    // queryUrl = "https://api.spotify.com/v1/me/player/play";
+    // queryUrl = apiUrl + "/me/player/play";
     // r = cpr::Put(
     //     cpr::Url(queryUrl),
     //     cpr::Header{
@@ -599,16 +814,17 @@ void SpotifyApiAccess::createPlaylist(std::string_view name, const std::vector<s
     json body_json;
     body_json["name"] = name;
     body_json["public"] = false;
-    std::string queryUrl = "https://api.spotify.com/v1/users/" + userId + "/playlists";
-    cpr::Response r = cpr::Post(
-        cpr::Url(queryUrl),
-        cpr::Header{{"Authorization", "Bearer " + access_token}, {"Content-Type", "application/json"}},
-        cpr::Body{body_json.dump()});
+    std::string queryUrl = apiUrl + "/users/" + userId + "/playlists";
+    cpr::Response r = checkSuccess(transport.send(
+        {.method = HttpTransport::Method::Post,
+         .url = queryUrl,
+         .header = getApiHeader(),
+         .body = body_json.dump()}));
     json ret_json = json::parse(r.text);
     std::string playlist_uri = ret_json["uri"].get<std::string>().substr(17, 22);
 
     // todo: progress bar
-    queryUrl = "https://api.spotify.com/v1/playlists/" + playlist_uri + "/tracks";
+    queryUrl = apiUrl + "/playlists/" + playlist_uri + "/tracks";
     for(int i = 0; i < trackUris.size(); i += 100)
     {
         json uri_json;
@@ -618,12 +834,11 @@ void SpotifyApiAccess::createPlaylist(std::string_view name, const std::vector<s
         {
             uri_json["uris"].push_back(trackUris[i + j]);
         }
-        std::cout << uri_json.dump(2) << std::endl;
-        r = cpr::Post(
-            cpr::Url(queryUrl),
-            cpr::Header{{"Authorization", "Bearer " + access_token}, {"Content-Type", "application/json"}},
-            cpr::Body{uri_json.dump()});
-        std::cout << r.text << std::endl;
+        checkSuccess(transport.send(
+            {.method = HttpTransport::Method::Post,
+             .url = queryUrl,
+             .header = getApiHeader(),
+             .body = uri_json.dump()}));
     }
 }
 
@@ -641,9 +856,8 @@ std::vector<std::string> SpotifyApiAccess::getRecommendations(std::vector<std::s
             seedString += ",";
         }
     }
-    cpr::Response r = cpr::Get(
-        cpr::Url("https://api.spotify.com/v1/recommendations?limit=100&seed_tracks=" + seedString),
-        cpr::Header{{"Content-Type", "application/json"}, {"Authorization", "Bearer " + access_token}});
+    cpr::Response r =
+        transport.get(apiUrl + "/recommendations?limit=100&seed_tracks=" + seedString, getApiHeader());
     json r_json = json::parse(r.text);
 
     std::vector<std::string> result = {};
@@ -659,13 +873,12 @@ std::vector<std::string> SpotifyApiAccess::getRecommendations(std::vector<std::s
 
 std::vector<std::string> SpotifyApiAccess::getRelatedArtists(const std::string& artistId)
 {
-    std::string queryURL = "https://api.spotify.com/v1/artists/" + artistId + "/related-artists";
-    cpr::Response r = cpr::Get(
-        cpr::Url(queryURL),
-        cpr::Header{{"Content-Type", "application/json"}, {"Authorization", "Bearer " + access_token}});
+    std::string queryURL = apiUrl + "/artists/" + artistId + "/related-artists";
+    cpr::Response r = transport.get(queryURL, getApiHeader());
     if(r.status_code != 200)
     {
-        std::cout << "API rate limit reached" << std::endl;
+        // rate limits were already handled by the transport, so this is a real error
+        std::cout << "Could not get related artists (status " << r.status_code << ")" << std::endl;
         return {};
     }
     // todo: replace for improved performance but dont want to deal with daw_json atm
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <chrono>
+#include <functional>
 #include <iostream>
 #include <optional>
 #include <string>
@@ -8,35 +10,83 @@
 #include <json/json.hpp>
 
 #include <CommonStructs/CommonStructs.hpp>
+#include <DynamicBitset/DynamicBitset.hpp>
+#include <FeatureStore/FeatureStore.hpp>
+#include <HttpTransport/HttpTransport.hpp>
+#include <Spotify/ApiResponses.hpp>
 #include <Track/Track.hpp>
 #include <utils/utf.hpp>
 
 using nlohmann::json;
 
+struct LoadProgress;
+struct PlaylistSource;
+class PlaylistStream;
+struct TrackSource;
+
 class SpotifyApiAccess
 {
   public:
-    SpotifyApiAccess();
+    // spotify limits requests over a rolling 30 second window, but doesnt say how many are allowed.
+    // This is roughly what it lets through before sending 429s, the transport backs off if it's less
+    static constexpr RateLimit spotifyRateLimit{.requestsPerWindow = 300, .window = std::chrono::seconds(30)};
+
+    // the urls are where the web api and the accounts service are, without a trailing slash (ie. to use a mock)
+    // maxInFlight and reuseConnections are passed on to the HttpTransport
+    explicit SpotifyApiAccess(
+        std::string apiUrl = defaultApiUrl(),
+        std::string accountsUrl = defaultAccountsUrl(),
+        RateLimit rateLimit = spotifyRateLimit,
+        uint32_t maxInFlight = HttpTransport::defaultMaxInFlight(),
+        bool reuseConnections = true);
+
+    // https://api.spotify.com/v1, can be overwritten with the PLAYLISTFILTER_API_URL environment variable
+    static std::string defaultApiUrl();
+    // https://accounts.spotify.com, can be overwritten with the PLAYLISTFILTER_ACCOUNTS_URL environment variable
+    static std::string defaultAccountsUrl();
 
     // build URL required to request authorization
     std::string getAuthURL();
     // have to pass as std::string :/ CPR Constructor takes only string not _view
     bool checkAuth(const std::string& p_state, const std::string& code);
+    // log in without a browser with the refresh token of an earlier authorization (ie. for PlaylistFilterCLI)
+    bool authorizeWithRefreshToken(const std::string& token);
     // refresh the users access token
     void refreshAccessToken();
     void startRefreshThread();
     void waitAndRefresh();
 
     // todo: handle api errors
-    // build the main playlist data, a vector of track objects and a map [Album ID -> CoverInfo Struct]
-    // (stores texture handle etc)
+    // the main playlist data, a vector of track objects, their audio features (stored column-wise)
+    // and a map [Album ID -> CoverInfo Struct] (stores texture handle etc)
+    // The genres are sorted by how many tracks have them, for every genre there is also a bitset of those tracks
+    // (built from a PlaylistSource by buildPlaylistData())
     using AlbumID = std::string;
     using ArtistID = std::string;
     using GenreName = std::string;
     using CoverTable_t = std::unordered_map<AlbumID, CoverInfo, StringHash, std::equal_to<>>;
     using ArtistIndexLUT_t = std::unordered_map<ArtistID, uint32_t, StringHash, std::equal_to<>>;
-    std::tuple<std::vector<Track>, CoverTable_t, std::vector<GenreName>, std::vector<ArtistID>, ArtistIndexLUT_t>
-    buildPlaylistData(std::string_view playlistID, float* progressTracker, std::string* progressName);
+    using PlaylistData_t = std::tuple<
+        std::vector<Track>,
+        FeatureStore,
+        CoverTable_t,
+        std::vector<GenreName>,
+        std::vector<DynBitset>,
+        std::vector<ArtistID>,
+        ArtistIndexLUT_t>;
+    /*
+        download everything about the tracks of a playlist.
+        If a stream is given, every track is published to it as soon as its page is in, and its audio features and
+        genres as soon as they are
+    */
+    PlaylistSource
+    downloadPlaylist(std::string_view playlistID, LoadProgress& progress, PlaylistStream* stream = nullptr);
+    /*
+        bring a previously downloaded playlist up to date, returns false if the playlist didnt change.
+        Only the track ids are requested for every page, full track data, audio features and genres are only
+        downloaded for what is new
+    */
+    bool syncPlaylist(std::string_view playlistID, PlaylistSource& source, LoadProgress& progress);
     // get the Album json returned by the api
     json getAlbum(const std::string& albumId);
     /*
@@ -49,14 +99,52 @@ class SpotifyApiAccess
     bool startTrackPlayback(const std::string& trackId);
     // stop the users current playback
     void stopPlayback();
-    // create a playlist with given name, consisting of tracks whose uris are stored in the 2nd parameter
+    /*
+        create a playlist with given name, consisting of tracks whose uris are stored in the 2nd parameter.
+        Throws ApiRequestError if spotify refuses creating it or adding any of the tracks
+    */
     void createPlaylist(std::string_view name, const std::vector<std::string>& trackUris);
     // Get the Ids of track recommendations based on up to 5 input track Ids
     std::vector<std::string> getRecommendations(std::vector<std::string_view>& seedIds);
 
     std::vector<std::string> getRelatedArtists(const std::string& artistId);
 
+    // for its statistics
+    [[nodiscard]] const HttpTransport& getTransport() const;
+    /*
+        Off waits for all pages of a playlist before requesting any audio features, and for those before
+        requesting any genres, like loading did before the requests were pipelined. Only to compare against
+    */
+    void setPipelining(bool enabled);
+
   private:
+    // json content type and the current access token
+    cpr::Header getApiHeader() const;
+    PlaylistInfoResponse getPlaylistInfo(std::string_view playlistID);
+    /*
+        full track data of the given pages (PlaylistSource::pageSize tracks each) of the playlist.
+        While the pages come in, the audio features (every feature except popularity, which comes with the track
+        data) of the tracks that needsFeatures() and the genres of artists that arent in source.artistGenres yet
+        are requested as well (unless pipelining is off). The genres are added to source.artistGenres.
+        Tracks are published to the stream (if any) in the order of the pages
+    */
+    std::vector<std::vector<TrackSource>> downloadTrackPages(
+        std::string_view playlistID,
+        const std::vector<uint32_t>& pages,
+        const std::function<bool(const TrackSource&)>& needsFeatures,
+        PlaylistSource& source,
+        LoadProgress& progress,
+        PlaylistStream* stream);
+    // at most 100 tracks
+    cpr::AsyncResponse requestAudioFeatures(const std::vector<TrackSource*>& tracks);
+    // at most 50 artists
+    cpr::AsyncResponse requestArtists(const std::vector<std::string_view>& artistIds);
+    void downloadArtistGenres(
+        const std::vector<std::string_view>& artistIds, PlaylistSource& source, LoadProgress& progress);
+
+    std::string apiUrl;
+    std::string accountsUrl;
+
     std::string state;
     std::string code_verifier;
 
@@ -68,4 +156,8 @@ class SpotifyApiAccess
     int secondsUntilRefreshRequired = 0;
     std::thread refreshThread;
     bool refreshThreadShouldTop = false;
+
+    // every request goes through here, keeps the connections alive and limits how many run at once
+    HttpTransport transport;
+    bool pipelineRequests = true;
 };
\ No newline at end of file
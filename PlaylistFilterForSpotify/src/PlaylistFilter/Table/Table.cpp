@@ -4,6 +4,7 @@
 #include "Table/Table.hpp"
 #include "Track/Track.hpp"
 #include <App/App.hpp>
+#include <FrameTiming/FrameTiming.hpp>
 
 PinnedTracksTable::PinnedTracksTable(App& p_app, std::vector<Track*>& p_tracks) : Table(p_app, p_tracks)
 {
@@ -110,23 +111,58 @@ void Table::calcHeaderWidth()
     columnHeaders[3].width = std::max(columnHeaders[2].width, size.x);
 };
 
+std::span<Track* const> Table::getVisibleTracks() const
+{
+    // the table could have changed since it was drawn
+    const uint32_t last = std::min(visibleRows.second, static_cast<uint32_t>(tracks.size()));
+    const uint32_t first = std::min(visibleRows.first, last);
+    return {tracks.data() + first, tracks.data() + last};
+}
+
 void Table::sortData()
 {
     if(tracks.size() > 1) // only need to sort if more than 1 track
     {
         if(sortAscending)
         {
-            std::sort(tracks.begin(), tracks.end(), TrackSorter{columnToSortBy});
+            parallelSort(
+                app.getWorkerPool(), tracks.begin(), tracks.end(), TrackSorter{columnToSortBy, app.getTrackFeatures()});
         }
         else
         {
-            std::sort(tracks.rbegin(), tracks.rend(), TrackSorter{columnToSortBy});
+            parallelSort(
+                app.getWorkerPool(), tracks.rbegin(), tracks.rend(), TrackSorter{columnToSortBy, app.getTrackFeatures()});
         }
     }
 }
 
+void Table::insertSorted(std::vector<Track*>& newTracks)
+{
+    if(newTracks.empty())
+    {
+        return;
+    }
+    // sort only the new tracks and merge them in, instead of sorting everything again
+    const auto oldSize = static_cast<std::ptrdiff_t>(tracks.size());
+    const TrackSorter sorter{columnToSortBy, app.getTrackFeatures()};
+    if(sortAscending)
+    {
+        std::sort(newTracks.begin(), newTracks.end(), sorter);
+        tracks.insert(tracks.end(), newTracks.begin(), newTracks.end());
+        std::inplace_merge(tracks.begin(), tracks.begin() + oldSize, tracks.end(), sorter);
+    }
+    else
+    {
+        std::sort(newTracks.rbegin(), newTracks.rend(), sorter);
+        tracks.insert(tracks.begin(), newTracks.begin(), newTracks.end());
+        // the old tracks are now at the end, so in reverse they come first
+        std::inplace_merge(tracks.rbegin(), tracks.rbegin() + oldSize, tracks.rend(), sorter);
+    }
+}
+
 void Table::draw(float height, bool updateColumnsState, bool stateToSet)
 {
+    TIME_FRAME_PHASE(TableDraw);
     assert(strcmp(tableName, "") != 0);
     assert(strcmp(lastColumnButtonName, "") != 0);
 
@@ -238,8 +274,11 @@ void Table::draw(float height, bool updateColumnsState, bool stateToSet)
         ImGuiListClipper clipper;
         clipper.Begin(tracks.size());
         int removeAfterFrame = -1;
+        visibleRows = {static_cast<uint32_t>(tracks.size()), 0};
         while(clipper.Step())
         {
+            visibleRows.first = std::min(visibleRows.first, static_cast<uint32_t>(clipper.DisplayStart));
+            visibleRows.second = std::max(visibleRows.second, static_cast<uint32_t>(clipper.DisplayEnd));
             for(int row = clipper.DisplayStart; row < clipper.DisplayEnd; row++)
             {
                 ImGui::TableNextRow();
@@ -310,35 +349,32 @@ void Table::draw(float height, bool updateColumnsState, bool stateToSet)
                     ImGui::EndTooltip();
                 }
 
+                const FeatureStore& features = app.getTrackFeatures();
+                const int trackIndex = tracks[row]->index;
                 for(int i = 4; i < 11; i++)
                 {
                     ImGui::TableSetColumnIndex(i);
-                    ImGui::Text("%.3f", tracks[row]->features[i - 4]);
+                    ImGui::Text("%.3f", features.get(i - 4, trackIndex));
                 }
 
                 ImGui::TableSetColumnIndex(11);
-                ImGui::Text("%.0f", std::round(tracks[row]->features[7]));
+                ImGui::Text("%.0f", std::round(features.get(7, trackIndex)));
 
                 ImGui::TableSetColumnIndex(12);
-                ImGui::Text("%.3f", tracks[row]->features[8]);
+                ImGui::Text("%.3f", features.get(8, trackIndex));
 
                 ImGui::TableSetColumnIndex(13);
                 if(ImGui::BeginCombo("##trackGenreCombo", "", ImGuiComboFlags_NoPreview))
                 {
-                    DynBitset temp = tracks[row]->genreMask;
-                    while(temp)
-                    {
-                        // todo: kind of inefficient, because the DynBitset -> Bool conversion already
-                        // iterates through all elements in bitset
-                        // so chcking as while-condition while also clearing all bits is super redundant
-                        uint32_t smallestIndex = temp.getFirstBitSet();
-                        temp.clearBit(smallestIndex);
-                        const bool isSelected = app.genrePassesFilter(smallestIndex);
-                        if(ImGui::Selectable(app.getGenreName(smallestIndex), isSelected))
+                    tracks[row]->genreMask.forEachSetBit(
+                        [&](uint32_t genreIndex)
                         {
-                            app.toggleGenreFilter(smallestIndex);
-                        }
-                    }
+                            const bool isSelected = app.genrePassesFilter(genreIndex);
+                            if(ImGui::Selectable(app.getGenreName(genreIndex), isSelected))
+                            {
+                                app.toggleGenreFilter(genreIndex);
+                            }
+                        });
                     ImGui::EndCombo();
                 }
 
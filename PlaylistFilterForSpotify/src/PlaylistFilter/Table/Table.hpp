@@ -2,6 +2,8 @@
 
 #include <algorithm>
 #include <numeric>
+#include <span>
+#include <utility>
 
 #include <ImGui/imgui.h>
 #include <Track/Track.hpp>
@@ -22,6 +24,10 @@ class Table
     void draw(float height, bool updateColumnsState, bool stateToSet);
     void calcHeaderWidth();
     void sortData();
+    // adds tracks to an already sorted table, keeping the current sort order. newTracks gets reordered
+    void insertSorted(std::vector<Track*>& newTracks);
+    // tracks of the rows that were drawn the last time, ie. the ones scrolled into view
+    [[nodiscard]] std::span<Track* const> getVisibleTracks() const;
 
     float coverSize = 40.0f;
     ImVec2 rowSize{0.0f, coverSize};
@@ -55,6 +61,8 @@ class Table
 
     int columnToSortBy = 0;
     bool sortAscending = false;
+    // [first, last) of the last draw
+    std::pair<uint32_t, uint32_t> visibleRows{0, 0};
 };
 
 // dont even *really* need inheritance here
@@ -0,0 +1,80 @@
+#include <ThreadPool/ThreadPool.hpp>
+
+#include <Testing/Testing.hpp>
+
+#include <atomic>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+/*
+    A chunk that throws has to end up as an exception in the caller of parallelFor, instead of the caller waiting
+    forever or a worker terminating the program. Afterwards the pool has to work like before.
+*/
+
+static void runThrowingJob(ThreadPool& pool, uint32_t throwingChunk, const std::string& what)
+{
+    constexpr uint32_t count = 1 << 16;
+    bool caught = false;
+    try
+    {
+        pool.parallelFor(
+            count,
+            64,
+            [&](uint32_t chunk, uint32_t /*begin*/, uint32_t /*end*/)
+            {
+                if(chunk == throwingChunk)
+                {
+                    throw std::runtime_error(what);
+                }
+            });
+    }
+    catch(const std::runtime_error& error)
+    {
+        caught = error.what() == what;
+    }
+    Testing::check(caught, "exception reaches the caller", what);
+}
+
+static void runNormalJob(ThreadPool& pool, const std::string& what)
+{
+    constexpr uint32_t count = 100000;
+    std::vector<uint32_t> values(count, 0);
+    std::atomic<uint32_t> chunksRun = 0;
+    pool.parallelFor(
+        count,
+        64,
+        [&](uint32_t /*chunk*/, uint32_t begin, uint32_t end)
+        {
+            for(uint32_t i = begin; i < end; i++)
+            {
+                values[i]++;
+            }
+            chunksRun++;
+        });
+    bool allOnce = true;
+    for(const uint32_t value : values)
+    {
+        allOnce = allOnce && value == 1;
+    }
+    Testing::check(allOnce, "every index visited once", what);
+    Testing::check(chunksRun == pool.getChunkCount(count, 64), "every chunk run", what);
+}
+
+int main()
+{
+    for(const uint32_t threadCount : {1U, 2U, 4U, 8U})
+    {
+        ThreadPool pool(threadCount);
+        const std::string threads = std::to_string(threadCount) + " threads";
+        for(int repeat = 0; repeat < 50; repeat++)
+        {
+            // the first chunk runs on the caller, the last one most likely on a worker
+            runThrowingJob(pool, 0, "first chunk, " + threads);
+            runThrowingJob(pool, threadCount - 1, "last chunk, " + threads);
+            runNormalJob(pool, "after a failed job, " + threads);
+        }
+    }
+    return Testing::result("ThreadPoolExceptionTest");
+}
@@ -0,0 +1,179 @@
+#include "ThreadPool.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cstdlib>
+#include <utility>
+
+ThreadPool::ThreadPool(uint32_t p_threadCount) : threadCount(std::max(p_threadCount, 1U))
+{
+    workers.reserve(threadCount - 1);
+    for(uint32_t i = 0; i < threadCount - 1; i++)
+    {
+        workers.emplace_back(&ThreadPool::workerLoop, this);
+    }
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard lock(mutex);
+        stopWorkers = true;
+    }
+    wakeWorkers.notify_all();
+    for(auto& worker : workers)
+    {
+        worker.join();
+    }
+}
+
+uint32_t ThreadPool::getThreadCount() const
+{
+    return threadCount;
+}
+
+uint32_t ThreadPool::getChunkSize(uint32_t count, uint32_t alignment) const
+{
+    assert(alignment > 0);
+    const uint32_t perThread = (count + threadCount - 1) / threadCount;
+    const uint32_t aligned = (perThread + alignment - 1) / alignment * alignment;
+    return std::max(aligned, alignment);
+}
+
+uint32_t ThreadPool::getChunkCount(uint32_t count, uint32_t alignment) const
+{
+    if(count == 0)
+    {
+        return 0;
+    }
+    const uint32_t chunkSize = getChunkSize(count, alignment);
+    return (count + chunkSize - 1) / chunkSize;
+}
+
+void ThreadPool::parallelFor(uint32_t count, uint32_t alignment, const ChunkFunc& func)
+{
+    const uint32_t chunkCount = getChunkCount(count, alignment);
+    if(chunkCount == 0)
+    {
+        return;
+    }
+    if(chunkCount == 1 || workers.empty())
+    {
+        // not worth waking anyone up
+        const uint32_t chunkSize = getChunkSize(count, alignment);
+        for(uint32_t chunk = 0; chunk < chunkCount; chunk++)
+        {
+            func(chunk, chunk * chunkSize, std::min(count, (chunk + 1) * chunkSize));
+        }
+        return;
+    }
+
+    std::lock_guard jobLock(jobMutex);
+    {
+        std::lock_guard lock(mutex);
+        job.func = &func;
+        job.count = count;
+        job.chunkSize = getChunkSize(count, alignment);
+        job.chunkCount = chunkCount;
+        job.nextChunk = 0;
+        job.chunksDone = 0;
+        job.failed = false;
+        job.error = nullptr;
+        jobActive = true;
+        jobGeneration++;
+    }
+    wakeWorkers.notify_all();
+
+    runChunks();
+
+    std::unique_lock lock(mutex);
+    jobDone.wait(lock, [&]() { return job.chunksDone.load() == job.chunkCount && workersInJob == 0; });
+    jobActive = false;
+    if(job.error)
+    {
+        const std::exception_ptr error = std::exchange(job.error, nullptr);
+        lock.unlock();
+        std::rethrow_exception(error);
+    }
+}
+
+void ThreadPool::runChunks()
+{
+    while(true)
+    {
+        const uint32_t chunk = job.nextChunk.fetch_add(1);
+        if(chunk >= job.chunkCount)
+        {
+            return;
+        }
+        const uint32_t begin = chunk * job.chunkSize;
+        const uint32_t end = std::min(job.count, begin + job.chunkSize);
+        // once one chunk failed the others are only counted, the result is thrown away anyways
+        if(!job.failed.load(std::memory_order_relaxed))
+        {
+            try
+            {
+                (*job.func)(chunk, begin, end);
+            }
+            catch(...)
+            {
+                // a worker cant let it escape, the caller would wait forever (or the program terminates)
+                std::lock_guard lock(mutex);
+                if(!job.error)
+                {
+                    job.error = std::current_exception();
+                }
+                job.failed = true;
+            }
+        }
+        if(job.chunksDone.fetch_add(1) + 1 == job.chunkCount)
+        {
+            // lock so the notification cant get lost between the callers check and its wait
+            std::lock_guard lock(mutex);
+            jobDone.notify_all();
+        }
+    }
+}
+
+void ThreadPool::workerLoop()
+{
+    uint64_t seenGeneration = 0;
+    while(true)
+    {
+        {
+            std::unique_lock lock(mutex);
+            wakeWorkers.wait(lock, [&]() { return stopWorkers || jobGeneration != seenGeneration; });
+            if(stopWorkers)
+            {
+                return;
+            }
+            seenGeneration = jobGeneration;
+            // woke up too late, the job is already over
+            if(!jobActive)
+            {
+                continue;
+            }
+            workersInJob++;
+        }
+        runChunks();
+        {
+            std::lock_guard lock(mutex);
+            workersInJob--;
+            jobDone.notify_all();
+        }
+    }
+}
+
+uint32_t ThreadPool::defaultThreadCount()
+{
+    // NOLINTNEXTLINE(concurrency-mt-unsafe) only read once at startup
+    if(const char* env = std::getenv("PLAYLISTFILTER_THREADS"))
+    {
+        const int requested = std::atoi(env);
+        if(requested > 0)
+        {
+            return static_cast<uint32_t>(requested);
+        }
+    }
+    return std::max(std::thread::hardware_concurrency(), 1U);
+}
@@ -0,0 +1,163 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+/*
+    Fixed set of worker threads for splitting up work on large playlists.
+    parallelFor() splits a range into contiguous chunks, so every chunk can write its own part of the output
+    (ie. its own words of a bitset, or its own partial list) and the results can be merged in chunk order.
+    That way the result never depends on which thread happened to process which chunk.
+*/
+class ThreadPool
+{
+  public:
+    /*
+        func(chunkIndex, begin, end)
+        Only refers to the callable it was made from (like std::function_ref), so passing a lambda to
+        parallelFor never allocates. The callable has to outlive it, which a temporary does for the call
+    */
+    class ChunkFunc
+    {
+      public:
+        template <class Func>
+            requires(!std::is_same_v<std::remove_cvref_t<Func>, ChunkFunc>)
+        ChunkFunc(Func&& func) // NOLINT: implicit, so lambdas can be passed directly
+            : callable(const_cast<void*>(static_cast<const void*>(std::addressof(func)))),
+              invoke([](void* callable, uint32_t chunk, uint32_t begin, uint32_t end)
+                     { (*static_cast<std::remove_reference_t<Func>*>(callable))(chunk, begin, end); })
+        {
+        }
+
+        inline void operator()(uint32_t chunk, uint32_t begin, uint32_t end) const
+        {
+            invoke(callable, chunk, begin, end);
+        }
+
+      private:
+        void* callable;
+        void (*invoke)(void*, uint32_t, uint32_t, uint32_t);
+    };
+
+    // threadCount includes the calling thread, so 1 means everything just runs on the caller
+    explicit ThreadPool(uint32_t threadCount = defaultThreadCount());
+    ~ThreadPool();
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+    ThreadPool(ThreadPool&&) = delete;
+    ThreadPool& operator=(ThreadPool&&) = delete;
+
+    [[nodiscard]] uint32_t getThreadCount() const;
+
+    /*
+        Splits [0, count) into at most getThreadCount() chunks. All chunk boundaries are multiples of alignment,
+        so no chunk is smaller than alignment (except the last one).
+        Calls func for every chunk, the calling thread works on chunks as well. Returns once all are done.
+        Doesnt allocate. If several threads call this at the same time the jobs run one after another, func
+        must not call parallelFor of the same pool.
+        If func throws, the chunks that havent started yet are skipped and the first exception is rethrown
+        here once all running chunks are done
+    */
+    void parallelFor(uint32_t count, uint32_t alignment, const ChunkFunc& func);
+    // number of chunks parallelFor uses for the same parameters, for sizing per chunk outputs
+    [[nodiscard]] uint32_t getChunkCount(uint32_t count, uint32_t alignment) const;
+
+    // hardware concurrency, can be overwritten with the PLAYLISTFILTER_THREADS environment variable
+    static uint32_t defaultThreadCount();
+
+  private:
+    // the one job the workers help with, reused for every parallelFor
+    struct Job
+    {
+        const ChunkFunc* func = nullptr;
+        uint32_t count = 0;
+        uint32_t chunkSize = 0;
+        uint32_t chunkCount = 0;
+        std::atomic<uint32_t> nextChunk = 0;
+        std::atomic<uint32_t> chunksDone = 0;
+        // set (under mutex) by the first chunk that throws
+        std::atomic<bool> failed = false;
+        std::exception_ptr error;
+    };
+
+    [[nodiscard]] uint32_t getChunkSize(uint32_t count, uint32_t alignment) const;
+    void workerLoop();
+    void runChunks();
+
+    uint32_t threadCount;
+    std::vector<std::thread> workers;
+
+    // held by the thread whose job is running
+    std::mutex jobMutex;
+    Job job;
+
+    std::mutex mutex;
+    std::condition_variable wakeWorkers;
+    std::condition_variable jobDone;
+    // workers only join the job while it is active, and it only ends once none of them is still in it
+    bool jobActive = false;
+    uint32_t workersInJob = 0;
+    uint64_t jobGeneration = 0;
+    bool stopWorkers = false;
+};
+
+/*
+    Sorts each chunk on its own, then merges neighbouring runs in parallel until one is left.
+    Only gives the same order as std::sort if comp is a strict total order (ie. ties are broken somehow),
+    otherwise the order of equal elements depends on the thread count.
+*/
+template <class RandomIt, class Compare>
+void parallelSort(ThreadPool& pool, RandomIt begin, RandomIt end, Compare comp)
+{
+    // below this many elements per chunk the merging costs more than it saves
+    constexpr uint32_t minChunkSize = 4096;
+    const auto count = static_cast<uint32_t>(end - begin);
+    const uint32_t chunkCount = pool.getChunkCount(count, minChunkSize);
+    if(chunkCount <= 1)
+    {
+        std::sort(begin, end, comp);
+        return;
+    }
+
+    std::vector<uint32_t> runStarts(chunkCount + 1, count);
+    pool.parallelFor(
+        count,
+        minChunkSize,
+        [&](uint32_t chunk, uint32_t first, uint32_t last)
+        {
+            runStarts[chunk] = first;
+            std::sort(begin + first, begin + last, comp);
+        });
+
+    while(runStarts.size() > 2)
+    {
+        const auto runCount = static_cast<uint32_t>(runStarts.size() - 1);
+        const uint32_t pairCount = runCount / 2;
+        pool.parallelFor(
+            pairCount,
+            1,
+            [&](uint32_t /*chunk*/, uint32_t firstPair, uint32_t lastPair)
+            {
+                for(uint32_t p = firstPair; p < lastPair; p++)
+                {
+                    std::inplace_merge(
+                        begin + runStarts[2 * p], begin + runStarts[2 * p + 1], begin + runStarts[2 * p + 2], comp);
+                }
+            });
+        std::vector<uint32_t> mergedStarts;
+        for(uint32_t r = 0; r < runCount; r += 2)
+        {
+            mergedStarts.push_back(runStarts[r]);
+        }
+        mergedStarts.push_back(count);
+        runStarts = std::move(mergedStarts);
+    }
+}
@@ -1,4 +1,5 @@
 #include "Track.hpp"
+#include <FeatureStore/FeatureStore.hpp>
 
 #include <utility>
 
@@ -36,9 +37,43 @@ bool TrackSorter::operator()(const Track* td1, const Track* td2) const
     case 0:
         return td1->index < td2->index;
     case 4 ... 12:
-        return td1->features[index - 4] < td2->features[index - 4];
+    {
+        const float a = features.get(index - 4, td1->index);
+        const float b = features.get(index - 4, td2->index);
+        if(a != b)
+        {
+            return a < b;
+        }
+        // tracks with equal values keep playlist order, so sorting always results in the same order
+        return td1->index < td2->index;
+    }
     default:
         assert(0 && "Column Sorting not handled");
     }
-    return td1->features[7] < td2->features[7]; // shouldnt be reached
-};
\ No newline at end of file
+    return features.get(7, td1->index) < features.get(7, td2->index); // shouldnt be reached
+};
+
+void getArtistMask(std::span<Track* const> tracks, uint32_t artistCount, DynBitset& artists)
+{
+    artists.resize(artistCount);
+    artists.clear();
+    for(const Track* track : tracks)
+    {
+        track->artistMask.forEachSetBit([&](uint32_t artist) { artists.setBit(artist); });
+    }
+}
+
+void findTracksByArtists(std::vector<Track>& tracks, const DynBitset& artists, std::vector<Track*>& found)
+{
+    found.clear();
+    for(Track& track : tracks)
+    {
+        // tracks only have a few artists, just look all of them up
+        bool hasArtist = false;
+        track.artistMask.forEachSetBit([&](uint32_t artist) { hasArtist |= artists.getBit(artist); });
+        if(hasArtist)
+        {
+            found.push_back(&track);
+        }
+    }
+}
@@ -2,13 +2,17 @@
 
 #include <array>
 #include <iostream>
+#include <span>
 #include <string>
 #include <vector>
 
 #include <CommonStructs/CommonStructs.hpp>
+#include <CompressedBitset/CompressedBitset.hpp>
 #include <DynamicBitset/DynamicBitset.hpp>
 #include <utils/utf.hpp>
 
+class FeatureStore;
+
 struct Track
 {
     Track() = default;
@@ -50,21 +54,32 @@ struct Track
          {&FeatureNamesData[71]},
          {&FeatureNamesData[79]},
          {&FeatureNamesData[86]}}};
-    std::array<float, featureAmount> features;
+    // the actual feature values are stored column-wise in a FeatureStore, indexed by Track::index
 
     CoverInfo* coverInfoPtr = nullptr;
 
-    DynBitset genreMask;
-    DynBitset artistMask;
+    // sized to all genres/artists of the playlist, but a track only has a few of them
+    CompressedBitset genreMask;
+    CompressedBitset artistMask;
 
     void decodeNames();
 };
 
 struct TrackSorter
 {
-    explicit TrackSorter(int i) : index(i){};
+    TrackSorter(int i, const FeatureStore& featureStore) : index(i), features(featureStore){};
     bool operator()(const Track* td1, const Track* td2) const;
 
   private:
     int index;
-};
\ No newline at end of file
+    const FeatureStore& features;
+};
+
+/*
+    Both only reuse the storage of their output, so they dont allocate when called again with a similar amount of
+    artists/tracks (ie. while the pins change)
+*/
+// sets artists (resized to artistCount) to the artists of all given tracks together
+void getArtistMask(std::span<Track* const> tracks, uint32_t artistCount, DynBitset& artists);
+// replaces found with the tracks with at least one of the given artists, in playlist order
+void findTracksByArtists(std::vector<Track>& tracks, const DynBitset& artists, std::vector<Track*>& found);
@@ -0,0 +1,220 @@
+#include "MappedFile.hpp"
+
+#include <utility>
+
+#ifdef _WIN32
+    #include <windows.h>
+#else
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+#ifdef _WIN32
+
+MappedFile::MappedFile(const std::filesystem::path& path)
+{
+    HANDLE file = CreateFileW(
+        path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if(file == INVALID_HANDLE_VALUE)
+    {
+        return;
+    }
+    fileHandle = file;
+    LARGE_INTEGER fileSize;
+    if(GetFileSizeEx(file, &fileSize) == 0 || fileSize.QuadPart <= 0)
+    {
+        close();
+        return;
+    }
+    mappingHandle = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if(mappingHandle == nullptr)
+    {
+        close();
+        return;
+    }
+    mapping = static_cast<uint8_t*>(MapViewOfFile(mappingHandle, FILE_MAP_READ, 0, 0, 0));
+    if(mapping == nullptr)
+    {
+        close();
+        return;
+    }
+    size = static_cast<size_t>(fileSize.QuadPart);
+}
+
+MappedFile::MappedFile(const std::filesystem::path& path, size_t writableSize)
+{
+    HANDLE file = CreateFileW(
+        path.c_str(),
+        GENERIC_READ | GENERIC_WRITE,
+        FILE_SHARE_READ,
+        nullptr,
+        OPEN_ALWAYS,
+        FILE_ATTRIBUTE_NORMAL,
+        nullptr);
+    if(file == INVALID_HANDLE_VALUE)
+    {
+        return;
+    }
+    fileHandle = file;
+    LARGE_INTEGER fileSize;
+    if(writableSize != 0)
+    {
+        fileSize.QuadPart = static_cast<LONGLONG>(writableSize);
+        if(SetFilePointerEx(file, fileSize, nullptr, FILE_BEGIN) == 0 || SetEndOfFile(file) == 0)
+        {
+            close();
+            return;
+        }
+    }
+    if(GetFileSizeEx(file, &fileSize) == 0 || fileSize.QuadPart <= 0)
+    {
+        close();
+        return;
+    }
+    mappingHandle = CreateFileMappingW(file, nullptr, PAGE_READWRITE, 0, 0, nullptr);
+    if(mappingHandle == nullptr)
+    {
+        close();
+        return;
+    }
+    mapping = static_cast<uint8_t*>(MapViewOfFile(mappingHandle, FILE_MAP_WRITE, 0, 0, 0));
+    if(mapping == nullptr)
+    {
+        close();
+        return;
+    }
+    size = static_cast<size_t>(fileSize.QuadPart);
+    writable = true;
+}
+
+void MappedFile::close()
+{
+    if(mapping != nullptr)
+    {
+        UnmapViewOfFile(mapping);
+    }
+    if(mappingHandle != nullptr)
+    {
+        CloseHandle(mappingHandle);
+    }
+    if(fileHandle != nullptr)
+    {
+        CloseHandle(fileHandle);
+    }
+    mapping = nullptr;
+    mappingHandle = nullptr;
+    fileHandle = nullptr;
+    size = 0;
+    writable = false;
+}
+
+#else
+
+MappedFile::MappedFile(const std::filesystem::path& path)
+{
+    const int file = open(path.c_str(), O_RDONLY);
+    if(file < 0)
+    {
+        return;
+    }
+    struct stat fileStat
+    {
+    };
+    if(fstat(file, &fileStat) == 0 && fileStat.st_size > 0)
+    {
+        void* view = mmap(nullptr, static_cast<size_t>(fileStat.st_size), PROT_READ, MAP_PRIVATE, file, 0);
+        if(view != MAP_FAILED)
+        {
+            mapping = static_cast<uint8_t*>(view);
+            size = static_cast<size_t>(fileStat.st_size);
+        }
+    }
+    // the mapping stays valid without the descriptor
+    ::close(file);
+}
+
+MappedFile::MappedFile(const std::filesystem::path& path, size_t writableSize)
+{
+    const int file = open(path.c_str(), O_RDWR | O_CREAT, 0644);
+    if(file < 0)
+    {
+        return;
+    }
+    struct stat fileStat
+    {
+    };
+    if((writableSize == 0 || ftruncate(file, static_cast<off_t>(writableSize)) == 0) && fstat(file, &fileStat) == 0
+       && fileStat.st_size > 0)
+    {
+        void* view = mmap(
+            nullptr, static_cast<size_t>(fileStat.st_size), PROT_READ | PROT_WRITE, MAP_SHARED, file, 0);
+        if(view != MAP_FAILED)
+        {
+            mapping = static_cast<uint8_t*>(view);
+            size = static_cast<size_t>(fileStat.st_size);
+            writable = true;
+        }
+    }
+    ::close(file);
+}
+
+void MappedFile::close()
+{
+    if(mapping != nullptr)
+    {
+        munmap(mapping, size);
+    }
+    mapping = nullptr;
+    size = 0;
+    writable = false;
+}
+
+#endif
+
+MappedFile::~MappedFile()
+{
+    close();
+}
+
+MappedFile::MappedFile(MappedFile&& other) noexcept
+{
+    *this = std::move(other);
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept
+{
+    if(this != &other)
+    {
+        close();
+        mapping = std::exchange(other.mapping, nullptr);
+        size = std::exchange(other.size, 0);
+        writable = std::exchange(other.writable, false);
+#ifdef _WIN32
+        fileHandle = std::exchange(other.fileHandle, nullptr);
+        mappingHandle = std::exchange(other.mappingHandle, nullptr);
+#endif
+    }
+    return *this;
+}
+
+bool MappedFile::isOpen() const
+{
+    return mapping != nullptr;
+}
+
+const uint8_t* MappedFile::data() const
+{
+    return mapping;
+}
+
+uint8_t* MappedFile::writableData() const
+{
+    return writable ? mapping : nullptr;
+}
+
+size_t MappedFile::getSize() const
+{
+    return size;
+}
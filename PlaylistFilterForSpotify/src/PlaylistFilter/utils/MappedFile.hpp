@@ -0,0 +1,40 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+
+// Memory mapping of a whole file (read-only unless asked otherwise), unmapped again on destruction
+class MappedFile
+{
+  public:
+    MappedFile() = default;
+    // check isOpen() afterwards, fails if the file doesnt exist, is empty or cant be mapped
+    explicit MappedFile(const std::filesystem::path& path);
+    /*
+        Maps the file for reading and writing, changes are written back to the file.
+        The file is created if it doesnt exist and resized to the given size first, 0 keeps its current size
+    */
+    MappedFile(const std::filesystem::path& path, size_t writableSize);
+    ~MappedFile();
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    MappedFile(MappedFile&& other) noexcept;
+    MappedFile& operator=(MappedFile&& other) noexcept;
+
+    [[nodiscard]] bool isOpen() const;
+    [[nodiscard]] const uint8_t* data() const;
+    // nullptr unless the file was mapped writable
+    [[nodiscard]] uint8_t* writableData() const;
+    [[nodiscard]] size_t getSize() const;
+    void close();
+
+  private:
+    uint8_t* mapping = nullptr;
+    size_t size = 0;
+    bool writable = false;
+#ifdef _WIN32
+    void* fileHandle = nullptr;
+    void* mappingHandle = nullptr;
+#endif
+};
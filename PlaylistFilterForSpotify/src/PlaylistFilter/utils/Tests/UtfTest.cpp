@@ -0,0 +1,27 @@
+#include <utils/utf.hpp>
+
+#include <Testing/Testing.hpp>
+
+#include <string>
+
+/*
+    Decodes and encodes track names with 1 to 4 byte sequences, and checks that invalid utf-8 (overlong,
+    truncated, surrogates, above U+10FFFF) becomes U+FFFD instead of garbage or a crash.
+*/
+
+int main()
+{
+    const std::string encoded = "a\xC3\xA4\xE2\x82\xAC\xF0\x9F\x8E\xB5z";
+    Testing::check(utf8_decode(encoded) == L"aä€\U0001F3B5z", "1 to 4 byte sequences");
+    Testing::check(utf8_encode(utf8_decode(encoded)) == encoded, "encoding gives back the same bytes");
+    Testing::check(utf8_decode(std::string()).empty() && utf8_encode(std::wstring()).empty(), "empty strings");
+
+    Testing::check(utf8_decode(std::string("\xC0\xAF")) == L"��", "overlong");
+    Testing::check(utf8_decode(std::string("\xE2\x82x")) == L"�x", "truncated in the middle");
+    Testing::check(utf8_decode(std::string("x\xE2\x82")) == L"x�", "truncated at the end");
+    Testing::check(utf8_decode(std::string("\xED\xA0\x80")) == L"�", "surrogate");
+    Testing::check(utf8_decode(std::string("\xF4\x90\x80\x80")) == L"�", "above U+10FFFF");
+    Testing::check(utf8_decode(std::string("\x80x")) == L"�x", "stray continuation byte");
+
+    return Testing::result("UtfTest");
+}
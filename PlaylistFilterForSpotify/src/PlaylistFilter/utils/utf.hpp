@@ -34,6 +34,127 @@ std::wstring utf8_decode(const SubstrType& str)
 
 #else
 
-    #error UTF EN - / DECODING IMPLEMENTATION MISSING FOR NON-WINDOWS PLATFORMS
+// wchar_t is utf-32 on linux and macos, utf-16 (surrogate pairs) is handled as well in case it isnt.
+// Invalid input becomes U+FFFD, like with the windows functions
+
+template <typename SubstrType>
+std::string utf8_encode(const SubstrType& wstr)
+{
+    std::string strTo;
+    strTo.reserve(wstr.size());
+    for(size_t i = 0; i < wstr.size(); i++)
+    {
+        char32_t c = static_cast<char32_t>(wstr[i]);
+        if(sizeof(wchar_t) == 2 && c >= 0xD800 && c < 0xDC00 && i + 1 < wstr.size())
+        {
+            const char32_t low = static_cast<char32_t>(wstr[i + 1]);
+            if(low >= 0xDC00 && low < 0xE000)
+            {
+                c = 0x10000 + ((c - 0xD800) << 10) + (low - 0xDC00);
+                i++;
+            }
+        }
+        if((c >= 0xD800 && c < 0xE000) || c > 0x10FFFF)
+        {
+            c = 0xFFFD;
+        }
+
+        if(c < 0x80)
+        {
+            strTo += static_cast<char>(c);
+        }
+        else if(c < 0x800)
+        {
+            strTo += static_cast<char>(0xC0 | (c >> 6));
+            strTo += static_cast<char>(0x80 | (c & 0x3F));
+        }
+        else if(c < 0x10000)
+        {
+            strTo += static_cast<char>(0xE0 | (c >> 12));
+            strTo += static_cast<char>(0x80 | ((c >> 6) & 0x3F));
+            strTo += static_cast<char>(0x80 | (c & 0x3F));
+        }
+        else
+        {
+            strTo += static_cast<char>(0xF0 | (c >> 18));
+            strTo += static_cast<char>(0x80 | ((c >> 12) & 0x3F));
+            strTo += static_cast<char>(0x80 | ((c >> 6) & 0x3F));
+            strTo += static_cast<char>(0x80 | (c & 0x3F));
+        }
+    }
+    return strTo;
+}
+
+// Convert an UTF8 string to a wide Unicode String
+template <typename SubstrType>
+std::wstring utf8_decode(const SubstrType& str)
+{
+    std::wstring wstrTo;
+    wstrTo.reserve(str.size());
+    size_t i = 0;
+    while(i < str.size())
+    {
+        const auto lead = static_cast<unsigned char>(str[i++]);
+        char32_t c = 0xFFFD;
+        // continuation bytes, and the smallest code point that needs that many (anything below is overlong)
+        size_t length = 0;
+        char32_t minimum = 0;
+        if(lead < 0x80)
+        {
+            c = lead;
+        }
+        else if(lead >= 0xC2 && lead < 0xE0)
+        {
+            c = lead & 0x1F;
+            length = 1;
+            minimum = 0x80;
+        }
+        else if(lead >= 0xE0 && lead < 0xF0)
+        {
+            c = lead & 0x0F;
+            length = 2;
+            minimum = 0x800;
+        }
+        else if(lead >= 0xF0 && lead < 0xF5)
+        {
+            c = lead & 0x07;
+            length = 3;
+            minimum = 0x10000;
+        }
+        else
+        {
+            // a stray continuation byte or a lead byte that cant start anything valid
+            length = 0;
+        }
+
+        bool valid = true;
+        for(size_t n = 0; n < length; n++)
+        {
+            if(i >= str.size() || (static_cast<unsigned char>(str[i]) & 0xC0) != 0x80)
+            {
+                // the byte that broke the sequence starts the next one
+                valid = false;
+                break;
+            }
+            c = (c << 6) | (static_cast<unsigned char>(str[i++]) & 0x3F);
+        }
+        if(!valid || c < minimum || c > 0x10FFFF || (c >= 0xD800 && c < 0xE000))
+        {
+            c = 0xFFFD;
+        }
+
+        if(sizeof(wchar_t) == 2 && c >= 0x10000)
+        {
+            c -= 0x10000;
+            wstrTo += static_cast<wchar_t>(0xD800 + (c >> 10));
+            wstrTo += static_cast<wchar_t>(0xDC00 + (c & 0x3FF));
+        }
+        else
+        {
+            wstrTo += static_cast<wchar_t>(c);
+        }
+    }
+    return wstrTo;
+}
 
 #endif
\ No newline at end of file
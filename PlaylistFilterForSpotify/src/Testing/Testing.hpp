@@ -0,0 +1,42 @@
+#pragma once
+
+#include <iostream>
+#include <string_view>
+
+/*
+    What every test executable needs: tests are plain executables that run all of their checks, print the ones
+    that failed and return Testing::result() from main, which is 1 if any check failed (and 0 otherwise).
+*/
+namespace Testing
+{
+    // amount of failed checks so far
+    inline int failures = 0;
+
+    // context is printed behind what failed, ie. the seed and step of a randomized test
+    inline void check(bool condition, std::string_view what, std::string_view context = {})
+    {
+        if(condition)
+        {
+            return;
+        }
+        failures++;
+        std::cout << "FAILED: " << what;
+        if(!context.empty())
+        {
+            std::cout << " (" << context << ")";
+        }
+        std::cout << std::endl;
+    }
+
+    // prints the summary of the test, its main returns this
+    inline int result(std::string_view testName)
+    {
+        if(failures != 0)
+        {
+            std::cout << failures << " checks failed" << std::endl;
+            return 1;
+        }
+        std::cout << testName << " passed" << std::endl;
+        return 0;
+    }
+} // namespace Testing
@@ -0,0 +1,795 @@
+#include "MockSpotifyApi.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <charconv>
+#include <cstdio>
+#include <fstream>
+#include <optional>
+#include <sstream>
+#include <thread>
+#include <utility>
+#include <vector>
+
+/*
+    Every synthetic id is 22 base62 characters, like the real ones:
+        5 characters hash of the playlist id, 5 characters its track count (together the tag of the playlist),
+        1 character kind (Track, Artist, alBum) and 11 characters the index of the track/artist/album
+    So a track id alone is enough to know its playlist and everything about the track.
+*/
+static constexpr std::string_view base62 = "0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz";
+static constexpr size_t idLength = 22;
+static constexpr size_t tagLength = 10;
+
+// a playlist has about one artist for every 6 tracks and one album for every 10
+static constexpr uint32_t tracksPerArtist = 6;
+static constexpr uint32_t tracksPerAlbum = 10;
+static constexpr uint32_t genrePoolSize = 600;
+
+static uint64_t mix(uint64_t value)
+{
+    // splitmix64
+    value += 0x9E3779B97F4A7C15;
+    value = (value ^ (value >> 30)) * 0xBF58476D1CE4E5B9;
+    value = (value ^ (value >> 27)) * 0x94D049BB133111EB;
+    return value ^ (value >> 31);
+}
+
+static uint64_t hashString(std::string_view string)
+{
+    // FNV-1a
+    uint64_t hash = 0xCBF29CE484222325;
+    for(const char c : string)
+    {
+        hash = (hash ^ static_cast<uint8_t>(c)) * 0x100000001B3;
+    }
+    return mix(hash);
+}
+
+// in [0, 1)
+static double toUnit(uint64_t hash)
+{
+    return static_cast<double>(hash >> 11) * 0x1.0p-53;
+}
+
+// below count, the low ones far more often (a few artists have most of the tracks)
+static uint32_t pickSkewed(uint64_t hash, uint32_t count)
+{
+    const double unit = toUnit(hash);
+    return std::min(static_cast<uint32_t>(unit * unit * count), count - 1);
+}
+
+static void appendBase62(std::string& out, uint64_t value, size_t digits)
+{
+    const size_t start = out.size();
+    out.resize(start + digits);
+    for(size_t i = digits; i-- > 0;)
+    {
+        out[start + i] = base62[value % base62.size()];
+        value /= base62.size();
+    }
+}
+
+static std::optional<uint64_t> parseBase62(std::string_view text)
+{
+    uint64_t value = 0;
+    for(const char c : text)
+    {
+        const size_t digit = base62.find(c);
+        if(digit == std::string_view::npos)
+        {
+            return std::nullopt;
+        }
+        value = value * base62.size() + digit;
+    }
+    return value;
+}
+
+struct MockId
+{
+    std::string_view tag;
+    char kind = 0;
+    uint32_t index = 0;
+    uint32_t trackCount = 0;
+};
+
+static std::optional<MockId> parseMockId(std::string_view id)
+{
+    if(id.size() != idLength)
+    {
+        return std::nullopt;
+    }
+    const auto trackCount = parseBase62(id.substr(5, 5));
+    const auto index = parseBase62(id.substr(tagLength + 1));
+    // the index of a track can be past the track count, if an edit added it to the playlist
+    if(!trackCount || !index || *trackCount == 0 || *index > UINT32_MAX)
+    {
+        return std::nullopt;
+    }
+    return MockId{
+        .tag = id.substr(0, tagLength),
+        .kind = id[tagLength],
+        .index = static_cast<uint32_t>(*index),
+        .trackCount = static_cast<uint32_t>(*trackCount)};
+}
+
+static std::string makeId(std::string_view tag, char kind, uint64_t index)
+{
+    std::string id(tag);
+    id += kind;
+    appendBase62(id, index, idLength - tagLength - 1);
+    return id;
+}
+
+static uint32_t getArtistCount(uint32_t trackCount)
+{
+    return std::max(trackCount / tracksPerArtist, 1u);
+}
+
+static uint32_t getAlbumCount(uint32_t trackCount)
+{
+    return std::max(trackCount / tracksPerAlbum, 1u);
+}
+
+// everything about a track follows from its playlist and index
+struct MockTrack
+{
+    uint32_t album = 0;
+    // the first one is the main artist
+    std::vector<uint32_t> artists;
+    uint32_t popularity = 0;
+};
+
+static MockTrack makeTrack(std::string_view tag, uint32_t trackCount, uint32_t index)
+{
+    const uint64_t hash = mix(hashString(tag) ^ (static_cast<uint64_t>(index) * 0xD6E8FEB86659FD93));
+    const uint32_t artistCount = getArtistCount(trackCount);
+    MockTrack track;
+    track.artists.push_back(pickSkewed(hash, artistCount));
+    // a quarter of the tracks are features
+    const uint64_t extraRoll = (hash >> 40) % 100;
+    const uint32_t extraArtists = extraRoll < 5 ? 2 : (extraRoll < 25 ? 1 : 0);
+    for(uint32_t i = 1; i <= extraArtists; i++)
+    {
+        const uint32_t artist = pickSkewed(mix(hash + i), artistCount);
+        if(std::find(track.artists.begin(), track.artists.end(), artist) == track.artists.end())
+        {
+            track.artists.push_back(artist);
+        }
+    }
+    // albums mostly belong to one artist
+    track.album = static_cast<uint32_t>(
+        (static_cast<uint64_t>(track.artists[0]) * 7 + (hash >> 20) % 3) % getAlbumCount(trackCount));
+    track.popularity = static_cast<uint32_t>(hash % 101);
+    return track;
+}
+
+// some names need escaping, like plenty of real ones do
+static void appendName(std::string& out, std::string_view kind, uint32_t index)
+{
+    out += kind;
+    out += ' ';
+    out += std::to_string(index);
+    switch(mix(index) % 8)
+    {
+    case 0:
+        out += R"( (feat. Beyoncé))";
+        break;
+    case 1:
+        out += R"( \"Live\")";
+        break;
+    case 2:
+        out += R"( - テスト)";
+        break;
+    case 3:
+        out += R"( (Caf\u00e9 Mix))";
+        break;
+    default:
+        break;
+    }
+}
+
+static std::string getGenreName(uint32_t genre)
+{
+    static constexpr std::array<std::string_view, 20> prefixes = {
+        "",       "indie ", "alt ",   "dark ",   "deep ",  "dream ", "neo ",   "post ",  "nu ",   "hyper ",
+        "lo-fi ", "acid ",  "art ",   "chill ",  "glitch ", "hard ", "new ",   "proto ", "slow ", "vapor "};
+    static constexpr std::array<std::string_view, 30> words = {
+        "pop",   "rock",     "jazz",    "soul",   "funk",   "house",   "techno", "trance", "dub",   "punk",
+        "metal", "folk",     "country", "blues",  "trap",   "drill",   "grime",  "garage", "disco", "ambient",
+        "wave",  "hardcore", "emo",     "gospel", "reggae", "ska",     "swing",  "bop",    "core",  "hip hop"};
+    const std::string_view word = words[genre / prefixes.size() % words.size()];
+    return std::string(prefixes[genre % prefixes.size()]) + std::string(word);
+}
+
+static void appendImages(std::string& out, std::string_view publicUrl, std::string_view albumId)
+{
+    static constexpr std::array<int, 3> sizes = {640, 300, 64};
+    out += R"("images":[)";
+    for(size_t i = 0; i < sizes.size(); i++)
+    {
+        // 40 hex digits, like the real ones
+        std::string name;
+        for(uint64_t part = 0; name.size() < 40; part++)
+        {
+            char hex[17];
+            const uint64_t bits = mix(hashString(albumId) + sizes[i] * 4 + part);
+            std::snprintf(hex, sizeof(hex), "%016llx", static_cast<unsigned long long>(bits));
+            name += hex;
+        }
+        name.resize(40);
+        out += R"({"height":)" + std::to_string(sizes[i]) + R"(,"url":")" + std::string(publicUrl) + "/image/" +
+               name + R"(","width":)" + std::to_string(sizes[i]) + "}";
+        out += i + 1 < sizes.size() ? "," : "";
+    }
+    out += "]";
+}
+
+static std::string_view getQuery(const MockSpotifyApi::Query& query, std::string_view key)
+{
+    const auto iter = query.find(key);
+    return iter != query.end() ? std::string_view(iter->second) : std::string_view();
+}
+
+static uint32_t getQueryNumber(const MockSpotifyApi::Query& query, std::string_view key, uint32_t fallback)
+{
+    const std::string_view text = getQuery(query, key);
+    uint32_t value = fallback;
+    std::from_chars(text.data(), text.data() + text.size(), value);
+    return value;
+}
+
+static std::vector<std::string_view> splitIds(std::string_view list)
+{
+    std::vector<std::string_view> ids;
+    while(!list.empty())
+    {
+        const size_t comma = list.find(',');
+        ids.push_back(list.substr(0, comma));
+        list.remove_prefix(comma == std::string_view::npos ? list.size() : comma + 1);
+    }
+    return ids;
+}
+
+static MockSpotifyApi::Response makeError(int status, std::string_view message)
+{
+    return {
+        .status = status,
+        .body = R"({"error":{"status":)" + std::to_string(status) + R"(,"message":")" + std::string(message) +
+                R"("}})"};
+}
+
+static std::optional<std::string> readFile(const std::filesystem::path& path)
+{
+    std::ifstream file(path, std::ios::binary);
+    if(!file)
+    {
+        return std::nullopt;
+    }
+    std::stringstream buffer;
+    buffer << file.rdbuf();
+    return std::move(buffer).str();
+}
+
+// the endpoint a path belongs to, every id (22 base62 characters or 40 hex for images) replaced by {id}
+static std::string getEndpoint(std::string_view path)
+{
+    std::string endpoint;
+    while(!path.empty())
+    {
+        const size_t slash = path.find('/', 1);
+        const std::string_view segment = path.substr(0, slash);
+        path.remove_prefix(segment.size());
+        const std::string_view name = segment.substr(1);
+        const bool isId = (name.size() == idLength || name.size() == 40) &&
+                          std::all_of(name.begin(), name.end(), [](char c) { return std::isalnum(c) != 0; });
+        endpoint += isId ? "/{id}" : segment;
+    }
+    return endpoint;
+}
+
+MockSpotifyApi::MockSpotifyApi(MockSpotifyConfig config) : config(std::move(config)), random(this->config.seed)
+{
+}
+
+MockSpotifyApi::Response
+MockSpotifyApi::handle(std::string_view method, std::string_view path, const Query& query)
+{
+    const std::string endpoint = std::string(method) + " " + getEndpoint(path);
+    // for the whole api and the endpoint
+    const auto count = [&](uint64_t Stats::*counter, uint64_t amount)
+    {
+        std::lock_guard lock(mutex);
+        stats.*counter += amount;
+        endpointStats[endpoint].*counter += amount;
+    };
+    count(&Stats::requests, 1);
+    if(config.recordRequests)
+    {
+        std::lock_guard lock(mutex);
+        recordedRequests.push_back({std::string(method), std::string(path), query});
+    }
+
+    if(const int retryAfter = checkThrottle(); retryAfter != 0)
+    {
+        count(&Stats::throttled, 1);
+        Response response = makeError(429, "API rate limit exceeded");
+        response.retryAfter = retryAfter;
+        delay(response.body.size());
+        return response;
+    }
+    const Fault fault = pickFault();
+    if(fault == Fault::ServerError)
+    {
+        count(&Stats::serverErrors, 1);
+        Response response = makeError(503, "Service unavailable");
+        delay(response.body.size());
+        return response;
+    }
+    Response response = answer(method, path, query);
+    if(fault == Fault::Drop)
+    {
+        // it breaks off right after the headers
+        count(&Stats::dropped, 1);
+        response.dropConnection = true;
+        delay(0);
+        return response;
+    }
+    delay(response.body.size());
+    count(&Stats::bytesSent, response.body.size());
+    return response;
+}
+
+int MockSpotifyApi::checkThrottle()
+{
+    const auto now = std::chrono::steady_clock::now();
+    std::lock_guard lock(mutex);
+    while(!recentRequests.empty() && recentRequests.front() + config.window <= now)
+    {
+        recentRequests.pop_front();
+    }
+    int retryAfter = 0;
+    if(config.requestsPerWindow != 0 && recentRequests.size() >= config.requestsPerWindow)
+    {
+        // until the oldest one leaves the window, rounded up
+        const auto wait = recentRequests.front() + config.window - now;
+        retryAfter = static_cast<int>(std::chrono::ceil<std::chrono::seconds>(wait).count());
+        retryAfter = std::max(retryAfter, 1);
+    }
+    else if(
+        config.throttleProbability > 0.0 &&
+        std::uniform_real_distribution<double>(0.0, 1.0)(random) < config.throttleProbability)
+    {
+        retryAfter = static_cast<int>(std::max<int64_t>(config.retryAfter.count(), 1));
+    }
+    if(retryAfter != 0)
+    {
+        return retryAfter;
+    }
+    recentRequests.push_back(now);
+    return 0;
+}
+
+MockSpotifyApi::Fault MockSpotifyApi::pickFault()
+{
+    if(config.serverErrorProbability <= 0.0 && config.dropProbability <= 0.0)
+    {
+        return Fault::None;
+    }
+    std::lock_guard lock(mutex);
+    const double roll = std::uniform_real_distribution<double>(0.0, 1.0)(random);
+    if(roll < config.serverErrorProbability)
+    {
+        return Fault::ServerError;
+    }
+    return roll < config.serverErrorProbability + config.dropProbability ? Fault::Drop : Fault::None;
+}
+
+void MockSpotifyApi::delay(size_t bytes)
+{
+    auto arrival = std::chrono::steady_clock::now() + config.latency;
+    if(config.bytesPerSecond != 0)
+    {
+        // the answer goes out once it's ready and the link is free, then takes its share of the bandwidth
+        const double seconds = static_cast<double>(bytes) / static_cast<double>(config.bytesPerSecond);
+        const auto transfer = std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+            std::chrono::duration<double>(seconds));
+        std::lock_guard lock(mutex);
+        linkFreeAt = std::max(linkFreeAt, arrival) + transfer;
+        arrival = linkFreeAt;
+    }
+    std::this_thread::sleep_until(arrival);
+}
+
+MockSpotifyApi::Response
+MockSpotifyApi::answer(std::string_view method, std::string_view path, const Query& query)
+{
+    if(method == "GET" && path == "/authorize")
+    {
+        Response response{.status = 302};
+        response.location = std::string(getQuery(query, "redirect_uri")) + "?code=mockcode&state=" +
+                            std::string(getQuery(query, "state"));
+        return response;
+    }
+    if(method == "POST" && path == "/api/token")
+    {
+        return {
+            .body = R"({"access_token":"mock-access-token","token_type":"Bearer","scope":"",)"
+                    R"("expires_in":3600,"refresh_token":"mock-refresh-token"})"};
+    }
+    if(method == "GET" && path == "/v1/me")
+    {
+        return {.body = R"({"id":"mockuser","display_name":"Mock User"})"};
+    }
+    if(method == "GET" && path.starts_with("/image/"))
+    {
+        if(!config.recordedDirectory.empty())
+        {
+            Response recorded = answerRecorded(path, query);
+            // generated playlists (see SyntheticPlaylist) dont come with their covers
+            if(recorded.status != 404 || config.imageData.empty())
+            {
+                return recorded;
+            }
+        }
+        return {.contentType = "image/jpeg", .body = config.imageData};
+    }
+    if(method == "POST" && path.starts_with("/v1/users/") && path.ends_with("/playlists"))
+    {
+        // the app takes the id out of the uri
+        const std::string id = makePlaylistId(0);
+        return {.status = 201, .body = R"({"id":")" + id + R"(","uri":"spotify:playlist:)" + id + R"("})"};
+    }
+    if((method == "POST" || method == "PUT") && path.starts_with("/v1/"))
+    {
+        // adding tracks, playback
+        return {.status = 201, .body = R"({"snapshot_id":"mock"})"};
+    }
+    if(method != "GET")
+    {
+        return makeError(405, "Method not allowed");
+    }
+    return config.recordedDirectory.empty() ? answerSynthetic(path, query) : answerRecorded(path, query);
+}
+
+MockSpotifyApi::Response MockSpotifyApi::answerSynthetic(std::string_view path, const Query& query)
+{
+    static constexpr std::string_view playlistsPrefix = "/v1/playlists/";
+    static constexpr std::string_view artistsPrefix = "/v1/artists/";
+    static constexpr std::string_view tracksSuffix = "/tracks";
+    static constexpr std::string_view relatedSuffix = "/related-artists";
+
+    if(path.starts_with(playlistsPrefix))
+    {
+        std::string_view playlistId = path.substr(playlistsPrefix.size());
+        const bool tracks = playlistId.ends_with(tracksSuffix);
+        if(tracks)
+        {
+            playlistId.remove_suffix(tracksSuffix.size());
+        }
+        // the track count is the number the id ends with
+        size_t digits = playlistId.size();
+        while(digits > 0 && std::isdigit(static_cast<unsigned char>(playlistId[digits - 1])) != 0)
+        {
+            digits--;
+        }
+        uint32_t trackCount = config.defaultTrackCount;
+        std::from_chars(playlistId.data() + digits, playlistId.data() + playlistId.size(), trackCount);
+        if(playlistId.empty() || trackCount == 0)
+        {
+            return makeError(404, "Not found.");
+        }
+        std::string tag;
+        appendBase62(tag, hashString(playlistId) ^ config.seed, 5);
+        appendBase62(tag, trackCount, 5);
+
+        const uint32_t offset = getQueryNumber(query, "offset", 0);
+        const uint32_t limit = std::min(getQueryNumber(query, "limit", 100), 100u);
+        // unless the playlist was edited it lists all of its tracks in order
+        uint32_t listedCount = trackCount;
+        std::string snapshotId = tag;
+        bool edited = false;
+        // of the requested page, if edited
+        std::vector<uint32_t> pageIndices;
+        {
+            std::lock_guard lock(mutex);
+            const auto editIter = playlistEdits.find(playlistId);
+            if(editIter != playlistEdits.end())
+            {
+                const PlaylistEdit& edit = editIter->second;
+                edited = true;
+                listedCount = static_cast<uint32_t>(edit.trackIndices.size());
+                snapshotId += "-" + std::to_string(edit.revision);
+                const auto pageBegin = edit.trackIndices.begin() + std::min(offset, listedCount);
+                const auto pageEnd = edit.trackIndices.begin() + std::min(offset + limit, listedCount);
+                pageIndices.assign(pageBegin, pageEnd);
+            }
+        }
+
+        if(!tracks)
+        {
+            return {
+                .body = R"({"name":"Mock playlist )" + std::to_string(trackCount) + R"(","snapshot_id":")" +
+                        snapshotId + R"(","tracks":{"total":)" + std::to_string(listedCount) + "}}"};
+        }
+
+        const uint32_t end = std::min(offset + limit, listedCount);
+        // the app only asks for the ids when syncing
+        const bool idsOnly = getQuery(query, "fields").find("popularity") == std::string_view::npos &&
+                             !getQuery(query, "fields").empty();
+        std::string body = R"({"items":[)";
+        for(uint32_t position = offset; position < end; position++)
+        {
+            const uint32_t index = edited ? pageIndices[position - offset] : position;
+            body += position != offset ? "," : "";
+            body += R"({"track":{)";
+            if(idsOnly)
+            {
+                body += R"("id":")" + makeId(tag, 'T', index) + R"("}})";
+                continue;
+            }
+            const MockTrack track = makeTrack(tag, trackCount, index);
+            const std::string albumId = makeId(tag, 'B', track.album);
+            body += R"("album":{"id":")" + albumId + R"(",)";
+            appendImages(body, config.publicUrl, albumId);
+            body += R"(,"name":")";
+            appendName(body, "Album", track.album);
+            body += R"("},"artists":[)";
+            for(size_t i = 0; i < track.artists.size(); i++)
+            {
+                body += i != 0 ? "," : "";
+                body += R"({"id":")" + makeId(tag, 'A', track.artists[i]) + R"(","name":")";
+                appendName(body, "Artist", track.artists[i]);
+                body += R"("})";
+            }
+            body += R"(],"id":")" + makeId(tag, 'T', index) + R"(","name":")";
+            appendName(body, "Track", index);
+            body += R"(","popularity":)" + std::to_string(track.popularity) + "}}";
+        }
+        body += "]}";
+        return {.body = std::move(body)};
+    }
+
+    if(path == "/v1/audio-features")
+    {
+        std::string body = R"({"audio_features":[)";
+        const std::vector<std::string_view> ids = splitIds(getQuery(query, "ids"));
+        for(size_t i = 0; i < ids.size(); i++)
+        {
+            body += i != 0 ? "," : "";
+            const auto id = parseMockId(ids[i]);
+            if(!id || id->kind != 'T')
+            {
+                body += "null";
+                continue;
+            }
+            const uint64_t hash = hashString(ids[i]);
+            const auto feature = [&](uint64_t salt) { return std::to_string(toUnit(mix(hash + salt))); };
+            body += R"({"id":")" + std::string(ids[i]) + R"(","acousticness":)" + feature(1) +
+                    R"(,"danceability":)" + feature(2) + R"(,"energy":)" + feature(3) +
+                    R"(,"instrumentalness":)" + feature(4) + R"(,"speechiness":)" + feature(5) +
+                    R"(,"liveness":)" + feature(6) + R"(,"valence":)" + feature(7) + R"(,"tempo":)" +
+                    std::to_string(60.0 + 140.0 * toUnit(mix(hash + 8))) + "}";
+        }
+        body += "]}";
+        return {.body = std::move(body)};
+    }
+
+    if(path == "/v1/artists")
+    {
+        std::string body = R"({"artists":[)";
+        const std::vector<std::string_view> ids = splitIds(getQuery(query, "ids"));
+        for(size_t i = 0; i < ids.size(); i++)
+        {
+            body += i != 0 ? "," : "";
+            const auto id = parseMockId(ids[i]);
+            if(!id || id->kind != 'A')
+            {
+                body += "null";
+                continue;
+            }
+            const uint64_t hash = hashString(ids[i]);
+            body += R"({"id":")" + std::string(ids[i]) + R"(","name":")";
+            appendName(body, "Artist", id->index);
+            body += R"(","genres":[)";
+            std::vector<uint32_t> genres;
+            for(uint64_t g = 0; g < hash % 5; g++)
+            {
+                const uint32_t genre = pickSkewed(mix(hash + g), genrePoolSize);
+                if(std::find(genres.begin(), genres.end(), genre) == genres.end())
+                {
+                    genres.push_back(genre);
+                    body += genres.size() > 1 ? "," : "";
+                    body += "\"" + getGenreName(genre) + "\"";
+                }
+            }
+            body += "]}";
+        }
+        body += "]}";
+        return {.body = std::move(body)};
+    }
+
+    if(path.starts_with(artistsPrefix) && path.ends_with(relatedSuffix))
+    {
+        const std::string_view artistId =
+            path.substr(artistsPrefix.size(), path.size() - artistsPrefix.size() - relatedSuffix.size());
+        const auto id = parseMockId(artistId);
+        if(!id || id->kind != 'A')
+        {
+            return makeError(404, "non existing id");
+        }
+        // neighbours in the same playlist
+        const uint32_t artistCount = getArtistCount(id->trackCount);
+        std::string body = R"({"artists":[)";
+        bool first = true;
+        for(uint32_t i = 1; i <= std::min(20u, artistCount - 1); i++)
+        {
+            const uint32_t related = static_cast<uint32_t>((id->index + uint64_t{i} * 7919) % artistCount);
+            if(related == id->index)
+            {
+                continue;
+            }
+            body += first ? "" : ",";
+            first = false;
+            body += R"({"id":")" + makeId(id->tag, 'A', related) + R"(","name":")";
+            appendName(body, "Artist", related);
+            body += R"("})";
+        }
+        body += "]}";
+        return {.body = std::move(body)};
+    }
+
+    if(path == "/v1/recommendations")
+    {
+        const std::vector<std::string_view> seeds = splitIds(getQuery(query, "seed_tracks"));
+        const auto seed = seeds.empty() ? std::nullopt : parseMockId(seeds.front());
+        if(!seed || seed->kind != 'T')
+        {
+            return makeError(400, "invalid request");
+        }
+        // other tracks of the playlist
+        const uint32_t limit = std::min(getQueryNumber(query, "limit", 20), 100u);
+        const uint64_t hash = hashString(seeds.front());
+        std::string body = R"({"seeds":[],"tracks":[)";
+        for(uint32_t i = 0; i < limit; i++)
+        {
+            body += i != 0 ? "," : "";
+            const uint32_t index = static_cast<uint32_t>(mix(hash + i) % seed->trackCount);
+            body += R"({"id":")" + makeId(seed->tag, 'T', index) + R"(","name":")";
+            appendName(body, "Track", index);
+            body += R"("})";
+        }
+        body += "]}";
+        return {.body = std::move(body)};
+    }
+
+    if(path.starts_with("/v1/albums/"))
+    {
+        const std::string_view albumId = path.substr(std::string_view("/v1/albums/").size());
+        const auto id = parseMockId(albumId);
+        if(!id || id->kind != 'B')
+        {
+            return makeError(404, "non existing id");
+        }
+        std::string body = R"({"id":")" + std::string(albumId) + R"(",)";
+        appendImages(body, config.publicUrl, albumId);
+        body += R"(,"name":")";
+        appendName(body, "Album", id->index);
+        body += R"("})";
+        return {.body = std::move(body)};
+    }
+
+    return makeError(404, "Service not found");
+}
+
+MockSpotifyApi::Response MockSpotifyApi::answerRecorded(std::string_view path, const Query& query) const
+{
+    std::string_view relative = path;
+    if(relative.starts_with("/v1/"))
+    {
+        relative.remove_prefix(4);
+    }
+    relative.remove_prefix(relative.starts_with('/') ? 1 : 0);
+    // no way out of the directory
+    if(relative.empty() || relative.find("..") != std::string_view::npos)
+    {
+        return makeError(404, "Not found.");
+    }
+
+    // the endpoints that take a list join the answers of every id
+    const auto joined = [&](std::string_view key) -> Response
+    {
+        std::string body = "{\"" + std::string(key) + "\":[";
+        const std::vector<std::string_view> ids = splitIds(getQuery(query, "ids"));
+        for(size_t i = 0; i < ids.size(); i++)
+        {
+            body += i != 0 ? "," : "";
+            const auto file = ids[i].find_first_of("./\\") == std::string_view::npos
+                                  ? readFile(config.recordedDirectory / relative / (std::string(ids[i]) + ".json"))
+                                  : std::nullopt;
+            body += file ? *file : "null";
+        }
+        body += "]}";
+        return {.body = std::move(body)};
+    };
+    if(relative == "audio-features")
+    {
+        return joined("audio_features");
+    }
+    if(relative == "artists")
+    {
+        return joined("artists");
+    }
+
+    std::filesystem::path file = config.recordedDirectory / relative;
+    Response response;
+    if(relative.starts_with("image/"))
+    {
+        response.contentType = "image/jpeg";
+    }
+    else if(relative.starts_with("playlists/") && relative.ends_with("/tracks"))
+    {
+        file /= std::to_string(getQueryNumber(query, "offset", 0)) + ".json";
+    }
+    else
+    {
+        file += ".json";
+    }
+    auto body = readFile(file);
+    if(!body)
+    {
+        return makeError(404, "Not found.");
+    }
+    response.body = std::move(*body);
+    return response;
+}
+
+MockSpotifyApi::Stats MockSpotifyApi::getStats() const
+{
+    std::lock_guard lock(mutex);
+    return stats;
+}
+
+std::map<std::string, uint64_t> MockSpotifyApi::getEndpointCounts() const
+{
+    std::lock_guard lock(mutex);
+    std::map<std::string, uint64_t> counts;
+    for(const auto& [endpoint, endpointStat] : endpointStats)
+    {
+        counts.emplace(endpoint, endpointStat.requests);
+    }
+    return counts;
+}
+
+std::map<std::string, MockSpotifyApi::Stats> MockSpotifyApi::getEndpointStats() const
+{
+    std::lock_guard lock(mutex);
+    return endpointStats;
+}
+
+const MockSpotifyConfig& MockSpotifyApi::getConfig() const
+{
+    return config;
+}
+
+std::vector<MockSpotifyApi::RecordedRequest> MockSpotifyApi::takeRecordedRequests()
+{
+    std::lock_guard lock(mutex);
+    return std::exchange(recordedRequests, {});
+}
+
+void MockSpotifyApi::editPlaylist(std::string_view playlistId, std::vector<uint32_t> trackIndices)
+{
+    std::lock_guard lock(mutex);
+    PlaylistEdit& edit = playlistEdits[std::string(playlistId)];
+    edit.trackIndices = std::move(trackIndices);
+    edit.revision++;
+}
+
+std::string MockSpotifyApi::makePlaylistId(uint32_t trackCount)
+{
+    // 22 characters like a real id, so the app takes it as one
+    std::string id = std::to_string(trackCount);
+    return "mockplaylist" + std::string(10 - std::min<size_t>(id.size(), 10), '0') + id;
+}
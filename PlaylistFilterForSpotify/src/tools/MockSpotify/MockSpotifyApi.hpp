@@ -0,0 +1,166 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <filesystem>
+#include <map>
+#include <mutex>
+#include <random>
+#include <string>
+#include <string_view>
+#include <vector>
+
+struct MockSpotifyConfig
+{
+    // every response is held back this long
+    std::chrono::milliseconds latency{0};
+    // bytes per second for all responses together (a single shared link), 0 is unlimited
+    uint64_t bytesPerSecond = 0;
+    // more requests than this in the rolling window are answered with 429 (like spotify does), 0 is unlimited
+    uint32_t requestsPerWindow = 0;
+    std::chrono::milliseconds window{30000};
+    // share of the requests (0 to 1) that get a 429 anyway
+    double throttleProbability = 0.0;
+    // sent with the injected 429s, the ones of the window say when the oldest request leaves it
+    std::chrono::seconds retryAfter{1};
+    // share of the requests (0 to 1) that get a 503
+    double serverErrorProbability = 0.0;
+    // share of the requests (0 to 1) whose connection is closed in the middle of the answer
+    double dropProbability = 0.0;
+
+    // if set, answers are read from there instead of being generated (see MockSpotifyApi)
+    std::filesystem::path recordedDirectory;
+    // synthetic playlists without a track count in their id get this many tracks
+    uint32_t defaultTrackCount = 1000;
+    // served for every cover image
+    std::string imageData;
+    // scheme, host and port the server is reachable under, the generated cover urls point there
+    std::string publicUrl = "http://127.0.0.1";
+    uint64_t seed = 1;
+    // keep every request for takeRecordedRequests(), ie. for tests to check what the app asked for
+    bool recordRequests = false;
+};
+
+/*
+    Answers requests the way the parts of the spotify web api the app uses do, without any network:
+        GET  /v1/playlists/{id}                     name, snapshot id and track count
+        GET  /v1/playlists/{id}/tracks              pages of tracks (offset, limit, fields=items(track(id)))
+        GET  /v1/audio-features?ids=                up to 100 tracks
+        GET  /v1/artists?ids=                       up to 50 artists, with their genres
+        GET  /v1/artists/{id}/related-artists
+        GET  /v1/recommendations?seed_tracks=
+        GET  /v1/me
+        GET  /image/{id}                            the configured image
+        GET  /authorize                             redirects straight back to redirect_uri with a code
+        POST /api/token                             a token that never expires (in practice)
+        POST /v1/users/{id}/playlists, /v1/playlists/{id}/tracks, /v1/me/player/... accepted and forgotten
+    Synthetic playlists are generated from their id, nothing is stored: the id decides how many tracks there
+    are (the number it ends with, ie. mockplaylist0000200000 has 200000 tracks) and the ids of tracks, artists
+    and albums say which playlist they belong to, so their details can be generated from the id alone.
+    editPlaylist() changes which of those tracks a synthetic playlist lists, and its snapshot id with it.
+    Recorded answers are files below recordedDirectory, named after the path of the request:
+        playlists/{id}.json, playlists/{id}/tracks/{offset}.json, artists/{id}/related-artists.json,
+        recommendations.json, image/{id} (the configured image if there is no such file)
+    The endpoints that take a list of ids join the files of every id instead, audio-features/{id}.json and
+    artists/{id}.json (missing ones are null, as spotify does).
+    Throttling, the injected errors and the configured latency and bandwidth are applied to both, handle() blocks
+    until the answer would have arrived. Thread safe.
+*/
+class MockSpotifyApi
+{
+  public:
+    struct Response
+    {
+        int status = 200;
+        std::string contentType = "application/json";
+        std::string body;
+        // for 429s, in seconds
+        int retryAfter = 0;
+        // for redirects
+        std::string location;
+        // close the connection after the headers instead of sending the body
+        bool dropConnection = false;
+    };
+
+    struct Stats
+    {
+        uint64_t requests = 0;
+        uint64_t throttled = 0;
+        // injected 503s
+        uint64_t serverErrors = 0;
+        uint64_t dropped = 0;
+        uint64_t bytesSent = 0;
+    };
+
+    using Query = std::multimap<std::string, std::string, std::less<>>;
+
+    struct RecordedRequest
+    {
+        std::string method;
+        std::string path;
+        Query query;
+    };
+
+    explicit MockSpotifyApi(MockSpotifyConfig config);
+
+    // path without scheme and host, the query already decoded
+    Response handle(std::string_view method, std::string_view path, const Query& query);
+
+    [[nodiscard]] Stats getStats() const;
+    // by endpoint (method and path), ids replaced by {id}
+    [[nodiscard]] std::map<std::string, uint64_t> getEndpointCounts() const;
+    [[nodiscard]] std::map<std::string, Stats> getEndpointStats() const;
+    [[nodiscard]] const MockSpotifyConfig& getConfig() const;
+    // the requests since the last call, in the order they came in (only with config.recordRequests)
+    std::vector<RecordedRequest> takeRecordedRequests();
+
+    /*
+        From now on the synthetic playlist lists these of its tracks, in this order (indices of the tracks that are
+        generated for it, the same one can be listed several times). Indices past its track count are tracks it
+        didnt have before, with artists and albums of the playlist like the others.
+        Every edit gives the playlist a new snapshot id
+    */
+    void editPlaylist(std::string_view playlistId, std::vector<uint32_t> trackIndices);
+
+    // a synthetic playlist with the given number of tracks
+    static std::string makePlaylistId(uint32_t trackCount);
+
+  private:
+    enum class Fault
+    {
+        None,
+        ServerError,
+        Drop
+    };
+
+    // 0 if the request may go through, otherwise the Retry-After in seconds
+    int checkThrottle();
+    Fault pickFault();
+    // holds the calling thread back for the latency and its share of the bandwidth
+    void delay(size_t bytes);
+
+    Response answer(std::string_view method, std::string_view path, const Query& query);
+    Response answerSynthetic(std::string_view path, const Query& query);
+    Response answerRecorded(std::string_view path, const Query& query) const;
+
+    MockSpotifyConfig config;
+
+    mutable std::mutex mutex;
+    std::mt19937_64 random;
+    // start of the requests in the current window
+    std::deque<std::chrono::steady_clock::time_point> recentRequests;
+    // when the shared link is free again
+    std::chrono::steady_clock::time_point linkFreeAt;
+    Stats stats;
+    std::map<std::string, Stats> endpointStats;
+    std::vector<RecordedRequest> recordedRequests;
+
+    struct PlaylistEdit
+    {
+        std::vector<uint32_t> trackIndices;
+        // counts the edits, part of the snapshot id
+        uint32_t revision = 0;
+    };
+    std::map<std::string, PlaylistEdit, std::less<>> playlistEdits;
+};
@@ -0,0 +1,91 @@
+#include "MockSpotifyServer.hpp"
+
+#include <httplib.h>
+
+#include <algorithm>
+
+// every kept alive connection holds one of them, and the client has plenty (api and covers)
+static constexpr size_t serverThreads = 128;
+
+MockSpotifyServer::MockSpotifyServer(MockSpotifyConfig config, const std::string& host, int port)
+    : server(std::make_unique<httplib::Server>())
+{
+    this->port = port == 0 ? server->bind_to_any_port(host) : (server->bind_to_port(host, port) ? port : -1);
+    if(this->port <= 0)
+    {
+        this->port = -1;
+        return;
+    }
+    url = "http://" + host + ":" + std::to_string(this->port);
+    config.publicUrl = url;
+    api = std::make_unique<MockSpotifyApi>(std::move(config));
+
+    server->new_task_queue = [] { return new httplib::ThreadPool(serverThreads); };
+    server->set_keep_alive_max_count(100000);
+    const auto handler = [this](const httplib::Request& request, httplib::Response& response)
+    {
+        const MockSpotifyApi::Query query(request.params.begin(), request.params.end());
+        MockSpotifyApi::Response answer = api->handle(request.method, request.path, query);
+        if(!answer.location.empty())
+        {
+            response.set_redirect(answer.location, answer.status);
+            return;
+        }
+        response.status = answer.status;
+        if(answer.retryAfter != 0)
+        {
+            response.set_header("Retry-After", std::to_string(answer.retryAfter));
+        }
+        if(answer.dropConnection)
+        {
+            // the headers announce the body, but the provider gives up before sending any of it, so the
+            // connection is closed and the client sees a broken off transfer
+            response.set_content_provider(
+                std::max<size_t>(answer.body.size(), 1),
+                answer.contentType,
+                [](size_t /*offset*/, size_t /*length*/, httplib::DataSink& /*sink*/) { return false; });
+            return;
+        }
+        response.set_content(std::move(answer.body), answer.contentType);
+    };
+    server->Get(".*", handler);
+    server->Post(".*", handler);
+    server->Put(".*", handler);
+
+    listenThread = std::thread([this] { server->listen_after_bind(); });
+    server->wait_until_ready();
+}
+
+MockSpotifyServer::~MockSpotifyServer()
+{
+    stop();
+}
+
+bool MockSpotifyServer::isRunning() const
+{
+    return listenThread.joinable();
+}
+
+int MockSpotifyServer::getPort() const
+{
+    return port;
+}
+
+const std::string& MockSpotifyServer::getUrl() const
+{
+    return url;
+}
+
+MockSpotifyApi& MockSpotifyServer::getApi()
+{
+    return *api;
+}
+
+void MockSpotifyServer::stop()
+{
+    if(listenThread.joinable())
+    {
+        server->stop();
+        listenThread.join();
+    }
+}
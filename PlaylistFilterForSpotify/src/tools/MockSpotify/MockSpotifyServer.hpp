@@ -0,0 +1,46 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <thread>
+
+#include <MockSpotify/MockSpotifyApi.hpp>
+
+namespace httplib
+{
+class Server;
+}
+
+/*
+    Serves a MockSpotifyApi over http on a thread of its own, until it is stopped or destroyed.
+    The web api and the accounts service are both under getUrl() (the web api below /v1), so
+    SpotifyApiAccess(getUrl() + "/v1", getUrl()) talks to it instead of spotify.
+*/
+class MockSpotifyServer
+{
+  public:
+    // port 0 picks a free one. The publicUrl of the config is replaced by where the server ends up
+    explicit MockSpotifyServer(MockSpotifyConfig config, const std::string& host = "127.0.0.1", int port = 0);
+    ~MockSpotifyServer();
+    MockSpotifyServer(const MockSpotifyServer&) = delete;
+    MockSpotifyServer& operator=(const MockSpotifyServer&) = delete;
+    MockSpotifyServer(MockSpotifyServer&&) = delete;
+    MockSpotifyServer& operator=(MockSpotifyServer&&) = delete;
+
+    // false if the port couldnt be bound
+    [[nodiscard]] bool isRunning() const;
+    [[nodiscard]] int getPort() const;
+    // scheme, host and port
+    [[nodiscard]] const std::string& getUrl() const;
+    MockSpotifyApi& getApi();
+
+    // blocks until the requests in flight are answered
+    void stop();
+
+  private:
+    std::unique_ptr<httplib::Server> server;
+    std::unique_ptr<MockSpotifyApi> api;
+    std::thread listenThread;
+    int port = -1;
+    std::string url;
+};
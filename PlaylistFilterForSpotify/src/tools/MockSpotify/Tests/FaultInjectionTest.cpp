@@ -0,0 +1,99 @@
+#include <MockSpotify/MockSpotifyServer.hpp>
+#include <Spotify/PlaylistSource.hpp>
+#include <Spotify/PlaylistStream.hpp>
+#include <Spotify/SpotifyApiAccess.hpp>
+
+#include <Testing/Testing.hpp>
+
+#include <cstdint>
+#include <exception>
+#include <iostream>
+#include <map>
+#include <string>
+#include <string_view>
+
+/*
+    Loads a playlist from a mock that answers some requests with 429 or 503 and drops the connection of others.
+    The load has to complete with the same playlist as from a mock without any errors, and for every endpoint the
+    transport has to count exactly the 429s (throttled) and 503s and dropped connections (retried) the mock
+    injected, without giving up on any request.
+*/
+
+static PlaylistSource load(MockSpotifyServer& server, const std::string& playlistId)
+{
+    SpotifyApiAccess apiAccess(server.getUrl() + "/v1", server.getUrl(), RateLimit{});
+    LoadProgress progress;
+    return apiAccess.downloadPlaylist(playlistId, progress);
+}
+
+static bool equalTracks(const PlaylistSource& a, const PlaylistSource& b)
+{
+    if(a.tracks.size() != b.tracks.size() || a.artistGenres != b.artistGenres)
+    {
+        return false;
+    }
+    for(size_t i = 0; i < a.tracks.size(); i++)
+    {
+        if(a.tracks[i].id != b.tracks[i].id || a.tracks[i].artistIds != b.tracks[i].artistIds ||
+           a.tracks[i].albumId != b.tracks[i].albumId || a.tracks[i].features != b.tracks[i].features)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+int main()
+{
+    // about 330 requests, so every kind of error happens plenty of times
+    constexpr uint32_t trackCount = 10000;
+    const std::string playlistId = MockSpotifyApi::makePlaylistId(trackCount);
+
+    MockSpotifyServer cleanServer(MockSpotifyConfig{});
+    MockSpotifyConfig config;
+    config.throttleProbability = 0.02;
+    config.serverErrorProbability = 0.04;
+    config.dropProbability = 0.04;
+    MockSpotifyServer server(config);
+    if(!cleanServer.isRunning() || !server.isRunning())
+    {
+        std::cout << "could not start the mock servers" << std::endl;
+        return 1;
+    }
+
+    const PlaylistSource expected = load(cleanServer, playlistId);
+    SpotifyApiAccess apiAccess(server.getUrl() + "/v1", server.getUrl(), RateLimit{});
+    LoadProgress progress;
+    try
+    {
+        const PlaylistSource source = apiAccess.downloadPlaylist(playlistId, progress);
+        Testing::check(source.tracks.size() == trackCount, "all tracks are loaded");
+        Testing::check(equalTracks(source, expected), "same playlist as without errors");
+    }
+    catch(const std::exception& e)
+    {
+        Testing::check(false, std::string("load completes, but threw ") + e.what());
+    }
+
+    const MockSpotifyApi::Stats injected = server.getApi().getStats();
+    Testing::check(
+        injected.throttled != 0 && injected.serverErrors != 0 && injected.dropped != 0, "errors were injected");
+
+    // the mock names endpoints with their method, the transport only by path
+    std::map<std::string, HttpTransport::EndpointStats> transportStats = apiAccess.getTransport().getEndpointStats();
+    for(const auto& [endpoint, mockStats] : server.getApi().getEndpointStats())
+    {
+        const std::string path = endpoint.substr(endpoint.find(' ') + 1);
+        const HttpTransport::EndpointStats& sent = transportStats[path];
+        Testing::check(sent.sent == mockStats.requests, path + ": every request is counted as sent");
+        Testing::check(sent.throttled == mockStats.throttled, path + ": 429s are counted as throttled");
+        Testing::check(
+            sent.retried == mockStats.serverErrors + mockStats.dropped,
+            path + ": 503s and dropped connections are counted as retried");
+        Testing::check(sent.failed == 0, path + ": no request is given up on");
+        std::cout << path << ": " << sent.sent << " sent, " << sent.throttled << " throttled, " << sent.retried
+                  << " retried" << std::endl;
+    }
+
+    return Testing::result("FaultInjectionTest");
+}
@@ -0,0 +1,277 @@
+#include <MockSpotify/MockSpotifyServer.hpp>
+#include <Spotify/PlaylistSource.hpp>
+#include <Spotify/PlaylistStream.hpp>
+#include <Spotify/SpotifyApiAccess.hpp>
+
+#include <Testing/Testing.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <iostream>
+#include <numeric>
+#include <set>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/*
+    Edits a playlist of the mock (appending, inserting, removing, moving and replacing tracks) and syncs the
+    downloaded playlist after every edit. Checks that the sync only downloads the pages that have new tracks on
+    them, only asks for the audio features of the new tracks and the genres of the new artists, and that the
+    synced playlist builds exactly the same tables as downloading it again from scratch.
+*/
+
+static std::vector<std::string_view> splitIds(std::string_view list)
+{
+    std::vector<std::string_view> ids;
+    while(!list.empty())
+    {
+        const size_t comma = list.find(',');
+        ids.push_back(list.substr(0, comma));
+        list.remove_prefix(comma == std::string_view::npos ? list.size() : comma + 1);
+    }
+    return ids;
+}
+
+// what the sync asked the mock for
+struct SyncRequests
+{
+    // of the pages with full track data
+    std::set<uint32_t> pageOffsets;
+    uint32_t pageRequests = 0;
+    std::multiset<std::string> featureIds;
+    std::multiset<std::string> artistIds;
+};
+
+static SyncRequests collectRequests(const std::vector<MockSpotifyApi::RecordedRequest>& requests)
+{
+    SyncRequests collected;
+    for(const MockSpotifyApi::RecordedRequest& request : requests)
+    {
+        const auto getQuery = [&](const std::string& key)
+        {
+            const auto iter = request.query.find(key);
+            return iter != request.query.end() ? std::string_view(iter->second) : std::string_view();
+        };
+        if(request.path.ends_with("/tracks") && getQuery("fields").find("popularity") != std::string_view::npos)
+        {
+            collected.pageOffsets.insert(static_cast<uint32_t>(std::stoul(std::string(getQuery("offset")))));
+            collected.pageRequests++;
+        }
+        else if(request.path == "/v1/audio-features")
+        {
+            for(const std::string_view id : splitIds(getQuery("ids")))
+            {
+                collected.featureIds.emplace(id);
+            }
+        }
+        else if(request.path == "/v1/artists")
+        {
+            for(const std::string_view id : splitIds(getQuery("ids")))
+            {
+                collected.artistIds.emplace(id);
+            }
+        }
+    }
+    return collected;
+}
+
+static bool equalSources(const PlaylistSource& synced, const PlaylistSource& reloaded)
+{
+    if(synced.snapshotId != reloaded.snapshotId || synced.tracks.size() != reloaded.tracks.size() ||
+       synced.pageHashes != reloaded.pageHashes || synced.artistGenres != reloaded.artistGenres)
+    {
+        return false;
+    }
+    for(size_t i = 0; i < synced.tracks.size(); i++)
+    {
+        const TrackSource& a = synced.tracks[i];
+        const TrackSource& b = reloaded.tracks[i];
+        if(a.id != b.id || a.name != b.name || a.artistsNames != b.artistsNames || a.artistIds != b.artistIds ||
+           a.albumId != b.albumId || a.albumName != b.albumName || a.coverUrl != b.coverUrl ||
+           a.features != b.features)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+static void comparePlaylistData(const PlaylistSource& synced, const PlaylistSource& reloaded, std::string_view edit)
+{
+    const SpotifyApiAccess::PlaylistData_t syncedData = buildPlaylistData(synced);
+    const SpotifyApiAccess::PlaylistData_t reloadedData = buildPlaylistData(reloaded);
+    const auto& [syncedTracks, syncedFeatures, syncedCovers, syncedGenres, syncedGenreTracks, syncedArtists, _] =
+        syncedData;
+    const auto& [tracks, features, covers, genres, genreTracks, artists, __] = reloadedData;
+
+    bool tracksEqual = syncedTracks.size() == tracks.size();
+    for(size_t i = 0; tracksEqual && i < tracks.size(); i++)
+    {
+        const Track& a = syncedTracks[i];
+        const Track& b = tracks[i];
+        tracksEqual = a.index == b.index && a.id == b.id && a.trackNameEncoded == b.trackNameEncoded &&
+                      a.artistsNamesEncoded == b.artistsNamesEncoded && a.albumId == b.albumId &&
+                      a.albumNameEncoded == b.albumNameEncoded && a.coverInfoPtr != nullptr &&
+                      b.coverInfoPtr != nullptr && a.coverInfoPtr->albumId == b.coverInfoPtr->albumId;
+    }
+    Testing::check(tracksEqual, "tracks", edit);
+
+    bool masksEqual = tracksEqual;
+    for(size_t i = 0; masksEqual && i < tracks.size(); i++)
+    {
+        masksEqual = syncedTracks[i].genreMask == tracks[i].genreMask &&
+                     syncedTracks[i].artistMask == tracks[i].artistMask;
+    }
+    Testing::check(masksEqual, "genre and artist masks of the tracks", edit);
+
+    bool featuresEqual = syncedFeatures.getTrackCount() == features.getTrackCount();
+    for(uint32_t i = 0; featuresEqual && i < features.getTrackCount(); i++)
+    {
+        for(int f = 0; f < Track::featureAmount; f++)
+        {
+            featuresEqual = featuresEqual && syncedFeatures.get(f, i) == features.get(f, i);
+        }
+    }
+    Testing::check(featuresEqual, "features", edit);
+
+    bool coversEqual = syncedCovers.size() == covers.size();
+    for(const auto& [albumId, cover] : covers)
+    {
+        const auto iter = syncedCovers.find(albumId);
+        coversEqual = coversEqual && iter != syncedCovers.end() && iter->second.url == cover.url;
+    }
+    Testing::check(coversEqual, "cover table", edit);
+
+    Testing::check(syncedGenres == genres && syncedGenreTracks == genreTracks, "genres and their tracks", edit);
+    Testing::check(syncedArtists == artists, "artists", edit);
+}
+
+int main()
+{
+    MockSpotifyConfig config;
+    config.recordRequests = true;
+    MockSpotifyServer server(config);
+    if(!server.isRunning())
+    {
+        std::cout << "could not start the mock server" << std::endl;
+        return 1;
+    }
+    MockSpotifyApi& mock = server.getApi();
+    SpotifyApiAccess apiAccess(server.getUrl() + "/v1", server.getUrl(), RateLimit{});
+    LoadProgress progress;
+
+    // 20 full pages
+    constexpr uint32_t trackCount = 1000;
+    const std::string playlistId = MockSpotifyApi::makePlaylistId(trackCount);
+    std::vector<uint32_t> listed(trackCount);
+    std::iota(listed.begin(), listed.end(), 0);
+    PlaylistSource source = apiAccess.downloadPlaylist(playlistId, progress);
+    Testing::check(source.tracks.size() == trackCount, "first download", "none");
+
+    // the next track the playlist didnt have before
+    uint32_t nextNewTrack = trackCount;
+    const auto newTracks = [&](uint32_t count)
+    {
+        std::vector<uint32_t> added(count);
+        std::iota(added.begin(), added.end(), nextNewTrack);
+        nextNewTrack += count;
+        return added;
+    };
+
+    struct Edit
+    {
+        std::string_view name;
+        void (*apply)(std::vector<uint32_t>& listed, const std::vector<uint32_t>& added);
+        uint32_t addedCount = 0;
+    };
+    const std::vector<Edit> edits = {
+        {"append over three pages",
+         [](std::vector<uint32_t>& listed, const std::vector<uint32_t>& added)
+         { listed.insert(listed.end(), added.begin(), added.end()); },
+         120},
+        // every later page shifts, but only the one with the new tracks has to be downloaded
+        {"insert in the middle",
+         [](std::vector<uint32_t>& listed, const std::vector<uint32_t>& added)
+         { listed.insert(listed.begin() + 130, added.begin(), added.end()); },
+         3},
+        {"remove",
+         [](std::vector<uint32_t>& listed, const std::vector<uint32_t>& /*added*/)
+         { listed.erase(listed.begin() + 400, listed.begin() + 460); }},
+        {"reorder",
+         [](std::vector<uint32_t>& listed, const std::vector<uint32_t>& /*added*/)
+         {
+             std::rotate(listed.begin(), listed.begin() + 10, listed.end());
+             std::reverse(listed.begin() + 200, listed.begin() + 260);
+         }},
+        {"replace and duplicate",
+         [](std::vector<uint32_t>& listed, const std::vector<uint32_t>& added)
+         {
+             std::copy(added.begin(), added.end(), listed.begin() + 355);
+             listed.push_back(listed.front());
+         },
+         5},
+    };
+
+    for(const Edit& edit : edits)
+    {
+        std::set<std::string> knownTracks;
+        for(const TrackSource& track : source.tracks)
+        {
+            knownTracks.insert(track.id);
+        }
+        std::set<std::string> knownArtists;
+        for(const auto& [artistId, genres] : source.artistGenres)
+        {
+            knownArtists.insert(artistId);
+        }
+
+        edit.apply(listed, newTracks(edit.addedCount));
+        mock.editPlaylist(playlistId, listed);
+        mock.takeRecordedRequests();
+        Testing::check(apiAccess.syncPlaylist(playlistId, source, progress), "sync finds the change", edit.name);
+        const SyncRequests requests = collectRequests(mock.takeRecordedRequests());
+
+        const PlaylistSource reloaded = apiAccess.downloadPlaylist(playlistId, progress);
+        Testing::check(reloaded.tracks.size() == listed.size(), "reload", edit.name);
+
+        // what the sync should have asked for, going by the reloaded playlist
+        std::set<uint32_t> changedPageOffsets;
+        std::multiset<std::string> newTrackIds;
+        std::set<std::string> newArtistIds;
+        for(uint32_t i = 0; i < reloaded.tracks.size(); i++)
+        {
+            const TrackSource& track = reloaded.tracks[i];
+            if(!knownTracks.contains(track.id))
+            {
+                changedPageOffsets.insert(i / PlaylistSource::pageSize * PlaylistSource::pageSize);
+                newTrackIds.insert(track.id);
+            }
+            for(const std::string& artistId : track.artistIds)
+            {
+                if(!knownArtists.contains(artistId))
+                {
+                    newArtistIds.insert(artistId);
+                }
+            }
+        }
+        Testing::check(
+            requests.pageOffsets == changedPageOffsets && requests.pageRequests == changedPageOffsets.size(),
+            "only the pages with new tracks are downloaded",
+            edit.name);
+        Testing::check(
+            requests.featureIds == newTrackIds, "only the features of new tracks are requested", edit.name);
+        Testing::check(
+            requests.artistIds == std::multiset<std::string>(newArtistIds.begin(), newArtistIds.end()),
+            "only the genres of new artists are requested",
+            edit.name);
+
+        Testing::check(equalSources(source, reloaded), "synced playlist equals a reload", edit.name);
+        comparePlaylistData(source, reloaded, edit.name);
+    }
+
+    Testing::check(
+        !apiAccess.syncPlaylist(playlistId, source, progress), "no changes after the last sync", "none");
+
+    return Testing::result("PlaylistSyncTest");
+}
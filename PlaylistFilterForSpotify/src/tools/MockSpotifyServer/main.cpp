@@ -0,0 +1,164 @@
+#include <MockSpotify/MockSpotifyServer.hpp>
+
+#include <charconv>
+#include <chrono>
+#include <csignal>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <thread>
+
+static constexpr std::string_view usage =
+    "MockSpotifyServer [options]\n"
+    "  --port <n>            default 8888, 0 picks a free one\n"
+    "  --host <address>      default 127.0.0.1\n"
+    "  --latency <ms>        added to every response\n"
+    "  --bandwidth <kB/s>    shared by all responses, 0 is unlimited\n"
+    "  --rate-limit <n>      requests per 30 seconds before answering with 429, 0 is unlimited\n"
+    "  --throttle <0..1>     share of requests answered with 429 anyway\n"
+    "  --retry-after <s>     Retry-After of those, default 1\n"
+    "  --server-errors <0..1> share of requests answered with 503\n"
+    "  --drop <0..1>         share of requests whose connection is dropped in the middle of the answer\n"
+    "  --recorded <dir>      answer from recorded files instead of generated data\n"
+    "  --image <file>        served for every cover, default misc/albumPlaceholder.jpg\n"
+    "  --tracks <n>          tracks of playlists whose id doesnt end in a number, default 1000\n"
+    "  --seed <n>\n";
+
+static volatile std::sig_atomic_t running = 1;
+
+template <typename T>
+static bool parseNumber(std::string_view text, T& value)
+{
+    const auto [end, error] = std::from_chars(text.data(), text.data() + text.size(), value);
+    return error == std::errc() && end == text.data() + text.size();
+}
+
+int main(int argc, char* argv[])
+{
+    MockSpotifyConfig config;
+    std::string host = "127.0.0.1";
+    int port = 8888;
+    std::string imagePath = MISC_PATH "/albumPlaceholder.jpg";
+    for(int i = 1; i < argc; i++)
+    {
+        const std::string_view option = argv[i];
+        if(option == "--help" || i + 1 >= argc)
+        {
+            std::cout << usage;
+            return option == "--help" ? 0 : 1;
+        }
+        const std::string_view value = argv[++i];
+        uint64_t number = 0;
+        bool valid = true;
+        if(option == "--port")
+        {
+            valid = parseNumber(value, port);
+        }
+        else if(option == "--host")
+        {
+            host = value;
+        }
+        else if(option == "--latency")
+        {
+            valid = parseNumber(value, number);
+            config.latency = std::chrono::milliseconds(number);
+        }
+        else if(option == "--bandwidth")
+        {
+            valid = parseNumber(value, number);
+            config.bytesPerSecond = number * 1000;
+        }
+        else if(option == "--rate-limit")
+        {
+            valid = parseNumber(value, config.requestsPerWindow);
+        }
+        else if(option == "--throttle")
+        {
+            valid = parseNumber(value, config.throttleProbability);
+        }
+        else if(option == "--server-errors")
+        {
+            valid = parseNumber(value, config.serverErrorProbability);
+        }
+        else if(option == "--drop")
+        {
+            valid = parseNumber(value, config.dropProbability);
+        }
+        else if(option == "--retry-after")
+        {
+            valid = parseNumber(value, number);
+            config.retryAfter = std::chrono::seconds(number);
+        }
+        else if(option == "--recorded")
+        {
+            config.recordedDirectory = value;
+        }
+        else if(option == "--image")
+        {
+            imagePath = value;
+        }
+        else if(option == "--tracks")
+        {
+            valid = parseNumber(value, config.defaultTrackCount);
+        }
+        else if(option == "--seed")
+        {
+            valid = parseNumber(value, config.seed);
+        }
+        else
+        {
+            valid = false;
+        }
+        if(!valid)
+        {
+            std::cout << "invalid option " << option << " " << value << "\n" << usage;
+            return 1;
+        }
+    }
+
+    std::ifstream image(imagePath, std::ios::binary);
+    if(!image)
+    {
+        std::cout << "could not read " << imagePath << std::endl;
+        return 1;
+    }
+    std::stringstream imageData;
+    imageData << image.rdbuf();
+    config.imageData = std::move(imageData).str();
+
+    MockSpotifyServer server(config, host, port);
+    if(!server.isRunning())
+    {
+        std::cout << "could not listen on " << host << ":" << port << std::endl;
+        return 1;
+    }
+    std::cout << "mock spotify api listening on " << server.getUrl() << "\n"
+              << "point the app at it with\n"
+              << "    PLAYLISTFILTER_API_URL=" << server.getUrl() << "/v1\n"
+              << "    PLAYLISTFILTER_ACCOUNTS_URL=" << server.getUrl() << "\n"
+              << "synthetic playlists look like " << MockSpotifyApi::makePlaylistId(10000)
+              << " (the number is the track count)" << std::endl;
+
+    std::signal(SIGINT, [](int) { running = 0; });
+    MockSpotifyApi::Stats reported;
+    while(running != 0)
+    {
+        std::this_thread::sleep_for(std::chrono::seconds(1));
+        const MockSpotifyApi::Stats stats = server.getApi().getStats();
+        if(stats.requests != reported.requests)
+        {
+            std::cout << stats.requests - reported.requests << " requests/s, " << stats.throttled << " throttled, "
+                      << stats.serverErrors << " 503s, " << stats.dropped << " dropped, " << (stats.bytesSent >> 20)
+                      << " MB sent" << std::endl;
+            reported = stats;
+        }
+    }
+    server.stop();
+    for(const auto& [endpoint, count] : server.getApi().getEndpointCounts())
+    {
+        std::cout << endpoint << ": " << count << "\n";
+    }
+    return 0;
+}
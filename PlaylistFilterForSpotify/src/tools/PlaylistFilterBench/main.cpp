@@ -0,0 +1,650 @@
+#include <CompressedBitset/CompressedBitset.hpp>
+#include <DynamicBitset/DynamicBitset.hpp>
+#include <Filter/TrackFilter.hpp>
+#include <Graphing/Graphing.hpp>
+#include <Spotify/ApiResponses.hpp>
+#include <SyntheticPlaylist/SyntheticPlaylist.hpp>
+#include <ThreadPool/ThreadPool.hpp>
+#include <Track/Track.hpp>
+
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <charconv>
+#include <cstdlib>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <new>
+#include <random>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include <glm/ext.hpp>
+
+/*
+    Microbenchmarks of the paths that run over the whole playlist, on synthetic playlists (see SyntheticPlaylist).
+    Besides the options of google benchmark (ie. --benchmark_out=results.json --benchmark_out_format=json for
+    machine readable results, --benchmark_filter=Sort) it takes
+        --tracks=<n,n,...>   playlist sizes, default 10000,100000,1000000
+        --seed=<n>           for the synthetic playlists, default 1
+*/
+
+// every allocation of the process, for the allocations per track of the parsing benchmark and checkNoAllocations
+static std::atomic<uint64_t> allocationCount = 0;
+
+void* operator new(std::size_t size)
+{
+    allocationCount.fetch_add(1, std::memory_order_relaxed);
+    if(void* memory = std::malloc(size == 0 ? 1 : size))
+    {
+        return memory;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* memory) noexcept
+{
+    std::free(memory);
+}
+
+void operator delete(void* memory, std::size_t /*size*/) noexcept
+{
+    std::free(memory);
+}
+
+/*
+    For the paths that are meant to not allocate at all once their buffers are large enough. Take the count right
+    before the benchmark loop (after running it once so the buffers could grow), call this right after it
+*/
+static void checkNoAllocations(benchmark::State& state, uint64_t allocationsBefore)
+{
+    const uint64_t allocations = allocationCount.load(std::memory_order_relaxed) - allocationsBefore;
+    state.counters["allocs"] = static_cast<double>(allocations);
+    if(allocations != 0)
+    {
+        state.SkipWithError("allocated inside the benchmark loop");
+    }
+}
+
+static uint64_t playlistSeed = 1;
+// playlist sizes every benchmark runs at
+static std::vector<int64_t> playlistSizes = {10000, 100000, 1000000};
+
+struct BenchPlaylist
+{
+    SpotifyApiAccess::PlaylistData_t data;
+    std::vector<Track*> tracks;
+
+    std::vector<Track>& getTracks()
+    {
+        return std::get<0>(data);
+    }
+    const FeatureStore& getFeatures()
+    {
+        return std::get<1>(data);
+    }
+    const std::vector<DynBitset>& getGenreTracks()
+    {
+        return std::get<4>(data);
+    }
+    uint32_t getArtistCount()
+    {
+        return static_cast<uint32_t>(std::get<5>(data).size());
+    }
+};
+
+static ThreadPool& getThreadPool()
+{
+    static ThreadPool pool;
+    return pool;
+}
+
+// built once per size, every benchmark of that size shares it
+static BenchPlaylist& getPlaylist(uint32_t trackCount)
+{
+    static std::map<uint32_t, std::unique_ptr<BenchPlaylist>> playlists;
+    std::unique_ptr<BenchPlaylist>& playlist = playlists[trackCount];
+    if(!playlist)
+    {
+        playlist = std::make_unique<BenchPlaylist>();
+        playlist->data =
+            generateSyntheticPlaylistData({.trackCount = trackCount, .seed = playlistSeed}, &getThreadPool());
+        for(Track& track : playlist->getTracks())
+        {
+            playlist->tracks.push_back(&track);
+        }
+    }
+    return *playlist;
+}
+
+// the default ranges of the ui, narrowed down for energy and valence
+static FeatureRanges getFilterRanges()
+{
+    FeatureRanges ranges;
+    ranges.fill(glm::vec2(0.0f, 1.0f));
+    ranges[7] = {0, 300};
+    ranges[2] = {0.3f, 0.8f};
+    ranges[6] = {0.2f, 0.9f};
+    return ranges;
+}
+
+// ----
+
+static DynBitset makeRandomBitset(uint32_t size, uint64_t seed)
+{
+    DynBitset bitset(size);
+    std::mt19937_64 random(seed);
+    for(uint32_t i = 0; i < size; i++)
+    {
+        if((random() & 1) != 0)
+        {
+            bitset.setBit(i);
+        }
+    }
+    return bitset;
+}
+
+static void BM_DynBitsetAnd(benchmark::State& state)
+{
+    const auto size = static_cast<uint32_t>(state.range(0));
+    DynBitset lhs = makeRandomBitset(size, 1);
+    const DynBitset rhs = makeRandomBitset(size, 2);
+    for(auto _ : state)
+    {
+        lhs &= rhs;
+        benchmark::DoNotOptimize(lhs.data());
+    }
+    state.SetItemsProcessed(state.iterations() * size);
+}
+
+static void BM_DynBitsetOr(benchmark::State& state)
+{
+    const auto size = static_cast<uint32_t>(state.range(0));
+    const DynBitset lhs = makeRandomBitset(size, 1);
+    const DynBitset rhs = makeRandomBitset(size, 2);
+    for(auto _ : state)
+    {
+        DynBitset result = lhs | rhs;
+        benchmark::DoNotOptimize(result.data());
+    }
+    state.SetItemsProcessed(state.iterations() * size);
+}
+
+static void BM_DynBitsetPopcount(benchmark::State& state)
+{
+    const auto size = static_cast<uint32_t>(state.range(0));
+    const DynBitset bitset = makeRandomBitset(size, 1);
+    for(auto _ : state)
+    {
+        benchmark::DoNotOptimize(bitset.popcount());
+    }
+    state.SetItemsProcessed(state.iterations() * size);
+}
+
+// a genre mask: thousands of genres in the playlist, of which only a few are set
+static DynBitset makeGenreMask(uint32_t genreCount, uint32_t setGenres, uint64_t seed)
+{
+    DynBitset mask(genreCount);
+    std::mt19937_64 random(seed);
+    while(mask.popcount() < std::min(setGenres, genreCount))
+    {
+        mask.setBit(static_cast<uint32_t>(random() % genreCount));
+    }
+    return mask;
+}
+
+static void BM_DynBitsetForEachSetBit(benchmark::State& state)
+{
+    const DynBitset mask =
+        makeGenreMask(static_cast<uint32_t>(state.range(0)), static_cast<uint32_t>(state.range(1)), 1);
+    for(auto _ : state)
+    {
+        uint64_t sum = 0;
+        mask.forEachSetBit([&](uint32_t i) { sum += i; });
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(1));
+}
+
+// the loop forEachSetBit replaced, every step scans the copy from the first word again
+static void BM_DynBitsetFirstBitSetLoop(benchmark::State& state)
+{
+    const DynBitset mask =
+        makeGenreMask(static_cast<uint32_t>(state.range(0)), static_cast<uint32_t>(state.range(1)), 1);
+    for(auto _ : state)
+    {
+        uint64_t sum = 0;
+        DynBitset temp = mask;
+        while(temp)
+        {
+            const uint32_t i = temp.getFirstBitSet();
+            temp.clearBit(i);
+            sum += i;
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(1));
+}
+
+// ----
+
+// the range filter as it was before the FeatureStore: the features inside every track, a scalar loop over them
+static void rangeFilterBaseline(
+    const std::vector<std::array<float, Track::featureAmount>>& trackFeatures,
+    const FeatureRanges& ranges,
+    DynBitset& passMask)
+{
+    passMask.resize(static_cast<uint32_t>(trackFeatures.size()));
+    passMask.clear();
+    for(uint32_t t = 0; t < trackFeatures.size(); t++)
+    {
+        const auto& features = trackFeatures[t];
+        for(auto i = 0; i < Track::featureAmount; i++)
+        {
+            if(features[i] < ranges[i].x || features[i] > ranges[i].y)
+            {
+                goto failedFilter;
+            }
+        }
+        passMask.setBit(t);
+    failedFilter:;
+    }
+}
+
+// the kernels of filterFeatureRanges on a single thread, rangeFilterBaselineArg runs the loop above instead
+static constexpr int64_t rangeFilterBaselineArg = -1;
+
+static void BM_RangeFilterKernel(benchmark::State& state)
+{
+    BenchPlaylist& playlist = getPlaylist(static_cast<uint32_t>(state.range(0)));
+    const FeatureStore& features = playlist.getFeatures();
+    const FeatureRanges ranges = getFilterRanges();
+    DynBitset passMask;
+    if(state.range(1) == rangeFilterBaselineArg)
+    {
+        std::vector<std::array<float, Track::featureAmount>> trackFeatures(features.getTrackCount());
+        for(uint32_t t = 0; t < features.getTrackCount(); t++)
+        {
+            for(int f = 0; f < Track::featureAmount; f++)
+            {
+                trackFeatures[t][f] = features.get(f, t);
+            }
+        }
+        for(auto _ : state)
+        {
+            rangeFilterBaseline(trackFeatures, ranges, passMask);
+            benchmark::DoNotOptimize(passMask.data());
+        }
+        state.SetLabel("baseline");
+    }
+    else
+    {
+        const auto kernel = static_cast<RangeFilterKernel>(state.range(1));
+        std::vector<uint16_t> failedFeatures;
+        for(auto _ : state)
+        {
+            filterFeatureRanges(kernel, features, ranges, passMask, failedFeatures);
+            benchmark::DoNotOptimize(passMask.data());
+        }
+        state.SetLabel(getRangeFilterKernelName(kernel));
+    }
+    state.counters["passing"] = static_cast<double>(passMask.popcount());
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+// everything the app does for a new set of filters: evaluate the whole playlist and collect the passing tracks
+static void refreshFilteredTracksFull(benchmark::State& state, ThreadPool& pool)
+{
+    BenchPlaylist& playlist = getPlaylist(static_cast<uint32_t>(state.range(0)));
+    TrackFilter filter;
+    filter.setThreadPool(&pool);
+    filter.setPlaylist(playlist.getTracks(), playlist.getFeatures(), playlist.getGenreTracks());
+    const FeatureRanges ranges = getFilterRanges();
+    DynBitset genreMask(static_cast<uint32_t>(playlist.getGenreTracks().size()));
+    for(uint32_t g = 0; g < std::min<uint32_t>(genreMask.getSize(), 3); g++)
+    {
+        genreMask.setBit(g);
+    }
+    const ImGuiTextFilter nameFilter;
+    std::vector<Track*> filteredTracks;
+    const auto refresh = [&]()
+    {
+        filter.invalidate();
+        filter.update(ranges, genreMask, nameFilter);
+        filter.collectPassingTracks(playlist.getTracks(), filteredTracks);
+    };
+    refresh();
+    const uint64_t allocationsBefore = allocationCount.load(std::memory_order_relaxed);
+    for(auto _ : state)
+    {
+        refresh();
+        benchmark::DoNotOptimize(filteredTracks.data());
+    }
+    checkNoAllocations(state, allocationsBefore);
+    state.counters["passing"] = static_cast<double>(filteredTracks.size());
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+static void BM_RefreshFilteredTracksFull(benchmark::State& state)
+{
+    refreshFilteredTracksFull(state, getThreadPool());
+}
+
+// the same with a pool of state.range(1) threads, for how it scales with the number of cores
+static void BM_RefreshFilteredTracksThreads(benchmark::State& state)
+{
+    ThreadPool pool(static_cast<uint32_t>(state.range(1)));
+    refreshFilteredTracksFull(state, pool);
+}
+
+// dragging a slider, every update only moves one border a little
+static void BM_RefreshFilteredTracksSlider(benchmark::State& state)
+{
+    BenchPlaylist& playlist = getPlaylist(static_cast<uint32_t>(state.range(0)));
+    TrackFilter filter;
+    filter.setThreadPool(&getThreadPool());
+    filter.setPlaylist(playlist.getTracks(), playlist.getFeatures(), playlist.getGenreTracks());
+    FeatureRanges ranges = getFilterRanges();
+    const DynBitset genreMask;
+    const ImGuiTextFilter nameFilter;
+    std::vector<Track*> filteredTracks;
+    filter.update(ranges, genreMask, nameFilter);
+    filter.collectPassingTracks(playlist.getTracks(), filteredTracks);
+    uint64_t step = 0;
+    const auto drag = [&]()
+    {
+        // back and forth between 0.3 and 0.4
+        ranges[2].x = 0.3f + 0.001f * static_cast<float>(step % 200 < 100 ? step % 100 : 100 - step % 100);
+        step++;
+        filter.update(ranges, genreMask, nameFilter);
+        // like the partial update of the app, without sorting the new tracks in
+        const DynBitset& passMask = filter.getPassMask();
+        std::erase_if(filteredTracks, [&](const Track* track) { return !passMask.getBit(track->index); });
+        for(const uint32_t i : filter.getChangedTracks())
+        {
+            if(passMask.getBit(i))
+            {
+                filteredTracks.push_back(&playlist.getTracks()[i]);
+            }
+        }
+    };
+    // one whole back and forth, so the list of changed tracks had its largest size once
+    for(int i = 0; i < 200; i++)
+    {
+        drag();
+    }
+    const uint64_t allocationsBefore = allocationCount.load(std::memory_order_relaxed);
+    for(auto _ : state)
+    {
+        drag();
+        benchmark::DoNotOptimize(filteredTracks.data());
+    }
+    checkNoAllocations(state, allocationsBefore);
+}
+
+// by the given column of the tables
+static void BM_SortTracks(benchmark::State& state)
+{
+    BenchPlaylist& playlist = getPlaylist(static_cast<uint32_t>(state.range(0)));
+    const auto column = static_cast<int>(state.range(1));
+    std::vector<Track*> shuffled = playlist.tracks;
+    std::shuffle(shuffled.begin(), shuffled.end(), std::mt19937_64(playlistSeed));
+    std::vector<Track*> tracks;
+    for(auto _ : state)
+    {
+        state.PauseTiming();
+        tracks = shuffled;
+        state.ResumeTiming();
+        parallelSort(getThreadPool(), tracks.begin(), tracks.end(), TrackSorter{column, playlist.getFeatures()});
+        benchmark::DoNotOptimize(tracks.data());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+static void BM_GenerateGraphingData(benchmark::State& state)
+{
+    BenchPlaylist& playlist = getPlaylist(static_cast<uint32_t>(state.range(0)));
+    std::vector<GraphingBufferElement> graphingData;
+    for(auto _ : state)
+    {
+        generateGraphingData(playlist.tracks, playlist.getFeatures(), {0, 1, 2}, graphingData);
+        benchmark::DoNotOptimize(graphingData.data());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+static void BM_RaycastGraphingData(benchmark::State& state)
+{
+    BenchPlaylist& playlist = getPlaylist(static_cast<uint32_t>(state.range(0)));
+    std::vector<GraphingBufferElement> graphingData;
+    generateGraphingData(playlist.tracks, playlist.getFeatures(), {0, 1, 2}, graphingData);
+    const glm::vec3 cameraPosition{2.0f, 1.5f, 2.5f};
+    const glm::mat4 view = glm::lookAt(cameraPosition, glm::vec3(0.5f), glm::vec3(0.0f, 1.0f, 0.0f));
+    const glm::vec3 rayDir = glm::normalize(glm::vec3(0.5f) - cameraPosition);
+    for(auto _ : state)
+    {
+        benchmark::DoNotOptimize(raycastGraphingData(
+            graphingData, cameraPosition, rayDir, view, glm::vec3(0.0f), glm::vec3(1.0f), 0.1f));
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+// the masks of "extend pins by artists", without asking spotify for the related artists
+static void BM_ExtendPinsByArtists(benchmark::State& state)
+{
+    BenchPlaylist& playlist = getPlaylist(static_cast<uint32_t>(state.range(0)));
+    std::vector<Track*> pinnedTracks;
+    std::mt19937_64 random(playlistSeed);
+    for(int i = 0; i < 20; i++)
+    {
+        pinnedTracks.push_back(playlist.tracks[random() % playlist.tracks.size()]);
+    }
+    DynBitset artists;
+    std::vector<Track*> tracks;
+    const auto extend = [&]()
+    {
+        getArtistMask(pinnedTracks, playlist.getArtistCount(), artists);
+        findTracksByArtists(playlist.getTracks(), artists, tracks);
+    };
+    extend();
+    const uint64_t allocationsBefore = allocationCount.load(std::memory_order_relaxed);
+    for(auto _ : state)
+    {
+        extend();
+        benchmark::DoNotOptimize(tracks.data());
+    }
+    checkNoAllocations(state, allocationsBefore);
+    state.counters["found"] = static_cast<double>(tracks.size());
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+// ----
+
+// a full page of tracks like spotify sends it, made from the example response
+static std::string makeTrackPage()
+{
+    std::ifstream file(MISC_PATH "/TrackResponse.jsonc");
+    std::stringstream text;
+    std::string line;
+    while(std::getline(file, line))
+    {
+        // the comments of the jsonc
+        if(line.find_first_not_of(" \t") != std::string::npos && !line.starts_with("//"))
+        {
+            text << line << "\n";
+        }
+    }
+    const std::string example = text.str();
+    const size_t itemStart = example.find('[') + 1;
+    const size_t itemEnd = example.rfind(']');
+    const std::string item = example.substr(itemStart, itemEnd - itemStart);
+    const std::string trackId = "3zSwFE91EdwhEwS6vnJohB";
+
+    std::string page = example.substr(0, itemStart);
+    for(uint32_t i = 0; i < PlaylistSource::pageSize; i++)
+    {
+        // every track with its own id, so nothing can be shared
+        std::string numberedItem = item;
+        const std::string number = std::to_string(i);
+        const size_t idPos = numberedItem.find(trackId);
+        if(idPos != std::string::npos)
+        {
+            numberedItem.replace(idPos + trackId.size() - number.size(), number.size(), number);
+        }
+        page += numberedItem;
+        page += i + 1 < PlaylistSource::pageSize ? "," : "";
+    }
+    page += example.substr(itemEnd);
+    return page;
+}
+
+static void BM_ParseTrackPage(benchmark::State& state)
+{
+    const std::string page = makeTrackPage();
+    uint64_t allocations = 0;
+    for(auto _ : state)
+    {
+        const uint64_t before = allocationCount.load(std::memory_order_relaxed);
+        std::vector<TrackSource> tracks = PlaylistTracksResponse::load(page);
+        allocations += allocationCount.load(std::memory_order_relaxed) - before;
+        benchmark::DoNotOptimize(tracks.data());
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * page.size()));
+    state.SetItemsProcessed(state.iterations() * PlaylistSource::pageSize);
+    state.counters["allocs/track"] = static_cast<double>(allocations) /
+                                     static_cast<double>(state.iterations() * PlaylistSource::pageSize);
+}
+BENCHMARK(BM_ParseTrackPage);
+
+// ----
+
+// for Apply(), runs the benchmark at every playlist size
+static void bySize(benchmark::internal::Benchmark* benchmark)
+{
+    for(const int64_t size : playlistSizes)
+    {
+        benchmark->Arg(size);
+    }
+}
+
+// takes --name=value out of the arguments, so google benchmark doesnt complain about it
+static std::optional<std::string> takeOption(int& argc, char** argv, std::string_view name)
+{
+    const std::string prefix = "--" + std::string(name) + "=";
+    for(int i = 1; i < argc; i++)
+    {
+        if(std::string_view(argv[i]).starts_with(prefix))
+        {
+            std::string value = argv[i] + prefix.size();
+            std::copy(argv + i + 1, argv + argc, argv + i);
+            argc--;
+            return value;
+        }
+    }
+    return std::nullopt;
+}
+
+int main(int argc, char** argv)
+{
+    if(const auto option = takeOption(argc, argv, "tracks"))
+    {
+        playlistSizes.clear();
+        std::string_view list = *option;
+        while(!list.empty())
+        {
+            const size_t comma = list.find(',');
+            const std::string_view text = list.substr(0, comma);
+            int64_t size = 0;
+            std::from_chars(text.data(), text.data() + text.size(), size);
+            if(size > 0)
+            {
+                playlistSizes.push_back(size);
+            }
+            list.remove_prefix(comma == std::string_view::npos ? list.size() : comma + 1);
+        }
+    }
+    if(const auto option = takeOption(argc, argv, "seed"))
+    {
+        playlistSeed = std::strtoull(option->c_str(), nullptr, 10);
+    }
+
+    benchmark::RegisterBenchmark("BM_DynBitsetAnd", BM_DynBitsetAnd)->Apply(bySize);
+    benchmark::RegisterBenchmark("BM_DynBitsetOr", BM_DynBitsetOr)->Apply(bySize);
+    benchmark::RegisterBenchmark("BM_DynBitsetPopcount", BM_DynBitsetPopcount)->Apply(bySize);
+    // genres in the playlist x genres set in the mask
+    for(auto* setBitLoop : {
+            benchmark::RegisterBenchmark("BM_DynBitsetForEachSetBit", BM_DynBitsetForEachSetBit),
+            benchmark::RegisterBenchmark("BM_DynBitsetFirstBitSetLoop", BM_DynBitsetFirstBitSetLoop)})
+    {
+        setBitLoop->ArgsProduct({{1000, 5000, 20000}, {8, 256}})->ArgNames({"genres", "set"});
+    }
+    auto* rangeFilterKernel = benchmark::RegisterBenchmark("BM_RangeFilterKernel", BM_RangeFilterKernel);
+    for(const int64_t size : playlistSizes)
+    {
+        rangeFilterKernel->Args({size, rangeFilterBaselineArg});
+        for(const RangeFilterKernel kernel :
+            {RangeFilterKernel::Scalar, RangeFilterKernel::SSE, RangeFilterKernel::AVX2})
+        {
+            if(isRangeFilterKernelSupported(kernel))
+            {
+                rangeFilterKernel->Args({size, static_cast<int64_t>(kernel)});
+            }
+        }
+    }
+    rangeFilterKernel->ArgNames({"tracks", "kernel"})->Unit(benchmark::kMicrosecond);
+    benchmark::RegisterBenchmark("BM_RefreshFilteredTracksFull", BM_RefreshFilteredTracksFull)
+        ->Apply(bySize)
+        ->Unit(benchmark::kMicrosecond);
+    std::vector<int64_t> threadCounts;
+    const uint32_t coreCount = std::max(std::thread::hardware_concurrency(), 1U);
+    for(uint32_t threads = 1; threads < coreCount; threads *= 2)
+    {
+        threadCounts.push_back(threads);
+    }
+    threadCounts.push_back(coreCount);
+    benchmark::RegisterBenchmark("BM_RefreshFilteredTracksThreads", BM_RefreshFilteredTracksThreads)
+        ->ArgsProduct({{100000, 1000000}, threadCounts})
+        ->ArgNames({"tracks", "threads"})
+        ->Unit(benchmark::kMicrosecond)
+        ->UseRealTime();
+    benchmark::RegisterBenchmark("BM_RefreshFilteredTracksSlider", BM_RefreshFilteredTracksSlider)
+        ->Apply(bySize)
+        ->Unit(benchmark::kMicrosecond);
+    // track number and every feature column, see TrackSorter
+    auto* sortTracks = benchmark::RegisterBenchmark("BM_SortTracks", BM_SortTracks);
+    for(const int64_t size : playlistSizes)
+    {
+        sortTracks->Args({size, 0});
+        for(int feature = 0; feature < Track::featureAmount; feature++)
+        {
+            sortTracks->Args({size, 4 + feature});
+        }
+    }
+    sortTracks->ArgNames({"tracks", "column"})->Unit(benchmark::kMillisecond);
+    benchmark::RegisterBenchmark("BM_GenerateGraphingData", BM_GenerateGraphingData)
+        ->Apply(bySize)
+        ->Unit(benchmark::kMicrosecond);
+    benchmark::RegisterBenchmark("BM_RaycastGraphingData", BM_RaycastGraphingData)
+        ->Apply(bySize)
+        ->Unit(benchmark::kMicrosecond);
+    benchmark::RegisterBenchmark("BM_ExtendPinsByArtists", BM_ExtendPinsByArtists)
+        ->Apply(bySize)
+        ->Unit(benchmark::kMicrosecond);
+
+    benchmark::Initialize(&argc, argv);
+    if(benchmark::ReportUnrecognizedArguments(argc, argv))
+    {
+        return 1;
+    }
+    benchmark::AddCustomContext("playlist seed", std::to_string(playlistSeed));
+    benchmark::AddCustomContext("worker threads", std::to_string(getThreadPool().getThreadCount()));
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+    return 0;
+}
@@ -0,0 +1,242 @@
+#include "FilterQuery.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cctype>
+#include <charconv>
+#include <cmath>
+#include <cstring>
+#include <iterator>
+#include <limits>
+
+static bool isSpace(char c)
+{
+    return std::isspace(static_cast<unsigned char>(c)) != 0;
+}
+
+static std::string toLower(std::string_view text)
+{
+    std::string lower(text);
+    std::transform(
+        lower.begin(),
+        lower.end(),
+        lower.begin(),
+        [](char c) { return static_cast<char>(std::tolower(static_cast<unsigned char>(c))); });
+    return lower;
+}
+
+static std::string_view trim(std::string_view text)
+{
+    while(!text.empty() && isSpace(text.front()))
+    {
+        text.remove_prefix(1);
+    }
+    while(!text.empty() && isSpace(text.back()))
+    {
+        text.remove_suffix(1);
+    }
+    return text;
+}
+
+static std::string_view unquote(std::string_view text)
+{
+    if(text.size() >= 2 && text.front() == '"' && text.back() == '"')
+    {
+        return text.substr(1, text.size() - 2);
+    }
+    return text;
+}
+
+static bool parseNumber(std::string_view text, float& value)
+{
+    const auto [end, error] = std::from_chars(text.data(), text.data() + text.size(), value);
+    return !text.empty() && error == std::errc() && end == text.data() + text.size();
+}
+
+// at every "and" that is a word of its own and not inside quotes
+static std::vector<std::string_view> splitConditions(std::string_view text)
+{
+    std::vector<std::string_view> conditions;
+    bool quoted = false;
+    size_t start = 0;
+    for(size_t i = 0; i < text.size(); i++)
+    {
+        if(text[i] == '"')
+        {
+            quoted = !quoted;
+            continue;
+        }
+        const bool wordStart = i == 0 || isSpace(text[i - 1]);
+        const bool wordEnd = i + 3 == text.size() || (i + 3 < text.size() && isSpace(text[i + 3]));
+        if(!quoted && wordStart && wordEnd && toLower(text.substr(i, 3)) == "and")
+        {
+            conditions.push_back(text.substr(start, i - start));
+            start = i + 3;
+        }
+    }
+    conditions.push_back(text.substr(start));
+    return conditions;
+}
+
+// "Tempo*" -> "tempo"
+static int findFeature(std::string_view name)
+{
+    for(int f = 0; f < Track::featureAmount; f++)
+    {
+        std::string_view featureName = Track::FeatureNames[f];
+        if(featureName.ends_with('*'))
+        {
+            featureName.remove_suffix(1);
+        }
+        if(toLower(featureName) == name)
+        {
+            return f;
+        }
+    }
+    return -1;
+}
+
+static std::string parseFeatureCondition(int feature, std::string_view condition, glm::vec2& range)
+{
+    std::string expression;
+    std::copy_if(
+        condition.begin(), condition.end(), std::back_inserter(expression), [](char c) { return !isSpace(c); });
+    const std::string_view text = expression;
+
+    const size_t dots = text.find("..");
+    if(dots != std::string_view::npos)
+    {
+        float min = 0;
+        float max = 0;
+        if(!parseNumber(text.substr(0, dots), min) || !parseNumber(text.substr(dots + 2), max))
+        {
+            return "expected a range like 0.2..0.6, got " + expression;
+        }
+        range.x = std::max(range.x, min);
+        range.y = std::min(range.y, max);
+        return {};
+    }
+
+    // longest operators first
+    constexpr float inf = std::numeric_limits<float>::infinity();
+    for(const std::string_view op : {">=", "<=", ">", "<"})
+    {
+        if(!text.starts_with(op))
+        {
+            continue;
+        }
+        float value = 0;
+        if(!parseNumber(text.substr(op.size()), value))
+        {
+            return "expected a number after " + std::string(op) + ", got " + expression;
+        }
+        // the range includes its bounds, so the strict ones start at the next float
+        if(op[0] == '>')
+        {
+            range.x = std::max(range.x, op.size() == 1 ? std::nextafter(value, inf) : value);
+        }
+        else
+        {
+            range.y = std::min(range.y, op.size() == 1 ? std::nextafter(value, -inf) : value);
+        }
+        return {};
+    }
+    return "expected >, >=, <, <= or a..b after " + std::string(Track::FeatureNames[feature]) + ", got " +
+           expression;
+}
+
+// the names are joined with commas into the search field of the app, which has a fixed size
+static bool fitsNameFilter(const std::vector<std::string>& names, std::string_view name)
+{
+    size_t length = name.size();
+    for(const std::string& other : names)
+    {
+        length += other.size() + 1;
+    }
+    return length < sizeof(ImGuiTextFilter::InputBuf);
+}
+
+static std::string parseCondition(std::string_view condition, FilterQuery& query)
+{
+    size_t nameLength = 0;
+    while(nameLength < condition.size() && std::isalpha(static_cast<unsigned char>(condition[nameLength])) != 0)
+    {
+        nameLength++;
+    }
+    const std::string keyword = toLower(condition.substr(0, nameLength));
+    const std::string_view rest = trim(condition.substr(nameLength));
+
+    if(keyword == "genre" || keyword == "name")
+    {
+        const std::string_view value = unquote(rest);
+        if(value.empty())
+        {
+            return keyword + " without a value";
+        }
+        if(keyword == "name" && !fitsNameFilter(query.names, value))
+        {
+            return "the names together are longer than the " +
+                   std::to_string(sizeof(ImGuiTextFilter::InputBuf) - 1) + " characters the name filter holds";
+        }
+        (keyword == "genre" ? query.genres : query.names).emplace_back(value);
+        return {};
+    }
+    const int feature = findFeature(keyword);
+    if(feature < 0)
+    {
+        return "unknown feature in \"" + std::string(condition) + "\"";
+    }
+    return parseFeatureCondition(feature, rest, query.featureRanges[feature]);
+}
+
+std::string parseFilter(std::string_view text, FilterQuery& query)
+{
+    for(const std::string_view condition : splitConditions(text))
+    {
+        const std::string_view trimmed = trim(condition);
+        if(trimmed.empty())
+        {
+            return "empty condition in \"" + std::string(text) + "\"";
+        }
+        std::string error = parseCondition(trimmed, query);
+        if(!error.empty())
+        {
+            return error;
+        }
+    }
+    return {};
+}
+
+std::vector<std::string> applyFilterQuery(const FilterQuery& query, PlaylistModel& model)
+{
+    model.featureMinMaxValues = query.featureRanges;
+
+    std::vector<std::string> missingGenres;
+    model.currentGenreMask = DynBitset(model.genreNames.size());
+    model.currentGenreMask.clear();
+    for(const std::string& genre : query.genres)
+    {
+        const std::optional<uint32_t> index = model.findGenre(genre);
+        if(index)
+        {
+            model.currentGenreMask.setBit(*index);
+        }
+        else
+        {
+            missingGenres.push_back(genre);
+        }
+    }
+
+    // the name filter already treats its comma separated parts as alternatives
+    std::string names;
+    for(const std::string& name : query.names)
+    {
+        names += (names.empty() ? "" : ",") + name;
+    }
+    // parseFilter doesnt take more than fits
+    assert(names.size() < sizeof(model.nameFilter.InputBuf));
+    std::memcpy(model.nameFilter.InputBuf, names.data(), names.size());
+    model.nameFilter.InputBuf[names.size()] = '\0';
+    model.nameFilter.Build();
+    return missingGenres;
+}
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <Filter/RangeFilter.hpp>
+#include <PlaylistModel/PlaylistModel.hpp>
+
+/*
+    The filters given on the command line, in the terms of the filter settings of the app:
+    a range per feature, genres of which a track needs any, and the text of the name filter.
+    Conditions look like
+        energy > 0.8            >, >=, < and <=
+        tempo 120..130          both bounds included
+        genre techno            quotes for names with "and" in them: genre "drum and bass"
+        name daft punk          track, artist or album name, in the syntax of the name filter of the app
+    and are joined with "and". Everything given has to pass, except that a track only needs one of the genres
+    and one of the names (same as selecting several genres in the app).
+*/
+struct FilterQuery
+{
+    FeatureRanges featureRanges = PlaylistModel::getFullFeatureRanges();
+    std::vector<std::string> genres;
+    std::vector<std::string> names;
+};
+
+/*
+    adds the conditions of text to the query, returns what is wrong with them (empty if nothing).
+    All names together have to fit into the name filter of the app
+*/
+std::string parseFilter(std::string_view text, FilterQuery& query);
+
+/*
+    Sets the filter settings of the model. Genres that none of its tracks have are returned, if the query has
+    genres but the playlist none of them no track can pass (the genre mask stays empty, which would let all pass)
+*/
+std::vector<std::string> applyFilterQuery(const FilterQuery& query, PlaylistModel& model);
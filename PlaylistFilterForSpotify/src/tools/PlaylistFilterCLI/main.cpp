@@ -0,0 +1,316 @@
+#include "FilterQuery.hpp"
+
+#include <PlaylistModel/PlaylistModel.hpp>
+#include <Snapshot/PlaylistSnapshot.hpp>
+#include <Spotify/ApiError.hpp>
+#include <Spotify/PlaylistSource.hpp>
+#include <Spotify/PlaylistStream.hpp>
+#include <Spotify/SpotifyApiAccess.hpp>
+#include <ThreadPool/ThreadPool.hpp>
+
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+static constexpr std::string_view usage =
+    "PlaylistFilterCLI <playlist> [filters] [output]\n"
+    "playlist, one of:\n"
+    "  --snapshot <file>          a snapshot the app wrote to its cache\n"
+    "  --cached <playlist id>     the snapshot of a playlist the app opened before, nothing is downloaded\n"
+    "  --playlist <playlist id>   downloads it, or only what changed since it was cached\n"
+    "  --refresh-token <token>    to log in for --playlist and --create-playlist, default\n"
+    "                             PLAYLISTFILTER_REFRESH_TOKEN. Use PLAYLISTFILTER_API_URL and\n"
+    "                             PLAYLISTFILTER_ACCOUNTS_URL to talk to MockSpotifyServer instead\n"
+    "filters, everything has to pass:\n"
+    "  --filter <conditions>      ie. \"energy > 0.8 and genre techno\", can be given more than once\n"
+    "  --filter-file <file>       conditions, one line each, # starts a comment\n"
+    "output:\n"
+    "  --format ids|uris|csv      default ids, csv has the names and all features\n"
+    "  --output <file>            default stdout\n"
+    "  --create-playlist <name>   of the tracks that pass, in the users account (\"-\" for a generated name)\n"
+    "  --timings                  how long every step took, on stderr\n"
+    "conditions, joined with \"and\":\n"
+    "  <feature> > x, >= x, < x, <= x or a..b\n"
+    "                             acousticness, danceability, energy, instrumentalness, speechiness,\n"
+    "                             liveness, valence, popularity (0..1) and tempo (bpm)\n"
+    "  genre <name>               tracks with any of the given genres\n"
+    "  name <text>                track, artist or album name, any of the given ones\n";
+
+static double secondsSince(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+static bool readFilterFile(const std::string& path, FilterQuery& query)
+{
+    std::ifstream file(path);
+    if(!file)
+    {
+        std::cerr << "could not open " << path << "\n";
+        return false;
+    }
+    std::string line;
+    for(int lineNumber = 1; std::getline(file, line); lineNumber++)
+    {
+        line = line.substr(0, line.find('#'));
+        if(line.find_first_not_of(" \t\r") == std::string::npos)
+        {
+            continue;
+        }
+        const std::string error = parseFilter(line, query);
+        if(!error.empty())
+        {
+            std::cerr << path << ":" << lineNumber << ": " << error << "\n";
+            return false;
+        }
+    }
+    return true;
+}
+
+static void writeCsvField(std::ostream& out, std::string_view field)
+{
+    if(field.find_first_of(",\"\r\n") == std::string_view::npos)
+    {
+        out << field;
+        return;
+    }
+    out << '"';
+    for(const char c : field)
+    {
+        out << (c == '"' ? "\"\"" : std::string_view(&c, 1));
+    }
+    out << '"';
+}
+
+static void writeTracks(
+    std::ostream& out, std::string_view format, const std::vector<Track*>& tracks, const FeatureStore& features)
+{
+    if(format == "csv")
+    {
+        // the features named as in the conditions
+        out << "id,name,artists,album,acousticness,danceability,energy,instrumentalness,speechiness,liveness,"
+               "valence,tempo,popularity";
+        out << "\n";
+    }
+    for(const Track* track : tracks)
+    {
+        if(format == "ids")
+        {
+            out << track->id << "\n";
+            continue;
+        }
+        if(format == "uris")
+        {
+            out << "spotify:track:" << track->id << "\n";
+            continue;
+        }
+        out << track->id << ",";
+        writeCsvField(out, track->trackNameEncoded);
+        out << ",";
+        writeCsvField(out, track->artistsNamesEncoded);
+        out << ",";
+        writeCsvField(out, track->albumNameEncoded);
+        for(int f = 0; f < Track::featureAmount; f++)
+        {
+            out << "," << features.get(f, track->index);
+        }
+        out << "\n";
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    std::string snapshotPath;
+    std::string playlistId;
+    bool downloadPlaylist = false;
+    // NOLINTNEXTLINE(concurrency-mt-unsafe) only read once at startup
+    const char* refreshTokenEnv = std::getenv("PLAYLISTFILTER_REFRESH_TOKEN");
+    std::string refreshToken = refreshTokenEnv != nullptr ? refreshTokenEnv : "";
+    FilterQuery query;
+    std::string format = "ids";
+    std::string outputPath;
+    std::optional<std::string> newPlaylistName;
+    bool printTimings = false;
+    for(int i = 1; i < argc; i++)
+    {
+        const std::string_view option = argv[i];
+        if(option == "--timings")
+        {
+            printTimings = true;
+            continue;
+        }
+        if(option == "--help" || i + 1 >= argc)
+        {
+            std::cout << usage;
+            return option == "--help" ? 0 : 1;
+        }
+        const std::string_view value = argv[++i];
+        bool valid = true;
+        if(option == "--snapshot")
+        {
+            snapshotPath = value;
+        }
+        else if(option == "--cached" || option == "--playlist")
+        {
+            playlistId = value;
+            downloadPlaylist = option == "--playlist";
+        }
+        else if(option == "--refresh-token")
+        {
+            refreshToken = value;
+        }
+        else if(option == "--filter")
+        {
+            const std::string error = parseFilter(value, query);
+            if(!error.empty())
+            {
+                std::cerr << error << "\n";
+                return 1;
+            }
+        }
+        else if(option == "--filter-file")
+        {
+            if(!readFilterFile(std::string(value), query))
+            {
+                return 1;
+            }
+        }
+        else if(option == "--format")
+        {
+            format = value;
+            valid = format == "ids" || format == "uris" || format == "csv";
+        }
+        else if(option == "--output")
+        {
+            outputPath = value;
+        }
+        else if(option == "--create-playlist")
+        {
+            newPlaylistName = value == "-" ? getGeneratedPlaylistName() : std::string(value);
+        }
+        else
+        {
+            valid = false;
+        }
+        if(!valid)
+        {
+            std::cerr << "invalid option " << option << " " << value << "\n" << usage;
+            return 1;
+        }
+    }
+    if(snapshotPath.empty() == playlistId.empty())
+    {
+        std::cerr << "needs either --snapshot, --cached or --playlist\n" << usage;
+        return 1;
+    }
+
+    // the api is only needed to download or to create a playlist
+    std::unique_ptr<SpotifyApiAccess> apiAccess;
+    if(downloadPlaylist || newPlaylistName)
+    {
+        apiAccess = std::make_unique<SpotifyApiAccess>();
+        if(refreshToken.empty() || !apiAccess->authorizeWithRefreshToken(refreshToken))
+        {
+            std::cerr << "could not log in, needs a valid --refresh-token\n";
+            return 1;
+        }
+    }
+
+    ThreadPool pool;
+    auto start = std::chrono::steady_clock::now();
+    std::optional<PlaylistSource> source;
+    if(downloadPlaylist)
+    {
+        try
+        {
+            LoadProgress progress;
+            source = loadPlaylistSource(*apiAccess, playlistId, progress, nullptr, &pool);
+        }
+        catch(const ApiRequestError& error)
+        {
+            std::cerr << "could not download the playlist: " << error.what() << "\n";
+            return 1;
+        }
+    }
+    else
+    {
+        const std::filesystem::path path =
+            snapshotPath.empty() ? getPlaylistSnapshotPath(playlistId) : std::filesystem::path(snapshotPath);
+        source = loadPlaylistSnapshot(path, &pool);
+        if(!source)
+        {
+            std::cerr << "no valid snapshot at " << path.string() << "\n";
+            return 1;
+        }
+    }
+    const double loadSeconds = secondsSince(start);
+
+    // only filtered once, so neither the filter indices nor anything that is only there to be shown is built
+    start = std::chrono::steady_clock::now();
+    PlaylistModel model;
+    model.trackFilter.setThreadPool(&pool);
+    model.setData(buildPlaylistData(*source, &pool, PlaylistBuildMode::FilterOnly), false);
+    // the source is only freed at the end, freeing its millions of strings right away makes the next larger
+    // allocations (in the filter) stall while the allocator merges them
+    const double buildSeconds = secondsSince(start);
+
+    start = std::chrono::steady_clock::now();
+    for(const std::string& genre : applyFilterQuery(query, model))
+    {
+        std::cerr << "none of the tracks has the genre " << genre << "\n";
+    }
+    std::vector<Track*> passing;
+    // none of the asked for genres being there would let everything pass, as no genre is selected
+    if(query.genres.empty() || model.currentGenreMask.popcount() != 0)
+    {
+        model.updateFilter();
+        model.trackFilter.collectPassingTracks(model.playlist, passing);
+    }
+    const double filterSeconds = secondsSince(start);
+
+    start = std::chrono::steady_clock::now();
+    if(outputPath.empty())
+    {
+        writeTracks(std::cout, format, passing, model.trackFeatures);
+        std::cout.flush();
+    }
+    else
+    {
+        std::ofstream file(outputPath);
+        writeTracks(file, format, passing, model.trackFeatures);
+        if(!file.good())
+        {
+            std::cerr << "could not write " << outputPath << "\n";
+            return 1;
+        }
+    }
+    if(newPlaylistName)
+    {
+        try
+        {
+            apiAccess->createPlaylist(*newPlaylistName, getTrackUris(passing));
+        }
+        catch(const ApiRequestError& error)
+        {
+            std::cerr << "could not create the playlist: " << error.what() << "\n";
+            return 1;
+        }
+    }
+    const double outputSeconds = secondsSince(start);
+
+    if(printTimings)
+    {
+        std::cerr << passing.size() << " of " << model.playlist.size() << " tracks passed\n"
+                  << "load   " << loadSeconds * 1000.0 << " ms\n"
+                  << "build  " << buildSeconds * 1000.0 << " ms\n"
+                  << "filter " << filterSeconds * 1000.0 << " ms\n"
+                  << "output " << outputSeconds * 1000.0 << " ms\n";
+    }
+    return 0;
+}
@@ -0,0 +1,392 @@
+#include <CoverLoader/CoverLoader.hpp>
+#include <MockSpotify/MockSpotifyServer.hpp>
+#include <Spotify/PlaylistSource.hpp>
+#include <Spotify/PlaylistStream.hpp>
+#include <Spotify/SpotifyApiAccess.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <charconv>
+#include <chrono>
+#include <cstdio>
+#include <exception>
+#include <fstream>
+#include <iostream>
+#include <optional>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#ifdef _WIN32
+    #include <windows.h>
+    #include <psapi.h>
+#else
+    #include <sys/resource.h>
+#endif
+
+static constexpr std::string_view usage =
+    "PlaylistLoadBenchmark [options]\n"
+    "Loads synthetic playlists of the given sizes from a mock of the spotify api, the way the app does, and\n"
+    "reports how long it took, the requests per second and the peak memory use.\n"
+    "  --sizes <n,n,...>     track counts, default 1000,10000,50000,200000\n"
+    "  --api-url <url>       a MockSpotifyServer that is already running (ie. http://127.0.0.1:8888),\n"
+    "                        otherwise one is started in this process with the options below\n"
+    "  --latency <ms>        added to every response\n"
+    "  --bandwidth <kB/s>    shared by all responses, 0 is unlimited\n"
+    "  --rate-limit <n>      requests per 30 seconds the mock allows before answering with 429\n"
+    "  --throttle <0..1>     share of requests the mock answers with 429 anyway\n"
+    "  --server-errors <0..1> share of requests the mock answers with 503\n"
+    "  --drop <0..1>         share of requests whose connection the mock drops in the middle of the answer\n"
+    "  --spotify-limit       the client keeps to spotify's rate limit, instead of sending as fast as it can\n"
+    "  --max-in-flight <n>   requests the client sends at the same time, default 8\n"
+    "  --no-pool             open a new connection for every request instead of keeping them alive\n"
+    "  --pipelining <mode>   on (default) requests features and genres while the pages come in, off waits for\n"
+    "                        every page before the features and for those before the genres, both runs every\n"
+    "                        size off and on, ie. --latency 40 --sizes 5000 --pipelining both\n"
+    "  --stream              a thread takes the tracks while they are loading, like the ui does\n"
+    "  --covers              also download and decode every cover\n";
+
+template <typename T>
+static bool parseNumber(std::string_view text, T& value)
+{
+    const auto [end, error] = std::from_chars(text.data(), text.data() + text.size(), value);
+    return error == std::errc() && end == text.data() + text.size();
+}
+
+#ifdef __linux__
+// the peak is reset before every run, so each run gets its own
+static void resetPeakMemory()
+{
+    std::ofstream("/proc/self/clear_refs") << "5";
+}
+#else
+// there is no way to reset the peak, thats why the sizes run from small to large
+static void resetPeakMemory()
+{
+}
+#endif
+
+// in MB
+static double getPeakMemory()
+{
+#ifdef _WIN32
+    PROCESS_MEMORY_COUNTERS counters{};
+    GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters));
+    return static_cast<double>(counters.PeakWorkingSetSize) / (1 << 20);
+#elif defined(__linux__)
+    std::ifstream status("/proc/self/status");
+    std::string line;
+    while(std::getline(status, line))
+    {
+        if(line.starts_with("VmHWM:"))
+        {
+            return std::stod(line.substr(6)) / 1024;
+        }
+    }
+    return 0.0;
+#else
+    rusage usage{};
+    getrusage(RUSAGE_SELF, &usage);
+    // bytes on macos
+    return static_cast<double>(usage.ru_maxrss) / (1 << 20);
+#endif
+}
+
+// how the client loads
+struct RunOptions
+{
+    RateLimit rateLimit;
+    uint32_t maxInFlight = HttpTransport::defaultMaxInFlight();
+    bool reuseConnections = true;
+    bool pipelining = true;
+    bool stream = false;
+    bool covers = false;
+};
+
+struct RunResult
+{
+    uint32_t tracks = 0;
+    uint64_t requests = 0;
+    uint64_t throttled = 0;
+    // after a 5xx or a network error
+    uint64_t retried = 0;
+    // opened by the api requests
+    uint32_t connections = 0;
+    double downloadSeconds = 0.0;
+    double buildSeconds = 0.0;
+    double coverSeconds = 0.0;
+    double peakMemory = 0.0;
+};
+
+static double secondsSince(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+static RunResult run(uint32_t size, const std::string& serverUrl, const RunOptions& options)
+{
+    RunResult result;
+    resetPeakMemory();
+    // a new one every time, so nothing (connections, statistics) carries over
+    SpotifyApiAccess apiAccess(
+        serverUrl + "/v1", serverUrl, options.rateLimit, options.maxInFlight, options.reuseConnections);
+    apiAccess.setPipelining(options.pipelining);
+
+    LoadProgress progress;
+    PlaylistStream playlistStream;
+    std::atomic<bool> loading = true;
+    std::thread consumer;
+    if(options.stream)
+    {
+        consumer = std::thread(
+            [&]
+            {
+                std::vector<TrackSource> tracks;
+                while(loading)
+                {
+                    std::this_thread::sleep_for(std::chrono::milliseconds(16));
+                    if(playlistStream.hasUpdate())
+                    {
+                        PlaylistStream::Update update = playlistStream.take();
+                        std::move(update.tracks.begin(), update.tracks.end(), std::back_inserter(tracks));
+                    }
+                }
+            });
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+    PlaylistSource source = apiAccess.downloadPlaylist(
+        MockSpotifyApi::makePlaylistId(size), progress, options.stream ? &playlistStream : nullptr);
+    result.downloadSeconds = secondsSince(start);
+    loading = false;
+    if(consumer.joinable())
+    {
+        consumer.join();
+    }
+
+    const auto buildStart = std::chrono::steady_clock::now();
+    SpotifyApiAccess::PlaylistData_t playlistData = buildPlaylistData(source);
+    result.buildSeconds = secondsSince(buildStart);
+    result.tracks = static_cast<uint32_t>(std::get<0>(playlistData).size());
+
+    if(options.covers)
+    {
+        SpotifyApiAccess::CoverTable_t& coverTable = std::get<2>(playlistData);
+        std::vector<CoverInfo*> coverInfos;
+        coverInfos.reserve(coverTable.size());
+        for(auto& [albumId, cover] : coverTable)
+        {
+            coverInfos.push_back(&cover);
+        }
+        const auto coverStart = std::chrono::steady_clock::now();
+        CoverLoader coverLoader;
+        coverLoader.load(std::move(coverInfos), [](TextureLoadInfo info) { delete[] info.data; });
+        while(coverLoader.getStats().pending != 0)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        result.coverSeconds = secondsSince(coverStart);
+        coverLoader.cancel();
+    }
+
+    const HttpTransport::Stats transportStats = apiAccess.getTransport().getStats();
+    result.requests = transportStats.requests;
+    result.connections = transportStats.sessions;
+    for(const auto& [endpoint, stats] : apiAccess.getTransport().getEndpointStats())
+    {
+        result.throttled += stats.throttled;
+        result.retried += stats.retried;
+    }
+    result.peakMemory = getPeakMemory();
+    return result;
+}
+
+int main(int argc, char* argv[])
+{
+    std::vector<uint32_t> sizes = {1000, 10000, 50000, 200000};
+    std::string apiUrl;
+    MockSpotifyConfig config;
+    RunOptions options;
+    std::vector<bool> pipeliningModes = {true};
+    for(int i = 1; i < argc; i++)
+    {
+        const std::string_view option = argv[i];
+        bool valid = true;
+        if(option == "--spotify-limit")
+        {
+            options.rateLimit = SpotifyApiAccess::spotifyRateLimit;
+            continue;
+        }
+        if(option == "--no-pool")
+        {
+            options.reuseConnections = false;
+            continue;
+        }
+        if(option == "--stream")
+        {
+            options.stream = true;
+            continue;
+        }
+        if(option == "--covers")
+        {
+            options.covers = true;
+            continue;
+        }
+        if(option == "--help" || i + 1 >= argc)
+        {
+            std::cout << usage;
+            return option == "--help" ? 0 : 1;
+        }
+        const std::string_view value = argv[++i];
+        uint64_t number = 0;
+        if(option == "--sizes")
+        {
+            sizes.clear();
+            std::string_view list = value;
+            while(valid && !list.empty())
+            {
+                const size_t comma = list.find(',');
+                uint32_t size = 0;
+                valid = parseNumber(list.substr(0, comma), size) && size != 0;
+                sizes.push_back(size);
+                list.remove_prefix(comma == std::string_view::npos ? list.size() : comma + 1);
+            }
+            std::sort(sizes.begin(), sizes.end());
+        }
+        else if(option == "--api-url")
+        {
+            apiUrl = value;
+        }
+        else if(option == "--max-in-flight")
+        {
+            valid = parseNumber(value, options.maxInFlight) && options.maxInFlight != 0;
+        }
+        else if(option == "--pipelining")
+        {
+            valid = value == "on" || value == "off" || value == "both";
+            pipeliningModes = value == "on" ? std::vector<bool>{true}
+                              : value == "off" ? std::vector<bool>{false}
+                                               : std::vector<bool>{false, true};
+        }
+        else if(option == "--latency")
+        {
+            valid = parseNumber(value, number);
+            config.latency = std::chrono::milliseconds(number);
+        }
+        else if(option == "--bandwidth")
+        {
+            valid = parseNumber(value, number);
+            config.bytesPerSecond = number * 1000;
+        }
+        else if(option == "--rate-limit")
+        {
+            valid = parseNumber(value, config.requestsPerWindow);
+        }
+        else if(option == "--throttle")
+        {
+            valid = parseNumber(value, config.throttleProbability);
+        }
+        else if(option == "--server-errors")
+        {
+            valid = parseNumber(value, config.serverErrorProbability);
+        }
+        else if(option == "--drop")
+        {
+            valid = parseNumber(value, config.dropProbability);
+        }
+        else
+        {
+            valid = false;
+        }
+        if(!valid)
+        {
+            std::cout << "invalid option " << option << " " << value << "\n" << usage;
+            return 1;
+        }
+    }
+
+    std::optional<MockSpotifyServer> server;
+    if(apiUrl.empty())
+    {
+        std::ifstream image(MISC_PATH "/albumPlaceholder.jpg", std::ios::binary);
+        std::stringstream imageData;
+        imageData << image.rdbuf();
+        config.imageData = std::move(imageData).str();
+        server.emplace(config);
+        if(!server->isRunning())
+        {
+            std::cout << "could not start the mock server" << std::endl;
+            return 1;
+        }
+        apiUrl = server->getUrl();
+    }
+    std::cout << "loading from " << apiUrl << " with up to " << options.maxInFlight << " requests in flight"
+              << (options.reuseConnections ? ", connections are kept alive" : ", a new connection for every request")
+              << std::endl;
+
+    std::printf(
+        "%10s %10s %10s %10s %10s %12s %12s %12s %10s %10s %10s %12s\n",
+        "tracks",
+        "pipelined",
+        "requests",
+        "429s",
+        "retries",
+        "connections",
+        "download s",
+        "requests/s",
+        "tracks/s",
+        "build s",
+        "covers s",
+        "peak RSS MB");
+    for(const uint32_t size : sizes)
+    {
+        for(const bool pipelining : pipeliningModes)
+        {
+            options.pipelining = pipelining;
+            try
+            {
+                const RunResult result = run(size, apiUrl, options);
+                std::printf(
+                    "%10u %10s %10llu %10llu %10llu %12u %12.3f %12.1f %10.0f %10.3f %10.3f %12.1f\n",
+                    result.tracks,
+                    pipelining ? "yes" : "no",
+                    static_cast<unsigned long long>(result.requests),
+                    static_cast<unsigned long long>(result.throttled),
+                    static_cast<unsigned long long>(result.retried),
+                    result.connections,
+                    result.downloadSeconds,
+                    static_cast<double>(result.requests) / result.downloadSeconds,
+                    result.tracks / result.downloadSeconds,
+                    result.buildSeconds,
+                    result.coverSeconds,
+                    result.peakMemory);
+                if(result.tracks != size)
+                {
+                    std::printf("    expected %u tracks\n", size);
+                }
+            }
+            catch(const std::exception& e)
+            {
+                std::printf("%10u %10s failed: %s\n", size, pipelining ? "yes" : "no", e.what());
+            }
+        }
+    }
+
+    if(server)
+    {
+        server->stop();
+        const MockSpotifyApi::Stats stats = server->getApi().getStats();
+        std::cout << "\nmock server: " << stats.requests << " requests, " << stats.throttled << " throttled, "
+                  << stats.serverErrors << " 503s, " << stats.dropped << " dropped, " << (stats.bytesSent >> 20)
+                  << " MB sent\n";
+        for(const auto& [endpoint, endpointStats] : server->getApi().getEndpointStats())
+        {
+            std::cout << "    " << endpoint << ": " << endpointStats.requests << " requests, "
+                      << endpointStats.throttled << " throttled, " << endpointStats.serverErrors << " 503s, "
+                      << endpointStats.dropped << " dropped\n";
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,669 @@
+#include "SyntheticPlaylist.hpp"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <charconv>
+#include <cmath>
+#include <fstream>
+#include <vector>
+
+// tracks are generated in blocks of this many, every block from its own seed
+static constexpr uint32_t blockSize = 1024;
+static constexpr std::string_view base62 = "0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz";
+
+static uint64_t mix(uint64_t value)
+{
+    // splitmix64
+    value += 0x9E3779B97F4A7C15;
+    value = (value ^ (value >> 30)) * 0xBF58476D1CE4E5B9;
+    value = (value ^ (value >> 27)) * 0x94D049BB133111EB;
+    return value ^ (value >> 31);
+}
+
+/*
+    Only integer and basic float math, the distributions of the standard library are implementation defined
+    and would give different playlists with different compilers
+*/
+class Random
+{
+  public:
+    explicit Random(uint64_t seed) : state(seed)
+    {
+    }
+
+    uint64_t next()
+    {
+        state += 0x9E3779B97F4A7C15;
+        return mix(state);
+    }
+    // in [0, 1)
+    double unit()
+    {
+        return static_cast<double>(next() >> 11) * 0x1.0p-53;
+    }
+    // below count
+    uint32_t below(uint32_t count)
+    {
+        return static_cast<uint32_t>((next() >> 32) * count >> 32);
+    }
+    // roughly standard normal (sum of 4 uniforms), never further out than 3.5
+    double normal()
+    {
+        return (unit() + unit() + unit() + unit() - 2.0) * 1.7320508075688772;
+    }
+
+  private:
+    uint64_t state;
+};
+
+// index 0 is the most likely, then 1 and so on
+class ZipfTable
+{
+  public:
+    ZipfTable(uint32_t count, double exponent) : cumulative(count)
+    {
+        double sum = 0.0;
+        for(uint32_t i = 0; i < count; i++)
+        {
+            sum += 1.0 / std::pow(static_cast<double>(i + 1), exponent);
+            cumulative[i] = sum;
+        }
+        for(double& value : cumulative)
+        {
+            value /= sum;
+        }
+    }
+
+    uint32_t sample(Random& random) const
+    {
+        const auto iter = std::upper_bound(cumulative.begin(), cumulative.end(), random.unit());
+        return static_cast<uint32_t>(std::min<size_t>(iter - cumulative.begin(), cumulative.size() - 1));
+    }
+    // share of the samples that are index
+    double probability(uint32_t index) const
+    {
+        return cumulative[index] - (index == 0 ? 0.0 : cumulative[index - 1]);
+    }
+
+  private:
+    std::vector<double> cumulative;
+};
+
+static float clampUnit(double value)
+{
+    return static_cast<float>(std::clamp(value, 0.0, 1.0));
+}
+
+// 22 base62 characters like the real ones, the second half is the index so they never collide
+static std::string makeId(uint64_t seed, char kind, uint64_t index)
+{
+    std::string id(22, '0');
+    uint64_t scrambled = mix(seed ^ (static_cast<uint64_t>(kind) << 56) ^ index);
+    uint64_t plain = index;
+    for(size_t i = 11; i-- > 0;)
+    {
+        id[i] = base62[scrambled % base62.size()];
+        scrambled /= base62.size();
+        id[11 + i] = base62[plain % base62.size()];
+        plain /= base62.size();
+    }
+    return id;
+}
+
+// ----
+
+static constexpr std::array<std::string_view, 32> latinWords = {
+    "Midnight", "Golden", "Velvet",  "Electric", "Silent", "Broken", "Neon",   "Paper",
+    "Summer",   "Ocean",  "Fire",    "Glass",    "Heart",  "River",  "Shadow", "Honey",
+    "Static",   "Wild",   "Crystal", "Lonely",   "Sugar",  "Cosmic", "Faded",  "Northern",
+    "Lights",   "Dreams", "Avenue",  "Machine",  "Season", "Garden", "Signal", "Horizon"};
+// accents, other scripts and emoji, all of them occur in real playlists
+static constexpr std::array<std::string_view, 24> unicodeWords = {
+    "Café",    "Beyoncé", "Señorita", "Über",   "Mañana", "Été",    "Ljubav", "Øresund",
+    "夜の街",  "東京",    "さくら",   "밤하늘", "사랑",   "서울",   "Ночь",   "Москва",
+    "Καλοκαίρι", "שלום", "حبيبي",    "नमस्ते",  "Tình yêu", "🌙",  "🔥",     "♥"};
+
+static void appendWord(std::string& out, Random& random, double unicodeShare)
+{
+    if(random.unit() < unicodeShare)
+    {
+        out += unicodeWords[random.below(unicodeWords.size())];
+    }
+    else
+    {
+        out += latinWords[random.below(latinWords.size())];
+    }
+}
+
+static std::string makeName(Random& random, double unicodeShare, uint32_t minWords, uint32_t maxWords)
+{
+    std::string name;
+    const uint32_t words = minWords + random.below(maxWords - minWords + 1);
+    for(uint32_t w = 0; w < words; w++)
+    {
+        if(w != 0)
+        {
+            name += ' ';
+        }
+        appendWord(name, random, unicodeShare);
+    }
+    return name;
+}
+
+// every genre name is unique, the most popular ones (low indices) are the plain ones
+static std::string getGenreName(uint32_t genre)
+{
+    static constexpr std::array<std::string_view, 36> styles = {
+        "pop",      "rock",    "hip hop", "house",   "techno",    "indie",  "jazz",    "soul",    "r&b",
+        "metal",    "punk",    "folk",    "country", "trap",      "edm",    "ambient", "disco",   "funk",
+        "reggae",   "dub",     "trance",  "drill",   "grime",     "garage", "blues",   "gospel",  "k-pop",
+        "j-pop",    "cumbia",  "forró",   "chanson", "schlager",  "emo",    "ska",     "bossa nova", "lo-fi"};
+    static constexpr std::array<std::string_view, 16> prefixes = {
+        "", "deep ", "alt ", "dark ", "dream ", "neo ", "post ", "hard ", "modern ", "classic ", "experimental ",
+        "melodic ", "acid ", "chill ", "progressive ", "underground "};
+    static constexpr std::array<std::string_view, 12> regions = {
+        "",          "german ",   "uk ",       "french ", "brazilian ", "japanese ",
+        "québécois ", "swedish ", "mexicano ", "korean ", "polish ",    "australian "};
+    const uint32_t style = genre % styles.size();
+    const uint32_t prefix = genre / styles.size() % prefixes.size();
+    const uint32_t region = genre / (styles.size() * prefixes.size()) % regions.size();
+    std::string name = std::string(regions[region]) + std::string(prefixes[prefix]) + std::string(styles[style]);
+    const uint32_t round = genre / (styles.size() * prefixes.size() * regions.size());
+    if(round != 0)
+    {
+        name += " " + std::to_string(round + 1);
+    }
+    return name;
+}
+
+// ----
+
+// the mean of the features of an artists tracks
+struct ArtistStyle
+{
+    double energy = 0;
+    double acousticness = 0;
+    double danceability = 0;
+    double valence = 0;
+    // chance of an instrumental track
+    double instrumental = 0;
+    double speechiness = 0;
+    double tempo = 0;
+    double popularity = 0;
+    uint32_t firstAlbum = 0;
+    uint32_t albumCount = 1;
+};
+
+struct SyntheticArtists
+{
+    std::vector<std::string> ids;
+    std::vector<std::string> names;
+    std::vector<ArtistStyle> styles;
+    std::vector<std::string> albumIds;
+    std::vector<std::string> albumNames;
+};
+
+static SyntheticArtists
+generateArtists(const SyntheticPlaylistConfig& config, const ZipfTable& artistTable, uint32_t artistCount)
+{
+    Random random(mix(config.seed ^ 0xA271));
+    SyntheticArtists artists;
+    artists.ids.reserve(artistCount);
+    artists.names.reserve(artistCount);
+    artists.styles.resize(artistCount);
+    // features add about a third of an artist to every track that has them
+    const double tracksPerDraw = config.trackCount * (1.0 + 0.3 * config.featuringShare);
+    uint32_t albumCount = 0;
+    for(uint32_t a = 0; a < artistCount; a++)
+    {
+        artists.ids.push_back(makeId(config.seed, 'A', a));
+        artists.names.push_back(makeName(random, config.unicodeShare, 1, 3));
+
+        ArtistStyle& style = artists.styles[a];
+        style.energy = std::clamp(0.6 + 0.2 * random.normal(), 0.05, 0.98);
+        style.acousticness = std::clamp(0.95 - style.energy + 0.15 * random.normal(), 0.0, 1.0);
+        style.danceability = std::clamp(0.55 + 0.15 * random.normal() + 0.3 * (style.energy - 0.6), 0.05, 0.98);
+        style.valence = std::clamp(0.45 + 0.2 * random.normal(), 0.02, 0.98);
+        style.instrumental = random.unit() < 0.15 ? 0.8 : 0.03;
+        style.speechiness = random.unit() < 0.1 ? 0.15 + 0.25 * random.unit() : 0.03 + 0.05 * random.unit();
+        style.tempo = std::clamp(118.0 + 20.0 * random.normal() + 40.0 * (style.energy - 0.6), 60.0, 200.0);
+        // the popular artists of the playlist are popular on spotify as well
+        style.popularity = std::clamp(0.85 - 0.09 * std::log10(a + 1.0) + 0.1 * random.normal(), 0.0, 1.0);
+
+        // about one album for every 12 tracks
+        const double expectedTracks = tracksPerDraw * artistTable.probability(a);
+        style.firstAlbum = albumCount;
+        style.albumCount = std::clamp(static_cast<uint32_t>(expectedTracks / 12.0) + 1, 1u, 40u);
+        albumCount += style.albumCount;
+    }
+    artists.albumIds.reserve(albumCount);
+    artists.albumNames.reserve(albumCount);
+    for(uint32_t album = 0; album < albumCount; album++)
+    {
+        artists.albumIds.push_back(makeId(config.seed, 'B', album));
+        artists.albumNames.push_back(makeName(random, config.unicodeShare, 1, 3));
+    }
+    return artists;
+}
+
+static PlaylistSource::ArtistGenres_t
+generateGenres(const SyntheticPlaylistConfig& config, const SyntheticArtists& artists, uint32_t genreCount)
+{
+    Random random(mix(config.seed ^ 0x6E7E));
+    const ZipfTable genreTable(genreCount, config.genreSkew);
+    std::vector<std::string> genreNames(genreCount);
+    for(uint32_t g = 0; g < genreCount; g++)
+    {
+        genreNames[g] = getGenreName(g);
+    }
+    PlaylistSource::ArtistGenres_t artistGenres;
+    artistGenres.reserve(artists.ids.size());
+    for(const std::string& artistId : artists.ids)
+    {
+        std::vector<std::string>& genres = artistGenres[artistId];
+        // 0 to 4, mostly 1 to 3
+        static constexpr std::array<double, 4> amountShares = {0.12, 0.37, 0.65, 0.85};
+        const double roll = random.unit();
+        const auto amount = static_cast<uint32_t>(
+            std::upper_bound(amountShares.begin(), amountShares.end(), roll) - amountShares.begin());
+        std::vector<uint32_t> picked;
+        for(uint32_t i = 0; i < amount; i++)
+        {
+            uint32_t genre = genreTable.sample(random);
+            // most artists stay close to their main genre
+            if(!picked.empty() && random.unit() < 0.6)
+            {
+                genre = std::min(picked.front() + 1 + random.below(4), genreCount - 1);
+            }
+            if(std::find(picked.begin(), picked.end(), genre) == picked.end())
+            {
+                picked.push_back(genre);
+                genres.push_back(genreNames[genre]);
+            }
+        }
+    }
+    return artistGenres;
+}
+
+static void generateTrack(
+    const SyntheticPlaylistConfig& config,
+    const SyntheticArtists& artists,
+    const ZipfTable& artistTable,
+    Random& random,
+    uint32_t index,
+    TrackSource& track)
+{
+    std::array<uint32_t, 3> trackArtists{};
+    uint32_t artistAmount = 1;
+    trackArtists[0] = artistTable.sample(random);
+    if(random.unit() < config.featuringShare)
+    {
+        const uint32_t extra = random.unit() < 0.2 ? 2 : 1;
+        for(uint32_t e = 0; e < extra; e++)
+        {
+            const uint32_t artist = artistTable.sample(random);
+            if(std::find(trackArtists.begin(), trackArtists.begin() + artistAmount, artist) ==
+               trackArtists.begin() + artistAmount)
+            {
+                trackArtists[artistAmount++] = artist;
+            }
+        }
+    }
+
+    track.id = makeId(config.seed, 'T', index);
+    track.name = makeName(random, config.unicodeShare, 1, 4);
+    for(uint32_t a = 0; a < artistAmount; a++)
+    {
+        track.artistIds.push_back(artists.ids[trackArtists[a]]);
+        if(a != 0)
+        {
+            track.artistsNames += ", ";
+        }
+        track.artistsNames += artists.names[trackArtists[a]];
+    }
+    if(artistAmount > 1)
+    {
+        track.name += " (feat. " + artists.names[trackArtists[1]] + ")";
+    }
+
+    const ArtistStyle& style = artists.styles[trackArtists[0]];
+    const uint32_t album = style.firstAlbum + random.below(style.albumCount);
+    track.albumId = artists.albumIds[album];
+    track.albumName = artists.albumNames[album];
+    track.coverUrl = config.coverUrlBase + track.albumId;
+
+    // in the order of Track::FeatureNames
+    const double energy = std::clamp(style.energy + 0.12 * random.normal(), 0.0, 1.0);
+    const double danceability = std::clamp(style.danceability + 0.1 * random.normal(), 0.0, 1.0);
+    track.features[0] = clampUnit(style.acousticness - 0.6 * (energy - style.energy) + 0.1 * random.normal());
+    track.features[1] = static_cast<float>(danceability);
+    track.features[2] = static_cast<float>(energy);
+    track.features[3] = random.unit() < style.instrumental ? clampUnit(0.75 + 0.15 * random.normal())
+                                                            : clampUnit(0.01 * std::abs(random.normal()));
+    track.features[4] = clampUnit(style.speechiness * (0.6 + 0.8 * random.unit()));
+    track.features[5] = random.unit() < 0.08 ? clampUnit(0.7 + 0.15 * random.normal())
+                                             : clampUnit(0.12 + 0.05 * std::abs(random.normal()));
+    track.features[6] =
+        clampUnit(style.valence + 0.12 * random.normal() + 0.3 * (danceability - style.danceability));
+    track.features[7] = static_cast<float>(
+        std::clamp(style.tempo + 12.0 * random.normal() + 30.0 * (energy - style.energy), 50.0, 220.0));
+    // whole numbers on spotify
+    track.features[8] =
+        static_cast<float>(std::round(std::clamp(style.popularity + 0.12 * random.normal(), 0.0, 1.0) * 100.0)) /
+        100.f;
+}
+
+SyntheticPlaylist generateSyntheticPlaylist(const SyntheticPlaylistConfig& config, ThreadPool* pool)
+{
+    const uint32_t artistCount =
+        config.artistCount != 0 ? config.artistCount : std::max(config.trackCount / 10, 1u);
+    const uint32_t genreCount = config.genreCount != 0 ? config.genreCount : std::max(artistCount / 50, 100u);
+    const ZipfTable artistTable(artistCount, config.artistSkew);
+    const SyntheticArtists artists = generateArtists(config, artistTable, artistCount);
+
+    SyntheticPlaylist playlist;
+    PlaylistSource& source = playlist.source;
+    source.artistGenres = generateGenres(config, artists, genreCount);
+    playlist.artistNames.reserve(artistCount);
+    for(uint32_t a = 0; a < artistCount; a++)
+    {
+        playlist.artistNames.emplace(artists.ids[a], artists.names[a]);
+    }
+
+    source.tracks.resize(config.trackCount);
+    const uint32_t blockCount = (config.trackCount + blockSize - 1) / blockSize;
+    const auto generateBlocks = [&](uint32_t /*chunk*/, uint32_t firstBlock, uint32_t lastBlock)
+    {
+        for(uint32_t block = firstBlock; block < lastBlock; block++)
+        {
+            Random random(mix(config.seed ^ (0x7AC5000000000000 + block)));
+            const uint32_t end = std::min((block + 1) * blockSize, config.trackCount);
+            for(uint32_t i = block * blockSize; i < end; i++)
+            {
+                generateTrack(config, artists, artistTable, random, i, source.tracks[i]);
+            }
+        }
+    };
+    if(pool != nullptr)
+    {
+        pool->parallelFor(blockCount, 1, generateBlocks);
+    }
+    else
+    {
+        generateBlocks(0, 0, blockCount);
+    }
+
+    std::string snapshotId;
+    for(uint64_t bits = mix(config.seed ^ config.trackCount); snapshotId.size() < 10; bits /= base62.size())
+    {
+        snapshotId += base62[bits % base62.size()];
+    }
+    source.snapshotId = std::move(snapshotId);
+    source.updatePageHashes();
+    return playlist;
+}
+
+SpotifyApiAccess::PlaylistData_t
+generateSyntheticPlaylistData(const SyntheticPlaylistConfig& config, ThreadPool* pool)
+{
+    return buildPlaylistData(generateSyntheticPlaylist(config, pool).source, pool);
+}
+
+// ----
+
+static void appendJsonString(std::string& out, std::string_view text)
+{
+    out += '"';
+    for(const char c : text)
+    {
+        if(c == '"' || c == '\\')
+        {
+            out += '\\';
+            out += c;
+        }
+        else if(static_cast<unsigned char>(c) < 0x20)
+        {
+            static constexpr std::string_view hex = "0123456789abcdef";
+            out += "\\u00";
+            out += hex[static_cast<unsigned char>(c) >> 4];
+            out += hex[c & 0xF];
+        }
+        else
+        {
+            out += c;
+        }
+    }
+    out += '"';
+}
+
+static void appendNumber(std::string& out, float value)
+{
+    std::array<char, 32> buffer{};
+    const auto result = std::to_chars(buffer.data(), buffer.data() + buffer.size(), value);
+    out.append(buffer.data(), result.ptr);
+}
+
+static bool writeFile(const std::filesystem::path& path, std::string_view text)
+{
+    std::ofstream file(path, std::ios::binary);
+    file.write(text.data(), static_cast<std::streamsize>(text.size()));
+    return file.good();
+}
+
+static void forEachChunk(ThreadPool* pool, uint32_t count, const ThreadPool::ChunkFunc& func)
+{
+    if(pool != nullptr)
+    {
+        pool->parallelFor(count, 1, func);
+    }
+    else
+    {
+        func(0, 0, count);
+    }
+}
+
+bool writeMockSpotifyFiles(
+    const SyntheticPlaylist& playlist,
+    std::string_view playlistId,
+    const std::filesystem::path& directory,
+    ThreadPool* pool)
+{
+    const PlaylistSource& source = playlist.source;
+    const auto trackCount = static_cast<uint32_t>(source.tracks.size());
+    const std::filesystem::path playlistDirectory = directory / "playlists";
+    const std::filesystem::path pageDirectory = playlistDirectory / playlistId / "tracks";
+    const std::filesystem::path featureDirectory = directory / "audio-features";
+    const std::filesystem::path artistDirectory = directory / "artists";
+    std::error_code error;
+    std::filesystem::create_directories(pageDirectory, error);
+    std::filesystem::create_directories(featureDirectory, error);
+    std::filesystem::create_directories(artistDirectory, error);
+    std::atomic<bool> success = true;
+
+    std::string info = R"({"name":"Synthetic playlist )" + std::to_string(trackCount) + R"(","snapshot_id":)";
+    appendJsonString(info, source.snapshotId);
+    info += R"(,"tracks":{"total":)" + std::to_string(trackCount) + "}}";
+    success = writeFile(playlistDirectory / (std::string(playlistId) + ".json"), info);
+
+    // pages as the app requests them, with the audio features of their tracks
+    static constexpr std::array<std::string_view, 8> featureKeys = {
+        "acousticness",
+        "danceability",
+        "energy",
+        "instrumentalness",
+        "speechiness",
+        "liveness",
+        "valence",
+        "tempo"};
+    const uint32_t pageCount = (trackCount + PlaylistSource::pageSize - 1) / PlaylistSource::pageSize;
+    forEachChunk(
+        pool,
+        pageCount,
+        [&](uint32_t /*chunk*/, uint32_t firstPage, uint32_t lastPage)
+        {
+            std::string page;
+            std::string features;
+            for(uint32_t p = firstPage; p < lastPage; p++)
+            {
+                page = R"({"items":[)";
+                const uint32_t pageStart = p * PlaylistSource::pageSize;
+                const uint32_t pageEnd = std::min(pageStart + PlaylistSource::pageSize, trackCount);
+                for(uint32_t i = pageStart; i < pageEnd; i++)
+                {
+                    const TrackSource& track = source.tracks[i];
+                    page += i != pageStart ? "," : "";
+                    page += R"({"track":{"album":{"id":)";
+                    appendJsonString(page, track.albumId);
+                    // the app only uses the smallest cover
+                    page += R"(,"images":[{"height":64,"url":)";
+                    appendJsonString(page, track.coverUrl);
+                    page += R"(,"width":64}],"name":)";
+                    appendJsonString(page, track.albumName);
+                    page += R"(},"artists":[)";
+                    for(size_t a = 0; a < track.artistIds.size(); a++)
+                    {
+                        page += a != 0 ? "," : "";
+                        page += R"({"id":)";
+                        appendJsonString(page, track.artistIds[a]);
+                        page += R"(,"name":)";
+                        const auto name = playlist.artistNames.find(track.artistIds[a]);
+                        appendJsonString(
+                            page,
+                            name != playlist.artistNames.end() ? std::string_view(name->second) : std::string_view());
+                        page += "}";
+                    }
+                    page += R"(],"id":)";
+                    appendJsonString(page, track.id);
+                    page += R"(,"name":)";
+                    appendJsonString(page, track.name);
+                    page += R"(,"popularity":)" + std::to_string(std::lround(track.features[8] * 100.f)) + "}}";
+
+                    features = R"({"id":)";
+                    appendJsonString(features, track.id);
+                    for(size_t f = 0; f < featureKeys.size(); f++)
+                    {
+                        features += ",\"" + std::string(featureKeys[f]) + "\":";
+                        appendNumber(features, track.features[f]);
+                    }
+                    features += "}";
+                    if(!writeFile(featureDirectory / (track.id + ".json"), features))
+                    {
+                        success = false;
+                    }
+                }
+                page += "]}";
+                if(!writeFile(pageDirectory / (std::to_string(pageStart) + ".json"), page))
+                {
+                    success = false;
+                }
+            }
+        });
+
+    // every artist of the playlist, with the ones sharing their main genre as related artists
+    std::vector<const std::string*> artistIds;
+    {
+        std::unordered_map<std::string_view, bool> seen;
+        for(const TrackSource& track : source.tracks)
+        {
+            for(const std::string& artistId : track.artistIds)
+            {
+                if(seen.try_emplace(artistId, true).second)
+                {
+                    artistIds.push_back(&artistId);
+                }
+            }
+        }
+    }
+    std::unordered_map<std::string_view, std::vector<const std::string*>> byMainGenre;
+    for(const std::string* artistId : artistIds)
+    {
+        const auto genres = source.artistGenres.find(*artistId);
+        if(genres != source.artistGenres.end() && !genres->second.empty())
+        {
+            std::vector<const std::string*>& sameGenre = byMainGenre[genres->second.front()];
+            if(sameGenre.size() <= 20)
+            {
+                sameGenre.push_back(artistId);
+            }
+        }
+    }
+    forEachChunk(
+        pool,
+        static_cast<uint32_t>(artistIds.size()),
+        [&](uint32_t /*chunk*/, uint32_t first, uint32_t last)
+        {
+            std::string artist;
+            std::string related;
+            for(uint32_t a = first; a < last; a++)
+            {
+                const std::string& artistId = *artistIds[a];
+                const auto name = playlist.artistNames.find(artistId);
+                const std::string_view artistName =
+                    name != playlist.artistNames.end() ? std::string_view(name->second) : std::string_view();
+                const auto genres = source.artistGenres.find(artistId);
+                artist = R"({"id":)";
+                appendJsonString(artist, artistId);
+                artist += R"(,"name":)";
+                appendJsonString(artist, artistName);
+                artist += R"(,"genres":[)";
+                related = R"({"artists":[)";
+                if(genres != source.artistGenres.end())
+                {
+                    for(size_t g = 0; g < genres->second.size(); g++)
+                    {
+                        artist += g != 0 ? "," : "";
+                        appendJsonString(artist, genres->second[g]);
+                    }
+                }
+                const auto sameGenre = genres != source.artistGenres.end() && !genres->second.empty()
+                                           ? byMainGenre.find(genres->second.front())
+                                           : byMainGenre.end();
+                if(sameGenre != byMainGenre.end())
+                {
+                    bool firstRelated = true;
+                    for(const std::string* other : sameGenre->second)
+                    {
+                        if(*other == artistId)
+                        {
+                            continue;
+                        }
+                        related += firstRelated ? "" : ",";
+                        firstRelated = false;
+                        related += R"({"id":)";
+                        appendJsonString(related, *other);
+                        related += "}";
+                    }
+                }
+                artist += "]}";
+                related += "]}";
+                std::error_code createError;
+                std::filesystem::create_directories(artistDirectory / artistId, createError);
+                if(!writeFile(artistDirectory / (artistId + ".json"), artist) ||
+                   !writeFile(artistDirectory / artistId / "related-artists.json", related))
+                {
+                    success = false;
+                }
+            }
+        });
+
+    // the same recommendations for every seed, spread over the playlist
+    std::string recommendations = R"({"seeds":[],"tracks":[)";
+    const uint32_t recommendationCount = std::min(trackCount, 100u);
+    for(uint32_t r = 0; r < recommendationCount; r++)
+    {
+        const TrackSource& track = source.tracks[static_cast<uint64_t>(r) * trackCount / recommendationCount];
+        recommendations += r != 0 ? "," : "";
+        recommendations += R"({"id":)";
+        appendJsonString(recommendations, track.id);
+        recommendations += R"(,"name":)";
+        appendJsonString(recommendations, track.name);
+        recommendations += "}";
+    }
+    recommendations += "]}";
+    if(!writeFile(directory / "recommendations.json", recommendations))
+    {
+        success = false;
+    }
+    return success;
+}
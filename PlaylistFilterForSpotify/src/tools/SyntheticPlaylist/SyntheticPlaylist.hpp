@@ -0,0 +1,69 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+#include <Spotify/PlaylistSource.hpp>
+#include <ThreadPool/ThreadPool.hpp>
+
+struct SyntheticPlaylistConfig
+{
+    uint32_t trackCount = 10000;
+    // 0 picks one artist for every 10 tracks
+    uint32_t artistCount = 0;
+    // genres the artists pick theirs from, 0 picks about one for every 50 artists (but at least 100)
+    uint32_t genreCount = 0;
+    // exponents of the zipf distributions, how much more often the most popular artists/genres show up
+    double artistSkew = 0.8;
+    double genreSkew = 1.1;
+    // share of the tracks with more than one artist
+    double featuringShare = 0.25;
+    // share of the names in other scripts than latin (or with accents, emoji)
+    double unicodeShare = 0.2;
+    // covers are this followed by the album id
+    std::string coverUrlBase = "https://i.scdn.co/image/";
+    uint64_t seed = 1;
+};
+
+struct SyntheticPlaylist
+{
+    using ArtistNames_t = std::unordered_map<SpotifyApiAccess::ArtistID, std::string, StringHash, std::equal_to<>>;
+
+    PlaylistSource source;
+    // the tracks only have the names of their artists joined, the mock server files need them one by one
+    ArtistNames_t artistNames;
+};
+
+/*
+    Generates a playlist that looks like a real (huge) one, for testing and benchmarking at scale:
+        - artists are picked following a zipf distribution, so a few artists have a lot of tracks and most
+          have only one or two. A share of the tracks has up to 3 artists
+        - every artist has 0 to 4 genres, the popular genres are picked far more often and an artists genres
+          tend to be close to each other (ie. "deep house" and "house")
+        - tracks of an artist share a handful of albums
+        - the audio features of a track are drawn around the style of its artist, so they correlate like the
+          real ones do (energetic tracks are rarely acoustic, tempo goes up with energy, popular artists have
+          popular tracks)
+        - some names are in other scripts or contain accents and emoji
+    The same config always gives the same playlist, no matter how many threads the pool has.
+    The pool splits up generating the tracks, without one everything runs on the calling thread
+*/
+SyntheticPlaylist generateSyntheticPlaylist(const SyntheticPlaylistConfig& config, ThreadPool* pool = nullptr);
+
+// the tables the app works with, same as buildPlaylistData() of a downloaded playlist
+SpotifyApiAccess::PlaylistData_t
+generateSyntheticPlaylistData(const SyntheticPlaylistConfig& config, ThreadPool* pool = nullptr);
+
+/*
+    Writes the files the mock server answers from when started with --recorded <directory> (see MockSpotifyApi),
+    so the playlist can be loaded through the api under the given id.
+    Returns false if any file could not be written
+*/
+bool writeMockSpotifyFiles(
+    const SyntheticPlaylist& playlist,
+    std::string_view playlistId,
+    const std::filesystem::path& directory,
+    ThreadPool* pool = nullptr);
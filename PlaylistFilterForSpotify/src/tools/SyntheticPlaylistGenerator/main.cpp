@@ -0,0 +1,169 @@
+#include <SyntheticPlaylist/SyntheticPlaylist.hpp>
+
+#include <algorithm>
+#include <charconv>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+static constexpr std::string_view usage =
+    "SyntheticPlaylistGenerator [options]\n"
+    "  --tracks <n>          default 1000000\n"
+    "  --artists <n>         default one for every 10 tracks\n"
+    "  --genres <n>          default one for every 50 artists, at least 100\n"
+    "  --artist-skew <x>     zipf exponent of the artist popularity, default 0.8\n"
+    "  --genre-skew <x>      zipf exponent of the genre popularity, default 1.1\n"
+    "  --featuring <0..1>    share of tracks with more than one artist, default 0.25\n"
+    "  --unicode <0..1>      share of names with accents, other scripts or emoji, default 0.2\n"
+    "  --seed <n>            default 1\n"
+    "  --mock-dir <dir>      write the files of MockSpotifyServer --recorded <dir> there\n"
+    "  --playlist-id <id>    id of the playlist in those files, default synthetic<tracks>\n"
+    "  --public-url <url>    where the mock server is reachable, the covers point there\n"
+    "Without --mock-dir the tables of the app are built in memory and described.\n";
+
+template <typename T>
+static bool parseNumber(std::string_view text, T& value)
+{
+    const auto [end, error] = std::from_chars(text.data(), text.data() + text.size(), value);
+    return error == std::errc() && end == text.data() + text.size();
+}
+
+static double secondsSince(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+int main(int argc, char* argv[])
+{
+    SyntheticPlaylistConfig config;
+    config.trackCount = 1000000;
+    std::string mockDirectory;
+    std::string playlistId;
+    std::string publicUrl;
+    for(int i = 1; i < argc; i++)
+    {
+        const std::string_view option = argv[i];
+        if(option == "--help" || i + 1 >= argc)
+        {
+            std::cout << usage;
+            return option == "--help" ? 0 : 1;
+        }
+        const std::string_view value = argv[++i];
+        bool valid = true;
+        if(option == "--tracks")
+        {
+            valid = parseNumber(value, config.trackCount);
+        }
+        else if(option == "--artists")
+        {
+            valid = parseNumber(value, config.artistCount);
+        }
+        else if(option == "--genres")
+        {
+            valid = parseNumber(value, config.genreCount);
+        }
+        else if(option == "--artist-skew")
+        {
+            valid = parseNumber(value, config.artistSkew);
+        }
+        else if(option == "--genre-skew")
+        {
+            valid = parseNumber(value, config.genreSkew);
+        }
+        else if(option == "--featuring")
+        {
+            valid = parseNumber(value, config.featuringShare);
+        }
+        else if(option == "--unicode")
+        {
+            valid = parseNumber(value, config.unicodeShare);
+        }
+        else if(option == "--seed")
+        {
+            valid = parseNumber(value, config.seed);
+        }
+        else if(option == "--mock-dir")
+        {
+            mockDirectory = value;
+        }
+        else if(option == "--playlist-id")
+        {
+            playlistId = value;
+        }
+        else if(option == "--public-url")
+        {
+            publicUrl = value;
+        }
+        else
+        {
+            valid = false;
+        }
+        if(!valid)
+        {
+            std::cout << "invalid option " << option << " " << value << "\n" << usage;
+            return 1;
+        }
+    }
+    if(!publicUrl.empty())
+    {
+        config.coverUrlBase = publicUrl + "/image/";
+    }
+    if(playlistId.empty())
+    {
+        playlistId = "synthetic" + std::to_string(config.trackCount);
+    }
+
+    ThreadPool pool;
+    std::cout << std::fixed << std::setprecision(2);
+    auto start = std::chrono::steady_clock::now();
+    const SyntheticPlaylist playlist = generateSyntheticPlaylist(config, &pool);
+    std::cout << "generated " << playlist.source.tracks.size() << " tracks in " << secondsSince(start) << " s"
+              << std::endl;
+
+    if(!mockDirectory.empty())
+    {
+        start = std::chrono::steady_clock::now();
+        if(!writeMockSpotifyFiles(playlist, playlistId, mockDirectory, &pool))
+        {
+            std::cout << "could not write everything to " << mockDirectory << std::endl;
+            return 1;
+        }
+        std::cout << "wrote the files in " << secondsSince(start) << " s\n"
+                  << "serve them with MockSpotifyServer --recorded " << mockDirectory
+                  << (publicUrl.empty() ? "" : " (covers point to " + publicUrl + ")") << "\n"
+                  << "and load the playlist " << playlistId << std::endl;
+        return 0;
+    }
+
+    start = std::chrono::steady_clock::now();
+    const auto [tracks, features, covers, genres, genreTracks, artistIds, artistLUT] =
+        buildPlaylistData(playlist.source, &pool);
+    std::cout << "built the tables in " << secondsSince(start) << " s\n";
+
+    size_t featuring = 0;
+    std::vector<uint32_t> artistTracks(artistIds.size());
+    for(const Track& track : tracks)
+    {
+        featuring += track.artistMask.popcount() > 1 ? 1 : 0;
+        track.artistMask.forEachSetBit([&](uint32_t artist) { artistTracks[artist]++; });
+    }
+    std::sort(artistTracks.rbegin(), artistTracks.rend());
+    const size_t topArtists = std::max<size_t>(artistTracks.size() / 100, 1);
+    size_t topArtistTracks = 0;
+    for(size_t a = 0; a < std::min(topArtists, artistTracks.size()); a++)
+    {
+        topArtistTracks += artistTracks[a];
+    }
+    const auto share = [&](size_t count) { return 100.0 * static_cast<double>(count) / tracks.size(); };
+    std::cout << artistIds.size() << " artists, " << covers.size() << " albums, " << genres.size() << " genres\n"
+              << share(featuring) << "% of the tracks have more than one artist\n"
+              << "the top 1% of the artists are on " << share(topArtistTracks) << "% of the tracks\n";
+    for(size_t g = 0; g < std::min<size_t>(genres.size(), 5); g++)
+    {
+        std::cout << "  " << genres[g] << ": " << share(genreTracks[g].popcount()) << "% of the tracks\n";
+    }
+    return 0;
+}